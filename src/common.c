@@ -24,6 +24,10 @@
 #include <sys/syscall.h>
 #include <sys/types.h>
 #include <unistd.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#   define LY_CHAR_SIMD
+#   include <immintrin.h>
+#endif
 
 #include "common.h"
 #include "parser.h"
@@ -1367,24 +1371,39 @@ dec64cmp(int64_t num1, uint8_t dig1, int64_t num2, uint8_t dig2)
     return (num1 > num2 ? 1 : -1);
 }
 
-LYB_HASH
-lyb_hash(struct lys_node *sibling, uint8_t collision_id)
+/* Bob Jenkin's one-at-a-time hash, used for LYB schema hashes by LYB version 0 */
+static uint32_t
+lyb_hash_v0_multi(uint32_t hash, const char *key_part, size_t len)
+{
+    size_t i;
+
+    if (key_part) {
+        for (i = 0; i < len; ++i) {
+            hash += key_part[i];
+            hash += (hash << 10);
+            hash ^= (hash >> 6);
+        }
+    } else {
+        hash += (hash << 3);
+        hash ^= (hash >> 11);
+        hash += (hash << 15);
+    }
+
+    return hash;
+}
+
+static LYB_HASH
+lyb_hash_compute(struct lys_node *sibling, uint8_t collision_id, uint32_t (*hash_multi)(uint32_t, const char *, size_t))
 {
     struct lys_module *mod;
     int ext_len;
     uint32_t full_hash;
     LYB_HASH hash;
 
-#ifdef LY_ENABLED_CACHE
-    if ((collision_id < LYS_NODE_HASH_COUNT) && sibling->hash[collision_id]) {
-        return sibling->hash[collision_id];
-    }
-#endif
-
     mod = lys_node_module(sibling);
 
-    full_hash = dict_hash_multi(0, mod->name, strlen(mod->name));
-    full_hash = dict_hash_multi(full_hash, sibling->name, strlen(sibling->name));
+    full_hash = hash_multi(0, mod->name, strlen(mod->name));
+    full_hash = hash_multi(full_hash, sibling->name, strlen(sibling->name));
     if (collision_id) {
         if (collision_id > strlen(mod->name)) {
             /* fine, we will not hash more bytes, just use more bits from the hash than previously */
@@ -1393,15 +1412,31 @@ lyb_hash(struct lys_node *sibling, uint8_t collision_id)
             /* use one more byte from the module name than before */
             ext_len = collision_id;
         }
-        full_hash = dict_hash_multi(full_hash, mod->name, ext_len);
+        full_hash = hash_multi(full_hash, mod->name, ext_len);
     }
-    full_hash = dict_hash_multi(full_hash, NULL, 0);
+    full_hash = hash_multi(full_hash, NULL, 0);
 
     /* use the shortened hash */
     hash = full_hash & (LYB_HASH_MASK >> collision_id);
     /* add colision identificator */
     hash |= LYB_HASH_COLLISION_ID >> collision_id;
 
+    return hash;
+}
+
+LYB_HASH
+lyb_hash(struct lys_node *sibling, uint8_t collision_id)
+{
+    LYB_HASH hash;
+
+#ifdef LY_ENABLED_CACHE
+    if ((collision_id < LYS_NODE_HASH_COUNT) && sibling->hash[collision_id]) {
+        return sibling->hash[collision_id];
+    }
+#endif
+
+    hash = lyb_hash_compute(sibling, collision_id, dict_hash_multi);
+
     /* save this hash */
 #ifdef LY_ENABLED_CACHE
     if (collision_id < LYS_NODE_HASH_COUNT) {
@@ -1412,6 +1447,12 @@ lyb_hash(struct lys_node *sibling, uint8_t collision_id)
     return hash;
 }
 
+LYB_HASH
+lyb_hash_v0(struct lys_node *sibling, uint8_t collision_id)
+{
+    return lyb_hash_compute(sibling, collision_id, lyb_hash_v0_multi);
+}
+
 int
 lyb_has_schema_model(struct lys_node *sibling, const struct lys_module **models, int mod_count)
 {
@@ -1426,3 +1467,271 @@ lyb_has_schema_model(struct lys_node *sibling, const struct lys_module **models,
 
     return 0;
 }
+
+const uint8_t ly_char_class[256] = {
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x02, 0x01, 0x01, 0x02, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x08, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x08, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+    0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+    0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+    0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+    0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+    0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+    0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+    0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04
+};
+
+/**
+ * @brief Get the length of a valid multi-byte UTF-8 character accepted by copyutf8().
+ *
+ * Overlong, truncated or otherwise malformed sequences are not accepted even if copyutf8()
+ * would copy them, it is left to the callers to deal with them character by character.
+ *
+ * @param[in] s Character to check, its first byte has the highest bit set.
+ * @return Length of the character, 0 if not valid.
+ */
+static size_t
+ly_utf8_char_len(const unsigned char *s)
+{
+    uint32_t value;
+
+    /* a continuation byte is never NUL so the checks cannot read past the end of the string */
+    if ((s[0] >= 0xc2) && (s[0] <= 0xdf)) {
+        return ((s[1] & 0xc0) == 0x80) ? 2 : 0;
+    } else if ((s[0] & 0xf0) == 0xe0) {
+        if (((s[1] & 0xc0) != 0x80) || ((s[2] & 0xc0) != 0x80)) {
+            return 0;
+        }
+        value = ((uint32_t)(s[0] & 0xf) << 12) | ((uint32_t)(s[1] & 0x3f) << 6) | (s[2] & 0x3f);
+        if ((value < 0x800) || ((value & 0xf800) == 0xd800) || ((value >= 0xfdd0) && (value <= 0xfdef))
+                || ((value & 0xffe) == 0xffe)) {
+            return 0;
+        }
+        return 3;
+    } else if ((s[0] >= 0xf0) && (s[0] <= 0xf4)) {
+        if (((s[1] & 0xc0) != 0x80) || ((s[2] & 0xc0) != 0x80) || ((s[3] & 0xc0) != 0x80)) {
+            return 0;
+        }
+        value = ((uint32_t)(s[0] & 0x7) << 18) | ((uint32_t)(s[1] & 0x3f) << 12) | ((uint32_t)(s[2] & 0x3f) << 6)
+                | (s[3] & 0x3f);
+        if ((value < 0x10000) || (value > 0x10ffff) || ((value & 0xffe) == 0xffe)) {
+            return 0;
+        }
+        return 4;
+    }
+
+    return 0;
+}
+
+/* length of the run of valid multi-byte UTF-8 characters, none of them crossing max */
+static size_t
+ly_utf8_run(const unsigned char *s, size_t max)
+{
+    size_t i = 0, len;
+
+    while ((i < max) && (s[i] & 0x80) && (len = ly_utf8_char_len(&s[i])) && (len <= max - i)) {
+        i += len;
+    }
+
+    return i;
+}
+
+/* index of the first byte from i on with a class in stop, or at least max */
+static size_t
+ly_char_find_scalar(const unsigned char *s, uint8_t stop, size_t i, size_t max)
+{
+    /* unrolled, the NUL byte always stops the run */
+    for (; i + 4 <= max; i += 4) {
+        if (ly_char_class[s[i]] & stop) {
+            return i;
+        }
+        if (ly_char_class[s[i + 1]] & stop) {
+            return i + 1;
+        }
+        if (ly_char_class[s[i + 2]] & stop) {
+            return i + 2;
+        }
+        if (ly_char_class[s[i + 3]] & stop) {
+            return i + 3;
+        }
+    }
+    for (; (i < max) && !(ly_char_class[s[i]] & stop); ++i);
+
+    return i;
+}
+
+#ifdef LY_CHAR_SIMD
+
+/*
+ * The vector scans use aligned loads only. Such a load never crosses a page boundary, so reading
+ * the bytes following the terminating NUL byte in the same block is safe, but these bytes are
+ * outside of the string as far as the address sanitizer is concerned.
+ */
+#ifdef __SANITIZE_ADDRESS__
+#   define LY_NO_SANITIZE __attribute__((no_sanitize_address))
+#else
+#   define LY_NO_SANITIZE
+#endif
+
+/* first byte with a class in stop in a vector with bits of the candidate bytes set in mask */
+static inline int
+ly_char_find_mask(const unsigned char *s, uint8_t stop, size_t i, size_t max, uint32_t mask, size_t *ret)
+{
+    for (; mask; mask &= mask - 1) {
+        *ret = i + __builtin_ctz(mask);
+        if ((*ret >= max) || (ly_char_class[s[*ret]] & stop)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+__attribute__((target("sse2"))) LY_NO_SANITIZE
+static size_t
+ly_char_find_sse2(const unsigned char *s, uint8_t stop, size_t i, size_t max)
+{
+    __m128i v, cand;
+    size_t ret;
+
+    /* reach an aligned address */
+    for (; (i < max) && ((uintptr_t)&s[i] & 15); ++i) {
+        if (ly_char_class[s[i]] & stop) {
+            return i;
+        }
+    }
+
+    for (; i < max; i += 16) {
+        v = _mm_load_si128((const __m128i *)&s[i]);
+        if (stop & LY_CHAR_UTF8) {
+            /* signed comparison, control characters and all the bytes with the highest bit set */
+            cand = _mm_cmplt_epi8(v, _mm_set1_epi8(0x20));
+        } else {
+            cand = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v);
+        }
+        if (stop & LY_CHAR_XML) {
+            cand = _mm_or_si128(cand, _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('&')),
+                                                                _mm_cmpeq_epi8(v, _mm_set1_epi8('<'))),
+                                                   _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('>')),
+                                                                _mm_cmpeq_epi8(v, _mm_set1_epi8(']')))));
+            cand = _mm_or_si128(cand, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                                                   _mm_cmpeq_epi8(v, _mm_set1_epi8('\''))));
+        }
+        if (stop & LY_CHAR_JSON) {
+            cand = _mm_or_si128(cand, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                                                   _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))));
+        }
+        if (ly_char_find_mask(s, stop, i, max, (uint32_t)_mm_movemask_epi8(cand), &ret)) {
+            return ret;
+        }
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2"))) LY_NO_SANITIZE
+static size_t
+ly_char_find_avx2(const unsigned char *s, uint8_t stop, size_t i, size_t max)
+{
+    __m256i v, cand;
+    size_t ret;
+
+    /* reach an aligned address */
+    for (; (i < max) && ((uintptr_t)&s[i] & 31); ++i) {
+        if (ly_char_class[s[i]] & stop) {
+            return i;
+        }
+    }
+
+    for (; i < max; i += 32) {
+        v = _mm256_load_si256((const __m256i *)&s[i]);
+        if (stop & LY_CHAR_UTF8) {
+            /* signed comparison, control characters and all the bytes with the highest bit set */
+            cand = _mm256_cmpgt_epi8(_mm256_set1_epi8(0x20), v);
+        } else {
+            cand = _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1f)), v);
+        }
+        if (stop & LY_CHAR_XML) {
+            cand = _mm256_or_si256(cand, _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('&')),
+                                                                         _mm256_cmpeq_epi8(v, _mm256_set1_epi8('<'))),
+                                                         _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('>')),
+                                                                         _mm256_cmpeq_epi8(v, _mm256_set1_epi8(']')))));
+            cand = _mm256_or_si256(cand, _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+                                                         _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\''))));
+        }
+        if (stop & LY_CHAR_JSON) {
+            cand = _mm256_or_si256(cand, _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+                                                         _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))));
+        }
+        if (ly_char_find_mask(s, stop, i, max, (uint32_t)_mm256_movemask_epi8(cand), &ret)) {
+            return ret;
+        }
+    }
+
+    return i;
+}
+
+typedef size_t (*ly_char_find_f)(const unsigned char *s, uint8_t stop, size_t i, size_t max);
+
+/* selected on the first use according to the CPU */
+static ly_char_find_f ly_char_find_impl;
+
+static size_t
+ly_char_find(const unsigned char *s, uint8_t stop, size_t i, size_t max)
+{
+    ly_char_find_f impl;
+
+    impl = __atomic_load_n(&ly_char_find_impl, __ATOMIC_RELAXED);
+    if (!impl) {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            impl = ly_char_find_avx2;
+        } else if (__builtin_cpu_supports("sse2")) {
+            impl = ly_char_find_sse2;
+        } else {
+            impl = ly_char_find_scalar;
+        }
+        /* all the threads select the same one */
+        __atomic_store_n(&ly_char_find_impl, impl, __ATOMIC_RELAXED);
+    }
+
+    return impl(s, stop, i, max);
+}
+
+#else
+
+#   define ly_char_find ly_char_find_scalar
+
+#endif /* LY_CHAR_SIMD */
+
+size_t
+ly_char_run(const char *str, uint8_t stop, size_t max)
+{
+    const unsigned char *s = (const unsigned char *)str;
+    size_t i = 0, len;
+
+    assert(stop & LY_CHAR_CTRL);
+
+    while (1) {
+        i = ly_char_find(s, stop, i, max);
+        if ((i >= max) || !(stop & LY_CHAR_UTF8) || !(s[i] & 0x80)) {
+            break;
+        }
+
+        /* validate all the following multi-byte characters at once */
+        len = ly_utf8_run(&s[i], max - i);
+        if (!len) {
+            /* invalid, let the caller handle it */
+            break;
+        }
+        i += len;
+    }
+
+    return (i < max) ? i : max;
+}
@@ -94,6 +94,8 @@ ly_ctx_new(const char *search_dir, int options)
 
     /* dictionary */
     lydict_init(&ctx->dict);
+    pthread_mutex_init(&ctx->ylib_lock, NULL);
+    pthread_mutex_init(&ctx->wd_tpls_lock, NULL);
 
     /* plugins */
     ly_load_plugins();
@@ -125,6 +127,7 @@ ly_ctx_new(const char *search_dir, int options)
         }
     }
     ctx->models.module_set_id = 1;
+    ctx->feature_epoch = 1;
 
     /* load internal modules */
     if (options & LY_CTX_NOYANGLIBRARY) {
@@ -158,13 +161,14 @@ ly_ctx_new_yl_legacy(struct ly_ctx *ctx, struct lyd_node *yltree)
     struct lyd_node *module, *node;
     struct ly_set *set;
     const char *name, *revision;
-    struct ly_set features = {0, 0, {NULL}};
+    struct ly_set features;
     const struct lys_module *mod;
 
     set = lyd_find_path(yltree, "/ietf-yang-library:yang-library/modules-state/module");
     if (!set) {
         return 1;
     }
+    memset(&features, 0, sizeof features);
 
     /* process the data tree */
     for (i = 0; i < set->number; ++i) {
@@ -194,6 +198,8 @@ ly_ctx_new_yl_legacy(struct ly_ctx *ctx, struct lyd_node *yltree)
         mod = ly_ctx_load_module(ctx, name, revision);
         if (!mod) {
             LOGERR(ctx, LY_EINVAL, "Unable to load module specified by yang library data.");
+            ly_set_clean(&features);
+            free(features.set.g);
             ly_set_free(set);
             return 1;
         }
@@ -204,6 +210,8 @@ ly_ctx_new_yl_legacy(struct ly_ctx *ctx, struct lyd_node *yltree)
         }
     }
 
+    ly_set_clean(&features);
+    free(features.set.g);
     ly_set_free(set);
     return 0;
 }
@@ -215,12 +223,14 @@ ly_ctx_new_yl_common(const char *search_dir, const char *input, LYD_FORMAT forma
     unsigned int i, u;
     struct lyd_node *module, *node;
     const char *name, *revision;
-    struct ly_set features = {0, 0, {NULL}};
+    struct ly_set features;
     const struct lys_module *mod;
     struct lyd_node *yltree = NULL;
     struct ly_ctx *ctx = NULL;
     struct ly_set *set = NULL;
 
+    memset(&features, 0, sizeof features);
+
     /* create empty (with internal modules including ietf-yang-library) context */
     ctx = ly_ctx_new(search_dir, options);
     if (!ctx) {
@@ -292,6 +302,8 @@ error:
     if (set) {
         ly_set_free(set);
     }
+    ly_set_clean(&features);
+    free(features.set.g);
 
     return ctx;
 }
@@ -491,6 +503,14 @@ ly_ctx_destroy(struct ly_ctx *ctx, void (*private_destructor)(const struct lys_n
         return;
     }
 
+    /* cached yang-library data */
+    lyd_free_withsiblings(ctx->ylib_data);
+    pthread_mutex_destroy(&ctx->ylib_lock);
+
+    /* default node templates */
+    lyd_wd_tpl_free_all(ctx);
+    pthread_mutex_destroy(&ctx->wd_tpls_lock);
+
     /* models list */
     for (; ctx->models.used > 0; ctx->models.used--) {
         /* remove the applied deviations and augments */
@@ -506,6 +526,9 @@ ly_ctx_destroy(struct ly_ctx *ctx, void (*private_destructor)(const struct lys_n
     }
     free(ctx->models.list);
 
+    /* XPath dependencies */
+    lys_xpath_dep_free_all(ctx);
+
     /* clean the error list */
     ly_err_clean(ctx, 0);
     pthread_key_delete(ctx->errlist_key);
@@ -1203,23 +1226,17 @@ ctx_modules_redo_backlinks(struct ly_set *mods)
             }
             if (!next) {
 next_sibling:
-                /* no children */
-                if (elem == mod->data) {
-                    /* we are done, (START) has no children */
-                    break;
-                }
-                /* try siblings */
+                /* no children, try siblings (all the top-level nodes are processed) */
                 next = elem->next;
             }
             while (!next) {
                 /* parent is already processed, go to its sibling */
                 elem = lys_parent(elem);
-
-                /* no siblings, go back through parents */
-                if (lys_parent(elem) == lys_parent(mod->data)) {
+                if (!elem) {
                     /* we are done, no next element to process */
                     break;
                 }
+                /* no siblings, go back through parents */
                 next = elem->next;
             }
         }
@@ -1347,6 +1364,7 @@ imported:
 
     /* update the module-set-id */
     ctx->models.module_set_id++;
+    lys_iffeature_cache_invalidate(ctx);
 
     return EXIT_SUCCESS;
 }
@@ -1473,6 +1491,7 @@ checkdependency:
 
     /* update the module-set-id */
     ctx->models.module_set_id++;
+    lys_iffeature_cache_invalidate(ctx);
 
     return EXIT_SUCCESS;
 }
@@ -1588,6 +1607,7 @@ imported:
     }
     ctx->models.used = o + 1;
     ctx->models.module_set_id++;
+    lys_iffeature_cache_invalidate(ctx);
 
     /* maintain backlinks (start with internal ietf-yang-library which have leafs as possible targets of leafrefs */
     ctx_modules_undo_backlinks(ctx, mods);
@@ -1621,6 +1641,7 @@ ly_ctx_clean(struct ly_ctx *ctx, void (*private_destructor)(const struct lys_nod
         ctx->models.list[ctx->models.used - 1] = NULL;
     }
     ctx->models.module_set_id++;
+    lys_iffeature_cache_invalidate(ctx);
 
     /* maintain backlinks (actually done only with ietf-yang-library since its leafs can be target of leafref) */
     ctx_modules_undo_backlinks(ctx, NULL);
@@ -1788,8 +1809,8 @@ ly_ctx_get_module_set_id(const struct ly_ctx *ctx)
     return ctx->models.module_set_id;
 }
 
-API struct lyd_node *
-ly_ctx_info(struct ly_ctx *ctx)
+static struct lyd_node *
+ylib_data_new(struct ly_ctx *ctx)
 {
     int i, bis = 0;
     char id[8];
@@ -1797,11 +1818,6 @@ ly_ctx_info(struct ly_ctx *ctx)
     const struct lys_module *mod;
     struct lyd_node *root, *root_bis = NULL, *cont = NULL, *set_bis = NULL;
 
-    if (!ctx) {
-        LOGARG;
-        return NULL;
-    }
-
     mod = ly_ctx_get_module(ctx, "ietf-yang-library", NULL, 1);
     if (!mod || !mod->data) {
         LOGERR(ctx, LY_EINVAL, "ietf-yang-library is not implemented.");
@@ -1973,6 +1989,134 @@ error:
     return NULL;
 }
 
+/* the cached data are valid until the module set or any feature changes, ctx->ylib_lock must be held */
+static const struct lyd_node *
+ylib_data_get(struct ly_ctx *ctx)
+{
+    struct lyd_node *data;
+
+    if (!ctx->ylib_data || (ctx->ylib_epoch != ctx->feature_epoch)) {
+        data = ylib_data_new(ctx);
+        if (!data) {
+            return NULL;
+        }
+        lyd_free_withsiblings(ctx->ylib_data);
+        ctx->ylib_data = data;
+        ctx->ylib_epoch = ctx->feature_epoch;
+    }
+
+    return ctx->ylib_data;
+}
+
+API struct lyd_node *
+ly_ctx_info(struct ly_ctx *ctx)
+{
+    const struct lyd_node *data;
+    struct lyd_node *dup = NULL;
+
+    if (!ctx) {
+        LOGARG;
+        return NULL;
+    }
+
+    pthread_mutex_lock(&ctx->ylib_lock);
+    data = ylib_data_get(ctx);
+    if (data) {
+        dup = lyd_dup_withsiblings(data, LYD_DUP_OPT_RECURSIVE);
+    }
+    pthread_mutex_unlock(&ctx->ylib_lock);
+
+    return dup;
+}
+
+API const struct lyd_node *
+ly_ctx_info_cached(struct ly_ctx *ctx)
+{
+    const struct lyd_node *data;
+
+    if (!ctx) {
+        LOGARG;
+        return NULL;
+    }
+
+    pthread_mutex_lock(&ctx->ylib_lock);
+    data = ylib_data_get(ctx);
+    pthread_mutex_unlock(&ctx->ylib_lock);
+
+    return data;
+}
+
+/* compare the data subtrees including the order of the instances, the values are stored in the dictionary */
+static int
+ylib_data_equal(const struct lyd_node *first, const struct lyd_node *second)
+{
+    const struct lyd_node *iter1, *iter2;
+
+    if (first->schema != second->schema) {
+        return 0;
+    }
+
+    switch (first->schema->nodetype) {
+    case LYS_LEAF:
+    case LYS_LEAFLIST:
+        return ((struct lyd_node_leaf_list *)first)->value_str == ((struct lyd_node_leaf_list *)second)->value_str;
+    case LYS_CONTAINER:
+    case LYS_LIST:
+        for (iter1 = first->child, iter2 = second->child; iter1 && iter2; iter1 = iter1->next, iter2 = iter2->next) {
+            if (!ylib_data_equal(iter1, iter2)) {
+                return 0;
+            }
+        }
+        return !iter1 && !iter2;
+    default:
+        return 0;
+    }
+}
+
+int
+ly_ctx_info_add(struct ly_ctx *ctx, struct lyd_node **root)
+{
+    const struct lyd_node *data, *iter;
+    struct lyd_node *node;
+    int ret = EXIT_FAILURE;
+
+    pthread_mutex_lock(&ctx->ylib_lock);
+    data = ylib_data_get(ctx);
+    if (!data) {
+        goto cleanup;
+    }
+
+    /* skip the merge if all the yang-library data are already there */
+    LY_TREE_FOR(data, iter) {
+        LY_TREE_FOR(*root, node) {
+            if (node->schema == iter->schema) {
+                break;
+            }
+        }
+        if (!node || !ylib_data_equal(node, iter)) {
+            break;
+        }
+    }
+    if (!iter) {
+        ret = EXIT_SUCCESS;
+        goto cleanup;
+    }
+
+    if (!*root) {
+        *root = lyd_dup_withsiblings(data, LYD_DUP_OPT_RECURSIVE);
+        if (!*root) {
+            goto cleanup;
+        }
+    } else if (lyd_merge(*root, data, LYD_OPT_EXPLICIT)) {
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    pthread_mutex_unlock(&ctx->ylib_lock);
+    return ret;
+}
+
 API const struct lys_node *
 ly_ctx_get_node(struct ly_ctx *ctx, const struct lys_node *start, const char *nodeid, int output)
 {
@@ -2007,3 +2151,90 @@ ly_ctx_find_path(struct ly_ctx *ctx, const char *path)
     resolve_schema_nodeid(path, NULL, ctx->models.list[0], &resultset, 1, 1);
     return resultset;
 }
+
+static int
+ly_schema_map_equal_cb(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    return ((struct ly_schema_map_rec *)val1_p)->src == ((struct ly_schema_map_rec *)val2_p)->src;
+}
+
+API struct ly_ctx_schema_map *
+ly_ctx_schema_map_new(struct ly_ctx *src_ctx, struct ly_ctx *dst_ctx)
+{
+    struct ly_ctx_schema_map *map;
+
+    if (!src_ctx || !dst_ctx) {
+        LOGARG;
+        return NULL;
+    }
+
+    map = calloc(1, sizeof *map);
+    LY_CHECK_ERR_RETURN(!map, LOGMEM(dst_ctx), NULL);
+    map->ht = lyht_new(64, sizeof(struct ly_schema_map_rec), ly_schema_map_equal_cb, NULL, 1);
+    LY_CHECK_ERR_RETURN(!map->ht, LOGMEM(dst_ctx); free(map), NULL);
+
+    map->src_ctx = src_ctx;
+    map->dst_ctx = dst_ctx;
+    map->src_epoch = src_ctx->feature_epoch;
+    map->dst_epoch = dst_ctx->feature_epoch;
+    return map;
+}
+
+API void
+ly_ctx_schema_map_free(struct ly_ctx_schema_map *map)
+{
+    if (!map) {
+        return;
+    }
+
+    lyht_free(map->ht);
+    free(map);
+}
+
+API const struct lys_node *
+ly_ctx_schema_map_get(struct ly_ctx_schema_map *map, const struct lys_node *schema)
+{
+    struct ly_schema_map_rec rec, *match;
+    struct hash_table *ht;
+    uint32_t hash;
+
+    if (!map || !schema) {
+        LOGARG;
+        return NULL;
+    }
+
+    if (schema->module->ctx != map->src_ctx) {
+        /* not mapped by this map */
+        return lys_get_schema_inctx((struct lys_node *)schema, map->dst_ctx);
+    }
+
+    if ((map->src_epoch != map->src_ctx->feature_epoch) || (map->dst_epoch != map->dst_ctx->feature_epoch)) {
+        /* the modules changed, the mapped nodes may not exist anymore */
+        ht = lyht_new(64, sizeof rec, ly_schema_map_equal_cb, NULL, 1);
+        LY_CHECK_ERR_RETURN(!ht, LOGMEM(map->dst_ctx), NULL);
+        lyht_free(map->ht);
+        map->ht = ht;
+        map->src_epoch = map->src_ctx->feature_epoch;
+        map->dst_epoch = map->dst_ctx->feature_epoch;
+    }
+
+    rec.src = schema;
+    hash = dict_hash_multi(0, (const char *)&schema, sizeof schema);
+    hash = dict_hash_multi(hash, NULL, 0);
+    if (!lyht_find(map->ht, &rec, hash, (void **)&match)) {
+        return match->trg;
+    }
+
+    /* not mapped yet, search for it (remember also a missing node) */
+    rec.trg = lys_get_schema_inctx((struct lys_node *)schema, map->dst_ctx);
+    if (map->dst_epoch != map->dst_ctx->feature_epoch) {
+        /* a module was loaded using the data callback, the map will be cleared next time */
+        return rec.trg;
+    }
+    if (lyht_insert(map->ht, &rec, hash, NULL)) {
+        LOGINT(map->dst_ctx);
+        return NULL;
+    }
+
+    return rec.trg;
+}
@@ -49,6 +49,42 @@ struct ly_ctx {
 #endif
     pthread_key_t errlist_key;
     uint8_t internal_module_count;
+    struct hash_table *xpath_deps;  /* schema XPath dependency graph (struct lys_xpath_dep *) */
+    int xpath_deps_partial;         /* some modules were parsed in a trusted context, so the XPath dependencies
+                                       of their nodes are not in the graph */
+    uint32_t feature_epoch;         /* changed whenever a feature or the module set changes, invalidates
+                                       the if-feature state cached in schema nodes (see lys_iffeature_cache_invalidate())
+                                       and the yang-library data */
+    struct lyd_node *ylib_data;     /* cached ietf-yang-library data (see ly_ctx_info_cached()) */
+    uint32_t ylib_epoch;            /* feature_epoch the cached ietf-yang-library data were created in */
+    pthread_mutex_t ylib_lock;      /* lock for accessing the cached ietf-yang-library data */
+    struct hash_table *wd_tpls;     /* default node templates of leaves and leaf-lists (struct lyd_wd_tpl *) */
+    uint32_t wd_tpls_epoch;         /* feature_epoch the default node templates were created in */
+    pthread_mutex_t wd_tpls_lock;   /* lock for accessing the default node templates */
 };
 
+/* one mapped schema node */
+struct ly_schema_map_rec {
+    const struct lys_node *src;     /* schema node in the source context */
+    struct lys_node *trg;           /* corresponding schema node in the target context, NULL if there is none */
+};
+
+struct ly_ctx_schema_map {
+    struct ly_ctx *src_ctx;
+    struct ly_ctx *dst_ctx;
+    uint32_t src_epoch;             /* feature_epoch of the source context the mapped nodes are valid for */
+    uint32_t dst_epoch;             /* feature_epoch of the target context the mapped nodes are valid for */
+    struct hash_table *ht;          /* mapped schema nodes (struct ly_schema_map_rec) */
+};
+
+/**
+ * @brief Add the ietf-yang-library data of the context into a data tree, unless it already
+ * contains the same ones.
+ *
+ * @param[in] ctx Context with the modules.
+ * @param[in,out] root Data tree to add the data into, can point to NULL.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+int ly_ctx_info_add(struct ly_ctx *ctx, struct lyd_node **root);
+
 #endif /* LY_CONTEXT_H_ */
@@ -14,9 +14,13 @@
 
 #include <string.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <pthread.h>
 #include <assert.h>
+#ifdef __SSE2__
+#   include <emmintrin.h>
+#endif
 
 #include "common.h"
 #include "context.h"
@@ -94,25 +98,110 @@ lydict_clean(struct dict_table *dict)
 }
 
 /*
- * Bob Jenkin's one-at-a-time hash
- * http://www.burtleburtle.net/bob/hash/doobs.html
- *
- * Spooky hash is faster, but it works only for little endian architectures.
+ * The string hash processes 8 bytes at a time, its structure and constants come from
+ * xxHash64 (https://github.com/Cyan4973/xxHash), long parts are processed in 4 independent
+ * lanes so that the rounds can be executed in parallel. Words are always read as little endian
+ * so the hash is the same on all architectures and in all runs (LYB depends on it).
  */
+#define DICT_HASH_P1 0x9e3779b185ebca87ULL
+#define DICT_HASH_P2 0xc2b2ae3d27d4eb4fULL
+#define DICT_HASH_P3 0x165667b19e3779f9ULL
+#define DICT_HASH_P4 0x85ebca77c2b2ae63ULL
+#define DICT_HASH_P5 0x27d4eb2f165667c5ULL
+
+#define DICT_HASH_ROTL(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static uint64_t
+dict_hash_read64(const char *p)
+{
+    uint64_t word;
+
+    memcpy(&word, p, sizeof word);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
 static uint32_t
-dict_hash(const char *key, size_t len)
+dict_hash_read32(const char *p)
 {
-    uint32_t hash, i;
+    uint32_t word;
 
-    for (hash = i = 0; i < len; ++i) {
-        hash += key[i];
-        hash += (hash << 10);
-        hash ^= (hash >> 6);
+    memcpy(&word, p, sizeof word);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    word = __builtin_bswap32(word);
+#endif
+    return word;
+}
+
+static uint64_t
+dict_hash_round(uint64_t acc, uint64_t word)
+{
+    acc += word * DICT_HASH_P2;
+    acc = DICT_HASH_ROTL(acc, 31);
+    return acc * DICT_HASH_P1;
+}
+
+static uint64_t
+dict_hash_merge(uint64_t hash, uint64_t acc)
+{
+    hash ^= dict_hash_round(0, acc);
+    return hash * DICT_HASH_P1 + DICT_HASH_P4;
+}
+
+/* hash a part of a key, the returned state is fully mixed */
+static uint64_t
+dict_hash_part(uint64_t hash, const char *key_part, size_t len)
+{
+    const char *end;
+    uint64_t h, v1, v2, v3, v4;
+
+    end = key_part + len;
+    if (len >= 32) {
+        v1 = hash + DICT_HASH_P1 + DICT_HASH_P2;
+        v2 = hash + DICT_HASH_P2;
+        v3 = hash;
+        v4 = hash - DICT_HASH_P1;
+        do {
+            v1 = dict_hash_round(v1, dict_hash_read64(key_part));
+            v2 = dict_hash_round(v2, dict_hash_read64(key_part + 8));
+            v3 = dict_hash_round(v3, dict_hash_read64(key_part + 16));
+            v4 = dict_hash_round(v4, dict_hash_read64(key_part + 24));
+            key_part += 32;
+        } while (key_part + 32 <= end);
+
+        h = DICT_HASH_ROTL(v1, 1) + DICT_HASH_ROTL(v2, 7) + DICT_HASH_ROTL(v3, 12) + DICT_HASH_ROTL(v4, 18);
+        h = dict_hash_merge(h, v1);
+        h = dict_hash_merge(h, v2);
+        h = dict_hash_merge(h, v3);
+        h = dict_hash_merge(h, v4);
+    } else {
+        h = hash + DICT_HASH_P5;
+    }
+    h += len;
+
+    for (; key_part + 8 <= end; key_part += 8) {
+        h ^= dict_hash_round(0, dict_hash_read64(key_part));
+        h = DICT_HASH_ROTL(h, 27) * DICT_HASH_P1 + DICT_HASH_P4;
+    }
+    if (key_part + 4 <= end) {
+        h ^= dict_hash_read32(key_part) * DICT_HASH_P1;
+        h = DICT_HASH_ROTL(h, 23) * DICT_HASH_P2 + DICT_HASH_P3;
+        key_part += 4;
     }
-    hash += (hash << 3);
-    hash ^= (hash >> 11);
-    hash += (hash << 15);
-    return hash;
+    for (; key_part < end; ++key_part) {
+        h ^= (uint8_t)*key_part * DICT_HASH_P5;
+        h = DICT_HASH_ROTL(h, 11) * DICT_HASH_P1;
+    }
+
+    /* mix all the bits before truncating, the state of the next part is only 32b */
+    h ^= h >> 33;
+    h *= DICT_HASH_P2;
+    h ^= h >> 29;
+    h *= DICT_HASH_P3;
+    h ^= h >> 32;
+    return h;
 }
 
 /*
@@ -124,21 +213,29 @@ dict_hash(const char *key, size_t len)
 uint32_t
 dict_hash_multi(uint32_t hash, const char *key_part, size_t len)
 {
-    uint32_t i;
-
-    if (key_part) {
-        for (i = 0; i < len; ++i) {
-            hash += key_part[i];
-            hash += (hash << 10);
-            hash ^= (hash >> 6);
-        }
-    } else {
-        hash += (hash << 3);
-        hash ^= (hash >> 11);
-        hash += (hash << 15);
+    if (!key_part) {
+        /* final avalanche of the 32b state */
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6b;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35;
+        hash ^= hash >> 16;
+        return hash;
     }
 
-    return hash;
+    return (uint32_t)dict_hash_part(hash, key_part, len);
+}
+
+uint64_t
+dict_hash64(uint64_t hash, const char *key, size_t len)
+{
+    return dict_hash_part(hash, key, len);
+}
+
+static uint32_t
+dict_hash(const char *key, size_t len)
+{
+    return dict_hash_multi(dict_hash_multi(0, key, len), NULL, 0);
 }
 
 API void
@@ -272,6 +369,107 @@ lyht_get_rec(unsigned char *recs, uint16_t rec_size, uint32_t idx)
     return (struct ht_rec *)&recs[idx * rec_size];
 }
 
+/* 7 bits of the hash stored in the control byte, all the hash bits are folded so that even short hashes differ */
+static uint8_t
+lyht_tag(uint32_t hash)
+{
+    return (hash ^ (hash >> 7) ^ (hash >> 14) ^ (hash >> 21) ^ (hash >> 28)) & 0x7f;
+}
+
+/* bit i of the returned mask is set if control byte i of the group equals ctrl */
+static uint32_t
+lyht_group_match(const uint8_t *group, uint8_t ctrl)
+{
+#ifdef __SSE2__
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)group), _mm_set1_epi8((char)ctrl)));
+#else
+    uint32_t i, mask = 0;
+
+    for (i = 0; i < LYHT_GROUP_SIZE; ++i) {
+        if (group[i] == ctrl) {
+            mask |= 1U << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+/* bit i of the returned mask is set if record i of the group is empty or deleted */
+static uint32_t
+lyht_group_match_free(const uint8_t *group)
+{
+#ifdef __SSE2__
+    /* only filled records have the highest bit unset */
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+    uint32_t i, mask = 0;
+
+    for (i = 0; i < LYHT_GROUP_SIZE; ++i) {
+        if (group[i] & 0x80) {
+            mask |= 1U << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+static uint32_t
+lyht_mask_first(uint32_t mask)
+{
+#ifdef __GNUC__
+    return __builtin_ctz(mask);
+#else
+    uint32_t i;
+
+    for (i = 0; !(mask & 1); ++i, mask >>= 1);
+    return i;
+#endif
+}
+
+/*
+ * Probing: the group starting at the record the hash points to is examined first, then the
+ * following groups with triangular steps. Every record is examined exactly once and tables
+ * smaller than a group fit into the first one.
+ */
+#define LYHT_PROBE_COUNT(ht) ((ht)->size < LYHT_GROUP_SIZE ? 1 : (ht)->size / LYHT_GROUP_SIZE)
+#define LYHT_PROBE_MASK(ht, mask) ((ht)->size < LYHT_GROUP_SIZE ? (mask) & ((1U << (ht)->size) - 1) : (mask))
+
+static void
+lyht_set_ctrl(struct hash_table *ht, uint32_t idx, uint8_t ctrl)
+{
+    uint32_t i;
+
+    ht->ctrl[idx] = ctrl;
+
+    /* update the copies after the end so that a group can be read at any position */
+    for (i = idx + ht->size; i < ht->size + LYHT_GROUP_SIZE - 1; i += ht->size) {
+        ht->ctrl[i] = ctrl;
+    }
+}
+
+static int
+lyht_val_equal(struct hash_table *ht, void *val1_p, void *val2_p, int mod)
+{
+    if (!ht->val_equal) {
+        return *(void **)val1_p == *(void **)val2_p;
+    }
+    return ht->val_equal(val1_p, val2_p, mod, ht->cb_data);
+}
+
+/* allocate records and control bytes for a table of the size, all the records are empty */
+static int
+lyht_alloc_recs(struct hash_table *ht, uint32_t size)
+{
+    ht->recs = calloc(1, size * ht->rec_size + size + LYHT_GROUP_SIZE - 1);
+    LY_CHECK_ERR_RETURN(!ht->recs, LOGMEM(NULL), -1);
+
+    ht->ctrl = ht->recs + size * ht->rec_size;
+    memset(ht->ctrl, LYHT_CTRL_EMPTY, size + LYHT_GROUP_SIZE - 1);
+    ht->size = size;
+    ht->deleted = 0;
+    return 0;
+}
+
 struct hash_table *
 lyht_new(uint32_t size, uint16_t val_size, values_equal_cb val_equal, void *cb_data, int resize)
 {
@@ -279,7 +477,8 @@ lyht_new(uint32_t size, uint16_t val_size, values_equal_cb val_equal, void *cb_d
 
     /* check that 2^x == size (power of 2) */
     assert(size && !(size & (size - 1)));
-    assert(val_equal && val_size);
+    assert(val_size);
+    assert(val_equal || (val_size >= sizeof(void *)));
     assert(resize == 0 || resize == 1);
 
     if (size < LYHT_MIN_SIZE) {
@@ -290,15 +489,18 @@ lyht_new(uint32_t size, uint16_t val_size, values_equal_cb val_equal, void *cb_d
     LY_CHECK_ERR_RETURN(!ht, LOGMEM(NULL), NULL);
 
     ht->used = 0;
-    ht->size = size;
     ht->val_equal = val_equal;
     ht->cb_data = cb_data;
     ht->resize = (uint16_t)resize;
 
-    ht->rec_size = (sizeof(struct ht_rec) - 1) + val_size;
-    /* allocate the records correctly */
-    ht->recs = calloc(size, ht->rec_size);
-    LY_CHECK_ERR_RETURN(!ht->recs, free(ht); LOGMEM(NULL), NULL);
+    /* keep the values of all the records aligned */
+    ht->val_size = val_size;
+    ht->rec_size = offsetof(struct ht_rec, val) + val_size;
+    ht->rec_size = (ht->rec_size + (sizeof(void *) - 1)) & ~(sizeof(void *) - 1);
+    if (lyht_alloc_recs(ht, size)) {
+        free(ht);
+        return NULL;
+    }
 
     return ht;
 }
@@ -332,13 +534,16 @@ lyht_dup(const struct hash_table *orig)
         return NULL;
     }
 
-    ht = lyht_new(orig->size, orig->rec_size - (sizeof(struct ht_rec) - 1), orig->val_equal, orig->cb_data, orig->resize ? 1 : 0);
-    if (!ht) {
-        return NULL;
-    }
+    ht = malloc(sizeof *ht);
+    LY_CHECK_ERR_RETURN(!ht, LOGMEM(NULL), NULL);
+    memcpy(ht, orig, sizeof *ht);
+
+    /* copy all the records, not only the first used ones, and their control bytes */
+    ht->recs = malloc(orig->size * orig->rec_size + orig->size + LYHT_GROUP_SIZE - 1);
+    LY_CHECK_ERR_RETURN(!ht->recs, LOGMEM(NULL); free(ht), NULL);
+    memcpy(ht->recs, orig->recs, orig->size * orig->rec_size + orig->size + LYHT_GROUP_SIZE - 1);
+    ht->ctrl = ht->recs + orig->size * orig->rec_size;
 
-    memcpy(ht->recs, orig->recs, orig->used * orig->rec_size);
-    ht->used = orig->used;
     return ht;
 }
 
@@ -351,38 +556,62 @@ lyht_free(struct hash_table *ht)
     }
 }
 
+/* return index of the first empty or deleted record where a value with the hash can be stored,
+ * size if there is none */
+static uint32_t
+lyht_find_free(struct hash_table *ht, uint32_t hash)
+{
+    uint32_t i, pos, mask;
+
+    pos = hash & (ht->size - 1);
+    for (i = 0; i < LYHT_PROBE_COUNT(ht); ) {
+        mask = LYHT_PROBE_MASK(ht, lyht_group_match_free(&ht->ctrl[pos]));
+        if (mask) {
+            return (pos + lyht_mask_first(mask)) & (ht->size - 1);
+        }
+
+        ++i;
+        pos = (pos + i * LYHT_GROUP_SIZE) & (ht->size - 1);
+    }
+
+    return ht->size;
+}
+
+/* rehash all the values into a table of the size, the values are never compared, only moved,
+ * idx_p is updated to the new index of the record */
 static int
-lyht_resize(struct hash_table *ht, int enlarge)
+lyht_resize(struct hash_table *ht, uint32_t size, uint32_t *idx_p)
 {
     struct ht_rec *rec;
     unsigned char *old_recs;
-    uint32_t i, old_size;
-    int ret;
+    uint8_t *old_ctrl;
+    uint32_t i, idx, old_size, old_deleted;
 
     old_recs = ht->recs;
+    old_ctrl = ht->ctrl;
     old_size = ht->size;
+    old_deleted = ht->deleted;
 
-    if (enlarge) {
-        /* double the size */
-        ht->size <<= 1;
-    } else {
-        /* half the size */
-        ht->size >>= 1;
+    if (lyht_alloc_recs(ht, size)) {
+        ht->recs = old_recs;
+        ht->ctrl = old_ctrl;
+        ht->size = old_size;
+        ht->deleted = old_deleted;
+        return -1;
     }
 
-    ht->recs = calloc(ht->size, ht->rec_size);
-    LY_CHECK_ERR_RETURN(!ht->recs, LOGMEM(NULL); ht->recs = old_recs; ht->size = old_size, -1);
-
-    /* reset used, it will increase again */
-    ht->used = 0;
-
-    /* add all the old records into the new records array */
+    /* move all the old records into the new records array */
     for (i = 0; i < old_size; ++i) {
         rec = lyht_get_rec(old_recs, ht->rec_size, i);
         if (rec->hits > 0) {
-            ret = lyht_insert(ht, rec->val, rec->hash, NULL);
-            assert(!ret);
-            (void)ret;
+            idx = lyht_find_free(ht, rec->hash);
+            assert(idx < ht->size);
+            memcpy(lyht_get_rec(ht->recs, ht->rec_size, idx), rec, ht->rec_size);
+            lyht_set_ctrl(ht, idx, lyht_tag(rec->hash));
+            if (idx_p && (*idx_p == i)) {
+                *idx_p = idx;
+                idx_p = NULL;
+            }
         }
     }
 
@@ -391,192 +620,126 @@ lyht_resize(struct hash_table *ht, int enlarge)
     return 0;
 }
 
-/* return: 0 - hash found, returned its record,
- *         1 - hash not found, returned the record where it would be inserted */
-static int
-lyht_find_first(struct hash_table *ht, uint32_t hash, struct ht_rec **rec_p)
-{
-    struct ht_rec *rec;
-    uint32_t i, idx;
-
-    if (rec_p) {
-        *rec_p = NULL;
-    }
-
-    idx = i = hash & (ht->size - 1);
-    rec = lyht_get_rec(ht->recs, ht->rec_size, idx);
-
-    /* skip through overflow and deleted records */
-    while ((rec->hits != 0) && ((rec->hits == -1) || ((rec->hash & (ht->size - 1)) != idx))) {
-        if ((rec->hits == -1) && rec_p && !(*rec_p)) {
-            /* remember this record for return */
-            *rec_p = rec;
-        }
-        i = (i + 1) % ht->size;
-        if (i == idx) {
-            /* we went through all the records (very unlikely, but possible when many records are invalid),
-             * just return not found */
-            assert(!rec_p || *rec_p);
-            return 1;
-        }
-        rec = lyht_get_rec(ht->recs, ht->rec_size, i);
-    }
-    if (rec->hits == 0) {
-        /* we could not find the value */
-        if (rec_p && !*rec_p) {
-            *rec_p = rec;
-        }
-        return 1;
-    }
-
-    /* we have found a record with equal (shortened) hash */
-    if (rec_p) {
-        *rec_p = rec;
-    }
-    return 0;
-}
-
 /**
- * @brief Search for the next collision.
+ * @brief Find the record of a value.
  *
  * @param[in] ht Hash table to search in.
- * @param[in,out] last Last returned collision record.
- * @param[in] first First collision record (hits > 1).
- * @return 0 when hash collision found, \p last points to this next collision,
- *         1 when hash collision not found, \p last points to the record where it would be inserted.
+ * @param[in] val_p Pointer to the value to find.
+ * @param[in] hash Hash of the value.
+ * @param[in] mod Whether the table is being modified, passed to the equal callback.
+ * @param[out] idx_p Index of the found record.
+ * @param[out] free_p Index of the first free record found while searching, size if none, optional.
+ * @return 0 on success, 1 on not found.
  */
 static int
-lyht_find_collision(struct hash_table *ht, struct ht_rec **last, struct ht_rec *first)
+lyht_find_rec(struct hash_table *ht, void *val_p, uint32_t hash, int mod, uint32_t *idx_p, uint32_t *free_p)
 {
-    struct ht_rec *empty = NULL;
-    uint32_t i, idx;
+    struct ht_rec *rec;
+    uint32_t i, pos, idx, mask;
+    uint8_t tag;
 
-    assert(last && *last);
+    if (free_p) {
+        *free_p = ht->size;
+    }
 
-    idx = (*last)->hash & (ht->size - 1);
-    i = (((unsigned char *)*last) - ht->recs) / ht->rec_size;
+    tag = lyht_tag(hash);
+    pos = hash & (ht->size - 1);
+#ifdef __GNUC__
+    /* most values are stored in the record their hash points to, load it in parallel with the control bytes */
+    __builtin_prefetch(lyht_get_rec(ht->recs, ht->rec_size, pos));
+#endif
+    for (i = 0; i < LYHT_PROBE_COUNT(ht); ) {
+        /* compare the values only in the records with a matching tag */
+        mask = LYHT_PROBE_MASK(ht, lyht_group_match(&ht->ctrl[pos], tag));
+        while (mask) {
+            idx = (pos + lyht_mask_first(mask)) & (ht->size - 1);
+            rec = lyht_get_rec(ht->recs, ht->rec_size, idx);
+            if ((rec->hash == hash) && lyht_val_equal(ht, val_p, &rec->val, mod)) {
+                *idx_p = idx;
+                return 0;
+            }
+            mask &= mask - 1;
+        }
 
-    do {
-        i = (i + 1) % ht->size;
-        *last = lyht_get_rec(ht->recs, ht->rec_size, i);
-        if (*last == first) {
-            /* we went through all the records (very unlikely, but possible when many records are invalid),
-             * just return an invalid record */
-            assert(empty);
-            *last = empty;
-            return 1;
+        if (free_p && (*free_p == ht->size)) {
+            mask = LYHT_PROBE_MASK(ht, lyht_group_match_free(&ht->ctrl[pos]));
+            if (mask) {
+                *free_p = (pos + lyht_mask_first(mask)) & (ht->size - 1);
+            }
         }
 
-        if (((*last)->hits == -1) && !empty) {
-            empty = *last;
+        if (LYHT_PROBE_MASK(ht, lyht_group_match(&ht->ctrl[pos], LYHT_CTRL_EMPTY))) {
+            /* the value would have been stored in this group */
+            break;
         }
-    } while (((*last)->hits != 0) && (((*last)->hits == -1) || (((*last)->hash & (ht->size - 1)) != idx)));
 
-    if ((*last)->hits > 0) {
-        /* we found a collision */
-        assert((*last)->hits == 1);
-        return 0;
+        ++i;
+        pos = (pos + i * LYHT_GROUP_SIZE) & (ht->size - 1);
     }
 
-    /* no next collision found, return the record where it would be inserted */
-    if (empty) {
-        *last = empty;
-    } /* else (*last)->hits == 0, it is already correct */
     return 1;
 }
 
 int
 lyht_find(struct hash_table *ht, void *val_p, uint32_t hash, void **match_p)
 {
-    struct ht_rec *rec, *crec;
-    uint32_t i, c;
-    int r;
+    uint32_t idx;
 
-    if (lyht_find_first(ht, hash, &rec)) {
+    if (lyht_find_rec(ht, val_p, hash, 0, &idx, NULL)) {
         /* not found */
         return 1;
     }
-    if ((rec->hash == hash) && ht->val_equal(val_p, &rec->val, 0, ht->cb_data)) {
-        /* even the value matches */
-        if (match_p) {
-            *match_p = rec->val;
-        }
-        return 0;
-    }
-
-    /* some collisions, we need to go through them, too */
-    crec = rec;
-    c = rec->hits;
-    for (i = 1; i < c; ++i) {
-        r = lyht_find_collision(ht, &rec, crec);
-        assert(!r);
-        (void)r;
 
-        /* compare values */
-        if ((rec->hash == hash) && ht->val_equal(val_p, &rec->val, 0, ht->cb_data)) {
-            if (match_p) {
-                *match_p = rec->val;
-            }
-            return 0;
-        }
+    if (match_p) {
+        *match_p = lyht_get_rec(ht->recs, ht->rec_size, idx)->val;
     }
-
-    /* not found even in collisions */
-    return 1;
+    return 0;
 }
 
 int
 lyht_find_next(struct hash_table *ht, void *val_p, uint32_t hash, void **match_p)
 {
-    struct ht_rec *rec, *crec;
-    uint32_t i, c;
-    int r, found = 0;
-
-    if (lyht_find_first(ht, hash, &rec)) {
-        /* not found, cannot happen */
-        assert(0);
-    }
-
-    if ((rec->hash == hash) && ht->val_equal(val_p, &rec->val, 1, ht->cb_data)) {
-        /* previously returned value */
-        found = 1;
-    }
-
-    if (rec->hits == 1) {
-        /* there are no more similar values */
-        assert(rec->hash == hash);
-        assert(found);
-        return 1;
-    }
-
-    /* go through collisions and find next one after the previous one */
-    crec = rec;
-    c = rec->hits;
-    for (i = 1; i < c; ++i) {
-        r = lyht_find_collision(ht, &rec, crec);
-        assert(!r);
-        (void)r;
+    struct ht_rec *rec;
+    uint32_t i, pos, idx, mask;
+    uint8_t tag;
+    int found = 0;
+
+    /* go through the records in the same order as when searching, find the previous value
+     * and then the next one with an equal hash */
+    tag = lyht_tag(hash);
+    pos = hash & (ht->size - 1);
+    for (i = 0; i < LYHT_PROBE_COUNT(ht); ) {
+        mask = LYHT_PROBE_MASK(ht, lyht_group_match(&ht->ctrl[pos], tag));
+        while (mask) {
+            idx = (pos + lyht_mask_first(mask)) & (ht->size - 1);
+            rec = lyht_get_rec(ht->recs, ht->rec_size, idx);
+            mask &= mask - 1;
+
+            if (rec->hash != hash) {
+                /* a normal collision, we are not interested in those */
+                continue;
+            }
 
-        if (rec->hash != hash) {
-            /* a normal collision, we are not interested in those */
-            continue;
-        }
+            if (found) {
+                /* next value with equal hash, found our value */
+                if (match_p) {
+                    *match_p = rec->val;
+                }
+                return 0;
+            }
 
-        if (found) {
-            /* next value with equal hash, found our value */
-            if (match_p) {
-                *match_p = rec->val;
+            if (lyht_val_equal(ht, val_p, &rec->val, 1)) {
+                /* this one was returned previously, continue looking */
+                found = 1;
             }
-            return 0;
         }
 
-        if (!ht->val_equal(val_p, &rec->val, 1, ht->cb_data)) {
-            /* already returned value, skip */
-            continue;
+        if (LYHT_PROBE_MASK(ht, lyht_group_match(&ht->ctrl[pos], LYHT_CTRL_EMPTY))) {
+            break;
         }
 
-        /* this one was returned previously, continue looking */
-        found = 1;
+        ++i;
+        pos = (pos + i * LYHT_GROUP_SIZE) & (ht->size - 1);
     }
 
     /* the last equal value was already returned */
@@ -586,60 +749,39 @@ lyht_find_next(struct hash_table *ht, void *val_p, uint32_t hash, void **match_p
 
 int
 lyht_insert_with_resize_cb(struct hash_table *ht, void *val_p, uint32_t hash,
-                           values_equal_cb resize_val_equal, void **match_p)
+                           values_equal_cb UNUSED(resize_val_equal), void **match_p)
 {
-    struct ht_rec *rec, *crec = NULL;
-    int32_t i;
+    struct ht_rec *rec;
+    uint32_t idx, match_idx;
     int r, ret;
-    values_equal_cb old_val_equal;
-
-    if (!lyht_find_first(ht, hash, &rec)) {
-        /* we found matching shortened hash */
-        if ((rec->hash == hash) && ht->val_equal(val_p, &rec->val, 1, ht->cb_data)) {
-            /* even the value matches */
-            if (match_p) {
-                *match_p = (void *)&rec->val;
-            }
-            return 1;
-        }
 
-        /* some collisions, we need to go through them, too */
-        crec = rec;
-        for (i = 1; i < crec->hits; ++i) {
-            r = lyht_find_collision(ht, &rec, crec);
-            assert(!r);
-
-            /* compare values */
-            if ((rec->hash == hash) && ht->val_equal(val_p, &rec->val, 1, ht->cb_data)) {
-                if (match_p) {
-                    *match_p = (void *)&rec->val;
-                }
-                return 1;
-            }
+    if (!lyht_find_rec(ht, val_p, hash, 1, &match_idx, &idx)) {
+        /* the value is already there */
+        if (match_p) {
+            *match_p = lyht_get_rec(ht->recs, ht->rec_size, match_idx)->val;
         }
-
-        /* value not found, get the record where it will be inserted */
-        r = lyht_find_collision(ht, &rec, crec);
-        assert(r);
-    }
-
-    /* insert it into the returned record */
-    assert(rec->hits < 1);
-    rec->hash = hash;
-    rec->hits = 1;
-    memcpy(&rec->val, val_p, ht->rec_size - (sizeof(struct ht_rec) - 1));
-    if (match_p) {
-        *match_p = (void *)&rec->val;
+        return 1;
     }
-
-    if (crec) {
-        /* there was a collision, increase hits */
-        if (crec->hits == INT32_MAX) {
+    if (idx == ht->size) {
+        /* the search did not reach a free record yet */
+        idx = lyht_find_free(ht, hash);
+        if (idx == ht->size) {
+            /* full table that cannot be resized */
             LOGINT(NULL);
+            return -1;
         }
-        ++crec->hits;
     }
 
+    /* insert it into the free record */
+    rec = lyht_get_rec(ht->recs, ht->rec_size, idx);
+    if (rec->hits == -1) {
+        --ht->deleted;
+    }
+    rec->hash = hash;
+    rec->hits = 1;
+    memcpy(&rec->val, val_p, ht->val_size);
+    lyht_set_ctrl(ht, idx, lyht_tag(hash));
+
     /* check size & enlarge if needed */
     ret = 0;
     ++ht->used;
@@ -650,22 +792,17 @@ lyht_insert_with_resize_cb(struct hash_table *ht, void *val_p, uint32_t hash,
             ht->resize = 2;
         }
         if ((ht->resize == 2) && (r >= LYHT_ENLARGE_PERCENTAGE)) {
-            if (resize_val_equal) {
-                old_val_equal = lyht_set_cb(ht, resize_val_equal);
-            }
-
             /* enlarge */
-            ret = lyht_resize(ht, 1);
-            /* if hash_table was resized, we need to find new matching value */
-            if (ret == 0 && match_p) {
-                lyht_find(ht, val_p, hash, match_p);
-            }
-
-            if (resize_val_equal) {
-                lyht_set_cb(ht, old_val_equal);
-            }
+            ret = lyht_resize(ht, ht->size << 1, &idx);
+        } else if (((ht->used + ht->deleted) * 100) / ht->size >= LYHT_ENLARGE_PERCENTAGE) {
+            /* too many deleted records, get rid of them */
+            ret = lyht_resize(ht, ht->size, &idx);
         }
     }
+
+    if (match_p) {
+        *match_p = lyht_get_rec(ht->recs, ht->rec_size, idx)->val;
+    }
     return ret;
 }
 
@@ -675,51 +812,47 @@ lyht_insert(struct hash_table *ht, void *val_p, uint32_t hash, void **match_p)
     return lyht_insert_with_resize_cb(ht, val_p, hash, NULL, match_p);
 }
 
-int
-lyht_remove(struct hash_table *ht, void *val_p, uint32_t hash)
+/* whether a search could have never continued past the record because all the records of a group were filled */
+static int
+lyht_was_never_full(struct hash_table *ht, uint32_t idx)
 {
-    struct ht_rec *rec, *crec;
-    int32_t i;
-    int first_matched = 0, r, ret;
+    uint32_t before = 0, after = 0;
 
-    if (lyht_find_first(ht, hash, &rec)) {
-        /* hash not found */
+    if (ht->size < LYHT_GROUP_SIZE) {
+        /* searches never continue past the first group */
         return 1;
     }
-    if ((rec->hash == hash) && ht->val_equal(val_p, &rec->val, 1, ht->cb_data)) {
-        /* even the value matches */
-        first_matched = 1;
+
+    while ((before < LYHT_GROUP_SIZE - 1) && (ht->ctrl[(idx - before - 1) & (ht->size - 1)] != LYHT_CTRL_EMPTY)) {
+        ++before;
+    }
+    while ((after < LYHT_GROUP_SIZE - 1) && (ht->ctrl[(idx + after + 1) & (ht->size - 1)] != LYHT_CTRL_EMPTY)) {
+        ++after;
     }
 
-    /* we always need to go through collisions */
-    crec = rec;
-    for (i = 1; i < crec->hits; ++i) {
-        r = lyht_find_collision(ht, &rec, crec);
-        assert(!r);
+    return before + after + 1 < LYHT_GROUP_SIZE;
+}
 
-        /* compare values */
-        if (!first_matched && (rec->hash == hash) && ht->val_equal(val_p, &rec->val, 1, ht->cb_data)) {
-            break;
-        }
+int
+lyht_remove(struct hash_table *ht, void *val_p, uint32_t hash)
+{
+    struct ht_rec *rec;
+    uint32_t idx;
+    int r, ret;
+
+    if (lyht_find_rec(ht, val_p, hash, 1, &idx, NULL)) {
+        /* value not found */
+        return 1;
     }
 
-    if (i < crec->hits) {
-        /* one of collisions matched, reduce collision count, remove the record */
-        assert(!first_matched);
-        --crec->hits;
-        rec->hits = -1;
-    } else if (first_matched) {
-        /* the first record matches */
-        if (crec != rec) {
-            /* ... so put the last collision in its place */
-            rec->hits = crec->hits - 1;
-            memcpy(crec, rec, ht->rec_size);
-        }
-        rec->hits = -1;
+    rec = lyht_get_rec(ht->recs, ht->rec_size, idx);
+    if (lyht_was_never_full(ht, idx)) {
+        rec->hits = 0;
+        lyht_set_ctrl(ht, idx, LYHT_CTRL_EMPTY);
     } else {
-        /* value not found even in collisions */
-        assert(!first_matched);
-        return 1;
+        rec->hits = -1;
+        lyht_set_ctrl(ht, idx, LYHT_CTRL_DELETED);
+        ++ht->deleted;
     }
 
     /* check size & shrink if needed */
@@ -729,9 +862,26 @@ lyht_remove(struct hash_table *ht, void *val_p, uint32_t hash)
         r = (ht->used * 100) / ht->size;
         if ((r < LYHT_SHRINK_PERCENTAGE) && (ht->size > LYHT_MIN_SIZE)) {
             /* shrink */
-            ret = lyht_resize(ht, 0);
+            ret = lyht_resize(ht, ht->size >> 1, NULL);
         }
     }
 
     return ret;
 }
+
+int
+lyht_iter_next(const struct hash_table *ht, uint32_t *idx, void **val_p)
+{
+    struct ht_rec *rec;
+
+    for (; *idx < ht->size; ++(*idx)) {
+        rec = lyht_get_rec(ht->recs, ht->rec_size, *idx);
+        if (rec->hits > 0) {
+            *val_p = &rec->val;
+            ++(*idx);
+            return 1;
+        }
+    }
+
+    return 0;
+}
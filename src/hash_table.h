@@ -32,6 +32,18 @@
  */
 uint32_t dict_hash_multi(uint32_t hash, const char *key_part, size_t len);
 
+/**
+ * @brief Compute a 64b hash of a string continuing from a previous hash.
+ *
+ * Uses the same function as dict_hash_multi(), but the whole state is returned and it is always finished.
+ *
+ * @param[in] hash Previous hash or any seed.
+ * @param[in] key Key to hash.
+ * @param[in] len Length of \p key.
+ * @return 64b hash.
+ */
+uint64_t dict_hash64(uint64_t hash, const char *key, size_t len);
+
 /**
  * @brief Callback for checking hash table values equivalence.
  *
@@ -55,34 +67,53 @@ typedef int (*values_equal_cb)(void *val1_p, void *val2_p, int mod, void *cb_dat
 /** never shrink beyond this size */
 #define LYHT_MIN_SIZE 8
 
+/** number of control bytes examined at once */
+#ifdef __SSE2__
+#   define LYHT_GROUP_SIZE 16
+#else
+#   define LYHT_GROUP_SIZE 8
+#endif
+
+/** control byte of an empty record, it terminates a search */
+#define LYHT_CTRL_EMPTY 0x80
+
+/** control byte of a deleted record, a search must continue past it */
+#define LYHT_CTRL_DELETED 0xfe
+
 /**
  * @brief Generic hash table record.
  */
 struct ht_rec {
     uint32_t hash;        /* hash of the value */
-    int32_t hits;         /* collision/overflow value count - 1 (a filled entry has 1 hit,
-                           * special value -1 means a deleted record) */
-    unsigned char val[1]; /* arbitrary-size value */
-} _PACKED;
+    int32_t hits;         /* 1 for a filled record, 0 for an empty record, -1 for a deleted record */
+    unsigned char val[1]; /* arbitrary-size value, aligned for storing pointers */
+};
 
 /**
  * @brief (Very) generic hash table.
  *
- * Hash table with open addressing collision resolution and
- * linear probing of interval 1 (next free record is used).
- * Removal is lazy (removed records are only marked), but
- * if possible, they are fully emptied.
+ * Hash table with open addressing collision resolution. Every record has
+ * a control byte holding either its state or 7 bits of its hash. The control
+ * bytes are examined in groups of ::LYHT_GROUP_SIZE so that only records
+ * with a matching tag are compared, the groups are probed quadratically.
+ * Removed records are marked as deleted only if some search may have
+ * continued past them, otherwise they are fully emptied.
  */
 struct hash_table {
     uint32_t used;        /* number of values stored in the hash table (filled records) */
     uint32_t size;        /* always holds 2^x == size (is power of 2), actually number of records allocated */
-    values_equal_cb val_equal; /* callback for testing value equivalence */
+    uint32_t deleted;     /* number of deleted records */
+    values_equal_cb val_equal; /* callback for testing value equivalence, NULL if the values are compared
+                                * by the pointer they start with */
     void *cb_data;        /* user data callback arbitrary value */
     uint16_t resize;      /* 0 - resizing is disabled, *
                            * 1 - enlarging is enabled, *
                            * 2 - both shrinking and enlarging is enabled */
     uint16_t rec_size;    /* real size (in bytes) of one record for accessing recs array */
+    uint16_t val_size;    /* size (in bytes) of the value stored in a record, may be less than its space */
     unsigned char *recs;  /* pointer to the hash table itself (array of struct ht_rec) */
+    uint8_t *ctrl;        /* control bytes of the records followed by a copy of the first (LYHT_GROUP_SIZE - 1)
+                           * ones, allocated together with recs */
 };
 
 struct dict_rec {
@@ -127,7 +158,8 @@ struct ht_rec *lyht_get_rec(unsigned char *recs, uint16_t rec_size, uint32_t idx
  *
  * @param[in] size Starting size of the hash table (capacity of values), must be power of 2.
  * @param[in] val_size Size in bytes of value (the stored hashed item).
- * @param[in] val_equal Callback for checking value equivalence.
+ * @param[in] val_equal Callback for checking value equivalence, NULL if the values start with a pointer
+ * that alone identifies them, it is then compared directly.
  * @param[in] cb_data User data always passed to \p val_equal.
  * @param[in] resize Whether to resize the table on too few/too many records taken.
  * @return Empty hash table, NULL on error.
@@ -204,7 +236,8 @@ int lyht_insert(struct hash_table *ht, void *val_p, uint32_t hash, void **match_
 /**
  * @brief Insert a value into hash table. Same functionality as lyht_insert()
  * but allows to specify a temporary val equal callback to be used in case the hash table
- * will be resized after successful insertion.
+ * will be resized after successful insertion. Currently, values are never compared when
+ * resizing so the callback is not used.
  *
  * @param[in] ht Hash table to insert into.
  * @param[in] val_p Pointer to the value to insert. Be careful, if the values stored in the hash table
@@ -228,4 +261,20 @@ int lyht_insert_with_resize_cb(struct hash_table *ht, void *val_p, uint32_t hash
  */
 int lyht_remove(struct hash_table *ht, void *val_p, uint32_t hash);
 
+/**
+ * @brief Iterate over all the values stored in a hash table.
+ *
+ * Usage:
+ * - init idx to 0
+ * - repeatedly call lyht_iter_next() until it returns 0
+ *
+ * The hash table must not be modified during the iteration.
+ *
+ * @param[in] ht Hash table to iterate over.
+ * @param[in,out] idx Index of the next record to examine, updated past the returned value.
+ * @param[out] val_p Pointer to the next value.
+ * @return 1 if a value was returned, 0 if there are no more values.
+ */
+int lyht_iter_next(const struct hash_table *ht, uint32_t *idx, void **val_p);
+
 #endif /* LY_HASH_TABLE_H_ */
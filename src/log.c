@@ -148,6 +148,28 @@ mem_fail:
     return -1;
 }
 
+int
+ly_log_needed(const struct ly_ctx *ctx, LY_LOG_LEVEL level)
+{
+    if ((log_opt == ILO_ERR2WRN) && (level == LY_LLERR)) {
+        level = LY_LLWRN;
+    }
+
+    if ((log_opt == ILO_IGNORE) || (level > ly_log_level)) {
+        return 0;
+    }
+
+    /* errors are stored internally regardless of the user options */
+    if ((level < LY_LLVRB) && ctx && ((ly_log_opts & LY_LOSTORE) || (log_opt == ILO_STORE))) {
+        return 1;
+    }
+    if ((ly_log_opts & LY_LOLOG) && (log_opt != ILO_STORE)) {
+        return 1;
+    }
+
+    return 0;
+}
+
 /* !! spends path !! */
 static void
 log_vprintf(const struct ly_ctx *ctx, LY_LOG_LEVEL level, LY_ERR no, LY_VECODE vecode, char *path,
@@ -172,6 +194,12 @@ log_vprintf(const struct ly_ctx *ctx, LY_LOG_LEVEL level, LY_ERR no, LY_VECODE v
         ly_errno = no;
     }
 
+    if (!ly_log_needed(ctx, level)) {
+        /* the message would be neither stored nor printed, do not even format it */
+        free(path);
+        return;
+    }
+
     if ((no == LY_EVALID) && (vecode == LYVE_SUCCESS)) {
         /* assume we are inheriting the error, so inherit vecode as well */
         vecode = ly_vecode(ctx);
@@ -493,27 +521,42 @@ static const LY_VECODE ecode2vecode[] = {
     LYVE_PATH_PREDTOOMANY, /* LYE_PATH_PREDTOOMANY */
 };
 
+/* size of the path buffer on stack, longer paths are moved into an allocated one */
+#define LY_VLOG_PATH_STACK 256
+
+/* path built backwards from its end, kept in the stack buffer unless it does not fit */
+struct ly_vlog_path {
+    char *buf;
+    uint16_t size;
+    uint16_t index;
+    char stack_buf[LY_VLOG_PATH_STACK];
+};
+
 static int
-ly_vlog_build_path_print(char **path, uint16_t *index, const char *str, uint16_t str_len, uint16_t *length)
+ly_vlog_build_path_print(struct ly_vlog_path *vpath, const char *str, uint16_t str_len)
 {
-    void *mem;
-    uint16_t step;
+    char *mem;
+    uint16_t step, length;
 
-    if ((*index) < str_len) {
+    if (vpath->index < str_len) {
         /* enlarge buffer */
         step = (str_len < LY_BUF_STEP) ? LY_BUF_STEP : str_len;
-        mem = realloc(*path, *length + *index + step + 1);
+        length = vpath->size - vpath->index;
+        mem = malloc(vpath->size + step);
         LY_CHECK_ERR_RETURN(!mem, LOGMEM(NULL), -1);
-        *path = mem;
 
-        /* move data, lengths */
-        memmove(&(*path)[*index + step], &(*path)[*index], *length);
-        (*index) += step;
+        /* move data */
+        memcpy(mem + vpath->index + step, vpath->buf + vpath->index, length);
+        if (vpath->buf != vpath->stack_buf) {
+            free(vpath->buf);
+        }
+        vpath->buf = mem;
+        vpath->size += step;
+        vpath->index += step;
     }
 
-    (*index) -= str_len;
-    memcpy(&(*path)[*index], str, str_len);
-    *length += str_len;
+    vpath->index -= str_len;
+    memcpy(vpath->buf + vpath->index, str, str_len);
 
     return 0;
 }
@@ -527,14 +570,14 @@ ly_vlog_build_path(enum LY_VLOG_ELEM elem_type, const void *elem, char **path, i
     struct lyd_node *dlist, *diter;
     const struct lys_module *top_smodule = NULL;
     const char *name, *prefix = NULL, *val_end, *val_start, *ext_name;
-    char *str;
-    uint16_t length, index;
+    char str[12];
+    struct ly_vlog_path vpath;
     size_t len;
 
-    length = 0;
-    *path = malloc(1);
-    LY_CHECK_ERR_RETURN(!(*path), LOGMEM(NULL), -1);
-    index = 0;
+    *path = NULL;
+    vpath.buf = vpath.stack_buf;
+    vpath.size = LY_VLOG_PATH_STACK;
+    vpath.index = vpath.size;
 
     while (elem) {
         switch (elem_type) {
@@ -558,13 +601,13 @@ ly_vlog_build_path(enum LY_VLOG_ELEM elem_type, const void *elem, char **path, i
             }
 
             if (((struct lys_node *)elem)->nodetype & (LYS_AUGMENT | LYS_GROUPING)) {
-                if (ly_vlog_build_path_print(path, &index, "]", 1, &length)) {
-                    return -1;
+                if (ly_vlog_build_path_print(&vpath, "]", 1)) {
+                    goto error;
                 }
 
                 name = ((struct lys_node *)elem)->name;
-                if (ly_vlog_build_path_print(path, &index, name, strlen(name), &length)) {
-                    return -1;
+                if (ly_vlog_build_path_print(&vpath, name, strlen(name))) {
+                    goto error;
                 }
 
                 if (((struct lys_node *)elem)->nodetype == LYS_GROUPING) {
@@ -631,36 +674,36 @@ ly_vlog_build_path(enum LY_VLOG_ELEM elem_type, const void *elem, char **path, i
                                 }
 
                                 /* print value */
-                                if (ly_vlog_build_path_print(path, &index, val_end, 2, &length)) {
-                                    return -1;
+                                if (ly_vlog_build_path_print(&vpath, val_end, 2)) {
+                                    goto error;
                                 }
                                 len = strlen(((struct lyd_node_leaf_list *)diter)->value_str);
-                                if (ly_vlog_build_path_print(path, &index,
-                                        ((struct lyd_node_leaf_list *)diter)->value_str, len, &length)) {
-                                    return -1;
+                                if (ly_vlog_build_path_print(&vpath,
+                                        ((struct lyd_node_leaf_list *)diter)->value_str, len)) {
+                                    goto error;
                                 }
 
                                 /* print schema name */
-                                if (ly_vlog_build_path_print(path, &index, val_start, 2, &length)) {
-                                    return -1;
+                                if (ly_vlog_build_path_print(&vpath, val_start, 2)) {
+                                    goto error;
                                 }
                                 len = strlen(diter->schema->name);
-                                if (ly_vlog_build_path_print(path, &index, diter->schema->name, len, &length)) {
-                                    return -1;
+                                if (ly_vlog_build_path_print(&vpath, diter->schema->name, len)) {
+                                    goto error;
                                 }
 
                                 if (lyd_node_module(dlist) != lyd_node_module(diter)) {
-                                    if (ly_vlog_build_path_print(path, &index, ":", 1, &length)) {
-                                        return -1;
+                                    if (ly_vlog_build_path_print(&vpath, ":", 1)) {
+                                        goto error;
                                     }
                                     len = strlen(lyd_node_module(diter)->name);
-                                    if (ly_vlog_build_path_print(path, &index, lyd_node_module(diter)->name, len, &length)) {
-                                        return -1;
+                                    if (ly_vlog_build_path_print(&vpath, lyd_node_module(diter)->name, len)) {
+                                        goto error;
                                     }
                                 }
 
-                                if (ly_vlog_build_path_print(path, &index, "[", 1, &length)) {
-                                    return -1;
+                                if (ly_vlog_build_path_print(&vpath, "[", 1)) {
+                                    goto error;
                                 }
                             }
                         }
@@ -673,22 +716,17 @@ ly_vlog_build_path(enum LY_VLOG_ELEM elem_type, const void *elem, char **path, i
                             j /= 10;
                         }
 
-                        if (ly_vlog_build_path_print(path, &index, "]", 1, &length)) {
-                            return -1;
+                        if (ly_vlog_build_path_print(&vpath, "]", 1)) {
+                            goto error;
                         }
 
-                        str = malloc(len + 1);
-                        LY_CHECK_ERR_RETURN(!str, LOGMEM(NULL), -1);
                         sprintf(str, "%d", i);
-
-                        if (ly_vlog_build_path_print(path, &index, str, len, &length)) {
-                            free(str);
-                            return -1;
+                        if (ly_vlog_build_path_print(&vpath, str, len)) {
+                            goto error;
                         }
-                        free(str);
 
-                        if (ly_vlog_build_path_print(path, &index, "[", 1, &length)) {
-                            return -1;
+                        if (ly_vlog_build_path_print(&vpath, "[", 1)) {
+                            goto error;
                         }
                     }
                 } else if (((struct lyd_node *)elem)->schema->nodetype == LYS_LEAFLIST &&
@@ -701,15 +739,15 @@ ly_vlog_build_path(enum LY_VLOG_ELEM elem_type, const void *elem, char **path, i
                         val_end = "']";
                     }
 
-                    if (ly_vlog_build_path_print(path, &index, val_end, 2, &length)) {
-                        return -1;
+                    if (ly_vlog_build_path_print(&vpath, val_end, 2)) {
+                        goto error;
                     }
                     len = strlen(((struct lyd_node_leaf_list *)elem)->value_str);
-                    if (ly_vlog_build_path_print(path, &index, ((struct lyd_node_leaf_list *)elem)->value_str, len, &length)) {
-                        return -1;
+                    if (ly_vlog_build_path_print(&vpath, ((struct lyd_node_leaf_list *)elem)->value_str, len)) {
+                        goto error;
                     }
-                    if (ly_vlog_build_path_print(path, &index, val_start, 4, &length)) {
-                        return -1;
+                    if (ly_vlog_build_path_print(&vpath, val_start, 4)) {
+                        goto error;
                     }
                 }
             }
@@ -718,11 +756,11 @@ ly_vlog_build_path(enum LY_VLOG_ELEM elem_type, const void *elem, char **path, i
             if (!((struct lyd_node *)elem)->parent) {
                 ext_name = lyp_get_yang_data_template_name(elem);
                 if (ext_name) {
-                    if (ly_vlog_build_path_print(path, &index, name, strlen(name), &length)) {
-                        return -1;
+                    if (ly_vlog_build_path_print(&vpath, name, strlen(name))) {
+                        goto error;
                     }
-                    if (ly_vlog_build_path_print(path, &index, "/", 1, &length)) {
-                        return -1;
+                    if (ly_vlog_build_path_print(&vpath, "/", 1)) {
+                        goto error;
                     }
                     yang_data_extension = 1;
                     name = ext_name;
@@ -733,46 +771,59 @@ ly_vlog_build_path(enum LY_VLOG_ELEM elem_type, const void *elem, char **path, i
             break;
         case LY_VLOG_STR:
             len = strlen((const char *)elem);
-            if (ly_vlog_build_path_print(path, &index, (const char *)elem, len, &length)) {
-                return -1;
+            if (ly_vlog_build_path_print(&vpath, (const char *)elem, len)) {
+                goto error;
             }
             goto success;
         default:
             /* shouldn't be here */
             LOGINT(NULL);
-            return -1;
+            goto error;
         }
         if (name) {
-            if (ly_vlog_build_path_print(path, &index, name, strlen(name), &length)) {
-                return -1;
+            if (ly_vlog_build_path_print(&vpath, name, strlen(name))) {
+                goto error;
             }
             if (prefix) {
-                if (yang_data_extension && ly_vlog_build_path_print(path, &index, "#", 1, &length)) {
-                    return -1;
+                if (yang_data_extension && ly_vlog_build_path_print(&vpath, "#", 1)) {
+                    goto error;
                 }
-                if (ly_vlog_build_path_print(path, &index, ":", 1, &length)) {
-                    return -1;
+                if (ly_vlog_build_path_print(&vpath, ":", 1)) {
+                    goto error;
                 }
-                if (ly_vlog_build_path_print(path, &index, prefix, strlen(prefix), &length)) {
-                    return -1;
+                if (ly_vlog_build_path_print(&vpath, prefix, strlen(prefix))) {
+                    goto error;
                 }
             }
         }
-        if (ly_vlog_build_path_print(path, &index, "/", 1, &length)) {
-            return -1;
+        if (ly_vlog_build_path_print(&vpath, "/", 1)) {
+            goto error;
         }
         if ((elem_type == LY_VLOG_LYS) && !elem && sparent && (sparent->nodetype == LYS_AUGMENT)) {
             len = strlen(((struct lys_node_augment *)sparent)->target_name);
-            if (ly_vlog_build_path_print(path, &index, ((struct lys_node_augment *)sparent)->target_name, len, &length)) {
-                return -1;
+            if (ly_vlog_build_path_print(&vpath, ((struct lys_node_augment *)sparent)->target_name, len)) {
+                goto error;
             }
         }
     }
 
 success:
-    memmove(*path, (*path) + index, length);
-    (*path)[length] = '\0';
+    len = vpath.size - vpath.index;
+    *path = malloc(len + 1);
+    LY_CHECK_ERR_GOTO(!(*path), LOGMEM(NULL), error);
+    memcpy(*path, vpath.buf + vpath.index, len);
+    (*path)[len] = '\0';
+
+    if (vpath.buf != vpath.stack_buf) {
+        free(vpath.buf);
+    }
     return 0;
+
+error:
+    if (vpath.buf != vpath.stack_buf) {
+        free(vpath.buf);
+    }
+    return -1;
 }
 
 void
@@ -787,6 +838,14 @@ ly_vlog(const struct ly_ctx *ctx, LY_ECODE ecode, enum LY_VLOG_ELEM elem_type, c
         return;
     }
 
+    if (!ly_log_needed(ctx, LY_LLERR)) {
+        /* nobody is going to read the message, just update ly_errno */
+        va_start(ap, elem);
+        log_vprintf(ctx, LY_LLERR, LY_EVALID, LYVE_SUCCESS, NULL, NULL, ap);
+        va_end(ap);
+        return;
+    }
+
     if (path_flag && (elem_type != LY_VLOG_NONE)) {
         if (elem_type == LY_VLOG_PREV) {
             /* use previous path */
@@ -832,6 +891,14 @@ ly_vlog_str(const struct ly_ctx *ctx, enum LY_VLOG_ELEM elem_type, const char *s
 
     assert((elem_type == LY_VLOG_NONE) || (elem_type == LY_VLOG_PREV));
 
+    if (!ly_log_needed(ctx, LY_LLERR)) {
+        /* nobody is going to read the message, just update ly_errno */
+        va_start(ap, str);
+        log_vprintf(ctx, LY_LLERR, LY_EVALID, LYVE_SUCCESS, NULL, NULL, ap);
+        va_end(ap);
+        return;
+    }
+
     if (elem_type == LY_VLOG_PREV) {
         /* use previous path */
         first = ly_err_first(ctx);
@@ -1004,3 +1071,35 @@ ly_err_last_set_apptag(const struct ly_ctx *ctx, const char *apptag)
         }
     }
 }
+
+/* !! spends path !! */
+static void
+log_printf(const struct ly_ctx *ctx, LY_LOG_LEVEL level, LY_ERR no, LY_VECODE vecode, char *path, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    log_vprintf(ctx, level, no, vecode, path, format, ap);
+    va_end(ap);
+}
+
+struct ly_err_item *
+ly_err_detach(const struct ly_ctx *ctx)
+{
+    struct ly_err_item *eitem;
+
+    eitem = pthread_getspecific(ctx->errlist_key);
+    pthread_setspecific(ctx->errlist_key, NULL);
+    return eitem;
+}
+
+void
+ly_err_repeat(const struct ly_ctx *ctx, struct ly_err_item *eitem)
+{
+    struct ly_err_item *i;
+
+    for (i = eitem; i; i = i->next) {
+        log_printf(ctx, i->level, i->no, i->vecode, i->path ? strdup(i->path) : NULL, "%s", i->msg);
+    }
+    ly_err_free(eitem);
+}
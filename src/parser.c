@@ -1215,7 +1215,7 @@ lyp_parse_value(struct lys_type *type, const char **value_, struct lyxml_elem *x
     struct lys_ident *ident;
     lyd_val *val, old_val;
     LY_DATA_TYPE *val_type, old_val_type;
-    uint8_t *val_flags, old_val_flags;
+    uint8_t *val_flags, old_val_flags, lex_class;
     struct lyd_node *contextnode;
     struct ly_ctx *ctx = type->parent->module->ctx;
 
@@ -1893,8 +1893,16 @@ lyp_parse_value(struct lys_type *type, const char **value_, struct lyxml_elem *x
         /* turn logging off, we are going to try to validate the value with all the types in order */
         ly_ilo_change(NULL, ILO_IGNORE, &prev_ilo, NULL);
 
+        /* integers in default values may also be octal or hexadecimal, try all the types in that case */
+        lex_class = dflt ? 0 : lyp_value_lex_class(*value_);
+
         while ((t = lyp_get_next_union_type(type, t, &found))) {
             found = 0;
+            if (!dflt && lyp_union_type_mismatch(t, *value_, lex_class)) {
+                /* the value cannot be valid, no need to parse it */
+                continue;
+            }
+
             ret = lyp_parse_value(t, value_, xml, leaf, attr, NULL, store, dflt, 0);
             if (ret) {
                 /* we have the result */
@@ -1993,6 +2001,81 @@ lyp_get_next_union_type(struct lys_type *type, struct lys_type *prev_type, int *
     return ret;
 }
 
+uint8_t
+lyp_value_lex_class(const char *value)
+{
+    uint8_t lex_class = LYP_LEX_INT | LYP_LEX_DEC64;
+    const char *ptr;
+
+    if (!value || !value[0]) {
+        return 0;
+    }
+    if (!isdigit(value[0]) && (value[0] != '+') && (value[0] != '-')) {
+        /* leading whitespaces are allowed only for integers */
+        lex_class &= ~LYP_LEX_DEC64;
+    }
+
+    for (ptr = value; *ptr; ++ptr) {
+        if (isdigit(*ptr) || (*ptr == '+') || (*ptr == '-')) {
+            continue;
+        } else if (isspace(*ptr)) {
+            lex_class &= ~LYP_LEX_DEC64;
+        } else if (*ptr == '.') {
+            lex_class &= ~LYP_LEX_INT;
+        } else {
+            lex_class &= ~(LYP_LEX_INT | LYP_LEX_DEC64);
+            if (*ptr == ':') {
+                lex_class |= LYP_LEX_COLON;
+                break;
+            }
+        }
+    }
+
+    return lex_class;
+}
+
+int
+lyp_union_type_mismatch(struct lys_type *type, const char *value, uint8_t lex_class)
+{
+    unsigned int i;
+
+    if ((lex_class & LYP_LEX_COLON) && (type->value_flags & LY_VALUE_NOCOLON)) {
+        return 1;
+    }
+
+    switch (type->base) {
+    case LY_TYPE_INT8:
+    case LY_TYPE_INT16:
+    case LY_TYPE_INT32:
+    case LY_TYPE_INT64:
+    case LY_TYPE_UINT8:
+    case LY_TYPE_UINT16:
+    case LY_TYPE_UINT32:
+    case LY_TYPE_UINT64:
+        return !(lex_class & LYP_LEX_INT);
+    case LY_TYPE_DEC64:
+        return !(lex_class & LYP_LEX_DEC64);
+    case LY_TYPE_BOOL:
+        return !value || (strcmp(value, "true") && strcmp(value, "false"));
+    case LY_TYPE_EMPTY:
+        return value && value[0];
+    case LY_TYPE_ENUM:
+        if (!value) {
+            return 1;
+        }
+        for (; !type->info.enums.count; type = &type->der->type);
+        for (i = 0; i < type->info.enums.count; ++i) {
+            if (!strcmp(value, type->info.enums.enm[i].name)) {
+                return 0;
+            }
+        }
+        return 1;
+    default:
+        /* the value must be parsed to learn whether it is valid */
+        return 0;
+    }
+}
+
 /* ret 0 - ret set, ret 1 - ret not set, no log, ret -1 - ret not set, fatal error */
 int
 lyp_fill_attr(struct ly_ctx *ctx, struct lyd_node *parent, const char *module_ns, const char *module_name,
@@ -3639,6 +3722,7 @@ lyp_ctx_add_module(struct lys_module *module)
     }
     module->ctx->models.list[module->ctx->models.used++] = module;
     module->ctx->models.module_set_id++;
+    lys_iffeature_cache_invalidate(module->ctx);
 
     return 0;
 }
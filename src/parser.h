@@ -58,7 +58,8 @@ struct lyd_node *lyd_parse_json(struct ly_ctx *ctx, const char *data, int option
  * @defgroup lybdata LYB data format support
  * @{
  */
-struct lyd_node *lyd_parse_lyb(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *data_tree,
+/* len is the length of data, SIZE_MAX if not known */
+struct lyd_node *lyd_parse_lyb(struct ly_ctx *ctx, const char *data, size_t len, int options, const struct lyd_node *data_tree,
                                const char *yang_data_name, int *parsed);
 
 /**@} lybdata */
@@ -95,6 +96,16 @@ int lyp_yin_parse_subnode_ext(struct lys_module *mod, void *elem, LYEXT_PAR elem
 
 struct lys_type *lyp_get_next_union_type(struct lys_type *type, struct lys_type *prev_type, int *found);
 
+/* lexical classes of a value, a value not in a class can never be valid for the corresponding types */
+#define LYP_LEX_INT   0x01 /**< only digits, signs, and whitespaces, possibly an integer */
+#define LYP_LEX_DEC64 0x02 /**< only digits, signs, and dots starting with a sign or a digit, possibly a decimal64 */
+#define LYP_LEX_COLON 0x04 /**< includes a colon, never valid for union members with #LY_VALUE_NOCOLON */
+
+uint8_t lyp_value_lex_class(const char *value);
+
+/* does not log, returns 1 if the union member type cannot accept the value without trying to parse it */
+int lyp_union_type_mismatch(struct lys_type *type, const char *value, uint8_t lex_class);
+
 /* return: 0 - ret set, ok; 1 - ret not set, no log, unknown meta; -1 - ret not set, log, fatal error */
 int lyp_fill_attr(struct ly_ctx *ctx, struct lyd_node *parent, const char *module_ns, const char *module_name,
                   const char *attr_name, const char *attr_value, struct lyxml_elem *xml, int options, struct lyd_attr **ret);
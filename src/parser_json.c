@@ -86,6 +86,14 @@ lyjson_parse_text(struct ly_ctx *ctx, const char *data, unsigned int *len)
             o = 0;
         }
 
+        if ((r = ly_char_run(&data[*len], LY_CHAR_CTRL | LY_CHAR_CTRLWS | LY_CHAR_UTF8 | LY_CHAR_JSON, BUFSIZE - o))) {
+            /* copy plain and valid UTF-8 characters at once, the run cannot include the closing quote */
+            memcpy(&buf[o], &data[*len], r);
+            o += r - 1; /* o is ++ in for loop */
+            (*len) += r;
+            continue;
+        }
+
         if (data[*len] == '\\') {
             /* parse escape sequence */
             (*len)++;
@@ -197,6 +205,76 @@ error:
     return NULL;
 }
 
+/**
+ * @brief Parse JSON string, avoid copying it if it includes no escape sequences.
+ *
+ * @param[in] ctx Context for logging.
+ * @param[in] data Input data right after the opening quotation mark.
+ * @param[out] str Parsed string, points either directly into \p data or to a newly allocated buffer.
+ * @param[out] str_len Length of \p str, it is not terminated if pointing into \p data.
+ * @param[out] dynamic Whether \p str was allocated and must be freed.
+ * @param[out] len Number of bytes read from \p data.
+ * @return 0 on success, -1 on error.
+ */
+static int
+lyjson_parse_str(struct ly_ctx *ctx, const char *data, const char **str, unsigned int *str_len, int *dynamic,
+                 unsigned int *len)
+{
+    char utf8[4], *buf;
+    unsigned int r = 0, c, i;
+
+    while (1) {
+        r += ly_char_run(&data[r], LY_CHAR_CTRL | LY_CHAR_CTRLWS | LY_CHAR_UTF8 | LY_CHAR_JSON, SIZE_MAX);
+        if (!(data[r] & 0x80)) {
+            break;
+        }
+
+        /* a character the run did not accept, validate it in place, do not let a truncated one hide the quote */
+        c = copyutf8(ctx, utf8, &data[r]);
+        if (!c) {
+            return -1;
+        }
+        for (i = 1; i < c; ++i) {
+            if ((data[r + i] & 0xc0) != 0x80) {
+                LOGVAL(ctx, LYE_XML_INCHAR, LY_VLOG_NONE, NULL, &data[r]);
+                LOGVAL(ctx, LYE_SPEC, LY_VLOG_NONE, NULL, "Invalid UTF-8 continuation byte 0x%02x",
+                       (uint8_t)data[r + i]);
+                return -1;
+            }
+        }
+        r += c;
+    }
+
+    if (data[r] == '"') {
+        /* no escape sequences, use the input directly */
+        *str = data;
+        *str_len = *len = r;
+        *dynamic = 0;
+        return 0;
+    }
+
+    /* the string needs to be unescaped (or is invalid) */
+    buf = lyjson_parse_text(ctx, data, len);
+    if (!buf) {
+        return -1;
+    }
+    *str = buf;
+    *str_len = strlen(buf);
+    *dynamic = 1;
+    return 0;
+}
+
+/**
+ * @brief Compare a terminated name with a name of the given length.
+ *
+ * @return non-zero if they are equal, 0 otherwise.
+ */
+static int
+lyjson_name_equal(const char *str, const char *name, unsigned int name_len)
+{
+    return !strncmp(str, name, name_len) && !str[name_len];
+}
+
 static unsigned int
 lyjson_parse_number(struct ly_ctx *ctx, const char *data)
 {
@@ -369,23 +447,29 @@ static unsigned int
 json_get_anydata(struct lyd_node_anydata *any, const char *data)
 {
     struct ly_ctx *ctx = any->schema->module->ctx;
-    unsigned int len = 0, c = 0;
-    char *str;
+    unsigned int len = 0, c = 0, str_len;
+    const char *str;
+    int dynamic;
 
     if (data[len] == '"') {
         len = 1;
-        str = lyjson_parse_text(ctx, &data[len], &c);
-        if (!str) {
+        if (lyjson_parse_str(ctx, &data[len], &str, &str_len, &dynamic, &c)) {
             return 0;
         }
         if (data[len + c] != '"') {
-            free(str);
+            if (dynamic) {
+                free((char *)str);
+            }
             LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, any,
                    "JSON data (missing quotation-mark at the end of string)");
             return 0;
         }
 
-        any->value.str = lydict_insert_zc(ctx, str);
+        if (dynamic) {
+            any->value.str = lydict_insert_zc(ctx, (char *)str);
+        } else {
+            any->value.str = lydict_insert(ctx, str, str_len);
+        }
         any->value_type = LYD_ANYDATA_CONSTSTRING;
         return len + c + 1;
     } else if (data[len] != '{') {
@@ -426,8 +510,10 @@ json_get_value(struct lyd_node_leaf_list *leaf, struct lyd_node **first_sibling,
     struct lyd_node_leaf_list *new;
     struct lys_type *stype;
     struct ly_ctx *ctx;
-    unsigned int len = 0, r;
+    unsigned int len = 0, r, str_len;
+    const char *value;
     char *str;
+    int dynamic;
 
     assert(leaf && data);
     ctx = leaf->schema->module->ctx;
@@ -451,12 +537,15 @@ repeat:
     if (data[len] == '"') {
         /* string representations */
         ++len;
-        str = lyjson_parse_text(ctx, &data[len], &r);
-        if (!str) {
+        if (lyjson_parse_str(ctx, &data[len], &value, &str_len, &dynamic, &r)) {
             LOGPATH(ctx, LY_VLOG_LYD, leaf);
             return 0;
         }
-        leaf->value_str = lydict_insert_zc(ctx, str);
+        if (dynamic) {
+            leaf->value_str = lydict_insert_zc(ctx, (char *)value);
+        } else {
+            leaf->value_str = lydict_insert(ctx, value, str_len);
+        }
         if (data[len + r] != '"') {
             LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, leaf,
                    "JSON data (missing quotation-mark at the end of string)");
@@ -770,11 +859,12 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
                 struct unres_data *unres, struct lyd_node **act_notif, const char *yang_data_name)
 {
     unsigned int len = 0;
-    unsigned int r;
+    unsigned int r, str_len, name_len, prefix_len = 0;
     unsigned int flag_leaflist = 0;
-    int i;
+    int i, str_dynamic = 0;
     uint8_t pos;
-    char *name, *prefix = NULL, *str = NULL;
+    const char *name, *prefix = NULL, *str = NULL, *colon;
+    char *aux;
     const struct lys_module *module = NULL;
     struct lys_node *schema = NULL;
     const struct lys_node *sparent = NULL;
@@ -790,25 +880,29 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
     }
     len++;
 
-    str = lyjson_parse_text(ctx, &data[len], &r);
-    if (!r) {
+    /* the name is usually used directly from the input, it is not terminated then */
+    if (lyjson_parse_str(ctx, &data[len], &str, &str_len, &str_dynamic, &r) || !r) {
         goto error;
     } else if (data[len + r] != '"') {
         LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, (*parent),
                "JSON data (missing quotation-mark at the end of string)");
         goto error;
     }
-    if ((name = strchr(str, ':'))) {
-        *name = '\0';
-        name++;
+    if ((colon = memchr(str, ':', str_len))) {
         prefix = str;
+        prefix_len = colon - str;
+        name = colon + 1;
+        name_len = str_len - prefix_len - 1;
         if (prefix[0] == '@') {
             prefix++;
+            prefix_len--;
         }
     } else {
         name = str;
+        name_len = str_len;
         if (name[0] == '@') {
             name++;
+            name_len--;
         }
     }
 
@@ -822,7 +916,7 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
     len++;
     len += skip_ws(&data[len]);
 
-    if (str[0] == '@' && !str[1]) {
+    if ((str_len == 1) && (str[0] == '@')) {
         /* process attribute of the parent object (container or list) */
         if (!(*parent)) {
             LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "attribute with no corresponding element to belongs to");
@@ -850,7 +944,9 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
             goto error;
         }
 
-        free(str);
+        if (str_dynamic) {
+            free((char *)str);
+        }
         return len;
     }
 
@@ -858,10 +954,16 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
     if (!(*parent)) {
         /* starting in root */
         /* get the proper schema */
-        module = ly_ctx_get_module(ctx, prefix, NULL, 0);
+        module = prefix_len ? ly_ctx_nget_module(ctx, prefix, prefix_len, NULL, 0) : NULL;
         if (ctx->data_clb) {
             if (!module) {
-                module = ctx->data_clb(ctx, prefix, NULL, 0, ctx->data_clb_data);
+                aux = NULL;
+                if (prefix) {
+                    aux = strndup(prefix, prefix_len);
+                    LY_CHECK_ERR_GOTO(!aux, LOGMEM(ctx), error);
+                }
+                module = ctx->data_clb(ctx, aux, NULL, 0, ctx->data_clb_data);
+                free(aux);
             } else if (!module->implemented) {
                 module = ctx->data_clb(ctx, module->name, module->ns, LY_MODCLB_NOT_IMPLEMENTED, ctx->data_clb_data);
             }
@@ -873,7 +975,7 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
                 if (sparent) {
                     /* get the proper schema node */
                     while ((schema = (struct lys_node *) lys_getnext(schema, sparent, module, 0))) {
-                        if (!strcmp(schema->name, name)) {
+                        if (lyjson_name_equal(schema->name, name, name_len)) {
                             break;
                         }
                     }
@@ -881,7 +983,7 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
             } else {
                 /* get the proper schema node */
                 while ((schema = (struct lys_node *) lys_getnext(schema, NULL, module, 0))) {
-                    if (!strcmp(schema->name, name)) {
+                    if (lyjson_name_equal(schema->name, name, name_len)) {
                         break;
                     }
                 }
@@ -890,10 +992,13 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
     } else {
         if (prefix) {
             /* get the proper module to give the chance to load/implement it */
-            module = ly_ctx_get_module(ctx, prefix, NULL, 1);
+            module = prefix_len ? ly_ctx_nget_module(ctx, prefix, prefix_len, NULL, 1) : NULL;
             if (ctx->data_clb) {
                 if (!module) {
-                    ctx->data_clb(ctx, prefix, NULL, 0, ctx->data_clb_data);
+                    aux = strndup(prefix, prefix_len);
+                    LY_CHECK_ERR_GOTO(!aux, LOGMEM(ctx), error);
+                    ctx->data_clb(ctx, aux, NULL, 0, ctx->data_clb_data);
+                    free(aux);
                 } else if (!module->implemented) {
                     ctx->data_clb(ctx, module->name, module->ns, LY_MODCLB_NOT_IMPLEMENTED, ctx->data_clb_data);
                 }
@@ -915,16 +1020,16 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
 
         if (schema_parent) {
             while ((schema = (struct lys_node *)lys_getnext(schema, schema_parent, NULL, 0))) {
-                if (!strcmp(schema->name, name)
-                        && ((prefix && !strcmp(lys_node_module(schema)->name, prefix))
+                if (lyjson_name_equal(schema->name, name, name_len)
+                        && ((prefix && lyjson_name_equal(lys_node_module(schema)->name, prefix, prefix_len))
                         || (!prefix && (lys_node_module(schema) == lys_node_module(schema_parent))))) {
                     break;
                 }
             }
         } else {
             while ((schema = (struct lys_node *)lys_getnext(schema, (*parent)->schema, NULL, 0))) {
-                if (!strcmp(schema->name, name)
-                        && ((prefix && !strcmp(lys_node_module(schema)->name, prefix))
+                if (lyjson_name_equal(schema->name, name, name_len)
+                        && ((prefix && lyjson_name_equal(lys_node_module(schema)->name, prefix, prefix_len))
                         || (!prefix && (lys_node_module(schema) == lyd_node_module(*parent))))) {
                     break;
                 }
@@ -934,7 +1039,10 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
 
     module = lys_node_module(schema);
     if (!module || !module->implemented || module->disabled) {
-        LOGVAL(ctx, LYE_INELEM, (*parent ? LY_VLOG_LYD : LY_VLOG_NONE), (*parent), name);
+        aux = strndup(name, name_len);
+        LY_CHECK_ERR_GOTO(!aux, LOGMEM(ctx), error);
+        LOGVAL(ctx, LYE_INELEM, (*parent ? LY_VLOG_LYD : LY_VLOG_NONE), (*parent), aux);
+        free(aux);
         goto error;
     }
 
@@ -978,7 +1086,9 @@ attr_repeat:
             len += skip_ws(&data[len]);
         }
 
-        free(str);
+        if (str_dynamic) {
+            free((char *)str);
+        }
         return len;
     }
 
@@ -1268,7 +1378,9 @@ attr_repeat:
         *parent = result;
     }
 
-    free(str);
+    if (str_dynamic) {
+        free((char *)str);
+    }
     return len;
 
 error:
@@ -1288,7 +1400,9 @@ error:
     }
 
     lyd_free(result);
-    free(str);
+    if (str_dynamic) {
+        free((char *)str);
+    }
 
     return 0;
 }
@@ -1321,8 +1435,9 @@ lyd_parse_json(struct ly_ctx *ctx, const char *data, int options, const struct l
     r = len + 1;
     r += skip_ws(&data[r]);
     if (data[r] == '}') {
-        if (options & LYD_OPT_DATA_ADD_YANGLIB) {
-            result = ly_ctx_info(ctx);
+        if ((options & LYD_OPT_DATA_ADD_YANGLIB) && ly_ctx_info_add(ctx, &result)) {
+            LOGERR(ctx, LY_EINT, "Adding ietf-yang-library data failed.");
+            return NULL;
         }
         lyd_validate(&result, options, ctx);
         return result;
@@ -1458,7 +1573,7 @@ lyd_parse_json(struct ly_ctx *ctx, const char *data, int options, const struct l
 
     /* add missing ietf-yang-library if requested */
     if (options & LYD_OPT_DATA_ADD_YANGLIB) {
-        if (lyd_merge(result, ly_ctx_info(ctx), LYD_OPT_DESTRUCT | LYD_OPT_EXPLICIT)) {
+        if (ly_ctx_info_add(ctx, &result)) {
             LOGERR(ctx, LY_EINT, "Adding ietf-yang-library data failed.");
             goto error;
         }
@@ -14,6 +14,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
@@ -56,6 +57,46 @@
 #define LYB_HAVE_READ_GOTO(r, d, go) if (r < 0) goto go; d += r;
 #define LYB_HAVE_READ_RETURN(r, d, ret) if (r < 0) return ret; d += r;
 
+/* streamed variant, only the innermost subtree data chunk is read */
+static int
+lyb_stream_read(const char *data, uint8_t *buf, size_t count, struct lyb_state *lybs)
+{
+    int ret = 0;
+    size_t to_read, *written;
+
+    if (!lybs->used) {
+        /* not in a subtree, no chunks */
+        if (buf) {
+            memcpy(buf, data, count);
+        }
+        return count;
+    }
+
+    written = &lybs->written[lybs->used - 1];
+    while (count) {
+        if (!*written) {
+            /* read the next chunk header */
+            if (((uint8_t)data[ret] == LYB_STREAM_END) || ((uint8_t)data[ret] == LYB_STREAM_SUBTREE)) {
+                LOGERR(lybs->ctx, LY_EINVAL, "Unexpected end of LYB subtree data.");
+                return -1;
+            }
+            *written = (uint8_t)data[ret];
+            ++ret;
+        }
+
+        to_read = (count < *written) ? count : *written;
+        if (buf) {
+            memcpy(buf, data + ret, to_read);
+            buf += to_read;
+        }
+        *written -= to_read;
+        count -= to_read;
+        ret += to_read;
+    }
+
+    return ret;
+}
+
 static int
 lyb_read(const char *data, uint8_t *buf, size_t count, struct lyb_state *lybs)
 {
@@ -65,6 +106,10 @@ lyb_read(const char *data, uint8_t *buf, size_t count, struct lyb_state *lybs)
 
     assert(data && lybs);
 
+    if (lybs->stream) {
+        return lyb_stream_read(data, buf, count, lybs);
+    }
+
     while (1) {
         /* check for fully-read (empty) data chunks */
         to_read = count;
@@ -160,12 +205,40 @@ lyb_read_enum(uint64_t *enum_idx, uint32_t count, const char *data, struct lyb_s
     return ret;
 }
 
+/* streamed variant, read all the remaining data chunks of the current subtree */
+static int
+lyb_stream_read_string(const char *data, char **str, struct lyb_state *lybs)
+{
+    int ret;
+    size_t len, *written;
+
+    written = &lybs->written[lybs->used - 1];
+
+    /* learn the length first */
+    len = *written;
+    for (ret = *written; ((uint8_t)data[ret] != LYB_STREAM_END) && ((uint8_t)data[ret] != LYB_STREAM_SUBTREE);
+            ret += 1 + (uint8_t)data[ret]) {
+        len += (uint8_t)data[ret];
+    }
+
+    *str = malloc((len + 1) * sizeof **str);
+    LY_CHECK_ERR_RETURN(!*str, LOGMEM(lybs->ctx), -1);
+
+    ret = lyb_stream_read(data, (uint8_t *)*str, len, lybs);
+    (*str)[len] = '\0';
+    return ret;
+}
+
 static int
 lyb_read_string(const char *data, char **str, int with_length, struct lyb_state *lybs)
 {
     int next_chunk = 0, r, ret = 0;
     size_t len = 0, cur_len;
 
+    if (!with_length && lybs->stream) {
+        return lyb_stream_read_string(data, str, lybs);
+    }
+
     if (with_length) {
         ret += (r = lyb_read_number(&len, 2, data, lybs));
         LYB_HAVE_READ_GOTO(r, data, error);
@@ -209,14 +282,79 @@ error:
     return -1;
 }
 
-static void
-lyb_read_stop_subtree(struct lyb_state *lybs)
+/* read a number written on as few bytes as needed, 7 bits in each */
+static int
+lyb_read_varint(uint32_t *num, const char *data, struct lyb_state *lybs)
+{
+    int r, ret = 0, shift = 0;
+    uint8_t byte;
+
+    *num = 0;
+    do {
+        if (shift > 28) {
+            LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB number.");
+            return -1;
+        }
+
+        ret += (r = lyb_read(data, &byte, 1, lybs));
+        LYB_HAVE_READ_RETURN(r, data, -1);
+
+        *num |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    return ret;
+}
+
+/* read a string, possibly as a reference into the string table, into the dictionary */
+static int
+lyb_read_table_string(const char *data, const char **str, int with_length, struct lyb_state *lybs)
+{
+    int r, ret = 0;
+    uint32_t idx = 0;
+    char *buf;
+
+    if (lybs->str_table) {
+        ret += (r = lyb_read_varint(&idx, data, lybs));
+        LYB_HAVE_READ_RETURN(r, data, -1);
+
+        if (idx > lybs->str_count) {
+            LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB string table reference %u.", idx);
+            return -1;
+        }
+    }
+
+    if (idx) {
+        *str = lydict_insert(lybs->ctx, lybs->strs[idx - 1], 0);
+    } else {
+        ret += (r = lyb_read_string(data, &buf, with_length, lybs));
+        LYB_HAVE_READ_RETURN(r, data, -1);
+
+        *str = lydict_insert_zc(lybs->ctx, buf);
+    }
+
+    return ret;
+}
+
+static int
+lyb_read_stop_subtree(const char *data, struct lyb_state *lybs)
 {
+    if (lybs->stream) {
+        if (lybs->written[lybs->used - 1] || ((uint8_t)data[0] != LYB_STREAM_END)) {
+            LOGINT(lybs->ctx);
+            return -1;
+        }
+
+        --lybs->used;
+        return 1;
+    }
+
     if (lybs->written[lybs->used - 1]) {
         LOGINT(lybs->ctx);
     }
 
     --lybs->used;
+    return 0;
 }
 
 static int
@@ -232,6 +370,19 @@ lyb_read_start_subtree(const char *data, struct lyb_state *lybs)
         LY_CHECK_ERR_RETURN(!lybs->written || !lybs->position || !lybs->inner_chunks, LOGMEM(lybs->ctx), -1);
     }
 
+    if (lybs->stream) {
+        if ((uint8_t)data[0] != LYB_STREAM_SUBTREE) {
+            LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB subtree start.");
+            return -1;
+        }
+
+        ++lybs->used;
+        lybs->written[lybs->used - 1] = 0;
+        lybs->inner_chunks[lybs->used - 1] = 0;
+        lybs->position[lybs->used - 1] = 0;
+        return 1;
+    }
+
     memcpy(meta_buf, data, LYB_META_BYTES);
 
     ++lybs->used;
@@ -242,6 +393,56 @@ lyb_read_start_subtree(const char *data, struct lyb_state *lybs)
     return LYB_META_BYTES;
 }
 
+/* check whether there is another nested subtree in the current subtree */
+static int
+lyb_read_has_subtree(const char *data, struct lyb_state *lybs)
+{
+    if (lybs->stream) {
+        return !lybs->written[lybs->used - 1] && ((uint8_t)data[0] == LYB_STREAM_SUBTREE);
+    }
+
+    return lybs->written[lybs->used - 1] ? 1 : 0;
+}
+
+static int
+lyb_skip_subtree(const char *data, struct lyb_state *lybs)
+{
+    int r, ret = 0, depth = 0;
+
+    if (lybs->stream) {
+        /* skip the rest of the current data chunk */
+        ret = lybs->written[lybs->used - 1];
+        lybs->written[lybs->used - 1] = 0;
+
+        /* skip all the following data chunks and nested subtrees, stop at the end of this subtree */
+        while (depth || ((uint8_t)data[ret] != LYB_STREAM_END)) {
+            if ((uint8_t)data[ret] == LYB_STREAM_SUBTREE) {
+                ++depth;
+                ++ret;
+            } else if ((uint8_t)data[ret] == LYB_STREAM_END) {
+                --depth;
+                ++ret;
+            } else {
+                ret += 1 + (uint8_t)data[ret];
+            }
+        }
+
+        return ret;
+    }
+
+    do {
+        ret += (r = lyb_read(data, NULL, lybs->written[lybs->used - 1], lybs));
+        LYB_HAVE_READ_RETURN(r, data, -1);
+
+        /* also skip the meta information inside */
+        r = lybs->inner_chunks[lybs->used - 1] * LYB_META_BYTES;
+        data += r;
+        ret += r;
+    } while (lybs->written[lybs->used - 1]);
+
+    return ret;
+}
+
 static int
 lyb_parse_model(const char *data, const struct lys_module **mod, struct lyb_state *lybs)
 {
@@ -306,8 +507,8 @@ lyb_new_node(const struct lys_node *schema)
     case LYS_LEAFLIST:
         node = calloc(sizeof(struct lyd_node_leaf_list), 1);
 
-        if (((struct lys_node_leaf *)schema)->type.base == LY_TYPE_LEAFREF) {
-            node->validity |= LYD_VAL_LEAFREF;
+        if (node && (((struct lys_node_leaf *)schema)->type.base == LY_TYPE_LEAFREF)) {
+            ((struct lyd_node_leaf_list *)node)->validity |= LYD_VAL_LEAFREF;
         }
         break;
     case LYS_ANYDATA:
@@ -367,17 +568,12 @@ lyb_parse_val_1(struct lys_type *type, LY_DATA_TYPE value_type, uint8_t value_fl
 {
     int r, ret;
     size_t i;
-    char *str = NULL;
     uint8_t byte;
     uint64_t num;
 
     if (value_flags & LY_VALUE_USER) {
         /* just read value_str */
-        ret = lyb_read_string(data, &str, 0, lybs);
-        if (ret > -1) {
-            *value_str = lydict_insert_zc(lybs->ctx, str);
-        }
-        return ret;
+        return lyb_read_table_string(data, value_str, 0, lybs);
     }
 
     /* find the correct structure, go through leafrefs and typedefs */
@@ -399,19 +595,13 @@ lyb_parse_val_1(struct lys_type *type, LY_DATA_TYPE value_type, uint8_t value_fl
     case LY_TYPE_IDENT:
     case LY_TYPE_UNION:
         /* we do not actually fill value now, but value_str */
-        ret = lyb_read_string(data, &str, 0, lybs);
-        if (ret > -1) {
-            *value_str = lydict_insert_zc(lybs->ctx, str);
-        }
+        ret = lyb_read_table_string(data, value_str, 0, lybs);
         break;
     case LY_TYPE_BINARY:
     case LY_TYPE_STRING:
     case LY_TYPE_UNKNOWN:
         /* read string */
-        ret = lyb_read_string(data, &str, 0, lybs);
-        if (ret > -1) {
-            value->string = lydict_insert_zc(lybs->ctx, str);
-        }
+        ret = lyb_read_table_string(data, &value->string, 0, lybs);
         break;
     case LY_TYPE_BITS:
         value->bit = calloc(type->info.bits.count, sizeof *value->bit);
@@ -749,10 +939,10 @@ lyb_parse_attr_name(const struct lys_module *mod, const char *data, struct lys_e
 {
     int r, ret = 0, pos, i, j, k;
     const struct lys_submodule *submod = NULL;
-    char *attr_name = NULL;
+    const char *attr_name = NULL;
 
     /* attr name */
-    ret += (r = lyb_read_string(data, &attr_name, 1, lybs));
+    ret += (r = lyb_read_table_string(data, &attr_name, 1, lybs));
     LYB_HAVE_READ_RETURN(r, data, -1);
 
     /* search module */
@@ -793,11 +983,11 @@ lyb_parse_attr_name(const struct lys_module *mod, const char *data, struct lys_e
 
     if (!*ext && (options & LYD_OPT_STRICT)) {
         LOGVAL(mod->ctx, LYE_SPEC, LY_VLOG_NONE, NULL, "Failed to find annotation \"%s\" in \"%s\".", attr_name, mod->name);
-        free(attr_name);
+        lydict_remove(lybs->ctx, attr_name);
         return -1;
     }
 
-    free(attr_name);
+    lydict_remove(lybs->ctx, attr_name);
     return ret;
 }
 
@@ -832,10 +1022,8 @@ lyb_parse_attributes(struct lyd_node *node, const char *data, int options, struc
 
         if (!mod || !ext) {
             /* unknown attribute, skip it */
-            do {
-                ret += (r = lyb_read(data, NULL, lybs->written[lybs->used - 1], lybs));
-                LYB_HAVE_READ_GOTO(r, data, error);
-            } while (lybs->written[lybs->used - 1]);
+            ret += (r = lyb_skip_subtree(data, lybs));
+            LYB_HAVE_READ_GOTO(r, data, error);
             goto stop_subtree;
         }
 
@@ -871,7 +1059,8 @@ lyb_parse_attributes(struct lyd_node *node, const char *data, int options, struc
         LYB_HAVE_READ_GOTO(r, data, error);
 
 stop_subtree:
-        lyb_read_stop_subtree(lybs);
+        ret += (r = lyb_read_stop_subtree(data, lybs));
+        LYB_HAVE_READ_GOTO(r, data, error);
     }
 
     return ret;
@@ -882,14 +1071,14 @@ error:
 }
 
 static int
-lyb_is_schema_hash_match(struct lys_node *sibling, LYB_HASH *hash, uint8_t hash_count)
+lyb_is_schema_hash_match(struct lys_node *sibling, LYB_HASH *hash, uint8_t hash_count, struct lyb_state *lybs)
 {
     LYB_HASH sibling_hash;
     uint8_t i;
 
     /* compare all the hashes starting from collision ID 0 */
     for (i = 0; i < hash_count; ++i) {
-        sibling_hash = lyb_hash(sibling, i);
+        sibling_hash = lybs->version ? lyb_hash(sibling, i) : lyb_hash_v0(sibling, i);
         if (sibling_hash != hash[i]) {
             return 0;
         }
@@ -967,7 +1156,7 @@ lyb_parse_schema_hash(const struct lys_node *sparent, const struct lys_module *m
     sibling = NULL;
     while ((sibling = (struct lys_node *)lys_getnext(sibling, sparent, mod, 0))) {
         /* skip schema nodes from models not present during printing */
-        if (lyb_has_schema_model(sibling, lybs->models, lybs->mod_count) && lyb_is_schema_hash_match(sibling, hash, i + 1)) {
+        if (lyb_has_schema_model(sibling, lybs->models, lybs->mod_count) && lyb_is_schema_hash_match(sibling, hash, i + 1, lybs)) {
             /* match found */
             break;
         }
@@ -989,24 +1178,6 @@ finish:
     return ret;
 }
 
-static int
-lyb_skip_subtree(const char *data, struct lyb_state *lybs)
-{
-    int r, ret = 0;
-
-    do {
-        ret += (r = lyb_read(data, NULL, lybs->written[lybs->used - 1], lybs));
-        LYB_HAVE_READ_RETURN(r, data, -1);
-
-        /* also skip the meta information inside */
-        r = lybs->inner_chunks[lybs->used - 1] * LYB_META_BYTES;
-        data += r;
-        ret += r;
-    } while (lybs->written[lybs->used - 1]);
-
-    return ret;
-}
-
 static int
 lyb_parse_subtree(const char *data, struct lyd_node *parent, struct lyd_node **first_sibling, const char *yang_data_name,
         int options, struct unres_data *unres, struct lyb_state *lybs)
@@ -1105,7 +1276,7 @@ lyb_parse_subtree(const char *data, struct lyd_node *parent, struct lyd_node **f
     }
 
     /* read all descendants */
-    while (lybs->written[lybs->used - 1]) {
+    while (lyb_read_has_subtree(data, lybs)) {
         ret += (r = lyb_parse_subtree(data, node, NULL, NULL, options, unres, lybs));
         LYB_HAVE_READ_GOTO(r, data, error);
     }
@@ -1133,7 +1304,8 @@ lyb_parse_subtree(const char *data, struct lyd_node *parent, struct lyd_node **f
 
 stop_subtree:
     /* end the subtree */
-    lyb_read_stop_subtree(lybs);
+    ret += (r = lyb_read_stop_subtree(data, lybs));
+    LYB_HAVE_READ_GOTO(r, data, error);
 
     return ret;
 
@@ -1166,6 +1338,181 @@ lyb_parse_data_models(const char *data, struct lyb_state *lybs)
     return ret;
 }
 
+static int
+lyb_parse_str_table(const char *data, struct lyb_state *lybs)
+{
+    int r, ret = 0;
+    uint32_t i, count;
+    char *str;
+
+    /* read string count */
+    ret += (r = lyb_read_varint(&count, data, lybs));
+    LYB_HAVE_READ_RETURN(r, data, -1);
+
+    if (count) {
+        lybs->strs = malloc(count * sizeof *lybs->strs);
+        LY_CHECK_ERR_RETURN(!lybs->strs, LOGMEM(lybs->ctx), -1);
+    }
+
+    /* read strings */
+    for (i = 0; i < count; ++i) {
+        ret += (r = lyb_read_string(data, &str, 1, lybs));
+        LYB_HAVE_READ_RETURN(r, data, -1);
+
+        lybs->strs[lybs->str_count++] = lydict_insert_zc(lybs->ctx, str);
+    }
+
+    return ret;
+}
+
+/* LZ4-like decompression of a single block, it must decompress exactly into dst_len bytes */
+static int
+lyb_lz_decompress(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_len)
+{
+    size_t ip = 0, op = 0, len, offset, i;
+    uint8_t token, byte;
+
+    while (1) {
+        if (ip == src_len) {
+            return -1;
+        }
+        token = src[ip++];
+
+        /* literals */
+        len = token >> 4;
+        if (len == 0x0F) {
+            do {
+                if (ip == src_len) {
+                    return -1;
+                }
+                byte = src[ip++];
+                len += byte;
+            } while (byte == UINT8_MAX);
+        }
+        if ((len > src_len - ip) || (len > dst_len - op)) {
+            return -1;
+        }
+        memcpy(dst + op, src + ip, len);
+        ip += len;
+        op += len;
+
+        if (ip == src_len) {
+            /* the last sequence has no match */
+            break;
+        }
+
+        /* match */
+        if (src_len - ip < 2) {
+            return -1;
+        }
+        offset = src[ip] | (src[ip + 1] << 8);
+        ip += 2;
+        if (!offset || (offset > op)) {
+            return -1;
+        }
+
+        len = token & 0x0F;
+        if (len == 0x0F) {
+            do {
+                if (ip == src_len) {
+                    return -1;
+                }
+                byte = src[ip++];
+                len += byte;
+            } while (byte == UINT8_MAX);
+        }
+        len += LYB_LZ_MIN_MATCH;
+        if (len > dst_len - op) {
+            return -1;
+        }
+
+        if (offset >= len) {
+            memcpy(dst + op, dst + op - offset, len);
+        } else {
+            /* overlapping match repeats the last offset bytes */
+            for (i = 0; i < len; ++i) {
+                dst[op + i] = dst[op + i - offset];
+            }
+        }
+        op += len;
+    }
+
+    return (op == dst_len) ? 0 : -1;
+}
+
+/* length of all the compressed blocks and of the payload they hold, -1 if they do not fit into avail bytes */
+static int
+lyb_blocks_length(const char *data, size_t avail, size_t *payload_len)
+{
+    const uint8_t *ptr = (const uint8_t *)data;
+    size_t raw_len, zlen, ret = 0;
+
+    *payload_len = 0;
+    while (1) {
+        if (avail - ret < 2) {
+            return -1;
+        }
+        raw_len = ptr[ret] | (ptr[ret + 1] << 8);
+        if (!raw_len) {
+            /* zero raw size of the last block */
+            break;
+        }
+        if (avail - ret < LYB_BLOCK_HEADER_BYTES) {
+            return -1;
+        }
+        zlen = ptr[ret + 2] | (ptr[ret + 3] << 8);
+        if (avail - ret - LYB_BLOCK_HEADER_BYTES < zlen) {
+            return -1;
+        }
+        *payload_len += raw_len;
+        ret += LYB_BLOCK_HEADER_BYTES + zlen;
+        if (ret > INT_MAX - 2) {
+            return -1;
+        }
+    }
+
+    return ret + 2;
+}
+
+/* decompress all the blocks into a new payload buffer, returns the length of the blocks */
+static int
+lyb_read_blocks(const char *data, size_t avail, char **payload, struct lyb_state *lybs)
+{
+    const uint8_t *ptr = (const uint8_t *)data;
+    size_t raw_len, zlen, payload_len, pos = 0;
+    int ret;
+
+    ret = lyb_blocks_length(data, avail, &payload_len);
+    if (ret < 0) {
+        LOGERR(lybs->ctx, LY_EINVAL, "Truncated LYB compressed blocks.");
+        return -1;
+    }
+
+    *payload = malloc(payload_len + 1);
+    LY_CHECK_ERR_RETURN(!*payload, LOGMEM(lybs->ctx), -1);
+
+    while ((raw_len = ptr[0] | (ptr[1] << 8))) {
+        zlen = ptr[2] | (ptr[3] << 8);
+        ptr += LYB_BLOCK_HEADER_BYTES;
+
+        if (zlen == raw_len) {
+            /* stored uncompressed */
+            memcpy(*payload + pos, ptr, raw_len);
+        } else if ((zlen > raw_len) || lyb_lz_decompress(ptr, zlen, (uint8_t *)*payload + pos, raw_len)) {
+            LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB compressed block.");
+            free(*payload);
+            *payload = NULL;
+            return -1;
+        }
+
+        ptr += zlen;
+        pos += raw_len;
+    }
+    (*payload)[pos] = '\0';
+
+    return ret;
+}
+
 static int
 lyb_parse_magic_number(const char *data, struct lyb_state *lybs)
 {
@@ -1199,20 +1546,36 @@ lyb_parse_magic_number(const char *data, struct lyb_state *lybs)
 static int
 lyb_parse_header(const char *data, struct lyb_state *lybs)
 {
-    int ret = 0;
+    int r, ret = 0;
     uint8_t byte = 0;
 
-    /* TODO version, any flags? */
-    ret += lyb_read(data, (uint8_t *)&byte, sizeof byte, lybs);
+    /* version, flags */
+    ret += (r = lyb_read(data, (uint8_t *)&byte, sizeof byte, lybs));
+    LYB_HAVE_READ_RETURN(r, data, -1);
+
+    lybs->version = byte & LYB_VERSION_MASK;
+    if (lybs->version > LYB_VERSION_NUM) {
+        LOGERR(lybs->ctx, LY_EINVAL, "Unsupported LYB version %u.", lybs->version);
+        return -1;
+    }
+    if (byte & ~(LYB_VERSION_MASK | LYB_HEADER_STREAM | LYB_HEADER_STRINGS | LYB_HEADER_COMPRESS)) {
+        LOGERR(lybs->ctx, LY_EINVAL, "Unsupported LYB header flags 0x%02x.", byte & ~LYB_VERSION_MASK);
+        return -1;
+    }
+    lybs->stream = (byte & LYB_HEADER_STREAM) ? 1 : 0;
+    lybs->str_table = (byte & LYB_HEADER_STRINGS) ? 1 : 0;
+    lybs->compress = (byte & LYB_HEADER_COMPRESS) ? 1 : 0;
 
     return ret;
 }
 
 struct lyd_node *
-lyd_parse_lyb(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *data_tree,
+lyd_parse_lyb(struct ly_ctx *ctx, const char *data, size_t len, int options, const struct lyd_node *data_tree,
               const char *yang_data_name, int *parsed)
 {
-    int r = 0, ret = 0;
+    int r = 0, ret = 0, consumed = 0;
+    uint32_t i;
+    char *payload = NULL;
     struct lyd_node *node = NULL, *next, *act_notif = NULL;
     struct unres_data *unres = NULL;
     struct lyb_state lybs;
@@ -1231,6 +1594,12 @@ lyd_parse_lyb(struct ly_ctx *ctx, const char *data, int options, const struct ly
     lybs.models = NULL;
     lybs.mod_count = 0;
     lybs.ctx = ctx;
+    lybs.version = 0;
+    lybs.stream = 0;
+    lybs.str_table = 0;
+    lybs.compress = 0;
+    lybs.strs = NULL;
+    lybs.str_count = 0;
 
     unres = calloc(1, sizeof *unres);
     LY_CHECK_ERR_GOTO(!unres, LOGMEM(ctx), finish);
@@ -1243,10 +1612,26 @@ lyd_parse_lyb(struct ly_ctx *ctx, const char *data, int options, const struct ly
     ret += (r = lyb_parse_header(data, &lybs));
     LYB_HAVE_READ_GOTO(r, data, finish);
 
+    if (lybs.compress) {
+        /* the rest is parsed from the decompressed payload */
+        r = lyb_read_blocks(data, (len == SIZE_MAX) ? SIZE_MAX : len - ret, &payload, &lybs);
+        if (r < 0) {
+            goto finish;
+        }
+        consumed = ret + r;
+        data = payload;
+    }
+
     /* read used models */
     ret += (r = lyb_parse_data_models(data, &lybs));
     LYB_HAVE_READ_GOTO(r, data, finish);
 
+    if (lybs.str_table) {
+        /* read string table */
+        ret += (r = lyb_parse_str_table(data, &lybs));
+        LYB_HAVE_READ_GOTO(r, data, finish);
+    }
+
     /* read subtree(s) */
     while (data[0]) {
         ret += (r = lyb_parse_subtree(data, NULL, &node, yang_data_name, options, unres, &lybs));
@@ -1260,10 +1645,10 @@ lyd_parse_lyb(struct ly_ctx *ctx, const char *data, int options, const struct ly
 
     /* read the last zero, parsing finished */
     ++ret;
-    r = ret;
+    r = payload ? consumed : ret;
 
     if (options & LYD_OPT_DATA_ADD_YANGLIB) {
-        if (lyd_merge(node, ly_ctx_info(ctx), LYD_OPT_DESTRUCT | LYD_OPT_EXPLICIT)) {
+        if (ly_ctx_info_add(ctx, &node)) {
             LOGERR(ctx, LY_EINT, "Adding ietf-yang-library data failed.");
             lyd_free_withsiblings(node);
             node = NULL;
@@ -1293,6 +1678,11 @@ finish:
     free(lybs.position);
     free(lybs.inner_chunks);
     free(lybs.models);
+    for (i = 0; i < lybs.str_count; ++i) {
+        lydict_remove(ctx, lybs.strs[i]);
+    }
+    free(lybs.strs);
+    free(payload);
     if (unres) {
         free(unres->node);
         free(unres->type);
@@ -1310,6 +1700,7 @@ lyd_lyb_data_length(const char *data)
 {
     struct lyb_state lybs;
     int r = 0, ret = 0, i;
+    uint32_t str_count;
     size_t len;
     uint8_t buf[LYB_SIZE_MAX];
 
@@ -1317,15 +1708,21 @@ lyd_lyb_data_length(const char *data)
         return -1;
     }
 
+    lybs.models = NULL;
     lybs.written = malloc(LYB_STATE_STEP * sizeof *lybs.written);
     lybs.position = malloc(LYB_STATE_STEP * sizeof *lybs.position);
     lybs.inner_chunks = malloc(LYB_STATE_STEP * sizeof *lybs.inner_chunks);
     LY_CHECK_ERR_GOTO(!lybs.written || !lybs.position || !lybs.inner_chunks, LOGMEM(NULL), finish);
     lybs.used = 0;
     lybs.size = LYB_STATE_STEP;
-    lybs.models = NULL;
     lybs.mod_count = 0;
     lybs.ctx = NULL;
+    lybs.version = 0;
+    lybs.stream = 0;
+    lybs.str_table = 0;
+    lybs.compress = 0;
+    lybs.strs = NULL;
+    lybs.str_count = 0;
 
     /* read magic number */
     ret += (r = lyb_parse_magic_number(data, &lybs));
@@ -1335,6 +1732,13 @@ lyd_lyb_data_length(const char *data)
     ret += (r = lyb_parse_header(data, &lybs));
     LYB_HAVE_READ_GOTO(r, data, finish);
 
+    if (lybs.compress) {
+        /* just the blocks follow */
+        r = lyb_blocks_length(data, SIZE_MAX, &len);
+        ret = (r < 0) ? -1 : ret + r;
+        goto finish;
+    }
+
     /* read model count */
     ret += (r = lyb_read_number((uint64_t *)&lybs.mod_count, 2, data, &lybs));
     LYB_HAVE_READ_GOTO(r, data, finish);
@@ -1355,6 +1759,21 @@ lyd_lyb_data_length(const char *data)
         LYB_HAVE_READ_GOTO(r, data, finish);
     }
 
+    if (lybs.str_table) {
+        /* skip string table */
+        ret += (r = lyb_read_varint(&str_count, data, &lybs));
+        LYB_HAVE_READ_GOTO(r, data, finish);
+
+        for (; str_count; --str_count) {
+            len = 0;
+            ret += (r = lyb_read_number(&len, 2, data, &lybs));
+            LYB_HAVE_READ_GOTO(r, data, finish);
+
+            ret += (r = lyb_read(data, NULL, len, &lybs));
+            LYB_HAVE_READ_GOTO(r, data, finish);
+        }
+    }
+
     while (data[0]) {
         /* register a new subtree */
         ret += (r = lyb_read_start_subtree(data, &lybs));
@@ -1365,7 +1784,8 @@ lyd_lyb_data_length(const char *data)
         LYB_HAVE_READ_GOTO(r, data, finish);
 
         /* subtree finished */
-        lyb_read_stop_subtree(&lybs);
+        ret += (r = lyb_read_stop_subtree(data, &lybs));
+        LYB_HAVE_READ_GOTO(r, data, finish);
     }
 
     /* read the last zero, parsing finished */
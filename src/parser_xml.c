@@ -718,9 +718,7 @@ lyd_parse_xml(struct ly_ctx *ctx, struct lyxml_elem **root, int options, ...)
 
     /* add missing ietf-yang-library if requested */
     if (options & LYD_OPT_DATA_ADD_YANGLIB) {
-        if (!result) {
-            result = ly_ctx_info(ctx);
-        } else if (lyd_merge(result, ly_ctx_info(ctx), LYD_OPT_DESTRUCT | LYD_OPT_EXPLICIT)) {
+        if (ly_ctx_info_add(ctx, &result)) {
             LOGERR(ctx, LY_EINT, "Adding ietf-yang-library data failed.");
             goto error;
         }
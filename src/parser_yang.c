@@ -2631,6 +2631,10 @@ yang_read_module(struct ly_ctx *ctx, const char* data, unsigned int size, const
     module->ctx = ctx;
     module->type = 0;
     module->implemented = (implement ? 1 : 0);
+    if (ctx->models.flags & LY_CTX_TRUSTED) {
+        /* the XPath expressions are not checked, so their dependencies are not known */
+        ctx->xpath_deps_partial = 1;
+    }
 
     /* add into the list of processed modules */
     if (lyp_check_circmod_add(module)) {
@@ -7334,6 +7334,10 @@ yin_read_module_(struct ly_ctx *ctx, struct lyxml_elem *yin, const char *revisio
     module->name = lydict_insert(ctx, value, strlen(value));
     module->type = 0;
     module->implemented = (implement ? 1 : 0);
+    if (ctx->models.flags & LY_CTX_TRUSTED) {
+        /* the XPath expressions are not checked, so their dependencies are not known */
+        ctx->xpath_deps_partial = 1;
+    }
 
     /* add into the list of processed modules */
     if (lyp_check_circmod_add(module)) {
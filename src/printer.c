@@ -22,10 +22,12 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #include "common.h"
 #include "tree_schema.h"
 #include "tree_data.h"
+#include "tree_internal.h"
 #include "printer.h"
 
 struct ext_substmt_info_s ext_substmt_info[] = {
@@ -281,6 +283,313 @@ ly_write_skipped(struct lyout *out, size_t position, const char *buf, size_t cou
     return count;
 }
 
+/* minimal number of siblings worth printing in parallel and of nodes in one chunk */
+#define LY_PRINT_PAR_MIN 256
+#define LY_PRINT_PAR_CHUNK_MIN 32
+
+/* number of the threads printing with LYP_PARALLEL, 0 for a thread per online CPU, accessed atomically */
+static uint16_t ly_print_thread_count;
+
+struct ly_print_chunk {
+    const struct lyd_node *first;   /* first node of the chunk */
+    uint32_t count;                 /* number of nodes in the chunk */
+    struct lyout out;               /* memory output the chunk is printed into */
+    int ret;
+    LY_ERR no;                      /* ly_errno of the printing thread */
+    struct ly_err_item *err;        /* messages stored by the printing thread, to be logged by the calling one */
+    int done;
+};
+
+/* worker threads of one print call, they print the chunks of one sibling set at a time */
+struct ly_print_pool {
+    struct ly_ctx *ctx;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t *threads;
+    uint32_t thread_count;
+    int quit;                       /* the print call is finished */
+
+    /* sibling set being printed, no chunks if none */
+    struct ly_print_chunk *chunks;
+    uint32_t chunk_count;
+    uint32_t next;                  /* next chunk to be printed */
+    uint32_t written;               /* number of chunks already written into the output */
+    uint32_t window;                /* how many chunks can be printed ahead of the written ones */
+    int same_schema;
+    int options;
+    ly_print_clb print_clb;
+    void *clb_arg;
+};
+
+static const struct lyd_node *
+ly_print_next(const struct lyd_node *node, int same_schema)
+{
+    const struct lyd_node *next;
+
+    for (next = node->next; next && same_schema && (next->schema != node->schema); next = next->next);
+    return next;
+}
+
+static int
+ly_print_chunk(struct ly_print_pool *pool, struct ly_print_chunk *chunk)
+{
+    const struct lyd_node *node;
+    uint32_t i;
+
+    chunk->out.type = LYOUT_MEMORY;
+    for (node = chunk->first, i = 0; i < chunk->count; node = ly_print_next(node, pool->same_schema), ++i) {
+        if (pool->print_clb(&chunk->out, node, (chunk == pool->chunks) && !i, pool->options, pool->clb_arg)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static void *
+ly_print_thread(void *arg)
+{
+    struct ly_print_pool *pool = arg;
+    struct ly_print_chunk *chunk;
+    struct ly_err_item *prev_eitem;
+    enum int_log_opts prev_ilo;
+
+    /* the messages of this thread would be lost, store them for the calling thread */
+    ly_ilo_change(pool->ctx, ILO_STORE, &prev_ilo, &prev_eitem);
+
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->quit) {
+        if ((pool->next >= pool->chunk_count) || (pool->next >= pool->written + pool->window)) {
+            /* no sibling set or all its chunks taken, or do not get too far ahead of the writer */
+            pthread_cond_wait(&pool->cond, &pool->lock);
+            continue;
+        }
+        chunk = &pool->chunks[pool->next++];
+        pthread_mutex_unlock(&pool->lock);
+
+        ly_errno = LY_SUCCESS;
+        chunk->ret = ly_print_chunk(pool, chunk);
+        chunk->no = ly_errno;
+        chunk->err = ly_err_detach(pool->ctx);
+
+        pthread_mutex_lock(&pool->lock);
+        chunk->done = 1;
+        pthread_cond_broadcast(&pool->cond);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    ly_ilo_restore(pool->ctx, prev_ilo, prev_eitem, 0);
+    return NULL;
+}
+
+/* start the worker threads of a print call, NULL if not possible */
+static struct ly_print_pool *
+ly_print_pool_new(struct ly_ctx *ctx, long max_threads)
+{
+    struct ly_print_pool *pool;
+
+    pool = calloc(1, sizeof *pool);
+    LY_CHECK_ERR_RETURN(!pool, LOGMEM(ctx), NULL);
+    pool->threads = malloc(max_threads * sizeof *pool->threads);
+    LY_CHECK_ERR_RETURN(!pool->threads, LOGMEM(ctx); free(pool), NULL);
+
+    pool->ctx = ctx;
+    pool->window = max_threads * 2;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+
+    for (pool->thread_count = 0; pool->thread_count < max_threads; ++pool->thread_count) {
+        if (pthread_create(&pool->threads[pool->thread_count], NULL, ly_print_thread, pool)) {
+            break;
+        }
+    }
+    if (!pool->thread_count) {
+        pthread_mutex_destroy(&pool->lock);
+        pthread_cond_destroy(&pool->cond);
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+void
+ly_print_pool_free(struct ly_print_pool *pool)
+{
+    uint32_t i;
+
+    if (!pool) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->quit = 1;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->thread_count; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->cond);
+    free(pool->threads);
+    free(pool);
+}
+
+API uint16_t
+lyd_print_threads(uint16_t threads)
+{
+#ifdef __GNUC__
+    return __atomic_exchange_n(&ly_print_thread_count, threads, __ATOMIC_RELAXED);
+#else
+    uint16_t prev = ly_print_thread_count;
+
+    ly_print_thread_count = threads;
+    return prev;
+#endif
+}
+
+/* print the chunks of a sibling set with the worker threads and write them in order */
+static int
+ly_print_siblings_par(struct lyout *out, struct ly_print_pool *pool, struct ly_print_chunk *chunks, uint32_t chunk_count)
+{
+    uint32_t i;
+    int ret = EXIT_SUCCESS;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->chunks = chunks;
+    pool->chunk_count = chunk_count;
+    pool->next = 0;
+    pool->written = 0;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    /* write the chunks in order as they are finished */
+    for (i = 0; i < chunk_count; ++i) {
+        pthread_mutex_lock(&pool->lock);
+        while (!chunks[i].done) {
+            pthread_cond_wait(&pool->cond, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        if (chunks[i].err) {
+            ly_err_repeat(pool->ctx, chunks[i].err);
+            chunks[i].err = NULL;
+        }
+        if (chunks[i].ret) {
+            if (chunks[i].no) {
+                ly_errno = chunks[i].no;
+            }
+            ret = EXIT_FAILURE;
+        } else if (chunks[i].out.method.mem.len) {
+            ly_write(out, chunks[i].out.method.mem.buf, chunks[i].out.method.mem.len);
+        }
+        free(chunks[i].out.method.mem.buf);
+        chunks[i].out.method.mem.buf = NULL;
+
+        pthread_mutex_lock(&pool->lock);
+        if (ret) {
+            /* stop printing the following chunks */
+            pool->chunk_count = pool->next;
+        }
+        ++pool->written;
+        pthread_cond_broadcast(&pool->cond);
+        pthread_mutex_unlock(&pool->lock);
+        if (ret) {
+            break;
+        }
+    }
+
+    /* wait for the chunks still being printed and release the sibling set */
+    pthread_mutex_lock(&pool->lock);
+    for (i = 0; i < pool->next; ++i) {
+        while (!chunks[i].done) {
+            pthread_cond_wait(&pool->cond, &pool->lock);
+        }
+    }
+    pool->chunks = NULL;
+    pool->chunk_count = 0;
+    pool->next = 0;
+    pthread_mutex_unlock(&pool->lock);
+
+    return ret;
+}
+
+int
+ly_print_siblings(struct lyout *out, const struct lyd_node *first, int same_schema, int options, ly_print_clb print_clb,
+                  void *clb_arg)
+{
+    struct ly_print_chunk *chunks;
+    const struct lyd_node *node;
+    uint32_t count, chunk_count, i, j, chunk_size;
+    long max_threads;
+    uint16_t thread_setting;
+    int ret;
+
+    if (options & LYP_PARALLEL) {
+        for (node = first, count = 0; node && (count < LY_PRINT_PAR_MIN); node = ly_print_next(node, same_schema), ++count);
+#ifdef __GNUC__
+        thread_setting = __atomic_load_n(&ly_print_thread_count, __ATOMIC_RELAXED);
+#else
+        thread_setting = ly_print_thread_count;
+#endif
+        max_threads = thread_setting ? thread_setting : sysconf(_SC_NPROCESSORS_ONLN);
+        if ((count == LY_PRINT_PAR_MIN) && (max_threads > 1)) {
+            if (!out->pool) {
+                /* the first parallel sibling set of this print call, the threads are kept until it ends */
+                out->pool = ly_print_pool_new(first->schema->module->ctx, max_threads);
+            }
+        } else {
+            max_threads = 0;
+        }
+    } else {
+        max_threads = 0;
+    }
+
+    if (!max_threads || !out->pool) {
+        /* sequential printing */
+        for (node = first, i = 0; node; node = ly_print_next(node, same_schema), ++i) {
+            if (print_clb(out, node, !i, options, clb_arg)) {
+                return EXIT_FAILURE;
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+
+    for (; node; node = ly_print_next(node, same_schema), ++count);
+
+    /* several chunks for every thread so that the uneven ones are balanced */
+    chunk_count = out->pool->thread_count * 4;
+    if (chunk_count > count / LY_PRINT_PAR_CHUNK_MIN) {
+        chunk_count = count / LY_PRINT_PAR_CHUNK_MIN;
+    }
+    chunks = calloc(chunk_count, sizeof *chunks);
+    LY_CHECK_ERR_RETURN(!chunks, LOGMEM(first->schema->module->ctx), EXIT_FAILURE);
+
+    chunk_size = count / chunk_count;
+    for (node = first, i = 0; i < chunk_count; ++i) {
+        chunks[i].first = node;
+        chunks[i].count = chunk_size + (i < count % chunk_count ? 1 : 0);
+        for (j = 0; j < chunks[i].count; node = ly_print_next(node, same_schema), ++j);
+    }
+
+    /* only the calling thread uses the pool, the nested siblings are printed sequentially in the worker threads */
+    out->pool->same_schema = same_schema;
+    out->pool->options = options & ~LYP_PARALLEL;
+    out->pool->print_clb = print_clb;
+    out->pool->clb_arg = clb_arg;
+
+    ret = ly_print_siblings_par(out, out->pool, chunks, chunk_count);
+
+    for (i = 0; i < chunk_count; ++i) {
+        free(chunks[i].out.method.mem.buf);
+        ly_err_free(chunks[i].err);
+    }
+    free(chunks);
+    return ret;
+}
+
 static int
 write_iff(struct lyout *out, const struct lys_module *module, struct lys_iffeature *expr, int prefix_kind,
           int *index_e, int *index_f)
@@ -706,17 +1015,29 @@ lys_print_target(struct lyout *out, const struct lys_module *module, const char
 static int
 lyd_print_(struct lyout *out, const struct lyd_node *root, LYD_FORMAT format, int options)
 {
+    int ret;
+
     switch (format) {
     case LYD_XML:
-        return xml_print_data(out, root, options);
+        ret = xml_print_data(out, root, options);
+        break;
     case LYD_JSON:
-        return json_print_data(out, root, options);
+        ret = json_print_data(out, root, options);
+        break;
     case LYD_LYB:
-        return lyb_print_data(out, root, options);
+        ret = lyb_print_data(out, root, options);
+        break;
     default:
         LOGERR(root->schema->module->ctx, LY_EINVAL, "Unknown output format.");
-        return EXIT_FAILURE;
+        ret = EXIT_FAILURE;
+        break;
     }
+
+    /* the threads are shared by all the parallel sibling sets of the print call */
+    ly_print_pool_free(out->pool);
+    out->pool = NULL;
+
+    return ret;
 }
 
 API int
@@ -936,7 +1257,9 @@ trim_dfs_nextsibling:
     } else if (node->dflt && node->schema->nodetype == LYS_CONTAINER && !(options & LYP_KEEPEMPTYCONT)) {
         /* avoid empty default containers */
         LY_TREE_DFS_BEGIN(node, next, elem) {
-            if (elem->schema->nodetype != LYS_CONTAINER) {
+            if ((elem->schema->nodetype != LYS_CONTAINER)
+                    || ((options & (LYP_WD_ALL | LYP_WD_ALL_TAG | LYP_WD_IMPL_TAG)) && elem->virt
+                        && (lyd_wd_virtual_children(elem, NULL) == 1))) {
                 flag = 1;
                 break;
             }
@@ -949,3 +1272,19 @@ trim_dfs_nextsibling:
 
     return 1;
 }
+
+int
+lyd_wd_virtual_toprint(const struct lyd_node *node, int options, struct lyd_node **virt)
+{
+    *virt = NULL;
+
+    if (!(options & (LYP_WD_ALL | LYP_WD_ALL_TAG | LYP_WD_IMPL_TAG))) {
+        /* the implicit default nodes are not printed */
+        return EXIT_SUCCESS;
+    }
+
+    if (lyd_wd_virtual_children(node, virt) == -1) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
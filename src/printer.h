@@ -49,6 +49,9 @@ struct lyout {
 
     /* hole counter */
     size_t hole_count;
+
+    /* threads printing the sibling sets with LYP_PARALLEL, created by the first one */
+    struct ly_print_pool *pool;
 };
 
 struct ext_substmt_info_s {
@@ -71,6 +74,24 @@ int ly_write(struct lyout *out, const char *buf, size_t count);
 int ly_write_skip(struct lyout *out, size_t count, size_t *position);
 int ly_write_skipped(struct lyout *out, size_t position, const char *buf, size_t count);
 
+/**
+ * @brief Callback printing a single data node, @p first is set for the first printed sibling.
+ */
+typedef int (*ly_print_clb)(struct lyout *out, const struct lyd_node *node, int first, int options, void *arg);
+
+/**
+ * @brief Print the node and its following siblings (only the instances of the same schema node if @p same_schema
+ * is set) using @p print_clb. With #LYP_PARALLEL and enough siblings, they are printed in chunks by the threads
+ * of @p out (started once for the whole print call) and the chunks are written into @p out in the original order.
+ */
+int ly_print_siblings(struct lyout *out, const struct lyd_node *first, int same_schema, int options, ly_print_clb print_clb,
+                      void *clb_arg);
+
+/**
+ * @brief Stop the threads started by ly_print_siblings() for a print call.
+ */
+void ly_print_pool_free(struct ly_print_pool *pool);
+
 /* prefix_kind: 0 - print import prefixes for foreign features, 1 - print module names, 2 - print prefixes (tree printer), 3 - print module names including revisions (JSONS printer) */
 int ly_print_iffeature(struct lyout *out, const struct lys_module *module, struct lys_iffeature *expr, int prefix_kind);
 
@@ -110,6 +131,13 @@ int lys_print_target(struct lyout *out, const struct lys_module *module, const c
  */
 int lyd_wd_toprint(const struct lyd_node *node, int options);
 
+/**
+ * get the virtual default children of a node to print according to the specified with-default mode,
+ * free them with lyd_wd_virtual_free()
+ * return EXIT_SUCCESS or EXIT_FAILURE
+ */
+int lyd_wd_virtual_toprint(const struct lyd_node *node, int options, struct lyd_node **virt);
+
 /* 0 - same, 1 - different */
 int nscmp(const struct lyd_node *node1, const struct lyd_node *node2);
 
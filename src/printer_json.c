@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <stdint.h>
 #include <inttypes.h>
 
 #include "common.h"
@@ -27,6 +28,7 @@
 #define INDENT ""
 #define LEVEL (level*2)
 
+static int json_print_children(struct lyout *out, int level, const struct lyd_node *node, int attrs, int options);
 static int json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int withsiblings, int toplevel,
                             int options);
 
@@ -34,6 +36,8 @@ int
 json_print_string(struct lyout *out, const char *text)
 {
     unsigned int i, n;
+    size_t len;
+    unsigned char ascii;
 
     if (!text) {
         return 0;
@@ -41,7 +45,18 @@ json_print_string(struct lyout *out, const char *text)
 
     ly_write(out, "\"", 1);
     for (i = n = 0; text[i]; i++) {
-        const unsigned char ascii = text[i];
+        /* write all the characters not needing escaping at once */
+        len = ly_char_run(&text[i], LY_CHAR_CTRL | LY_CHAR_CTRLWS | LY_CHAR_JSON, SIZE_MAX);
+        if (len) {
+            ly_write(out, &text[i], len);
+            n += len;
+            i += len;
+            if (!text[i]) {
+                break;
+            }
+        }
+
+        ascii = text[i];
         if (ascii < 0x20) {
             /* control character */
             n += ly_print(out, "\\u%.4X", ascii);
@@ -270,11 +285,8 @@ json_print_container(struct lyout *out, int level, const struct lyd_node *node,
             return EXIT_FAILURE;
         }
         ly_print(out, "%*s}", LEVEL, INDENT);
-        if (node->child) {
-            ly_print(out, ",%s", (level ? "\n" : ""));
-        }
     }
-    if (json_print_nodes(out, level, node->child, 1, 0, options)) {
+    if (json_print_children(out, level, node, node->attr ? 1 : 0, options)) {
         return EXIT_FAILURE;
     }
     if (level) {
@@ -285,6 +297,41 @@ json_print_container(struct lyout *out, int level, const struct lyd_node *node,
     return EXIT_SUCCESS;
 }
 
+/* ly_print_siblings() callback, arg is the level of the list */
+static int
+json_print_list_instance(struct lyout *out, const struct lyd_node *list, int first, int options, void *arg)
+{
+    int level = *(int *)arg;
+
+    if (!first) {
+        ly_print(out, ",%s", (level ? "\n" : ""));
+    }
+
+    if (level) {
+        ++level;
+    }
+    ly_print(out, "%*s{%s", LEVEL, INDENT, (level ? "\n" : ""));
+    if (level) {
+        ++level;
+    }
+    if (list->attr) {
+        ly_print(out, "%*s\"@\":%s{%s", LEVEL, INDENT, (level ? " " : ""), (level ? "\n" : ""));
+        if (json_print_attrs(out, (level ? level + 1 : level), list, NULL)) {
+            return EXIT_FAILURE;
+        }
+        ly_print(out, "%*s}", LEVEL, INDENT);
+    }
+    if (json_print_children(out, level, list, list->attr ? 1 : 0, options)) {
+        return EXIT_FAILURE;
+    }
+    if (level) {
+        --level;
+    }
+    ly_print(out, "%*s}", LEVEL, INDENT);
+
+    return EXIT_SUCCESS;
+}
+
 static int
 json_print_leaf_list(struct lyout *out, int level, const struct lyd_node *node, int is_list, int toplevel, int options)
 {
@@ -315,46 +362,26 @@ json_print_leaf_list(struct lyout *out, int level, const struct lyd_node *node,
         ++level;
     }
 
-    while (list) {
-        if (is_list) {
-            /* list print */
-            if (level) {
-                ++level;
-            }
-            ly_print(out, "%*s{%s", LEVEL, INDENT, (level ? "\n" : ""));
-            if (level) {
-                ++level;
-            }
-            if (list->attr) {
-                ly_print(out, "%*s\"@\":%s{%s", LEVEL, INDENT, (level ? " " : ""), (level ? "\n" : ""));
-                if (json_print_attrs(out, (level ? level + 1 : level), list, NULL)) {
-                    return EXIT_FAILURE;
-                }
-                if (list->child) {
-                    ly_print(out, "%*s},%s", LEVEL, INDENT, (level ? "\n" : ""));
-                } else {
-                    ly_print(out, "%*s}", LEVEL, INDENT);
-                }
-            }
-            if (json_print_nodes(out, level, list->child, 1, 0, options)) {
-                return EXIT_FAILURE;
-            }
-            if (level) {
-                --level;
-            }
-            ly_print(out, "%*s}", LEVEL, INDENT);
-            if (level) {
-                --level;
-            }
-        } else {
-            /* leaf-list print */
-            ly_print(out, "%*s", LEVEL, INDENT);
-            if (json_print_leaf(out, level, list, 1, toplevel, options)) {
+    if (is_list) {
+        /* list print */
+        if (toplevel && !(options & LYP_WITHSIBLINGS)) {
+            /* if initially called without LYP_WITHSIBLINGS do not print other list entries */
+            if (json_print_list_instance(out, list, 1, options, &level)) {
                 return EXIT_FAILURE;
             }
-            if (list->attr) {
-                flag_attrs = 1;
-            }
+        } else if (ly_print_siblings(out, list, 1, options, json_print_list_instance, &level)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    while (list && !is_list) {
+        /* leaf-list print */
+        ly_print(out, "%*s", LEVEL, INDENT);
+        if (json_print_leaf(out, level, list, 1, toplevel, options)) {
+            return EXIT_FAILURE;
+        }
+        if (list->attr) {
+            flag_attrs = 1;
         }
         if (toplevel && !(options & LYP_WITHSIBLINGS)) {
             /* if initially called without LYP_WITHSIBLINGS do not print other list entries */
@@ -506,9 +533,10 @@ json_print_anydataxml(struct lyout *out, int level, const struct lyd_node *node,
 }
 
 static int
-json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int withsiblings, int toplevel, int options)
+json_print_siblings(struct lyout *out, int level, const struct lyd_node *root, int withsiblings, int toplevel, int options,
+                    int *comma_flag)
 {
-    int ret = EXIT_SUCCESS,comma_flag = 0;
+    int ret = EXIT_SUCCESS;
     const struct lyd_node *node, *iter;
 
     LY_TREE_FOR(root, node) {
@@ -522,14 +550,14 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
         case LYS_ACTION:
         case LYS_NOTIF:
         case LYS_CONTAINER:
-            if (comma_flag) {
+            if (*comma_flag) {
                 /* print the previous comma */
                 ly_print(out, ",%s", (level ? "\n" : ""));
             }
             ret = json_print_container(out, level, node, toplevel, options);
             break;
         case LYS_LEAF:
-            if (comma_flag) {
+            if (*comma_flag) {
                 /* print the previous comma */
                 ly_print(out, ",%s", (level ? "\n" : ""));
             }
@@ -548,7 +576,7 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
                 }
             }
             if (!iter->next || node == root) {
-                if (comma_flag) {
+                if (*comma_flag) {
                     /* print the previous comma */
                     ly_print(out, ",%s", (level ? "\n" : ""));
                 }
@@ -559,7 +587,7 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
             break;
         case LYS_ANYXML:
         case LYS_ANYDATA:
-            if (comma_flag) {
+            if (*comma_flag) {
                 /* print the previous comma */
                 ly_print(out, ",%s", (level ? "\n" : ""));
             }
@@ -574,8 +602,18 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
         if (!withsiblings) {
             break;
         }
-        comma_flag = 1;
+        *comma_flag = 1;
     }
+
+    return ret;
+}
+
+static int
+json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int withsiblings, int toplevel, int options)
+{
+    int ret, comma_flag = 0;
+
+    ret = json_print_siblings(out, level, root, withsiblings, toplevel, options, &comma_flag);
     if (root && level) {
         ly_print(out, "\n");
     }
@@ -583,6 +621,29 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
     return ret;
 }
 
+static int
+json_print_children(struct lyout *out, int level, const struct lyd_node *node, int attrs, int options)
+{
+    struct lyd_node *virt;
+    int ret, comma_flag = attrs;
+
+    if (lyd_wd_virtual_toprint(node, options, &virt)) {
+        return EXIT_FAILURE;
+    }
+
+    /* the virtual default nodes follow the real children */
+    ret = json_print_siblings(out, level, node->child, 1, 0, options, &comma_flag);
+    if (!ret && virt) {
+        ret = json_print_siblings(out, level, virt, 1, 0, options, &comma_flag);
+    }
+    if ((node->child || virt) && level) {
+        ly_print(out, "\n");
+    }
+
+    lyd_wd_virtual_free(virt);
+    return ret;
+}
+
 int
 json_print_data(struct lyout *out, const struct lyd_node *root, int options)
 {
@@ -347,6 +347,223 @@ lyb_hash_find(struct hash_table *ht, struct lys_node *node)
     return hash;
 }
 
+/* number of bits of the block compression hash table index */
+#define LYB_LZ_HASH_BITS 12
+
+static void
+lyb_lz_write_len(uint8_t *dst, size_t *pos, size_t len)
+{
+    for (; len >= UINT8_MAX; len -= UINT8_MAX) {
+        dst[(*pos)++] = UINT8_MAX;
+    }
+    dst[(*pos)++] = len;
+}
+
+/* write a sequence of literals followed by a match (if any), returns the new position in dst, 0 if it does not fit */
+static size_t
+lyb_lz_write_sequence(uint8_t *dst, size_t pos, size_t dst_size, const uint8_t *lit, size_t lit_len, size_t offset,
+                      size_t match_len)
+{
+    uint8_t *token;
+
+    if (pos + 1 + lit_len / UINT8_MAX + 1 + lit_len + 2 + match_len / UINT8_MAX + 1 > dst_size) {
+        return 0;
+    }
+
+    /* token - literal length and match length, 4 bits each */
+    token = &dst[pos++];
+    *token = (lit_len < 0x0F ? lit_len : 0x0F) << 4;
+    if (lit_len >= 0x0F) {
+        lyb_lz_write_len(dst, &pos, lit_len - 0x0F);
+    }
+    memcpy(dst + pos, lit, lit_len);
+    pos += lit_len;
+
+    if (match_len) {
+        match_len -= LYB_LZ_MIN_MATCH;
+        *token |= (match_len < 0x0F ? match_len : 0x0F);
+
+        /* match offset, little-endian */
+        dst[pos++] = offset & 0xFF;
+        dst[pos++] = offset >> 8;
+        if (match_len >= 0x0F) {
+            lyb_lz_write_len(dst, &pos, match_len - 0x0F);
+        }
+    }
+
+    return pos;
+}
+
+/* LZ4-like compression of a single block, returns the compressed size or 0 if it does not fit into dst */
+static size_t
+lyb_lz_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_size)
+{
+    uint32_t table[1 << LYB_LZ_HASH_BITS], val, hash;
+    size_t ip = 0, anchor = 0, ref, match_len, pos = 0;
+
+    memset(table, 0, sizeof table);
+
+    /* the last match must start far enough from the block end */
+    while (ip + LYB_LZ_MF_LIMIT <= len) {
+        memcpy(&val, src + ip, sizeof val);
+        hash = (val * 2654435761U) >> (32 - LYB_LZ_HASH_BITS);
+        ref = table[hash];
+        table[hash] = ip;
+
+        if ((ref >= ip) || (ip - ref > UINT16_MAX) || memcmp(src + ref, src + ip, LYB_LZ_MIN_MATCH)) {
+            /* no match, move faster over data that do not compress */
+            ip += 1 + ((ip - anchor) >> 6);
+            continue;
+        }
+
+        /* extend the match, the last literals must remain */
+        for (match_len = LYB_LZ_MIN_MATCH;
+                (ip + match_len < len - LYB_LZ_LAST_LITERALS) && (src[ref + match_len] == src[ip + match_len]);
+                ++match_len);
+
+        pos = lyb_lz_write_sequence(dst, pos, dst_size, src + anchor, ip - anchor, ip - ref, match_len);
+        if (!pos) {
+            return 0;
+        }
+        ip += match_len;
+        anchor = ip;
+    }
+
+    /* the last literals */
+    return lyb_lz_write_sequence(dst, pos, dst_size, src + anchor, len - anchor, 0, 0);
+}
+
+/* write a block of the payload, compressed only if it makes it smaller */
+static int
+lyb_write_block(struct lyout *out, const uint8_t *buf, size_t len, struct lyb_state *lybs)
+{
+    int r;
+    size_t zlen;
+
+    assert(len && (len <= LYB_BLOCK_SIZE));
+
+    zlen = lyb_lz_compress(buf, len, lybs->zbuf + LYB_BLOCK_HEADER_BYTES, len - 1);
+
+    /* raw and compressed size */
+    lybs->zbuf[0] = len & 0xFF;
+    lybs->zbuf[1] = len >> 8;
+    lybs->zbuf[2] = (zlen ? zlen : len) & 0xFF;
+    lybs->zbuf[3] = (zlen ? zlen : len) >> 8;
+
+    if (zlen) {
+        r = ly_write(out, (char *)lybs->zbuf, LYB_BLOCK_HEADER_BYTES + zlen);
+        if ((r < 0) || ((size_t)r < LYB_BLOCK_HEADER_BYTES + zlen)) {
+            return -1;
+        }
+    } else {
+        r = ly_write(out, (char *)lybs->zbuf, LYB_BLOCK_HEADER_BYTES);
+        if (r < LYB_BLOCK_HEADER_BYTES) {
+            return -1;
+        }
+        r = ly_write(out, (char *)buf, len);
+        if ((r < 0) || ((size_t)r < len)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* streamed variant, write all the buffered data into the output */
+static int
+lyb_stream_flush(struct lyout *out, struct lyb_state *lybs)
+{
+    int r;
+
+    assert(!lybs->chunk_open);
+
+    if (lybs->buf_len) {
+        if (lybs->compress) {
+            /* the whole buffer is one block */
+            if (lyb_write_block(out, lybs->buf, lybs->buf_len, lybs)) {
+                return -1;
+            }
+        } else {
+            r = ly_write(out, (char *)lybs->buf, lybs->buf_len);
+            if ((r < 0) || ((size_t)r < lybs->buf_len)) {
+                return -1;
+            }
+        }
+        lybs->buf_len = 0;
+    }
+
+    return 0;
+}
+
+/* streamed variant, finish the open data chunk by writing its size into its header */
+static void
+lyb_stream_close_chunk(struct lyb_state *lybs)
+{
+    if (lybs->chunk_open) {
+        lybs->buf[lybs->chunk_pos] = (lybs->buf_len - lybs->chunk_pos - 1) & 0xFF;
+        lybs->chunk_open = 0;
+    }
+}
+
+/* streamed variant, write a subtree tag */
+static int
+lyb_stream_write_tag(struct lyout *out, uint8_t tag, struct lyb_state *lybs)
+{
+    lyb_stream_close_chunk(lybs);
+
+    if ((lybs->buf_len == lybs->buf_size) && lyb_stream_flush(out, lybs)) {
+        return -1;
+    }
+    lybs->buf[lybs->buf_len++] = tag;
+
+    return 1;
+}
+
+/* streamed variant, data in subtrees are written in chunks, the whole chunk is always kept in the buffer
+ * until it is finished so its size can be written into its header */
+static int
+lyb_stream_write(struct lyout *out, const uint8_t *buf, size_t count, struct lyb_state *lybs)
+{
+    int ret = 0;
+    size_t to_write;
+
+    while (count) {
+        if (lybs->used && !lybs->chunk_open) {
+            /* open a new data chunk, make sure it fits into the buffer */
+            if ((lybs->buf_len + 1 + LYB_STREAM_CHUNK_MAX > lybs->buf_size) && lyb_stream_flush(out, lybs)) {
+                return -1;
+            }
+            lybs->chunk_pos = lybs->buf_len++;
+            lybs->chunk_open = 1;
+            ++ret;
+        } else if (!lybs->used && (lybs->buf_len == lybs->buf_size) && lyb_stream_flush(out, lybs)) {
+            return -1;
+        }
+
+        if (lybs->used) {
+            to_write = LYB_STREAM_CHUNK_MAX - (lybs->buf_len - lybs->chunk_pos - 1);
+        } else {
+            to_write = lybs->buf_size - lybs->buf_len;
+        }
+        if (to_write > count) {
+            to_write = count;
+        }
+
+        memcpy(lybs->buf + lybs->buf_len, buf, to_write);
+        lybs->buf_len += to_write;
+        count -= to_write;
+        buf += to_write;
+        ret += to_write;
+
+        if (lybs->used && (lybs->buf_len - lybs->chunk_pos - 1 == LYB_STREAM_CHUNK_MAX)) {
+            /* full chunk */
+            lyb_stream_close_chunk(lybs);
+        }
+    }
+
+    return ret;
+}
+
 /* writing function handles writing size information */
 static int
 lyb_write(struct lyout *out, const uint8_t *buf, size_t count, struct lyb_state *lybs)
@@ -357,6 +574,10 @@ lyb_write(struct lyout *out, const uint8_t *buf, size_t count, struct lyb_state
 
     assert(out && lybs);
 
+    if (lybs->stream) {
+        return lyb_stream_write(out, buf, count, lybs);
+    }
+
     while (1) {
         /* check for full data chunks */
         to_write = count;
@@ -435,6 +656,14 @@ lyb_write_stop_subtree(struct lyout *out, struct lyb_state *lybs)
     int r;
     uint8_t meta_buf[LYB_META_BYTES];
 
+    if (lybs->stream) {
+        if (lyb_stream_write_tag(out, LYB_STREAM_END, lybs) < 0) {
+            return -1;
+        }
+        --lybs->used;
+        return 0;
+    }
+
     /* write the meta chunk information */
     meta_buf[0] = lybs->written[lybs->used - 1] & 0xFF;
     meta_buf[1] = lybs->inner_chunks[lybs->used - 1] & 0xFF;
@@ -453,6 +682,12 @@ lyb_write_start_subtree(struct lyout *out, struct lyb_state *lybs)
 {
     int i;
 
+    if (lybs->stream) {
+        /* no sizes are tracked */
+        ++lybs->used;
+        return lyb_stream_write_tag(out, LYB_STREAM_SUBTREE, lybs);
+    }
+
     if (lybs->used == lybs->size) {
         lybs->size += LYB_STATE_STEP;
         lybs->written = ly_realloc(lybs->written, lybs->size * sizeof *lybs->written);
@@ -543,6 +778,116 @@ lyb_write_string(const char *str, size_t str_len, int with_length, struct lyout
     return ret;
 }
 
+/* write a number on as few bytes as needed, 7 bits in each with the highest bit set if another byte follows */
+static int
+lyb_write_varint(uint32_t num, struct lyout *out, struct lyb_state *lybs)
+{
+    uint8_t buf[5];
+    size_t len = 0;
+
+    do {
+        buf[len] = num & 0x7F;
+        num >>= 7;
+        if (num) {
+            buf[len] |= 0x80;
+        }
+        ++len;
+    } while (num);
+
+    return lyb_write(out, buf, len, lybs);
+}
+
+/* string table record, strings are dictionary strings so they are compared as pointers */
+struct lyb_str_rec {
+    const char *str;
+    uint32_t count;
+    uint32_t idx;
+};
+
+static int
+lyb_str_equal_cb(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    return ((struct lyb_str_rec *)val1_p)->str == ((struct lyb_str_rec *)val2_p)->str;
+}
+
+static uint32_t
+lyb_str_hash(const char *str)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&str, sizeof str);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+/* count another occurrence of a string */
+static int
+lyb_str_table_add(const char *str, struct lyb_state *lybs)
+{
+    struct lyb_str_rec rec, *match;
+    int r;
+
+    rec.str = str;
+    rec.count = 1;
+    rec.idx = 0;
+    r = lyht_insert(lybs->str_ht, &rec, lyb_str_hash(str), (void **)&match);
+    if (r == -1) {
+        return -1;
+    } else if (r == 1) {
+        ++match->count;
+        return 0;
+    }
+
+    /* new string, remember the order, the array is doubled whenever full */
+    if (!(lybs->str_count & (lybs->str_count - 1))) {
+        lybs->strs = ly_realloc(lybs->strs, (lybs->str_count ? lybs->str_count * 2 : 1) * sizeof *lybs->strs);
+        LY_CHECK_ERR_RETURN(!lybs->strs, LOGMEM(lybs->ctx), -1);
+    }
+    lybs->strs[lybs->str_count++] = str;
+
+    return 0;
+}
+
+/* index of the string in the string table (+ 1), 0 if it is not there */
+static uint32_t
+lyb_str_table_find(const char *str, struct lyb_state *lybs)
+{
+    struct lyb_str_rec rec, *match;
+
+    rec.str = str;
+    if (lyht_find(lybs->str_ht, &rec, lyb_str_hash(str), (void **)&match)) {
+        return 0;
+    }
+    return match->idx;
+}
+
+/* write a string as a reference into the string table if used and the string is there */
+static int
+lyb_write_table_string(const char *str, int with_length, struct lyout *out, struct lyb_state *lybs)
+{
+    int r, ret = 0;
+    uint32_t idx;
+
+    if (!lybs->str_table) {
+        return lyb_write_string(str, 0, with_length, out, lybs);
+    }
+
+    idx = lyb_str_table_find(str, lybs);
+    ret += (r = lyb_write_varint(idx, out, lybs));
+    if (r < 0) {
+        return -1;
+    }
+
+    if (!idx) {
+        /* the string itself */
+        ret += (r = lyb_write_string(str, 0, with_length, out, lybs));
+        if (r < 0) {
+            return -1;
+        }
+    }
+
+    return ret;
+}
+
 static int
 lyb_print_model(struct lyout *out, const struct lys_module *mod, struct lyb_state *lybs)
 {
@@ -677,6 +1022,103 @@ next_mod:
     return ret;
 }
 
+/* whether the value is printed as a string, see lyb_print_value() */
+static int
+lyb_value_is_string(const struct lys_type *type, LY_DATA_TYPE value_type, uint8_t value_flags)
+{
+    if ((value_flags & LY_VALUE_USER) || (type->base == LY_TYPE_UNION)) {
+        return 1;
+    } else if (value_type == LY_TYPE_LEAFREF) {
+        while (type->base == LY_TYPE_LEAFREF) {
+            type = &type->info.lref.target->type;
+        }
+        value_type = type->base;
+    }
+
+    switch (value_type) {
+    case LY_TYPE_BINARY:
+    case LY_TYPE_INST:
+    case LY_TYPE_STRING:
+    case LY_TYPE_UNION:
+    case LY_TYPE_IDENT:
+    case LY_TYPE_UNKNOWN:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* strings that occur more than once are written only once into the string table before all the data */
+static int
+lyb_print_str_table(struct lyout *out, struct lyd_node *root, int options, struct lyb_state *lybs)
+{
+    int r, ret = 0;
+    uint32_t i, count;
+    struct lyd_node *node, *next, *elem;
+    struct lyd_node_leaf_list *leaf;
+    struct lyd_attr *attr;
+    struct lys_type **type;
+    struct lyb_str_rec rec, *match;
+
+    lybs->str_ht = lyht_new(8, sizeof(struct lyb_str_rec), lyb_str_equal_cb, NULL, 1);
+    LY_CHECK_ERR_RETURN(!lybs->str_ht, LOGMEM(lybs->ctx), -1);
+
+    /* count all the strings */
+    LY_TREE_FOR(root, node) {
+        LY_TREE_DFS_BEGIN(node, next, elem) {
+            LY_TREE_FOR(elem->attr, attr) {
+                if (lyb_str_table_add(attr->annotation->arg_value, lybs)) {
+                    return -1;
+                }
+                type = (struct lys_type **)lys_ext_complex_get_substmt(LY_STMT_TYPE, attr->annotation, NULL);
+                if (type && *type && lyb_value_is_string(*type, attr->value_type, attr->value_flags)
+                        && lyb_str_table_add(attr->value_str, lybs)) {
+                    return -1;
+                }
+            }
+
+            if (elem->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST)) {
+                leaf = (struct lyd_node_leaf_list *)elem;
+                if (lyb_value_is_string(&((struct lys_node_leaf *)leaf->schema)->type, leaf->value_type, leaf->value_flags)
+                        && lyb_str_table_add(leaf->value_str, lybs)) {
+                    return -1;
+                }
+            }
+            LY_TREE_DFS_END(node, next, elem);
+        }
+
+        if (!(options & LYP_WITHSIBLINGS)) {
+            break;
+        }
+    }
+
+    /* index the repeated strings in the order of their first occurrence */
+    count = 0;
+    for (i = 0; i < lybs->str_count; ++i) {
+        rec.str = lybs->strs[i];
+        lyht_find(lybs->str_ht, &rec, lyb_str_hash(rec.str), (void **)&match);
+        if (match->count > 1) {
+            match->idx = ++count;
+        }
+    }
+
+    /* string count and the strings with length */
+    ret += (r = lyb_write_varint(count, out, lybs));
+    if (r < 0) {
+        return -1;
+    }
+    for (i = 0; i < lybs->str_count; ++i) {
+        if (lyb_str_table_find(lybs->strs[i], lybs)) {
+            ret += (r = lyb_write_string(lybs->strs[i], 0, 1, out, lybs));
+            if (r < 0) {
+                return -1;
+            }
+        }
+    }
+
+    return ret;
+}
+
 static int
 lyb_print_magic_number(struct lyout *out)
 {
@@ -691,12 +1133,21 @@ lyb_print_magic_number(struct lyout *out)
 }
 
 static int
-lyb_print_header(struct lyout *out)
+lyb_print_header(struct lyout *out, struct lyb_state *lybs)
 {
     int ret = 0;
-    uint8_t byte = 0;
+    uint8_t byte = LYB_VERSION_NUM;
 
-    /* TODO version, some other flags? */
+    /* version, flags */
+    if (lybs->stream) {
+        byte |= LYB_HEADER_STREAM;
+    }
+    if (lybs->str_table) {
+        byte |= LYB_HEADER_STRINGS;
+    }
+    if (lybs->compress) {
+        byte |= LYB_HEADER_COMPRESS;
+    }
     ret += ly_write(out, (char *)&byte, sizeof byte);
 
     return ret;
@@ -708,6 +1159,7 @@ lyb_print_anydata(struct lyd_node_anydata *anydata, struct lyout *out, struct ly
     int ret = 0, len;
     char *buf;
     LYD_ANYDATA_VALUETYPE type;
+    struct lyout mem_out;
 
     if (anydata->value_type == LYD_ANYDATA_XML) {
         /* transform XML into CONSTSTRING */
@@ -733,7 +1185,17 @@ lyb_print_anydata(struct lyd_node_anydata *anydata, struct lyout *out, struct ly
     ret += lyb_write(out, (uint8_t *)&type, sizeof type, lybs);
 
     /* followed by the content */
-    if (anydata->value_type == LYD_ANYDATA_DATATREE) {
+    if ((anydata->value_type == LYD_ANYDATA_DATATREE) && lybs->stream) {
+        /* the nested data would bypass the output buffer, print them into memory first */
+        memset(&mem_out, 0, sizeof mem_out);
+        mem_out.type = LYOUT_MEMORY;
+        if (lyb_print_data(&mem_out, anydata->value.tree, 0)) {
+            ret = -1;
+        } else {
+            ret += lyb_write_string(mem_out.method.mem.buf, mem_out.method.mem.len, 0, out, lybs);
+        }
+        free(mem_out.method.mem.buf);
+    } else if (anydata->value_type == LYD_ANYDATA_DATATREE) {
         ret += lyb_print_data(out, anydata->value.tree, 0);
     } else if (anydata->value_type == LYD_ANYDATA_LYB) {
         len = lyd_lyb_data_length(anydata->value.mem);
@@ -812,7 +1274,7 @@ lyb_print_value(const struct lys_type *type, const char *value_str, lyd_val valu
     case LY_TYPE_IDENT:
     case LY_TYPE_UNKNOWN:
         /* store string */
-        ret += lyb_write_string(value_str, 0, 0, out, lybs);
+        ret += lyb_write_table_string(value_str, 0, out, lybs);
         break;
     case LY_TYPE_BITS:
         /* find the correct structure */
@@ -922,7 +1384,7 @@ lyb_print_attributes(struct lyout *out, struct lyd_attr *attr, struct lyb_state
         }
 
         /* annotation name with length */
-        ret += (r = lyb_write_string(iter->annotation->arg_value, 0, 1, out, lybs));
+        ret += (r = lyb_write_table_string(iter->annotation->arg_value, 1, out, lybs));
         if (r < 0) {
             return -1;
         }
@@ -1054,6 +1516,7 @@ lyb_print_subtree(struct lyout *out, const struct lyd_node *node, struct hash_ta
     int r, ret = 0;
     struct lyd_node_leaf_list *leaf;
     struct lys_node *sparent;
+    struct lyd_node *virt;
     struct hash_table *child_ht = NULL;
 
     /* skip nodes that should not be printed */
@@ -1131,12 +1594,20 @@ lyb_print_subtree(struct lyout *out, const struct lyd_node *node, struct hash_ta
     /* recursively write all the descendants */
     r = 0;
     if (node->schema->nodetype & (LYS_CONTAINER | LYS_LIST | LYS_NOTIF | LYS_RPC | LYS_ACTION)) {
+        /* the virtual default nodes are always printed, trusted data are parsed without adding them */
+        if (lyd_wd_virtual_children(node, &virt) == -1) {
+            return -1;
+        }
         LY_TREE_FOR(node->child, node) {
             ret += (r = lyb_print_subtree(out, node, &child_ht, lybs, options, 0));
             if (r < 0) {
                 break;
             }
         }
+        for (node = virt; node && (r > -1); node = node->next) {
+            ret += (r = lyb_print_subtree(out, node, &child_ht, lybs, options, 0));
+        }
+        lyd_wd_virtual_free(virt);
     }
     if (r < 0) {
         return -1;
@@ -1156,12 +1627,15 @@ lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
 {
     int r, ret = 0, rc = EXIT_SUCCESS;
     uint8_t zero = 0;
+    size_t i, len;
     struct hash_table *top_sibling_ht = NULL;
     const struct lys_module *prev_mod = NULL;
     struct lys_node *parent;
     struct lyb_state lybs;
+    struct lyout *header_out = out, payload_out;
 
     memset(&lybs, 0, sizeof lybs);
+    memset(&payload_out, 0, sizeof payload_out);
 
     if (root) {
         lybs.ctx = lyd_node_module(root)->ctx;
@@ -1173,15 +1647,37 @@ lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
         }
     }
 
+    if (options & LYP_LYB_STREAM) {
+        /* the whole buffer is written as a single compressed block */
+        lybs.stream = 1;
+        lybs.buf_size = (options & LYP_LYB_COMPRESS) ? LYB_BLOCK_SIZE : LYB_STREAM_BUF_SIZE;
+        lybs.buf = malloc(lybs.buf_size);
+        LY_CHECK_ERR_GOTO(!lybs.buf, LOGMEM(lybs.ctx); rc = EXIT_FAILURE, finish);
+    }
+    if (options & LYP_LYB_STRINGS) {
+        lybs.str_table = 1;
+    }
+    if (options & LYP_LYB_COMPRESS) {
+        lybs.compress = 1;
+        lybs.zbuf = malloc(LYB_BLOCK_HEADER_BYTES + LYB_BLOCK_SIZE);
+        LY_CHECK_ERR_GOTO(!lybs.zbuf, LOGMEM(lybs.ctx); rc = EXIT_FAILURE, finish);
+
+        if (!lybs.stream) {
+            /* the size holes are filled only at the end, print the whole payload into memory first */
+            payload_out.type = LYOUT_MEMORY;
+            out = &payload_out;
+        }
+    }
+
     /* LYB magic number */
-    ret += (r = lyb_print_magic_number(out));
+    ret += (r = lyb_print_magic_number(header_out));
     if (r < 0) {
         rc = EXIT_FAILURE;
         goto finish;
     }
 
     /* LYB header */
-    ret += (r = lyb_print_header(out));
+    ret += (r = lyb_print_header(header_out, &lybs));
     if (r < 0) {
         rc = EXIT_FAILURE;
         goto finish;
@@ -1194,6 +1690,14 @@ lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
         goto finish;
     }
 
+    if (lybs.str_table) {
+        ret += (r = lyb_print_str_table(out, (struct lyd_node *)root, options, &lybs));
+        if (r < 0) {
+            rc = EXIT_FAILURE;
+            goto finish;
+        }
+    }
+
     LY_TREE_FOR(root, root) {
         /* do not reuse sibling hash tables from different modules */
         if (lyd_node_module(root) != prev_mod) {
@@ -1216,9 +1720,40 @@ lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
     ret += (r = lyb_write(out, &zero, sizeof zero, &lybs));
     if (r < 0) {
         rc = EXIT_FAILURE;
+        goto finish;
+    }
+
+    if (lybs.stream && lyb_stream_flush(out, &lybs)) {
+        rc = EXIT_FAILURE;
+        goto finish;
+    }
+
+    if (lybs.compress) {
+        /* compress the payload printed into memory */
+        for (i = 0; i < payload_out.method.mem.len; i += len) {
+            len = payload_out.method.mem.len - i;
+            if (len > LYB_BLOCK_SIZE) {
+                len = LYB_BLOCK_SIZE;
+            }
+            if (lyb_write_block(header_out, (uint8_t *)payload_out.method.mem.buf + i, len, &lybs)) {
+                rc = EXIT_FAILURE;
+                goto finish;
+            }
+        }
+
+        /* zero raw size of the last block */
+        r = ly_write(header_out, "\0\0", 2);
+        if (r < 2) {
+            rc = EXIT_FAILURE;
+        }
     }
 
 finish:
+    free(payload_out.method.mem.buf);
+    free(lybs.zbuf);
+    lyht_free(lybs.str_ht);
+    free(lybs.strs);
+    free(lybs.buf);
     free(lybs.written);
     free(lybs.position);
     free(lybs.inner_chunks);
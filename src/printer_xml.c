@@ -427,49 +427,84 @@ printvalue:
     return EXIT_SUCCESS;
 }
 
+/* position of the printed siblings for ly_print_siblings() */
+struct xml_print_pos {
+    int level;
+    int toplevel;
+};
+
 static int
-xml_print_container(struct lyout *out, int level, const struct lyd_node *node, int toplevel, int options)
+xml_print_sibling(struct lyout *out, const struct lyd_node *node, int first, int options, void *arg)
 {
-    struct lyd_node *child;
-    const char *ns;
+    struct xml_print_pos *pos = arg;
 
-    if (toplevel || !node->parent || nscmp(node, node->parent)) {
-        /* print "namespace" */
-        ns = lyd_node_module(node)->ns;
-        ly_print(out, "%*s<%s xmlns=\"%s\"", LEVEL, INDENT, node->schema->name, ns);
-    } else {
-        ly_print(out, "%*s<%s", LEVEL, INDENT, node->schema->name);
-    }
+    (void)first;
+    return xml_print_node(out, pos->level, node, pos->toplevel, options);
+}
 
-    if (toplevel) {
-        xml_print_ns(out, node, options);
-    }
+static int
+xml_print_children(struct lyout *out, int level, const struct lyd_node *node, int options)
+{
+    struct lyd_node *child, *virt;
+    struct xml_print_pos pos;
 
-    if (xml_print_attrs(out, node, options)) {
+    if (lyd_wd_virtual_toprint(node, options, &virt)) {
         return EXIT_FAILURE;
     }
 
-    if (!node->child) {
+    if (!node->child && !virt) {
         ly_print(out, "/>%s", level ? "\n" : "");
         return EXIT_SUCCESS;
     }
     ly_print(out, ">%s", level ? "\n" : "");
 
-    LY_TREE_FOR(node->child, child) {
+    /* the namespaces are declared in the top-level nodes, so the children can be printed in separate chunks */
+    pos.level = level ? level + 1 : 0;
+    pos.toplevel = 0;
+    if (node->child && ly_print_siblings(out, node->child, 0, options, xml_print_sibling, &pos)) {
+        lyd_wd_virtual_free(virt);
+        return EXIT_FAILURE;
+    }
+    LY_TREE_FOR(virt, child) {
         if (xml_print_node(out, level ? level + 1 : 0, child, 0, options)) {
+            lyd_wd_virtual_free(virt);
             return EXIT_FAILURE;
         }
     }
+    lyd_wd_virtual_free(virt);
 
     ly_print(out, "%*s</%s>%s", LEVEL, INDENT, node->schema->name, level ? "\n" : "");
 
     return EXIT_SUCCESS;
 }
 
+static int
+xml_print_container(struct lyout *out, int level, const struct lyd_node *node, int toplevel, int options)
+{
+    const char *ns;
+
+    if (toplevel || !node->parent || nscmp(node, node->parent)) {
+        /* print "namespace" */
+        ns = lyd_node_module(node)->ns;
+        ly_print(out, "%*s<%s xmlns=\"%s\"", LEVEL, INDENT, node->schema->name, ns);
+    } else {
+        ly_print(out, "%*s<%s", LEVEL, INDENT, node->schema->name);
+    }
+
+    if (toplevel) {
+        xml_print_ns(out, node, options);
+    }
+
+    if (xml_print_attrs(out, node, options)) {
+        return EXIT_FAILURE;
+    }
+
+    return xml_print_children(out, level, node, options);
+}
+
 static int
 xml_print_list(struct lyout *out, int level, const struct lyd_node *node, int is_list, int toplevel, int options)
 {
-    struct lyd_node *child;
     const char *ns;
 
     if (is_list) {
@@ -489,19 +524,7 @@ xml_print_list(struct lyout *out, int level, const struct lyd_node *node, int is
             return EXIT_FAILURE;
         }
 
-        if (!node->child) {
-            ly_print(out, "/>%s", level ? "\n" : "");
-            return EXIT_SUCCESS;
-        }
-        ly_print(out, ">%s", level ? "\n" : "");
-
-        LY_TREE_FOR(node->child, child) {
-            if (xml_print_node(out, level ? level + 1 : 0, child, 0, options)) {
-                return EXIT_FAILURE;
-            }
-        }
-
-        ly_print(out, "%*s</%s>%s", LEVEL, INDENT, node->schema->name, level ? "\n" : "");
+        return xml_print_children(out, level, node, options);
     } else {
         /* leaf-list print */
         xml_print_leaf(out, level, node, toplevel, options);
@@ -636,6 +659,7 @@ xml_print_data(struct lyout *out, const struct lyd_node *root, int options)
 {
     const struct lyd_node *node, *next;
     struct lys_node *parent = NULL;
+    struct xml_print_pos pos;
     int level, action_input = 0;
 
     if (!root) {
@@ -682,13 +706,14 @@ xml_print_data(struct lyout *out, const struct lyd_node *root, int options)
     }
 
     /* content */
-    LY_TREE_FOR(root, node) {
-        if (xml_print_node(out, level, node, 1, options)) {
+    if (options & LYP_WITHSIBLINGS) {
+        pos.level = level;
+        pos.toplevel = 1;
+        if (ly_print_siblings(out, root, 0, options, xml_print_sibling, &pos)) {
             return EXIT_FAILURE;
         }
-        if (!(options & LYP_WITHSIBLINGS)) {
-            break;
-        }
+    } else if (root && xml_print_node(out, level, root, 1, options)) {
+        return EXIT_FAILURE;
     }
 
     if (action_input) {
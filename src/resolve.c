@@ -1236,8 +1236,7 @@ resolve_json_data_node_hash(struct lyd_node *parent, struct parsed_pred pp)
     prev_cb = lyht_set_cb(parent->ht, resolve_hash_table_find_equal);
 
     /* get the hash of the searched node */
-    hash = dict_hash_multi(0, lys_node_module(pp.schema)->name, strlen(lys_node_module(pp.schema)->name));
-    hash = dict_hash_multi(hash, pp.schema->name, strlen(pp.schema->name));
+    hash = lys_data_hash(pp.schema);
     if (pp.schema->nodetype == LYS_LEAFLIST) {
         assert((pp.len == 1) && (pp.pred[0].name[0] == '.') && (pp.pred[0].nam_len == 1));
         /* leaf-list value in predicate */
@@ -3866,6 +3865,9 @@ resolve_data(const struct lys_module *mod, const char *name, int nam_len, struct
             ++i;
             continue;
         }
+        if (parents->node[i] && parents->node[i]->virt && lyd_wd_virtual_create(parents->node[i])) {
+            return -1;
+        }
         flag = 0;
         LY_TREE_FOR(parents->node[i] ? parents->node[i]->child : start, node) {
             if (lyd_node_module(node) == mod && !strncmp(node->schema->name, name, nam_len)
@@ -4561,6 +4563,7 @@ check_xpath(struct lys_node *node, int check_place)
     struct lys_node *parent;
     struct lyxp_set set;
     enum int_log_opts prev_ilo;
+    int rc;
 
     if (check_place) {
         parent = node;
@@ -4586,13 +4589,18 @@ check_xpath(struct lys_node *node, int check_place)
 
     /* produce just warnings */
     ly_ilo_change(NULL, ILO_ERR2WRN, &prev_ilo, NULL);
-    lyxp_node_atomize(node, &set, 1);
+    rc = lyxp_node_atomize(node, &set, 1);
     ly_ilo_restore(NULL, prev_ilo, NULL, 0);
 
-    if (set.val.snodes) {
-        free(set.val.snodes);
+    /* remember the nodes the expressions depend on */
+    if (!rc && lys_xpath_dep_store(node, &set)) {
+        rc = -1;
+    } else {
+        rc = EXIT_SUCCESS;
     }
-    return EXIT_SUCCESS;
+
+    free(set.val.snodes);
+    return rc;
 }
 
 static int
@@ -6800,6 +6808,124 @@ check_type_union_leafref(struct lys_type *type)
     return type->der->has_union_leafref;
 }
 
+/**
+ * @brief Check whether a pattern can never match a string with a colon. It is only a conservative guess,
+ * any construct that could possibly match a colon makes it fail.
+ *
+ * @param[in] pattern XSD regular expression.
+ * @return 1 if the pattern never matches a colon, 0 otherwise.
+ */
+static int
+pattern_excludes_colon(const char *pattern)
+{
+    const unsigned char *ptr, *last = NULL;
+    int in_class = 0;
+
+    for (ptr = (const unsigned char *)pattern; *ptr; ++ptr) {
+        switch (*ptr) {
+        case ':':
+        case '.':
+            /* the colon itself or any character */
+            return 0;
+        case '\\':
+            ++ptr;
+            if (!*ptr) {
+                /* trailing backslash */
+                return 0;
+            } else if ((*ptr == 'p') && (ptr[1] == '{') && ((ptr[2] == 'L') || (ptr[2] == 'N'))) {
+                /* letters or numbers */
+                for (; *ptr && (*ptr != '}'); ++ptr);
+                if (!*ptr) {
+                    return 0;
+                }
+                last = NULL;
+            } else if (strchr("dswnrt", *ptr)) {
+                /* character classes without the colon */
+                last = NULL;
+            } else if (!isalnum(*ptr) && (*ptr != ':')) {
+                /* escaped metacharacter */
+                last = ptr;
+            } else {
+                return 0;
+            }
+            break;
+        case '[':
+            if (in_class && (last == ptr - 1) && (*last == '-')) {
+                /* class subtraction, can only remove characters */
+            } else if (ptr[1] == '^') {
+                return 0;
+            }
+            ++in_class;
+            last = NULL;
+            break;
+        case ']':
+            if (in_class) {
+                --in_class;
+            }
+            last = NULL;
+            break;
+        case '-':
+            if (in_class && last && ptr[1] && (ptr[1] != ']') && (ptr[1] != '[')) {
+                /* character range, check its end */
+                ++ptr;
+                if (*ptr == '\\') {
+                    ++ptr;
+                    if (!*ptr || isalnum(*ptr)) {
+                        return 0;
+                    }
+                }
+                if ((*last <= ':') && (*ptr >= ':')) {
+                    return 0;
+                }
+                last = NULL;
+            } else {
+                last = ptr;
+            }
+            break;
+        default:
+            last = ptr;
+            break;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Prepare union type for resolving its values. Members that can never accept values with a colon are marked
+ * so that these values are not tried to be parsed as such type at all.
+ *
+ * @param[in] type Union type with all the member types resolved.
+ */
+static void
+resolve_union_plan(struct lys_type *type)
+{
+    struct lys_type *t;
+    unsigned int i, j;
+
+    for (i = 0; i < type->info.uni.count; ++i) {
+        if (type->info.uni.types[i].base == LY_TYPE_UNION) {
+            resolve_union_plan(&type->info.uni.types[i]);
+            continue;
+        } else if (type->info.uni.types[i].base != LY_TYPE_STRING) {
+            continue;
+        }
+
+        /* all the patterns of all the derived types must match */
+        for (t = &type->info.uni.types[i]; t; t = (t->der ? &t->der->type : NULL)) {
+            for (j = 0; j < t->info.str.pat_count; ++j) {
+                if ((t->info.str.patterns[j].expr[0] == 0x06) && pattern_excludes_colon(&t->info.str.patterns[j].expr[1])) {
+                    type->info.uni.types[i].value_flags |= LY_VALUE_NOCOLON;
+                    break;
+                }
+            }
+            if (j < t->info.str.pat_count) {
+                break;
+            }
+        }
+    }
+}
+
 /**
  * @brief Resolve a single unres schema item. Logs indirectly.
  *
@@ -6902,6 +7028,10 @@ resolve_unres_schema_item(struct lys_module *mod, void *item, enum UNRES_ITEM ty
                 LOGWRN(ctx, "The leaf-list \"%s\" is of \"empty\" type, which does not make sense.", node->name);
             }
 
+            if (stype->base == LY_TYPE_UNION) {
+                resolve_union_plan(stype);
+            }
+
             if ((type == UNRES_TYPE_DER_TPDF) && (stype->base == LY_TYPE_UNION)) {
                 /* fill typedef union leafref flag */
                 ((struct lys_tpdf *)stype->parent)->has_union_leafref = check_type_union_leafref(stype);
@@ -7939,6 +8069,7 @@ resolve_union(struct lyd_node_leaf_list *leaf, struct lys_type *type, int store,
     struct lyd_node *ret;
     enum int_log_opts prev_ilo;
     int found, success = 0, ext_dep, req_inst;
+    uint8_t lex_class;
     const char *json_val = NULL;
 
     assert(type->base == LY_TYPE_UNION);
@@ -7952,15 +8083,25 @@ resolve_union(struct lyd_node_leaf_list *leaf, struct lys_type *type, int store,
         lyd_free_value(leaf->value, leaf->value_type, leaf->value_flags, &((struct lys_node_leaf *)leaf->schema)->type,
                        leaf->value_str, NULL, NULL, NULL);
         memset(&leaf->value, 0, sizeof leaf->value);
+#ifdef LY_ENABLED_CACHE
+        /* the value string can become canonical */
+        lyd_digest_invalidate((struct lyd_node *)leaf);
+#endif
     }
 
     /* turn logging off, we are going to try to validate the value with all the types in order */
     ly_ilo_change(NULL, ILO_IGNORE, &prev_ilo, 0);
 
+    lex_class = lyp_value_lex_class(leaf->value_str);
+
     t = NULL;
     found = 0;
     while ((t = lyp_get_next_union_type(type, t, &found))) {
         found = 0;
+        if (lyp_union_type_mismatch(t, leaf->value_str, lex_class)) {
+            /* the value cannot be valid, no need to parse it */
+            continue;
+        }
 
         switch (t->base) {
         case LY_TYPE_LEAFREF:
@@ -8272,6 +8413,97 @@ resolve_unres_data_autodel_diff(struct unres_data *unres, uint32_t unres_i)
     unres->node[unres_i] = NULL;
 }
 
+/**
+ * @brief Check whether any when condition applicable to a data node is among \p deps.
+ *
+ * Follows the schema nodes examined by resolve_when().
+ */
+static int
+resolve_when_depends(const struct lyd_node *node, const struct ly_set *deps)
+{
+    struct lys_node *sparent;
+
+    sparent = node->schema;
+    if (ly_set_contains(deps, sparent) > -1) {
+        return 1;
+    }
+    goto check_augment;
+
+    while (sparent && (sparent->nodetype & (LYS_USES | LYS_CHOICE | LYS_CASE))) {
+        if (ly_set_contains(deps, sparent) > -1) {
+            return 1;
+        }
+
+check_augment:
+        if (sparent->parent && (sparent->parent->nodetype == LYS_AUGMENT)
+                && (ly_set_contains(deps, sparent->parent) > -1)) {
+            return 1;
+        }
+
+        sparent = lys_parent(sparent);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Return already resolved true when conditions reading nodes from an auto-deleted subtree
+ * back into the unres list. Only the expressions depending on the deleted schema nodes
+ * (according to the schema XPath dependency graph) are affected.
+ *
+ * @param[in] unres Unres data structure to update.
+ * @param[in] del_idx Index of the deleted (unlinked) subtree in \p unres.
+ * @return Number of when conditions to be evaluated again, -1 on error.
+ */
+static int
+resolve_unres_data_when_deps(struct unres_data *unres, uint32_t del_idx)
+{
+    struct lyd_node *next, *elem, *top;
+    struct ly_set *deps, *node_deps;
+    uint32_t i, j;
+    int count = 0;
+
+    deps = ly_set_new();
+    LY_CHECK_ERR_RETURN(!deps, LOGMEM(unres->node[del_idx]->schema->module->ctx), -1);
+
+    /* collect all the expressions reading the deleted nodes */
+    LY_TREE_DFS_BEGIN(unres->node[del_idx], next, elem) {
+        node_deps = lys_xpath_dep_get(elem->schema);
+        for (i = 0; node_deps && (i < node_deps->number); ++i) {
+            if (ly_set_add(deps, node_deps->set.s[i], 0) == -1) {
+                ly_set_free(deps);
+                return -1;
+            }
+        }
+        LY_TREE_DFS_END(unres->node[del_idx], next, elem);
+    }
+
+    for (i = 0; deps->number && (i < unres->count); ++i) {
+        /* only resolved when with the result true can be affected, other items were not resolved yet */
+        if ((unres->type[i] != UNRES_RESOLVED) || !(unres->node[i]->when_status & LYD_WHEN_TRUE)
+                || (unres->node[i]->when_status & LYD_WHEN_FALSE) || !resolve_when_depends(unres->node[i], deps)) {
+            continue;
+        }
+
+        /* skip nodes in deleted subtrees */
+        for (top = unres->node[i]; top->parent; top = top->parent);
+        for (j = 0; j < unres->count; ++j) {
+            if ((unres->type[j] == UNRES_DELETE) && (unres->node[j] == top)) {
+                break;
+            }
+        }
+        if (j < unres->count) {
+            continue;
+        }
+
+        unres->type[i] = UNRES_WHEN;
+        ++count;
+    }
+
+    ly_set_free(deps);
+    return count;
+}
+
 /**
  * @brief Resolve every unres data item in the structure. Logs directly.
  *
@@ -8418,6 +8650,13 @@ resolve_unres_data(struct ly_ctx *ctx, struct unres_data *unres, struct lyd_node
                             }
                         }
                     }
+
+                    /* when conditions already evaluated with the deleted nodes must be evaluated again */
+                    rc = resolve_unres_data_when_deps(unres, i);
+                    if (rc == -1) {
+                        goto error;
+                    }
+                    resolved -= rc;
                 } else {
                     unres->type[i] = UNRES_RESOLVED;
                 }
@@ -42,6 +42,16 @@ static struct lys_node *lyd_get_schema_inctx(const struct lyd_node *node, struct
 
 static struct lyd_node *lyd_dup_withsiblings_to_ctx(const struct lyd_node *node, int options, struct ly_ctx *ctx);
 
+static struct lyd_node *_lyd_dup_to_ctx(const struct lyd_node *node, int options, struct ly_ctx *ctx,
+                                        struct ly_ctx_schema_map *map);
+
+static struct lyd_node *lyd_dup_withsiblings_r(const struct lyd_node *first, struct lyd_node *parent_dup, int options,
+                                               struct ly_ctx *ctx, struct ly_ctx_schema_map *map);
+
+static uint32_t lyd_diff_hash(struct lyd_node *node);
+
+static struct hash_table *lyd_diff_siblings_ht(struct lyd_node *first_sibling, int *options, struct hash_table **tmp_ht);
+
 static int
 lyd_anydata_equal(struct lyd_node *first, struct lyd_node *second)
 {
@@ -315,30 +325,39 @@ lyd_hash_table_val_equal(void *val1_p, void *val2_p, int mod, void *UNUSED(cb_da
     return 0;
 }
 
-static void
-lyd_hash_keyless_list_dfs(struct lyd_node *child, uint32_t *hash)
+/*
+ * sum of the hashes of all the terminal nodes in a subtree, the hash of a key-less list is combined from the
+ * sum of its descendants so that it does not depend on their order and can be adjusted on every change
+ */
+static uint32_t
+lyd_hash_keyless_list_sum(struct lyd_node *node)
 {
-    LY_TREE_FOR(child, child) {
-        switch (child->schema->nodetype) {
-        case LYS_CONTAINER:
-            lyd_hash_keyless_list_dfs(child->child, hash);
-            break;
-        case LYS_LIST:
-            /* ignore lists with missing keys */
-            if (lyd_list_has_keys(child)) {
-                lyd_hash_keyless_list_dfs(child->child, hash);
-            }
-            break;
-        case LYS_LEAFLIST:
-        case LYS_ANYXML:
-        case LYS_ANYDATA:
-        case LYS_LEAF:
-            *hash = dict_hash_multi(*hash, (char *)&child->hash, sizeof child->hash);
+    struct lyd_node *child;
+    uint32_t sum = 0;
+
+    switch (node->schema->nodetype) {
+    case LYS_LIST:
+        /* ignore lists with missing keys */
+        if (!lyd_list_has_keys(node)) {
             break;
-        default:
-            assert(0);
         }
+        /* fallthrough */
+    case LYS_CONTAINER:
+        LY_TREE_FOR(node->child, child) {
+            sum += lyd_hash_keyless_list_sum(child);
+        }
+        break;
+    case LYS_LEAFLIST:
+    case LYS_ANYXML:
+    case LYS_ANYDATA:
+    case LYS_LEAF:
+        sum = node->hash;
+        break;
+    default:
+        assert(0);
     }
+
+    return sum;
 }
 
 int
@@ -350,21 +369,21 @@ lyd_hash(struct lyd_node *node)
     assert(!node->hash || ((node->schema->nodetype == LYS_LIST) && !((struct lys_node_list *)node->schema)->keys_size));
 
     if ((node->schema->nodetype != LYS_LIST) || lyd_list_has_keys(node)) {
-        node->hash = dict_hash_multi(0, lyd_node_module(node)->name, strlen(lyd_node_module(node)->name));
-        node->hash = dict_hash_multi(node->hash, node->schema->name, strlen(node->schema->name));
+        /* module and node name are hashed only once in the schema node */
+        node->hash = lys_data_hash(node->schema);
         if (node->schema->nodetype == LYS_LEAFLIST) {
             node->hash = dict_hash_multi(node->hash, ((struct lyd_node_leaf_list *)node)->value_str,
                                         strlen(((struct lyd_node_leaf_list *)node)->value_str));
         } else if (node->schema->nodetype == LYS_LIST) {
-            if (((struct lys_node_list *)node->schema)->keys_size) {
-                for (i = 0, iter = node->child; i < ((struct lys_node_list *)node->schema)->keys_size; ++i, iter = iter->next) {
-                    assert(iter);
-                    node->hash = dict_hash_multi(node->hash, ((struct lyd_node_leaf_list *)iter)->value_str,
-                                                 strlen(((struct lyd_node_leaf_list *)iter)->value_str));
-                }
-            } else {
+            if (!((struct lys_node_list *)node->schema)->keys_size) {
                 /* no-keys list */
-                lyd_hash_keyless_list_dfs(node->child, &node->hash);
+                node->hash = dict_hash_multi(node->hash, NULL, 0) + lyd_hash_keyless_list_sum(node);
+                return 0;
+            }
+            for (i = 0, iter = node->child; i < ((struct lys_node_list *)node->schema)->keys_size; ++i, iter = iter->next) {
+                assert(iter);
+                node->hash = dict_hash_multi(node->hash, ((struct lyd_node_leaf_list *)iter)->value_str,
+                                             strlen(((struct lyd_node_leaf_list *)iter)->value_str));
             }
         }
         node->hash = dict_hash_multi(node->hash, NULL, 0);
@@ -374,28 +393,14 @@ lyd_hash(struct lyd_node *node)
     return 1;
 }
 
-static void
-lyd_keyless_list_hash_change(struct lyd_node *parent)
+/* get the closest key-less list whose hash includes the hashes of the children of parent */
+static struct lyd_node *
+lyd_keyless_list_ancestor(struct lyd_node *parent)
 {
-    int r;
-
     while (parent && (parent->schema->flags & LYS_CONFIG_R)) {
         if (parent->schema->nodetype == LYS_LIST) {
             if (!((struct lys_node_list *)parent->schema)->keys_size) {
-                if (parent->parent && parent->parent->ht) {
-                    /* remove the list from the parent */
-                    r = lyht_remove(parent->parent->ht, &parent, parent->hash);
-                    assert(!r);
-                    (void)r;
-                }
-                /* recalculate the hash */
-                lyd_hash(parent);
-                if (parent->parent && parent->parent->ht) {
-                    /* re-add the list again */
-                    r = lyht_insert(parent->parent->ht, &parent, parent->hash, NULL);
-                    assert(!r);
-                    (void)r;
-                }
+                return parent;
             } else if (!lyd_list_has_keys(parent)) {
                 /* a parent is a list without keys so it cannot be a part of any parent hash */
                 break;
@@ -404,12 +409,37 @@ lyd_keyless_list_hash_change(struct lyd_node *parent)
 
         parent = parent->parent;
     }
+
+    return NULL;
+}
+
+/* add diff to the hash of list and all its key-less list ancestors */
+static void
+lyd_keyless_list_hash_change(struct lyd_node *list, uint32_t diff)
+{
+    int r;
+
+    for (; list; list = lyd_keyless_list_ancestor(list->parent)) {
+        if (list->parent && list->parent->ht) {
+            /* remove the list from the parent */
+            r = lyht_remove(list->parent->ht, &list, list->hash);
+            assert(!r);
+            (void)r;
+        }
+        list->hash += diff;
+        if (list->parent && list->parent->ht) {
+            /* re-add the list again */
+            r = lyht_insert(list->parent->ht, &list, list->hash, NULL);
+            assert(!r);
+            (void)r;
+        }
+    }
 }
 
 static void
 _lyd_insert_hash(struct lyd_node *node, int keyless_list_check)
 {
-    struct lyd_node *iter;
+    struct lyd_node *iter, *added = node;
     int i;
 
     if (node->parent) {
@@ -419,6 +449,7 @@ _lyd_insert_hash(struct lyd_node *node, int keyless_list_check)
                 if (!lyd_hash(node->parent)) {
                     /* yep, we successfully hashed node->parent so it is technically now added to its parent (hash-wise) */
                     _lyd_insert_hash(node->parent, 0);
+                    added = node->parent;
                 }
             }
 
@@ -452,9 +483,98 @@ _lyd_insert_hash(struct lyd_node *node, int keyless_list_check)
             }
 
             /* if node was in a state data subtree, wasn't it a part of a key-less list hash? */
-            if (keyless_list_check) {
-                lyd_keyless_list_hash_change(node->parent);
+            if (keyless_list_check && (iter = lyd_keyless_list_ancestor(added->parent))) {
+                lyd_keyless_list_hash_change(iter, lyd_hash_keyless_list_sum(added));
+            }
+        }
+    }
+}
+
+/* create the hash table of a parent whose children were all connected directly, without lyd_insert_hash() */
+static int
+lyd_insert_hash_children(struct lyd_node *parent)
+{
+    struct lyd_node *iter;
+    uint32_t count = 0, size;
+
+    assert(!parent->ht);
+
+    LY_TREE_FOR(parent->child, iter) {
+        if ((iter->schema->nodetype != LYS_LIST) || lyd_list_has_keys(iter)) {
+            ++count;
+        }
+    }
+    if (count < LY_CACHE_HT_MIN_CHILDREN) {
+        return EXIT_SUCCESS;
+    }
+
+    /* large enough not to be enlarged while being filled */
+    for (size = LYHT_MIN_SIZE; (count * 100) / size >= LYHT_ENLARGE_PERCENTAGE; size <<= 1);
+    parent->ht = lyht_new(size, sizeof(struct lyd_node *), lyd_hash_table_val_equal, NULL, 1);
+    if (!parent->ht) {
+        return EXIT_FAILURE;
+    }
+    LY_TREE_FOR(parent->child, iter) {
+        if ((iter->schema->nodetype == LYS_LIST) && !lyd_list_has_keys(iter)) {
+            /* skip lists without keys */
+            continue;
+        }
+
+        if (lyht_insert(parent->ht, &iter, iter->hash, NULL)) {
+            assert(0);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* the values of a list instance may have changed, its records in the unique index are no longer valid */
+static void
+lyd_uniq_changed(struct lyd_node *list)
+{
+    struct lyd_node *root;
+    struct lyd_uniq_idx *idx;
+
+    list->validity |= LYD_VAL_UNIQUE;
+    if ((root = lyv_uniq_root(list)) && (idx = lyv_uniq_idx_find(root, list->schema))) {
+        lyv_uniq_idx_remove(idx, list);
+    }
+}
+
+/* keep the unique indexes of the tree valid when the node is inserted into or unlinked from the parent */
+static void
+lyd_uniq_invalidate(struct lyd_node *node, struct lyd_node *parent, int unlink)
+{
+    struct lyd_node *root, *next, *elem;
+    struct lyd_uniq_idx *idx;
+
+    if (!unlink && !(node->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) && node->uniq) {
+        /* no longer a root, the indexes would not be maintained */
+        lyv_uniq_idx_free(node->uniq);
+        node->uniq = NULL;
+    }
+
+    root = lyv_uniq_root(parent);
+    if (!root || !root->uniq) {
+        return;
+    }
+
+    /* indexed instances leaving the tree are removed, the ones entering it are added when validated */
+    LY_TREE_DFS_BEGIN(node, next, elem) {
+        if ((elem->schema->nodetype == LYS_LIST) && (idx = lyv_uniq_idx_find(root, elem->schema))) {
+            if (unlink) {
+                lyv_uniq_idx_remove(idx, elem);
             }
+            elem->validity |= LYD_VAL_UNIQUE;
+        }
+        LY_TREE_DFS_END(node, next, elem);
+    }
+
+    if (unlink && (node->schema->nodetype != LYS_LIST)) {
+        /* the values of the list instance may have changed, even to a default value (of another case) */
+        for (elem = parent; elem && (elem->schema->nodetype != LYS_LIST); elem = elem->parent);
+        if (elem && ((struct lys_node_list *)elem->schema)->unique_size) {
+            lyd_uniq_changed(elem);
         }
     }
 }
@@ -463,15 +583,20 @@ _lyd_insert_hash(struct lyd_node *node, int keyless_list_check)
 void
 lyd_insert_hash(struct lyd_node *node)
 {
+    lyd_digest_invalidate(node->parent);
+    if (node->parent) {
+        lyd_uniq_invalidate(node, node->parent, 0);
+    }
     _lyd_insert_hash(node, 1);
 }
 
 static void
 _lyd_unlink_hash(struct lyd_node *node, struct lyd_node *orig_parent, int keyless_list_check)
 {
-#ifndef NDEBUG
-    struct lyd_node *iter;
+    struct lyd_node *iter, *child, *removed = orig_parent;
+    uint32_t diff;
 
+#ifndef NDEBUG
     /* it must already be unlinked otherwise keyless lists would get wrong hash */
     if (keyless_list_check && orig_parent) {
         LY_TREE_FOR(orig_parent->child, iter) {
@@ -500,11 +625,19 @@ _lyd_unlink_hash(struct lyd_node *node, struct lyd_node *orig_parent, int keyles
 
                 _lyd_unlink_hash(orig_parent, orig_parent->parent, 0);
                 orig_parent->hash = 0;
+                removed = orig_parent->parent;
             }
 
             /* if node was in a state data subtree, shouldn't it be a part of a key-less list hash? */
-            if (keyless_list_check) {
-                lyd_keyless_list_hash_change(orig_parent);
+            if (keyless_list_check && (iter = lyd_keyless_list_ancestor(removed))) {
+                diff = lyd_hash_keyless_list_sum(node);
+                if (removed != orig_parent) {
+                    /* the whole list lost its key and is no longer a part of the hash */
+                    LY_TREE_FOR(orig_parent->child, child) {
+                        diff += lyd_hash_keyless_list_sum(child);
+                    }
+                }
+                lyd_keyless_list_hash_change(iter, -diff);
             }
         }
     }
@@ -514,10 +647,129 @@ _lyd_unlink_hash(struct lyd_node *node, struct lyd_node *orig_parent, int keyles
 void
 lyd_unlink_hash(struct lyd_node *node, struct lyd_node *orig_parent)
 {
+    lyd_digest_invalidate(orig_parent);
+    if (orig_parent) {
+        lyd_uniq_invalidate(node, orig_parent, 1);
+    }
     _lyd_unlink_hash(node, orig_parent, 1);
 }
 
+void
+lyd_digest_invalidate(struct lyd_node *node)
+{
+    if (node && (node->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA))) {
+        /* terminal nodes do not store their digest */
+        node = node->parent;
+    }
+
+    /* a stored digest is computed from the stored digests of all the descendants,
+     * so if a node does not have it, none of its ancestors can have it either */
+    for (; node && node->digest; node = node->parent) {
+        node->digest = 0;
+    }
+}
+
+#endif
+
+/* whether two subtrees are known to be the same without comparing them */
+static int
+lyd_subtree_same(struct lyd_node *node1, struct lyd_node *node2)
+{
+#ifdef LY_ENABLED_CACHE
+    return lyd_digest(node1) == lyd_digest(node2);
+#else
+    /* digests would have to be computed from the whole subtrees */
+    (void)node1;
+    (void)node2;
+    return 0;
+#endif
+}
+
+static uint64_t
+lyd_digest_mix(uint64_t digest, uint64_t value)
+{
+    return dict_hash64(digest, (const char *)&value, sizeof value);
+}
+
+API uint64_t
+lyd_digest(struct lyd_node *node)
+{
+    struct lyd_node *child;
+    struct lyd_node_anydata *any;
+#ifndef LY_ENABLED_CACHE
+    struct lys_module *mod;
+#endif
+    const char *str;
+    uint64_t digest, sum, ord;
+
+    if (!node) {
+        LOGARG;
+        return 0;
+    }
+
+    /* module and node name, default flag */
+#ifdef LY_ENABLED_CACHE
+    digest = lys_data_hash(node->schema);
+#else
+    mod = lys_node_module(node->schema);
+    digest = dict_hash64(0, mod->name, strlen(mod->name));
+    digest = dict_hash64(digest, node->schema->name, strlen(node->schema->name));
+#endif
+    digest = (digest << 1) | node->dflt;
+
+    switch (node->schema->nodetype) {
+    case LYS_LEAF:
+    case LYS_LEAFLIST:
+        str = ((struct lyd_node_leaf_list *)node)->value_str;
+        if (!str) {
+            str = "";
+        }
+        digest = dict_hash64(digest, str, strlen(str));
+        break;
+    case LYS_ANYXML:
+    case LYS_ANYDATA:
+        any = (struct lyd_node_anydata *)node;
+        digest = lyd_digest_mix(digest, any->value_type);
+        if ((any->value_type == LYD_ANYDATA_CONSTSTRING) || (any->value_type == LYD_ANYDATA_SXML)
+                || (any->value_type == LYD_ANYDATA_JSON)) {
+            str = any->value.str ? any->value.str : "";
+            digest = dict_hash64(digest, str, strlen(str));
+        } else {
+            /* trees and raw memory can be changed directly, such a node is the same only as itself */
+            digest = lyd_digest_mix(digest, (uintptr_t)node);
+        }
+        break;
+    default:
+#ifdef LY_ENABLED_CACHE
+        if (node->digest) {
+            return node->digest;
+        }
+#endif
+        /* the order of the children matters only for user-ordered instances */
+        sum = 0;
+        ord = digest;
+        LY_TREE_FOR(node->child, child) {
+            if ((child->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) && (child->schema->flags & LYS_USERORDERED)) {
+                ord = lyd_digest_mix(ord, lyd_digest(child));
+            } else {
+                sum += lyd_digest(child);
+            }
+        }
+        digest = lyd_digest_mix(lyd_digest_mix(digest, sum), ord);
+        break;
+    }
+
+    if (!digest) {
+        /* 0 is reserved for errors and not computed digests */
+        digest = 1;
+    }
+#ifdef LY_ENABLED_CACHE
+    if (!(node->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA))) {
+        node->digest = digest;
+    }
 #endif
+    return digest;
+}
 
 /**
  * @brief get the list of \p data's siblings of the given schema
@@ -619,6 +871,12 @@ lyd_check_mandatory_data(struct lyd_node *root, struct lyd_node *last_parent,
         } else if ((options & LYD_OPT_TRUSTED) || ((options & LYD_OPT_TYPEMASK) && (schema->flags & LYS_CONFIG_R))) {
             /* status schema node in non-status data tree */
             return EXIT_SUCCESS;
+        } else if ((options & LYD_OPT_VIRTUAL_DFLT)
+                && (((schema->nodetype & (LYS_LEAF | LYS_ANYDATA)) && !(schema->flags & LYS_MAND_TRUE))
+                    || ((schema->nodetype == LYS_LIST) && !((struct lys_node_list *)schema)->min)
+                    || ((schema->nodetype == LYS_LEAFLIST) && !((struct lys_node_leaflist *)schema)->min))) {
+            /* no instance is required, evaluating its when would only create the virtual default nodes it refers to */
+            return EXIT_SUCCESS;
         } else if (lyd_is_when_false(root, last_parent, schema, options)) {
             return EXIT_SUCCESS;
         }
@@ -921,8 +1179,8 @@ lyd_check_mandatory_tree(struct lyd_node *root, struct ly_ctx *ctx, const struct
 }
 
 static struct lyd_node *
-lyd_parse_(struct ly_ctx *ctx, const struct lyd_node *rpc_act, const char *data, LYD_FORMAT format, int options,
-           const struct lyd_node *data_tree, const char *yang_data_name)
+lyd_parse_(struct ly_ctx *ctx, const struct lyd_node *rpc_act, const char *data, size_t len, LYD_FORMAT format,
+           int options, const struct lyd_node *data_tree, const char *yang_data_name)
 {
     struct lyxml_elem *xml;
     struct lyd_node *result = NULL;
@@ -960,7 +1218,7 @@ lyd_parse_(struct ly_ctx *ctx, const struct lyd_node *rpc_act, const char *data,
         result = lyd_parse_json(ctx, data, options, rpc_act, data_tree, yang_data_name);
         break;
     case LYD_LYB:
-        result = lyd_parse_lyb(ctx, data, options, data_tree, yang_data_name, NULL);
+        result = lyd_parse_lyb(ctx, data, len, options, data_tree, yang_data_name, NULL);
         break;
     default:
         /* error */
@@ -976,7 +1234,7 @@ lyd_parse_(struct ly_ctx *ctx, const struct lyd_node *rpc_act, const char *data,
 }
 
 static struct lyd_node *
-lyd_parse_data_(struct ly_ctx *ctx, const char *data, LYD_FORMAT format, int options, va_list ap)
+lyd_parse_data_(struct ly_ctx *ctx, const char *data, size_t len, LYD_FORMAT format, int options, va_list ap)
 {
     const struct lyd_node *rpc_act = NULL, *data_tree = NULL, *iter;
     const char *yang_data_name = NULL;
@@ -1023,7 +1281,7 @@ lyd_parse_data_(struct ly_ctx *ctx, const char *data, LYD_FORMAT format, int opt
         yang_data_name = va_arg(ap, const char *);
     }
 
-    return lyd_parse_(ctx, rpc_act, data, format, options, data_tree, yang_data_name);
+    return lyd_parse_(ctx, rpc_act, data, len, format, options, data_tree, yang_data_name);
 }
 
 API struct lyd_node *
@@ -1033,7 +1291,7 @@ lyd_parse_mem(struct ly_ctx *ctx, const char *data, LYD_FORMAT format, int optio
     struct lyd_node *result;
 
     va_start(ap, options);
-    result = lyd_parse_data_(ctx, data, format, options, ap);
+    result = lyd_parse_data_(ctx, data, SIZE_MAX, format, options, ap);
     va_end(ap);
 
     return result;
@@ -1043,6 +1301,7 @@ static struct lyd_node *
 lyd_parse_fd_(struct ly_ctx *ctx, int fd, LYD_FORMAT format, int options, va_list ap)
 {
     struct lyd_node *ret;
+    struct stat sb;
     size_t length;
     char *data;
 
@@ -1058,7 +1317,8 @@ lyd_parse_fd_(struct ly_ctx *ctx, int fd, LYD_FORMAT format, int options, va_lis
         return NULL;
     }
 
-    ret = lyd_parse_data_(ctx, data, format, options, ap);
+    /* the mapping is longer than the file, it is zero-padded */
+    ret = lyd_parse_data_(ctx, data, fstat(fd, &sb) ? SIZE_MAX : (size_t)sb.st_size, format, options, ap);
 
     lyp_munmap(data, length);
 
@@ -1303,6 +1563,9 @@ lyd_wd_update_parents(struct lyd_node *node)
             /* all siblings are implicit default nodes, propagate it to the parent */
             node = node->parent;
             node->dflt = 1;
+#ifdef LY_ENABLED_CACHE
+            lyd_digest_invalidate(node);
+#endif
             continue;
         } else {
             /* stop the loop */
@@ -1376,6 +1639,9 @@ lyd_change_leaf(struct lyd_node_leaf_list *leaf, const char *val_str)
     backup = leaf->value_str;
     leaf->value_str = lydict_insert(leaf->schema->module->ctx, val_str ? val_str : "", 0);
     /* leaf->value is erased by lyp_parse_value() */
+#ifdef LY_ENABLED_CACHE
+    lyd_digest_invalidate((struct lyd_node *)leaf);
+#endif
 
     /* parse the type correctly, makes the value canonical if needed */
     if (!lyp_parse_value(&((struct lys_node_leaf *)leaf->schema)->type, &leaf->value_str, NULL, leaf, NULL, NULL, 1, 0, 0)) {
@@ -1414,7 +1680,11 @@ lyd_change_leaf(struct lyd_node_leaf_list *leaf, const char *val_str)
     if (val_change && (leaf->schema->flags & LYS_UNIQUE)) {
         for (parent = leaf->parent; parent && (parent->schema->nodetype != LYS_LIST); parent = parent->parent);
         if (parent) {
+#ifdef LY_ENABLED_CACHE
+            lyd_uniq_changed(parent);
+#else
             parent->validity |= LYD_VAL_UNIQUE;
+#endif
         } else {
             LOGINT(leaf->schema->module->ctx);
             return -1;
@@ -1706,6 +1976,11 @@ lyd_new_path_update(struct lyd_node *node, void *value, LYD_ANYDATA_VALUETYPE va
     struct lyd_node_anydata *any;
     int len;
 
+#ifdef LY_ENABLED_CACHE
+    /* the value or the default flag is going to change */
+    lyd_digest_invalidate(node);
+#endif
+
     switch (node->schema->nodetype) {
     case LYS_LEAF:
         if (value_type > LYD_ANYDATA_STRING) {
@@ -2321,7 +2596,7 @@ error:
     return NULL;
 }
 
-static struct lys_node *
+struct lys_node *
 lys_get_schema_inctx(struct lys_node *schema, struct ly_ctx *ctx)
 {
     const struct lys_module *mod, *trg_mod = NULL;
@@ -2390,7 +2665,8 @@ lys_get_schema_inctx(struct lys_node *schema, struct ly_ctx *ctx)
 
     /* now search in the schema tree for the matching node */
     while (1) {
-        lys_get_sibling(first_sibling, trg_mod->name, 0, parent->name, 0, parent->nodetype,
+        /* nodes augmented from other modules are in the same subtree */
+        lys_get_sibling(first_sibling, lys_node_module(parent)->name, 0, parent->name, 0, parent->nodetype,
                         (const struct lys_node **)&iter);
         if (!iter) {
             /* not found, iter will be used as NULL result */
@@ -2422,9 +2698,10 @@ lyd_get_schema_inctx(const struct lyd_node *node, struct ly_ctx *ctx)
 
 /* both target and source were validated */
 static void
-lyd_merge_node_update(struct lyd_node *target, struct lyd_node *source)
+lyd_merge_node_update(struct lyd_node *target, struct lyd_node *source, int options)
 {
     struct ly_ctx *ctx;
+    struct lyd_node *dup;
     struct lyd_node_leaf_list *trg_leaf, *src_leaf;
     struct lyd_node_anydata *trg_any, *src_any;
     int len;
@@ -2432,6 +2709,26 @@ lyd_merge_node_update(struct lyd_node *target, struct lyd_node *source)
     assert(target->schema->nodetype & (LYS_LEAF | LYS_ANYDATA));
     ctx = target->schema->module->ctx;
 
+    if ((target->schema->nodetype == LYS_LEAF) && (ctx == source->schema->module->ctx) && (target->dflt == source->dflt)
+            && (((struct lyd_node_leaf_list *)target)->value_str == ((struct lyd_node_leaf_list *)source)->value_str)) {
+        /* the same value (strings are in the same dictionary), nothing to update */
+        return;
+    }
+
+    if (!(options & LYD_OPT_DESTRUCT) && (ctx == source->schema->module->ctx)) {
+        /* the value would be taken from the source, take it from its copy instead */
+        dup = lyd_dup(source, 0);
+        if (dup) {
+            lyd_merge_node_update(target, dup, LYD_OPT_DESTRUCT);
+            lyd_free(dup);
+        }
+        return;
+    }
+
+#ifdef LY_ENABLED_CACHE
+    lyd_digest_invalidate(target);
+#endif
+
     if (ctx == source->schema->module->ctx) {
         /* source and targets are in the same context */
         if (target->schema->nodetype == LYS_LEAF) {
@@ -2681,11 +2978,133 @@ lyd_merge_node_equal(struct lyd_node *node1, struct lyd_node *node2)
     return -1;
 }
 
-/* spends source */
+/* find the instance of source among the target siblings (in their hash table, if any),
+ * return: 0 (not found), 1 (found), 2 (found and state leaf-/list marked), -1 (error) */
+static int
+lyd_merge_find(struct hash_table *ht, struct lyd_node *first, struct lyd_node *source, struct lyd_node **match)
+{
+    struct lyd_node **match_p;
+    int ret;
+
+    *match = NULL;
+    if (ht && first && (first->schema->module->ctx == source->schema->module->ctx) && lyd_diff_hash(source)) {
+        if (lyht_find(ht, &source, lyd_diff_hash(source), (void **)&match_p)) {
+            return 0;
+        }
+        *match = *match_p;
+
+        /* it is a bit more difficult with keyless state lists and leaf-lists */
+        if ((((*match)->schema->nodetype == LYS_LIST) && !((struct lys_node_list *)(*match)->schema)->keys_size)
+                || (((*match)->schema->nodetype == LYS_LEAFLIST) && ((*match)->schema->flags & LYS_CONFIG_R))) {
+            assert((*match)->schema->flags & LYS_CONFIG_R);
+
+            while (*match && ((*match)->validity & LYD_VAL_INUSE)) {
+                /* state lists, find one not-already-found */
+                if (lyht_find_next(ht, match, lyd_diff_hash(*match), (void **)&match_p)) {
+                    *match = NULL;
+                } else {
+                    *match = *match_p;
+                }
+            }
+            if (!*match) {
+                /* actually, it was matched already and no other instance found, so now not a match */
+                return 0;
+            }
+
+            /* mark it as matched */
+            (*match)->validity |= LYD_VAL_INUSE;
+            return 2;
+        }
+        return 1;
+    }
+
+    LY_TREE_FOR(first, *match) {
+        /* schema match, data match? */
+        ret = lyd_merge_node_schema_equal(*match, source);
+        if (ret == 1) {
+            ret = lyd_merge_node_equal(*match, source);
+        }
+        if (ret != 0) {
+            /* even data match (or an error) */
+            return ret;
+        }
+    }
+    return 0;
+}
+
+/* link an (unlinked) subtree that has no instance among the target siblings as the last sibling of first (child of
+ * parent, if set), nothing in the subtree is rehashed and only its lists with unique statements are invalidated,
+ * return: 0 (linked), 1 (inserted, some siblings may have been removed), -1 (error) */
+static int
+lyd_merge_link(struct lyd_node *parent, struct lyd_node *first, struct lyd_node *node)
+{
+    struct lys_node *siter;
+    struct lyd_node *iter, *next, *elem;
+
+    assert(!node->parent && (node->prev == node) && !node->next);
+
+    for (siter = lys_parent(node->schema); siter && (siter->nodetype == LYS_USES); siter = lys_parent(siter));
+    if ((node->schema->nodetype == LYS_LEAFLIST) || (siter && (siter->nodetype & (LYS_CHOICE | LYS_CASE)))
+            || lyp_is_rpc_action(node->schema)) {
+        /* default leaf-list instances and other cases are removed and RPC nodes ordered, insert it properly */
+        if (parent ? lyd_insert(parent, node) : lyd_insert_after(first->prev, node)) {
+            return -1;
+        }
+        return 1;
+    }
+
+    if (parent && !parent->child) {
+        parent->child = node;
+    } else {
+        if (parent) {
+            first = parent->child;
+        }
+        first->prev->next = node;
+        node->prev = first->prev;
+        first->prev = node;
+    }
+    node->parent = parent;
+
+#ifdef LY_ENABLED_CACHE
+    lyd_insert_hash(node);
+#endif
+
+    /* the same invalidation as lyd_insert_setinvalid() does, but without searching the subtree for unique leaves */
+    node->validity = ly_new_node_validity(node->schema);
+    for (iter = parent; iter && (iter->schema->nodetype != LYS_LIST); iter = iter->parent);
+    if (iter && ((struct lys_node_list *)iter->schema)->unique_size) {
+        iter->validity |= LYD_VAL_UNIQUE;
+    }
+    LY_TREE_DFS_BEGIN(node, next, elem) {
+        if ((elem->schema->nodetype == LYS_LIST) && ((struct lys_node_list *)elem->schema)->unique_size) {
+            /* the source nested lists may have been parsed without checking their unique statements */
+            elem->validity |= LYD_VAL_UNIQUE;
+        }
+        LY_TREE_DFS_END(node, next, elem);
+    }
+    if (parent) {
+        if (((node->schema->nodetype == LYS_LIST) && ((struct lys_node_list *)node->schema)->max)
+                || (parent->schema->flags & LYS_VALID_EXT)) {
+            parent->validity |= LYD_VAL_MAND;
+        }
+        if (!node->dflt) {
+            for (iter = parent; iter && iter->dflt; iter = iter->parent) {
+                iter->dflt = 0;
+            }
+        }
+    }
+
+    /* unresolved leafrefs may refer to the new nodes */
+    check_leaf_list_backlinks(node, 0);
+    return 0;
+}
+
+/* spends source with LYD_OPT_DESTRUCT, otherwise copies only what is inserted,
+ * merges only the first source sibling with LYD_OPT_NOSIBLINGS */
 static int
-lyd_merge_parent_children(struct lyd_node *target, struct lyd_node *source, int options)
+lyd_merge_parent_children(struct lyd_node *target, struct lyd_node *source, int options, struct ly_ctx_schema_map *map)
 {
-    struct lyd_node *trg_parent, *src, *src_backup, *src_elem, *src_elem_backup, *src_next, *trg_child, *trg_parent_backup;
+    struct lyd_node *trg_parent, *src, *src_backup, *src_elem, *src_elem_backup = NULL, *src_next, *trg_child, *trg_parent_backup = NULL;
     int ret, clear_flag = 0;
     struct ly_ctx *ctx = target->schema->module->ctx; /* shortcut */
 
@@ -2704,79 +3123,34 @@ lyd_merge_parent_children(struct lyd_node *target, struct lyd_node *source, int
                 goto src_skip;
             }
 
-            ret = 0;
-
 #ifdef LY_ENABLED_CACHE
-            struct lyd_node **trg_child_p;
-
             /* trees are supposed to be validated so all nodes must have their hash, but lets not be that strict */
             if (!src_elem->hash) {
                 lyd_hash(src_elem);
             }
 
-            if (trg_parent->ht) {
-                trg_child = NULL;
-                if (!lyht_find(trg_parent->ht, &src_elem, src_elem->hash, (void **)&trg_child_p)) {
-                    trg_child = *trg_child_p;
-                    ret = 1;
-
-                    /* it is a bit more difficult with keyless state lists and leaf-lists */
-                    if (((trg_child->schema->nodetype == LYS_LIST) && !((struct lys_node_list *)trg_child->schema)->keys_size)
-                            || ((trg_child->schema->nodetype == LYS_LEAFLIST) && (trg_child->schema->flags & LYS_CONFIG_R))) {
-                        assert(trg_child->schema->flags & LYS_CONFIG_R);
+            ret = lyd_merge_find(trg_parent->ht, trg_parent->child, src_elem, &trg_child);
+#else
+            ret = lyd_merge_find(NULL, trg_parent->child, src_elem, &trg_child);
+#endif
 
-                        while (trg_child && (trg_child->validity & LYD_VAL_INUSE)) {
-                            /* state lists, find one not-already-found */
-                            if (lyht_find_next(trg_parent->ht, &trg_child, trg_child->hash, (void **)&trg_child_p)) {
-                                trg_child = NULL;
-                            } else {
-                                trg_child = *trg_child_p;
-                            }
-                        }
-                        if (trg_child) {
-                            /* mark it as matched */
-                            trg_child->validity |= LYD_VAL_INUSE;
-                            ret = 2;
-                        } else {
-                            /* actually, it was matched already and no other instance found, so now not a match */
-                            ret = 0;
-                        }
-                    }
-                }
-            } else
-#endif
-            {
-                LY_TREE_FOR(trg_parent->child, trg_child) {
-                    /* schema match, data match? */
-                    ret = lyd_merge_node_schema_equal(trg_child, src_elem);
-                    if (ret == 1) {
-                        ret = lyd_merge_node_equal(trg_child, src_elem);
-                    }
-                    if (ret != 0) {
-                        /* even data match */
-                        break;
-                    }
-                }
-            }
-
-            if (ret > 0) {
-                if (trg_child->schema->nodetype & (LYS_LEAF | LYS_ANYDATA)) {
-                    lyd_merge_node_update(trg_child, src_elem);
-                } else if (ret == 2) {
-                    clear_flag = 1;
+            if (ret > 0) {
+                if (trg_child->schema->nodetype & (LYS_LEAF | LYS_ANYDATA)) {
+                    lyd_merge_node_update(trg_child, src_elem, options);
+                } else if (ret == 2) {
+                    clear_flag = 1;
                 }
             } else if (ret == -1) {
-                /* error */
-                lyd_free_withsiblings(source);
-                return 1;
+                goto error;
             }
 
             /* first prepare for the next iteration */
             src_elem_backup = src_elem;
             trg_parent_backup = trg_parent;
             if (((src_elem->schema->nodetype == LYS_CONTAINER) || ((src_elem->schema->nodetype == LYS_LIST)
-                    && ((struct lys_node_list *)src_elem->schema)->keys_size)) && src_elem->child && trg_child) {
-                /* go into children */
+                    && ((struct lys_node_list *)src_elem->schema)->keys_size)) && src_elem->child && trg_child
+                    && !lyd_subtree_same(src_elem, trg_child)) {
+                /* go into children (unless there is nothing to merge) */
                 src_next = src_elem->child;
                 trg_parent = trg_child;
             } else {
@@ -2785,7 +3159,8 @@ src_skip:
                 if (src_elem == src) {
                     /* we are done with this subtree */
                     if (trg_child) {
-                        /* it's an empty container, list without keys, or an already-updated leaf/anydata, nothing else to do */
+                        /* it's an empty container, list without keys, an already-updated leaf/anydata, or an already
+                         * present subtree, nothing else to do */
                         break;
                     } else {
                         /* ... but we still need to insert it */
@@ -2812,25 +3187,26 @@ src_skip:
             if (!trg_child) {
 src_insert:
                 /* we need to insert the whole subtree */
-                if (ctx == src_elem_backup->schema->module->ctx) {
+                if ((options & LYD_OPT_DESTRUCT) && (ctx == src_elem_backup->schema->module->ctx)) {
                     /* same context - unlink the subtree and insert it into the target */
+                    if (src_elem_backup == source) {
+                        /* it will be linked into another data tree and the pointers changed */
+                        source = source->next;
+                    }
                     lyd_unlink(src_elem_backup);
                 } else {
-                    /* different contexts - before inserting subtree, instead of unlinking, duplicate it into the
-                     * target context */
-                    src_elem_backup = lyd_dup_to_ctx(src_elem_backup, 1, ctx);
-                }
-
-                if (src_elem == source) {
-                    /* it will be linked into another data tree and the pointers changed */
-                    source = source->next;
+                    /* source is kept or in a different context - before inserting subtree, instead of unlinking,
+                     * duplicate it (into the target context) */
+                    src_elem_backup = _lyd_dup_to_ctx(src_elem_backup, 1, ctx, map);
+                    if (!src_elem_backup) {
+                        goto error;
+                    }
                 }
 
-                /* insert subtree into the target */
-                if (lyd_insert(trg_parent_backup, src_elem_backup)) {
+                /* link the subtree into the target */
+                if (lyd_merge_link(trg_parent_backup, NULL, src_elem_backup) == -1) {
                     LOGINT(ctx);
-                    lyd_free_withsiblings(source);
-                    return 1;
+                    goto error;
                 }
                 if (src_elem == src) {
                     /* we are finished for this src */
@@ -2838,78 +3214,99 @@ src_insert:
                 }
             }
         }
+
+        if (options & LYD_OPT_NOSIBLINGS) {
+            break;
+        }
     }
 
-    lyd_free_withsiblings(source);
+    if (options & LYD_OPT_DESTRUCT) {
+        lyd_free_withsiblings(source);
+    }
     if (clear_flag) {
         return 2;
     }
     return 0;
+
+error:
+    if (options & LYD_OPT_DESTRUCT) {
+        lyd_free_withsiblings(source);
+    }
+    return 1;
 }
 
-/* spends source */
+/* spends source with LYD_OPT_DESTRUCT, otherwise copies only what is inserted,
+ * merges only the first source sibling with LYD_OPT_NOSIBLINGS */
 static int
-lyd_merge_siblings(struct lyd_node *target, struct lyd_node *source, int options)
+lyd_merge_siblings(struct lyd_node *target, struct lyd_node *source, int options, struct ly_ctx_schema_map *map)
 {
     struct lyd_node *trg, *src, *src_backup, *ins;
-    int ret, clear_flag = 0;
+    struct hash_table *ht = NULL, *tmp_ht = NULL;
+    int ret, clear_flag = 0, ht_options = LYD_DIFFOPT_WITHDEFAULTS;
     struct ly_ctx *ctx = target->schema->module->ctx; /* shortcut */
 
     while (target->prev->next) {
         target = target->prev;
     }
 
+    if (ctx == source->schema->module->ctx) {
+        /* top-level siblings have no parent hash table, the same one as lyd_diff() uses is created for many of them */
+        ht = lyd_diff_siblings_ht(target, &ht_options, &tmp_ht);
+    }
+
     LY_TREE_FOR_SAFE(source, src_backup, src) {
-        LY_TREE_FOR(target, trg) {
-            /* sibling found, merge it */
-            ret = lyd_merge_node_schema_equal(trg, src);
-            if (ret == 1) {
-                ret = lyd_merge_node_equal(trg, src);
+#ifdef LY_ENABLED_CACHE
+        if (!src->hash) {
+            lyd_hash(src);
+        }
+#endif
+
+        /* find the sibling and merge it */
+        ret = lyd_merge_find(ht, target, src, &trg);
+        if (ret > 0) {
+            if (ret == 2) {
+                clear_flag = 1;
             }
-            if (ret > 0) {
-                if (ret == 2) {
-                    clear_flag = 1;
-                }
 
-                switch (trg->schema->nodetype) {
-                case LYS_LEAF:
-                case LYS_ANYXML:
-                case LYS_ANYDATA:
-                    lyd_merge_node_update(trg, src);
-                    break;
-                case LYS_LEAFLIST:
-                    /* it's already there, nothing to do */
-                    break;
-                case LYS_LIST:
-                case LYS_CONTAINER:
-                case LYS_NOTIF:
-                case LYS_RPC:
-                case LYS_INPUT:
-                case LYS_OUTPUT:
-                    ret = lyd_merge_parent_children(trg, src->child, options);
-                    if (ret == 2) {
-                        clear_flag = 1;
-                    } else if (ret) {
-                        lyd_free_withsiblings(source);
-                        return 1;
-                    }
+            switch (trg->schema->nodetype) {
+            case LYS_LEAF:
+            case LYS_ANYXML:
+            case LYS_ANYDATA:
+                lyd_merge_node_update(trg, src, options);
+                break;
+            case LYS_LEAFLIST:
+                /* it's already there, nothing to do */
+                break;
+            case LYS_LIST:
+            case LYS_CONTAINER:
+            case LYS_NOTIF:
+            case LYS_RPC:
+            case LYS_INPUT:
+            case LYS_OUTPUT:
+                if (lyd_subtree_same(trg, src)) {
+                    /* nothing to merge */
                     break;
-                default:
-                    LOGINT(ctx);
-                    lyd_free_withsiblings(source);
-                    return 1;
+                }
+                ret = lyd_merge_parent_children(trg, src->child, options & ~LYD_OPT_NOSIBLINGS, map);
+                if (ret == 2) {
+                    clear_flag = 1;
+                } else if (ret) {
+                    goto error;
                 }
                 break;
-            } else if (ret == -1) {
-                lyd_free_withsiblings(source);
-                return 1;
-            } /* else not equal, nothing to do */
-        }
-
-        /* sibling not found, insert it */
-        if (!trg) {
-            if (ctx != src->schema->module->ctx) {
-                ins = lyd_dup_to_ctx(src, 1, ctx);
+            default:
+                LOGINT(ctx);
+                goto error;
+            }
+        } else if (ret == -1) {
+            goto error;
+        } else {
+            /* sibling not found, insert it */
+            if (!(options & LYD_OPT_DESTRUCT) || (ctx != src->schema->module->ctx)) {
+                ins = _lyd_dup_to_ctx(src, 1, ctx, map);
+                if (!ins) {
+                    goto error;
+                }
             } else {
                 lyd_unlink(src);
                 if (src == source) {
@@ -2918,19 +3315,46 @@ lyd_merge_siblings(struct lyd_node *target, struct lyd_node *source, int options
                 }
                 ins = src;
             }
-            lyd_insert_after(target->prev, ins);
+
+            ret = lyd_merge_link(target->parent, target, ins);
+            if (ret == -1) {
+                goto error;
+            } else if (ret == 1) {
+                /* some siblings may have been removed, including the first one */
+                for (target = ins; target->prev->next; target = target->prev);
+                if (tmp_ht) {
+                    ht = lyd_diff_siblings_ht(target, &ht_options, &tmp_ht);
+                }
+            } else if (tmp_ht && (lyht_insert(tmp_ht, &ins, lyd_diff_hash(ins), NULL) == -1)) {
+                goto error;
+            }
+        }
+
+        if (options & LYD_OPT_NOSIBLINGS) {
+            break;
         }
     }
 
-    lyd_free_withsiblings(source);
+    lyht_free(tmp_ht);
+    if (options & LYD_OPT_DESTRUCT) {
+        lyd_free_withsiblings(source);
+    }
     if (clear_flag) {
         return 2;
     }
     return 0;
+
+error:
+    lyht_free(tmp_ht);
+    if (options & LYD_OPT_DESTRUCT) {
+        lyd_free_withsiblings(source);
+    }
+    return 1;
 }
 
-API int
-lyd_merge_to_ctx(struct lyd_node **trg, const struct lyd_node *src, int options, struct ly_ctx *ctx)
+static int
+_lyd_merge_to_ctx(struct lyd_node **trg, const struct lyd_node *src, int options, struct ly_ctx *ctx,
+                  struct ly_ctx_schema_map *map)
 {
     struct lyd_node *node = NULL, *node2, *target, *trg_merge_start, *src_merge_start = NULL;
     const struct lyd_node *iter;
@@ -2966,7 +3390,7 @@ lyd_merge_to_ctx(struct lyd_node **trg, const struct lyd_node *src, int options,
         *trg = target;
 
         for (node = NULL, trg_merge_start = target; target; target = target->next) {
-            node2 = lyd_dup_to_ctx(target, 1, ctx);
+            node2 = _lyd_dup_to_ctx(target, 1, ctx, map);
             if (!node2) {
                 goto error;
             }
@@ -3046,7 +3470,11 @@ lyd_merge_to_ctx(struct lyd_node **trg, const struct lyd_node *src, int options,
             LY_TREE_FOR(node, node) {
                 if (ctx) {
                     /* we have the schema nodes in the different context */
-                    sch = lys_get_schema_inctx(src_snode, ctx);
+                    if (map) {
+                        sch = (struct lys_node *)ly_ctx_schema_map_get(map, src_snode);
+                    } else {
+                        sch = lys_get_schema_inctx(src_snode, ctx);
+                    }
                     if (!sch) {
                         LOGERR(ctx, LY_EINVAL, "Target context does not contain schema node for the data node being "
                                "merged (%s:%s).", lys_node_module(src_snode)->name, src_snode->name);
@@ -3074,7 +3502,11 @@ lyd_merge_to_ctx(struct lyd_node **trg, const struct lyd_node *src, int options,
              * this is done to save some work and have the source in the same context
              * when the provided source tree is below duplicated in the target context
              * and connected into the parents created here */
-            src_snode = lys_get_schema_inctx(src_snode, ctx);
+            if (map) {
+                src_snode = (struct lys_node *)ly_ctx_schema_map_get(map, src_snode);
+            } else {
+                src_snode = lys_get_schema_inctx(src_snode, ctx);
+            }
             if (!src_snode) {
                 LOGERR(ctx, LY_EINVAL, "Target context does not contain schema node for the data node being "
                        "merged (%s:%s).", lys_node_module(src_snode)->name, src_snode->name);
@@ -3111,20 +3543,24 @@ lyd_merge_to_ctx(struct lyd_node **trg, const struct lyd_node *src, int options,
             lyd_unlink(node);
             lyd_free_withsiblings(node2);
         }
+    } else if (!src_merge_start && (src->schema->module->ctx == target->schema->module->ctx)) {
+        /* merge the source directly, only the inserted subtrees and updated values are copied */
+        node = (struct lyd_node *)src;
     } else {
         node = NULL;
         for (; src; src = src->next) {
-            /* because we already have to duplicate it, do it in the correct context */
-            node2 = lyd_dup_to_ctx(src, 1, ctx);
+            /* all of it is going to be inserted into the created parents or moved into another context,
+             * so duplicate it in the correct context */
+            node2 = _lyd_dup_to_ctx(src, 1, ctx, map);
             if (!node2) {
                 lyd_free_withsiblings(node);
                 goto error;
             }
             if (node) {
-                if (lyd_insert_after(node->prev, node2)) {
-                    lyd_free_withsiblings(node);
-                    goto error;
-                }
+                /* the copies are just connected, they are the same siblings as in source */
+                node2->prev = node->prev;
+                node->prev->next = node2;
+                node->prev = node2;
             } else {
                 node = node2;
             }
@@ -3133,6 +3569,9 @@ lyd_merge_to_ctx(struct lyd_node **trg, const struct lyd_node *src, int options,
                 break;
             }
         }
+
+        /* the copy can be spent */
+        options |= LYD_OPT_DESTRUCT;
     }
 
     if (src_merge_start) {
@@ -3150,12 +3589,12 @@ lyd_merge_to_ctx(struct lyd_node **trg, const struct lyd_node *src, int options,
 
     if (!first_iter) {
         /* !! src_merge start is a child(ren) of trg_merge_start */
-        ret = lyd_merge_parent_children(trg_merge_start, src_merge_start, options);
+        ret = lyd_merge_parent_children(trg_merge_start, src_merge_start, options, map);
     } else {
         /* !! src_merge start is a (top-level) sibling(s) of trg_merge_start */
-        ret = lyd_merge_siblings(trg_merge_start, src_merge_start, options);
+        ret = lyd_merge_siblings(trg_merge_start, src_merge_start, options, map);
     }
-    /* it was freed whatever the return value */
+    /* it was freed (or left untouched) whatever the return value */
     src_merge_start = NULL;
     if (ret == 2) {
         /* clear remporary LYD_VAL_INUSE validation flags */
@@ -3189,6 +3628,23 @@ error:
     return -1;
 }
 
+API int
+lyd_merge_to_ctx(struct lyd_node **trg, const struct lyd_node *src, int options, struct ly_ctx *ctx)
+{
+    return _lyd_merge_to_ctx(trg, src, options, ctx, NULL);
+}
+
+API int
+lyd_merge_to_ctx_map(struct lyd_node **trg, const struct lyd_node *src, int options, struct ly_ctx_schema_map *map)
+{
+    if (!map) {
+        LOGARG;
+        return -1;
+    }
+
+    return _lyd_merge_to_ctx(trg, src, options, map->dst_ctx, map);
+}
+
 API int
 lyd_merge(struct lyd_node *target, const struct lyd_node *source, int options)
 {
@@ -3225,8 +3681,8 @@ lyd_difflist_add(struct lyd_difflist *diff, unsigned int *size, unsigned int ind
     ctx = (first ? first->schema->module->ctx : (second ? second->schema->module->ctx : NULL));
 
     if (index + 1 == *size) {
-        /* it's time to enlarge */
-        *size = *size + 16;
+        /* it's time to enlarge, double the size so that long diffs are not reallocated over and over */
+        *size = *size * 2;
         new = realloc(diff->type, *size * sizeof *diff->type);
         LY_CHECK_ERR_RETURN(!new, LOGMEM(ctx), EXIT_FAILURE);
         diff->type = new;
@@ -3254,6 +3710,12 @@ lyd_difflist_add(struct lyd_difflist *diff, unsigned int *size, unsigned int ind
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Minimum number of siblings in the first tree for lyd_diff() to create a temporary hash table
+ * of them in case their parent has none.
+ */
+#define LY_DIFF_HT_MIN_SIBLINGS 8
+
 struct diff_ordered_dist {
     struct diff_ordered_dist *next;
     int dist;
@@ -3271,53 +3733,231 @@ struct diff_ordered {
     struct diff_ordered_dist *dist;  /* linked list (1-way, ring) */
     struct diff_ordered_dist *dist_last;  /* aux pointer for faster insertion sort */
 };
+struct diff_ordered_pos {
+    struct lyd_node *first;
+    unsigned int pos;
+};
+struct diff_ordset {
+    struct ly_set *set;              /* struct diff_ordered items in the order they were created */
+    struct hash_table *ht;           /* the same items indexed by their schema and parent */
+    struct hash_table *pos_ht;       /* struct diff_ordered_pos, positions of the matched instances in the first tree */
+};
+
+static uint32_t
+diff_ptr_hash(const void *ptr1, const void *ptr2)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&ptr1, sizeof ptr1);
+    hash = dict_hash_multi(hash, (const char *)&ptr2, sizeof ptr2);
+    return dict_hash_multi(hash, NULL, 0);
+}
 
 static int
-diff_ordset_insert(struct lyd_node *node, struct ly_set *ordset)
+diff_ordered_equal_cb(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
 {
-    unsigned int i;
-    struct diff_ordered *new_ordered, *iter;
+    struct diff_ordered *val1 = *(struct diff_ordered **)val1_p;
+    struct diff_ordered *val2 = *(struct diff_ordered **)val2_p;
 
-    for (i = 0; i < ordset->number; i++) {
-        iter = (struct diff_ordered *)ordset->set.g[i];
-        if (iter->schema == node->schema && iter->parent == node->parent) {
-            break;
-        }
+    return (val1->schema == val2->schema) && (val1->parent == val2->parent);
+}
+
+static int
+diff_ordered_pos_equal_cb(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    return ((struct diff_ordered_pos *)val1_p)->first == ((struct diff_ordered_pos *)val2_p)->first;
+}
+
+static int
+diff_ordset_init(struct ly_ctx *ctx, struct diff_ordset *ordset)
+{
+    ordset->set = ly_set_new();
+    ordset->ht = lyht_new(1, sizeof(struct diff_ordered *), diff_ordered_equal_cb, NULL, 1);
+    ordset->pos_ht = lyht_new(1, sizeof(struct diff_ordered_pos), diff_ordered_pos_equal_cb, NULL, 1);
+    LY_CHECK_ERR_RETURN(!ordset->set || !ordset->ht || !ordset->pos_ht, LOGMEM(ctx), EXIT_FAILURE);
+
+    return EXIT_SUCCESS;
+}
+
+/* find the user-ordered instances of schema in the first tree with the parent */
+static struct diff_ordered *
+diff_ordset_find(struct diff_ordset *ordset, struct lys_node *schema, struct lyd_node *parent)
+{
+    struct diff_ordered key, *key_p = &key, **match_p;
+
+    key.schema = schema;
+    key.parent = parent;
+    if (lyht_find(ordset->ht, &key_p, diff_ptr_hash(schema, parent), (void **)&match_p)) {
+        return NULL;
     }
-    if (i == ordset->number) {
+
+    return *match_p;
+}
+
+static int
+diff_ordset_insert(struct lyd_node *node, struct diff_ordset *ordset)
+{
+    struct diff_ordered *ordered;
+
+    ordered = diff_ordset_find(ordset, node->schema, node->parent);
+    if (!ordered) {
         /* not seen user-ordered list */
-        new_ordered = calloc(1, sizeof *new_ordered);
-        LY_CHECK_ERR_RETURN(!new_ordered, LOGMEM(node->schema->module->ctx), EXIT_FAILURE);
-        new_ordered->schema = node->schema;
-        new_ordered->parent = node->parent;
+        ordered = calloc(1, sizeof *ordered);
+        LY_CHECK_ERR_RETURN(!ordered, LOGMEM(node->schema->module->ctx), EXIT_FAILURE);
+        ordered->schema = node->schema;
+        ordered->parent = node->parent;
+
+        if ((ly_set_add(ordset->set, ordered, LY_SET_OPT_USEASLIST) == -1)
+                || lyht_insert(ordset->ht, &ordered, diff_ptr_hash(ordered->schema, ordered->parent), NULL)) {
+            free(ordered);
+            return EXIT_FAILURE;
+        }
+    }
+    ordered->count++;
+
+    return EXIT_SUCCESS;
+}
+
+/* remember the positions of the matched instances of the user-ordered list in the first tree */
+static int
+diff_ordset_positions(struct diff_ordset *ordset, struct diff_ordered *ordered, struct lyd_node *first_sibling)
+{
+    struct diff_ordered_pos pos;
+    struct lyd_node *iter;
+
+    pos.pos = 0;
+    LY_TREE_FOR(first_sibling, iter) {
+        if ((iter->schema != ordered->schema) || !(iter->validity & LYD_VAL_INUSE)) {
+            /* skip deleted nodes */
+            continue;
+        }
 
-        ly_set_add(ordset, new_ordered, LY_SET_OPT_USEASLIST);
+        pos.first = iter;
+        if (lyht_insert(ordset->pos_ht, &pos, diff_ptr_hash(iter, NULL), NULL)) {
+            return EXIT_FAILURE;
+        }
+        ++pos.pos;
     }
-    ((struct diff_ordered *)ordset->set.g[i])->count++;
 
     return EXIT_SUCCESS;
 }
 
 static void
-diff_ordset_free(struct ly_set *set)
+diff_ordset_free(struct diff_ordset *ordset)
 {
     unsigned int i, j;
     struct diff_ordered *ord;
 
-    if (!set) {
-        return;
+    if (ordset->set) {
+        for (i = 0; i < ordset->set->number; i++) {
+            ord = (struct diff_ordered *)ordset->set->set.g[i];
+            for (j = 0; j < ord->count; j++) {
+                free(ord->items[j].dist);
+            }
+            free(ord->items);
+            free(ord);
+        }
+        ly_set_free(ordset->set);
     }
+    lyht_free(ordset->ht);
+    lyht_free(ordset->pos_ht);
+    memset(ordset, 0, sizeof *ordset);
+}
 
-    for (i = 0; i < set->number; i++) {
-        ord = (struct diff_ordered *)set->set.g[i];
-        for (j = 0; j < ord->count; j++) {
-            free(ord->items[j].dist);
+/* hash of a node to find its instance among the siblings in the other tree */
+static uint32_t
+lyd_diff_hash(struct lyd_node *node)
+{
+#ifdef LY_ENABLED_CACHE
+    return node->hash;
+#else
+    struct lyd_node *iter;
+    uint32_t hash;
+    int i;
+
+    hash = dict_hash_multi(0, (const char *)&node->schema, sizeof node->schema);
+    if (node->schema->nodetype == LYS_LEAFLIST) {
+        hash = dict_hash_multi(hash, ((struct lyd_node_leaf_list *)node)->value_str,
+                               strlen(((struct lyd_node_leaf_list *)node)->value_str));
+    } else if ((node->schema->nodetype == LYS_LIST) && lyd_list_has_keys(node)) {
+        for (i = 0, iter = node->child; i < ((struct lys_node_list *)node->schema)->keys_size; ++i, iter = iter->next) {
+            hash = dict_hash_multi(hash, ((struct lyd_node_leaf_list *)iter)->value_str,
+                                   strlen(((struct lyd_node_leaf_list *)iter)->value_str));
+        }
+    }
+    return dict_hash_multi(hash, NULL, 0);
+#endif
+}
+
+/* the same equivalence as lyd_diff_compare() uses, cb_data are the lyd_diff() options */
+static int
+lyd_diff_sibling_equal_cb(void *val1_p, void *val2_p, int mod, void *cb_data)
+{
+    struct lyd_node *val1 = *(struct lyd_node **)val1_p;
+    struct lyd_node *val2 = *(struct lyd_node **)val2_p;
+    int options = *(int *)cb_data;
+
+    if (mod) {
+        return val1 == val2;
+    }
+
+    if (val1->schema != val2->schema) {
+        return 0;
+    }
+    if (val1->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) {
+        return (lyd_list_equal(val1, val2, (options & LYD_DIFFOPT_WITHDEFAULTS ? 1 : 0)) == 1);
+    }
+    return 1;
+}
+
+/**
+ * @brief Get the hash table of siblings in the first tree to find the instances of nodes from the second tree in.
+ * Their parent's hash table is used if there is one, otherwise a temporary one is created if there are
+ * enough siblings.
+ *
+ * @param[in] first_sibling First sibling in the first tree.
+ * @param[in] options lyd_diff() options, must exist as long as the temporary hash table.
+ * @param[in,out] tmp_ht Temporary hash table of the previous siblings, replaced by the one of \p first_sibling.
+ * @return Hash table, NULL if the siblings should be searched one by one or on error.
+ */
+static struct hash_table *
+lyd_diff_siblings_ht(struct lyd_node *first_sibling, int *options, struct hash_table **tmp_ht)
+{
+    struct lyd_node *iter;
+    unsigned int count;
+
+    lyht_free(*tmp_ht);
+    *tmp_ht = NULL;
+
+#ifdef LY_ENABLED_CACHE
+    if (first_sibling->parent && first_sibling->parent->ht) {
+        return first_sibling->parent->ht;
+    }
+#endif
+
+    for (count = 0, iter = first_sibling; iter && (count < LY_DIFF_HT_MIN_SIBLINGS); iter = iter->next, ++count);
+    if (count < LY_DIFF_HT_MIN_SIBLINGS) {
+        /* not worth it */
+        return NULL;
+    }
+
+    *tmp_ht = lyht_new(1, sizeof(struct lyd_node *), lyd_diff_sibling_equal_cb, options, 1);
+    LY_CHECK_ERR_RETURN(!*tmp_ht, LOGMEM(first_sibling->schema->module->ctx), NULL);
+    LY_TREE_FOR(first_sibling, iter) {
+#ifdef LY_ENABLED_CACHE
+        if (!iter->hash) {
+            /* a list with missing keys, it is not in any parent hash table either */
+            continue;
+        }
+#endif
+        if (lyht_insert(*tmp_ht, &iter, lyd_diff_hash(iter), NULL) == -1) {
+            lyht_free(*tmp_ht);
+            *tmp_ht = NULL;
+            return NULL;
         }
-        free(ord->items);
-        free(ord);
     }
 
-    ly_set_free(set);
+    return *tmp_ht;
 }
 
 /*
@@ -3362,14 +4002,14 @@ lyd_diff_compare(struct lyd_node *first, struct lyd_node *second, int options)
  */
 static int
 lyd_diff_match(struct lyd_node *first, struct lyd_node *second, struct lyd_difflist *diff, unsigned int *size,
-               unsigned int *i, struct ly_set *matchset, struct ly_set *ordset, int options)
+               unsigned int *i, struct ly_set *matchset, struct diff_ordset *ordset, int options)
 {
     switch (first->schema->nodetype) {
     case LYS_LEAFLIST:
     case LYS_LIST:
         /* additional work for future move matching in case of user ordered lists */
-        if (first->schema->flags & LYS_USERORDERED) {
-            diff_ordset_insert(first, ordset);
+        if ((first->schema->flags & LYS_USERORDERED) && diff_ordset_insert(first, ordset)) {
+            return -1;
         }
 
         /* falls through */
@@ -3409,50 +4049,13 @@ lyd_diff_match(struct lyd_node *first, struct lyd_node *second, struct lyd_diffl
     return 0;
 }
 
-/* @brief compare if the nodes are equivalent including checking the list's keys
- * Go through the nodes and their parents and in the case of list, compare its keys.
- *
- * @return 0 different, 1 equivalent
- */
-static int
-lyd_diff_equivnode(struct lyd_node *first, struct lyd_node *second)
-{
-    struct lyd_node *iter1, *iter2;
-
-    for (iter1 = first, iter2 = second; iter1 && iter2; iter1 = iter1->parent, iter2 = iter2->parent) {
-        if (iter1->schema->module->ctx == iter2->schema->module->ctx) {
-            if (iter1->schema != iter2->schema) {
-                return 0;
-            }
-        } else {
-            if (!ly_strequal(iter1->schema->name, iter2->schema->name, 0)) {
-                /* comparing the names is fine, even if they are, in fact, 2 different nodes
-                 * with equal names, some of their parents will differ */
-                return 0;
-            }
-        }
-        if (iter1->schema->nodetype == LYS_LIST) {
-            /* compare keys */
-            if (lyd_list_equal(iter1, iter2, 0) != 1) {
-                return 0;
-            }
-        }
-    }
-
-    if (iter1 != iter2) {
-        /* we are supposed to be in root (NULL) in both trees */
-        return 0;
-    }
-
-    return 1;
-}
-
 static int
-lyd_diff_move_preprocess(struct diff_ordered *ordered, struct lyd_node *first, struct lyd_node *second)
+lyd_diff_move_preprocess(struct diff_ordset *ordset, struct diff_ordered *ordered, struct lyd_node *first,
+                         struct lyd_node *second)
 {
     struct ly_ctx *ctx = first->schema->module->ctx;
-    struct lyd_node *iter;
-    unsigned int pos = 0;
+    struct diff_ordered_pos pos_key, *pos_p;
+    unsigned int pos;
     int abs_dist;
     struct diff_ordered_dist *dist_aux;
     struct diff_ordered_dist *dist_iter, *dist_last;
@@ -3462,16 +4065,13 @@ lyd_diff_move_preprocess(struct diff_ordered *ordered, struct lyd_node *first, s
      * item's information, so it is actually position of the second node
      */
 
-    /* get the position of the first node */
-    for (iter = first->prev; iter->next; iter = iter->prev) {
-        if (!(iter->validity & LYD_VAL_INUSE)) {
-            /* skip deleted nodes */
-            continue;
-        }
-        if (iter->schema == first->schema) {
-            pos++;
-        }
+    /* get the position of the first node, learned by diff_ordset_positions() */
+    pos_key.first = first;
+    if (lyht_find(ordset->pos_ht, &pos_key, diff_ptr_hash(first, NULL), (void **)&pos_p)) {
+        LOGINT(ctx);
+        return EXIT_FAILURE;
     }
+    pos = pos_p->pos;
     if (pos != ordered->count) {
         LOGDBG(LY_LDGDIFF, "detected moved element \"%s\" from %d to %d (distance %d)",
                str = lyd_path(first), pos, ordered->count, ordered->count - pos);
@@ -3563,14 +4163,16 @@ lyd_diff(struct lyd_node *first, struct lyd_node *second, int options)
     struct lyd_node *elem1, *elem2, *iter, *aux, *parent = NULL, *next1, *next2;
     struct lyd_difflist *result, *result2 = NULL;
     void *new;
-    unsigned int size, size2, index = 0, index2 = 0, i, j, k;
+    unsigned int size, size2, index = 0, index2 = 0, i, k;
     struct matchlist_s {
         struct matchlist_s *prev;
         struct ly_set *match;
         unsigned int i;
     } *matchlist = NULL, *mlaux;
-    struct ly_set *ordset = NULL;
+    struct diff_ordset ordset = {NULL, NULL, NULL};
     struct diff_ordered *ordered;
+    struct hash_table *ht = NULL, *tmp_ht = NULL;
+    struct lyd_node **iter_p, *ht_first = NULL;
     struct diff_ordered_dist *dist_aux, *dist_iter;
     struct diff_ordered_item item_aux;
 
@@ -3667,8 +4269,7 @@ lyd_diff(struct lyd_node *first, struct lyd_node *second, int options)
     matchlist->match = ly_set_new();
     matchlist->prev = NULL;
 
-    ordset = ly_set_new();
-    LY_CHECK_ERR_GOTO(!ordset, , error);
+    LY_CHECK_ERR_GOTO(diff_ordset_init(ctx, &ordset), , error);
 
     /*
      * compare trees
@@ -3684,12 +4285,15 @@ lyd_diff(struct lyd_node *first, struct lyd_node *second, int options)
             goto cmp_continue;
         }
 
-#ifdef LY_ENABLED_CACHE
-        struct lyd_node **iter_p;
+        if (elem1 != ht_first) {
+            /* new siblings to search in */
+            ht = elem1 ? lyd_diff_siblings_ht(elem1, &options, &tmp_ht) : NULL;
+            ht_first = elem1;
+        }
 
-        if (elem1 && elem1->parent && elem1->parent->ht) {
+        if (ht) {
             iter = NULL;
-            if (!lyht_find(elem1->parent->ht, &elem2, elem2->hash, (void **)&iter_p)) {
+            if (!lyht_find(ht, &elem2, lyd_diff_hash(elem2), (void **)&iter_p)) {
                 iter = *iter_p;
                 /* we found a match */
                 if (iter->dflt && !(options & LYD_DIFFOPT_WITHDEFAULTS)) {
@@ -3700,16 +4304,14 @@ lyd_diff(struct lyd_node *first, struct lyd_node *second, int options)
                 while (iter && (iter->validity & LYD_VAL_INUSE)) {
                     /* state lists, find one not-already-found */
                     assert((iter->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) && (iter->schema->flags & LYS_CONFIG_R));
-                    if (lyht_find_next(elem1->parent->ht, &iter, iter->hash, (void **)&iter_p)) {
+                    if (lyht_find_next(ht, &iter, lyd_diff_hash(iter), (void **)&iter_p)) {
                         iter = NULL;
                     } else {
                         iter = *iter_p;
                     }
                 }
             }
-        } else
-#endif
-        {
+        } else {
             /* search for elem2 instance in the first */
             LY_TREE_FOR(elem1, iter) {
                 if (iter->schema != elem2->schema) {
@@ -3727,7 +4329,7 @@ lyd_diff(struct lyd_node *first, struct lyd_node *second, int options)
             }
         }
         /* we have a match */
-        if (iter && lyd_diff_match(iter, elem2, result, &size, &index, matchlist->match, ordset, options)) {
+        if (iter && lyd_diff_match(iter, elem2, result, &size, &index, matchlist->match, &ordset, options)) {
             goto error;
         }
 
@@ -3773,8 +4375,8 @@ cmp_continue:
 
             /* first pass of the siblings done, some additional work for future
              * detection of move may be needed */
-            for (i = ordset->number; i > 0; i--) {
-                ordered = (struct diff_ordered *)ordset->set.g[i - 1];
+            for (i = ordset.set->number; i > 0; i--) {
+                ordered = (struct diff_ordered *)ordset.set->set.g[i - 1];
                 if (ordered->items) {
                     /* already preprocessed ordered structure */
                     break;
@@ -3784,6 +4386,9 @@ cmp_continue:
                 ordered->dist = NULL;
                 /* zero the count to be used as a node position in lyd_diff_move_preprocess() */
                 ordered->count = 0;
+                if (diff_ordset_positions(&ordset, ordered, ordered->parent ? ordered->parent->child : first)) {
+                    goto error;
+                }
             }
 
             /* first, get the first sibling */
@@ -3815,15 +4420,13 @@ cmp_continue:
 
                 iter->validity &= ~LYD_VAL_INUSE;
                 if ((iter->schema->nodetype & (LYS_LEAFLIST | LYS_LIST)) && (iter->schema->flags & LYS_USERORDERED)) {
-                    for (j = ordset->number; j > 0; j--) {
-                        ordered = (struct diff_ordered *)ordset->set.g[j - 1];
-                        if (ordered->schema != iter->schema || !lyd_diff_equivnode(ordered->parent, iter->parent)) {
-                            continue;
-                        }
+                    /* the matching node in first belongs to the ordered instances with its parent */
+                    aux = matchlist->match->set.d[matchlist->i];
+                    ordered = diff_ordset_find(&ordset, iter->schema, aux->parent);
 
-                        /* store necessary information for move detection */
-                        lyd_diff_move_preprocess(ordered, matchlist->match->set.d[matchlist->i], iter);
-                        break;
+                    /* store necessary information for move detection */
+                    if (ordered && lyd_diff_move_preprocess(&ordset, ordered, aux, iter)) {
+                        goto error;
                     }
                 }
 
@@ -3837,6 +4440,13 @@ cmp_continue:
                         LOGINT(ctx);
                         goto error;
                     }
+                    aux = matchlist->match->set.d[matchlist->i];
+                    if (lyd_subtree_same(aux, iter)) {
+                        /* the same subtrees, skip them (also when looking for deleted nodes) */
+                        aux->validity |= LYD_VAL_INUSE_SAME;
+                        matchlist->i++;
+                        continue;
+                    }
                     next1 = matchlist->match->set.d[matchlist->i]->child;
                     if (!next1) {
                         parent = matchlist->match->set.d[matchlist->i];
@@ -3894,15 +4504,13 @@ cmp_continue:
 
                 iter->validity &= ~LYD_VAL_INUSE;
                 if ((iter->schema->nodetype & (LYS_LEAFLIST | LYS_LIST)) && (iter->schema->flags & LYS_USERORDERED)) {
-                    for (j = ordset->number ; j > 0; j--) {
-                        ordered = (struct diff_ordered *)ordset->set.g[j - 1];
-                        if (ordered->schema != iter->schema || !lyd_diff_equivnode(ordered->parent, iter->parent)) {
-                            continue;
-                        }
+                    /* the matching node in first belongs to the ordered instances with its parent */
+                    aux = mlaux->match->set.d[mlaux->i];
+                    ordered = diff_ordset_find(&ordset, iter->schema, aux->parent);
 
-                        /* store necessary information for move detection */
-                        lyd_diff_move_preprocess(ordered, mlaux->match->set.d[mlaux->i], iter);
-                        break;
+                    /* store necessary information for move detection */
+                    if (ordered && lyd_diff_move_preprocess(&ordset, ordered, aux, iter)) {
+                        goto error;
                     }
                 }
 
@@ -3916,6 +4524,13 @@ cmp_continue:
                         LOGINT(ctx);
                         goto error;
                     }
+                    aux = mlaux->match->set.d[mlaux->i];
+                    if (lyd_subtree_same(aux, iter)) {
+                        /* the same subtrees, skip them (also when looking for deleted nodes) */
+                        aux->validity |= LYD_VAL_INUSE_SAME;
+                        mlaux->i++;
+                        continue;
+                    }
                     next1 = mlaux->match->set.d[mlaux->i]->child;
                     if (!next1) {
                         parent = mlaux->match->set.d[mlaux->i];
@@ -3948,11 +4563,17 @@ cmp_continue:
     ly_set_free(matchlist->match);
     free(matchlist);
     matchlist = NULL;
+    lyht_free(tmp_ht);
+    tmp_ht = NULL;
 
     /* 2) deleted nodes */
     LY_TREE_DFS_BEGIN(first, next1, elem1) {
         /* search for elem1s deleted in the second */
-        if (elem1->validity & LYD_VAL_INUSE) {
+        if (elem1->validity & LYD_VAL_INUSE_SAME) {
+            /* the subtree is the same in the second tree, nothing deleted there */
+            elem1->validity &= ~(LYD_VAL_INUSE | LYD_VAL_INUSE_SAME);
+            goto dfs_nextsibling;
+        } else if (elem1->validity & LYD_VAL_INUSE) {
             /* erase temporary LYD_VAL_INUSE flag and continue into children */
             elem1->validity &= ~LYD_VAL_INUSE;
         } else if (!elem1->dflt || (options & LYD_DIFFOPT_WITHDEFAULTS)) {
@@ -3992,8 +4613,8 @@ dfs_nextsibling:
     }
 
     /* 3) moved nodes (when user-ordered) */
-    for (i = 0; i < ordset->number; i++) {
-        ordered = (struct diff_ordered *)ordset->set.g[i];
+    for (i = 0; i < ordset.set->number; i++) {
+        ordered = (struct diff_ordered *)ordset.set->set.g[i];
         if (!ordered->dist->dist) {
             /* the dist list is sorted here, but the biggest dist is 0,
              * so nothing changed in order of these items between first
@@ -4068,8 +4689,7 @@ movedone:
         }
     }
 
-    diff_ordset_free(ordset);
-    ordset = NULL;
+    diff_ordset_free(&ordset);
 
     if (index2) {
         /* append result2 with newly created
@@ -4107,7 +4727,8 @@ error:
         free(mlaux);
 
     }
-    diff_ordset_free(ordset);
+    diff_ordset_free(&ordset);
+    lyht_free(tmp_ht);
 
     lyd_free_diff(result);
     lyd_free_diff(result2);
@@ -4218,6 +4839,9 @@ lyd_replace(struct lyd_node *orig, struct lyd_node *repl, int destroy)
 
     /* parent */
     if (orig->parent) {
+#ifdef LY_ENABLED_CACHE
+        lyd_uniq_invalidate(orig, orig->parent, 1);
+#endif
         if (orig->parent->child == orig) {
             orig->parent->child = repl;
         }
@@ -4904,6 +5528,9 @@ lyd_schema_sort(struct lyd_node *sibling, int recursive)
             }
         }
         free(array);
+#ifdef LY_ENABLED_CACHE
+        lyd_digest_invalidate(sibling->parent);
+#endif
     }
 
     /* sort all the children recursively */
@@ -4976,6 +5603,9 @@ _lyd_validate(struct lyd_node **node, struct lyd_node *data_tree, struct ly_ctx
             if (!iter->dflt && (iter->schema->nodetype == LYS_CONTAINER) && !iter->child
                         && !((struct lys_node_container *)iter->schema)->presence && !iter->attr) {
                 iter->dflt = 1;
+#ifdef LY_ENABLED_CACHE
+                lyd_digest_invalidate(iter);
+#endif
             }
 
             LY_TREE_DFS_END(root, next2, iter);
@@ -5023,9 +5653,7 @@ _lyd_validate(struct lyd_node **node, struct lyd_node *data_tree, struct ly_ctx
 
     /* add missing ietf-yang-library if requested */
     if (options & LYD_OPT_DATA_ADD_YANGLIB) {
-        if (!(*node)) {
-            (*node) = ly_ctx_info(ctx);
-        } else if (lyd_merge((*node), ly_ctx_info(ctx), LYD_OPT_DESTRUCT | LYD_OPT_EXPLICIT)) {
+        if (ly_ctx_info_add(ctx ? ctx : (*node)->schema->module->ctx, node)) {
             LOGERR(ctx, LY_EINT, "Adding ietf-yang-library data failed.");
             goto cleanup;
         }
@@ -5369,6 +5997,14 @@ lyd_unlink_internal(struct lyd_node *node, int permanent)
         if (permanent != 2) {
             lyd_unlink_hash(node, node->parent);
         }
+#else
+        if ((permanent != 2) && (node->schema->nodetype != LYS_LIST)) {
+            /* the values of the list instance may have changed, even to a default value (of another case) */
+            for (iter = node->parent; iter && (iter->schema->nodetype != LYS_LIST); iter = iter->parent);
+            if (iter && ((struct lys_node_list *)iter->schema)->unique_size) {
+                iter->validity |= LYD_VAL_UNIQUE;
+            }
+        }
 #endif
 
         node->parent = NULL;
@@ -5405,6 +6041,8 @@ _lyd_dup_node_common(struct lyd_node *new_node, const struct lyd_node *orig, str
     new_node->parent = NULL;
     new_node->validity = ly_new_node_validity(new_node->schema);
     new_node->dflt = orig->dflt;
+    /* the virtual children are generated from the schema, they stay valid for a complete copy */
+    new_node->virt = (options & LYD_DUP_OPT_RECURSIVE) ? orig->virt : 0;
     if (options & LYD_DUP_OPT_WITH_WHEN) {
         new_node->when_status = orig->when_status;
     } else {
@@ -5412,7 +6050,10 @@ _lyd_dup_node_common(struct lyd_node *new_node, const struct lyd_node *orig, str
     }
 #ifdef LY_ENABLED_CACHE
     /* just copy the hash, it will not change */
-    if ((new_node->schema->nodetype != LYS_LIST) || lyd_list_has_keys(new_node)) {
+    if ((new_node->schema->nodetype == LYS_LIST) && !((struct lys_node_list *)new_node->schema)->keys_size) {
+        /* except for a key-less list, the hashes of its children are added to it when they are inserted */
+        lyd_hash(new_node);
+    } else if ((new_node->schema->nodetype != LYS_LIST) || lyd_list_has_keys(new_node)) {
         new_node->hash = orig->hash;
     }
 #endif
@@ -5431,6 +6072,7 @@ _lyd_dup_node(const struct lyd_node *node, const struct lys_node *schema, struct
 {
     struct lyd_node *new_node = NULL;
     struct lys_node_leaf *sleaf;
+    const struct lys_type *btype;
     struct lyd_node_leaf_list *new_leaf;
     struct lyd_node_anydata *new_any, *old_any;
     int r;
@@ -5442,7 +6084,7 @@ _lyd_dup_node(const struct lyd_node *node, const struct lys_node *schema, struct
         new_leaf = calloc(1, sizeof *new_leaf);
         new_node = (struct lyd_node *)new_leaf;
         LY_CHECK_ERR_GOTO(!new_node, LOGMEM(ctx), error);
-        new_node->schema = (struct lys_node *)schema;
+        new_leaf->schema = (struct lys_node *)schema;
 
         new_leaf->value_str = lydict_insert(ctx, ((struct lyd_node_leaf_list *)node)->value_str, 0);
         new_leaf->value_type = ((struct lyd_node_leaf_list *)node)->value_type;
@@ -5474,10 +6116,25 @@ _lyd_dup_node(const struct lyd_node *node, const struct lys_node *schema, struct
             break;
         case LY_TYPE_ENUM:
         case LY_TYPE_IDENT:
+            if (schema == node->schema) {
+                /* the same schema, the pointers to its enum or identity can be shared */
+                new_leaf->value = ((struct lyd_node_leaf_list *)node)->value;
+                break;
+            }
+            /* fallthrough */
         case LY_TYPE_BITS:
-            /* in case of duplicating bits (no matter if in the same context or not) or enum and identityref into
-             * a different context, searching for the type and duplicating the data is almost as same as resolving
-             * the string value, so due to a simplicity, parse the value for the duplicated leaf */
+            if ((new_leaf->value_type == LY_TYPE_BITS) && (schema == node->schema) && (sleaf->type.base == LY_TYPE_BITS)) {
+                /* the same schema and no union, only copy the array of the pointers to its bits */
+                for (btype = &sleaf->type; !btype->info.bits.count; btype = &btype->der->type);
+                new_leaf->value.bit = malloc(btype->info.bits.count * sizeof *new_leaf->value.bit);
+                LY_CHECK_ERR_GOTO(!new_leaf->value.bit, LOGMEM(ctx), error);
+                memcpy(new_leaf->value.bit, ((struct lyd_node_leaf_list *)node)->value.bit,
+                       btype->info.bits.count * sizeof *new_leaf->value.bit);
+                break;
+            }
+            /* in case of duplicating bits of a union or enum and identityref into a different context,
+             * searching for the type and duplicating the data is almost as same as resolving the string value,
+             * so due to a simplicity, parse the value for the duplicated leaf */
             if (!lyp_parse_value(&sleaf->type, &new_leaf->value_str, NULL, new_leaf, NULL, NULL, 1, node->dflt, 0)) {
                 goto error;
             }
@@ -5487,8 +6144,18 @@ _lyd_dup_node(const struct lyd_node *node, const struct lys_node *schema, struct
             break;
         }
 
-        if (sleaf->type.der && sleaf->type.der->module) {
-            r = lytype_store(sleaf->type.der->module, sleaf->type.der->name, &new_leaf->value_str, &new_leaf->value);
+        if (new_leaf->value_flags & LY_VALUE_USER) {
+            /* store the value the same way as the original, in case of a union it was stored by its member type,
+             * which must be also used when the value is freed */
+            new_leaf->value_flags &= ~LY_VALUE_USER;
+            btype = &sleaf->type;
+            if (btype->base == LY_TYPE_UNION) {
+                btype = lyd_leaf_type(new_leaf);
+                if (!btype) {
+                    goto error;
+                }
+            }
+            r = lytype_store(btype->der->module, btype->der->name, &new_leaf->value_str, &new_leaf->value);
             if (r == -1) {
                 goto error;
             } else if (!r) {
@@ -5502,7 +6169,7 @@ _lyd_dup_node(const struct lyd_node *node, const struct lys_node *schema, struct
         new_any = calloc(1, sizeof *new_any);
         new_node = (struct lyd_node *)new_any;
         LY_CHECK_ERR_GOTO(!new_node, LOGMEM(ctx), error);
-        new_node->schema = (struct lys_node *)schema;
+        new_any->schema = (struct lys_node *)schema;
 
         if (_lyd_dup_node_common(new_node, node, ctx, options)) {
             goto error;
@@ -5604,8 +6271,8 @@ lyd_dup_keys(struct lyd_node *new_list, const struct lyd_node *old_list, struct
     return 0;
 }
 
-API struct lyd_node *
-lyd_dup_to_ctx(const struct lyd_node *node, int options, struct ly_ctx *ctx)
+static struct lyd_node *
+_lyd_dup_to_ctx(const struct lyd_node *node, int options, struct ly_ctx *ctx, struct ly_ctx_schema_map *map)
 {
     struct ly_ctx *log_ctx;
     struct lys_node *schema;
@@ -5635,7 +6302,10 @@ lyd_dup_to_ctx(const struct lyd_node *node, int options, struct ly_ctx *ctx)
         /* find the correct schema */
         if (ctx) {
             schema = NULL;
-            if (parent) {
+            if (map) {
+                /* the schema node is mapped only once */
+                schema = (struct lys_node *)ly_ctx_schema_map_get(map, elem->schema);
+            } else if (parent) {
                 trg_mod = lyp_get_module(parent->schema->module, NULL, 0, lyd_node_module(elem)->name,
                                          strlen(lyd_node_module(elem)->name), 1);
                 if (!trg_mod) {
@@ -5693,6 +6363,22 @@ lyd_dup_to_ctx(const struct lyd_node *node, int options, struct ly_ctx *ctx)
             break;
         }
 
+        if (ctx && map) {
+            /* the schema nodes are mapped, the copies of all the descendants can be connected directly */
+            if (!(elem->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) && elem->child
+                    && !lyd_dup_withsiblings_r(elem->child, new_node, options, log_ctx, map)) {
+                goto error;
+            }
+#ifdef LY_ENABLED_CACHE
+            assert(!parent);
+            if (new_node->schema->nodetype == LYS_LIST) {
+                /* the list is not connected anywhere yet and has all its descendants */
+                new_node->hash = elem->hash;
+            }
+#endif
+            break;
+        }
+
         /* LY_TREE_DFS_END */
         /* select element for the next run - children first,
          * child exception for lyd_node_leaf and lyd_node_leaflist */
@@ -5756,63 +6442,107 @@ error:
     return NULL;
 }
 
+API struct lyd_node *
+lyd_dup_to_ctx(const struct lyd_node *node, int options, struct ly_ctx *ctx)
+{
+    return _lyd_dup_to_ctx(node, options, ctx, NULL);
+}
+
+API struct lyd_node *
+lyd_dup_to_ctx_map(const struct lyd_node *node, int options, struct ly_ctx_schema_map *map)
+{
+    if (!map) {
+        LOGARG;
+        return NULL;
+    }
+
+    return _lyd_dup_to_ctx(node, options, map->dst_ctx, map);
+}
+
 API struct lyd_node *
 lyd_dup(const struct lyd_node *node, int options)
 {
     return lyd_dup_to_ctx(node, options, NULL);
 }
 
+/* with a schema map, the siblings are duplicated into its target context and are not validated */
 static struct lyd_node *
-lyd_dup_withsiblings_r(const struct lyd_node *first, struct lyd_node *parent_dup, int options, struct ly_ctx *ctx)
+lyd_dup_withsiblings_r(const struct lyd_node *first, struct lyd_node *parent_dup, int options, struct ly_ctx *ctx,
+                       struct ly_ctx_schema_map *map)
 {
     struct lyd_node *first_dup = NULL, *prev_dup = NULL, *last_dup;
     const struct lyd_node *next;
+    const struct lys_node *schema;
 
     assert(first);
 
     /* duplicate and connect all siblings */
     LY_TREE_FOR(first, next) {
-        last_dup = _lyd_dup_node(next, next->schema, ctx, options);
+        if (map) {
+            schema = ly_ctx_schema_map_get(map, next->schema);
+            if (!schema) {
+                LOGERR(ctx, LY_EINVAL, "Target context does not contain schema node for the data node being duplicated "
+                       "(%s:%s).", lyd_node_module(next)->name, next->schema->name);
+                goto error;
+            }
+        } else {
+            schema = next->schema;
+        }
+
+        last_dup = _lyd_dup_node(next, schema, ctx, options);
         if (!last_dup) {
             goto error;
         }
 
-        /* the whole data tree is exactly the same so we can safely copy the validation flags */
-        last_dup->validity = next->validity;
-        last_dup->when_status = next->when_status;
+        if (!map) {
+            /* the whole data tree is exactly the same so we can safely copy the validation flags */
+            last_dup->validity = next->validity;
+            last_dup->when_status = next->when_status;
+        }
 
         last_dup->parent = parent_dup;
         if (!first_dup) {
             first_dup = last_dup;
+            if (parent_dup) {
+                parent_dup->child = first_dup;
+            }
         } else {
             assert(prev_dup);
             prev_dup->next = last_dup;
             last_dup->prev = prev_dup;
+            first_dup->prev = last_dup;
         }
 
         if ((next->schema->nodetype & (LYS_LIST | LYS_CONTAINER | LYS_RPC | LYS_ACTION | LYS_NOTIF)) && next->child) {
             /* recursively duplicate all children */
-            if (!lyd_dup_withsiblings_r(next->child, last_dup, options, ctx)) {
+            if (!lyd_dup_withsiblings_r(next->child, last_dup, options, ctx, map)) {
                 goto error;
             }
         }
 
+#ifdef LY_ENABLED_CACHE
+        if (last_dup->schema->nodetype == LYS_LIST) {
+            /* the whole subtree is the same, so is the hash of a list with its keys or without any */
+            last_dup->hash = next->hash;
+        }
+#endif
+
         prev_dup = last_dup;
     }
 
-    /* correctly set last sibling and parent child pointer */
-    assert(!prev_dup->next);
-    first_dup->prev = prev_dup;
-    if (parent_dup) {
-        parent_dup->child = first_dup;
+#ifdef LY_ENABLED_CACHE
+    /* all the children are hashed, add them into the parent hash table at once */
+    if (parent_dup && lyd_insert_hash_children(parent_dup)) {
+        goto error;
     }
+#endif
 
+    assert(!prev_dup->next && (first_dup->prev == prev_dup));
     return first_dup;
 
 error:
-    /* disconnect and free */
-    if (first_dup) {
-        first_dup->parent = NULL;
+    /* free, but if connected, the nodes are freed with the parent */
+    if (first_dup && !parent_dup) {
         lyd_free_withsiblings(first_dup);
     }
     return NULL;
@@ -5857,7 +6587,7 @@ lyd_dup_withsiblings_to_ctx(const struct lyd_node *node, int options, struct ly_
         }
     } else {
         /* duplicating top-level siblings, we can duplicate much more efficiently */
-        ret = lyd_dup_withsiblings_r(node, NULL, options, ctx);
+        ret = lyd_dup_withsiblings_r(node, NULL, options, ctx, NULL);
     }
 
     return ret;
@@ -6076,6 +6806,7 @@ _lyd_free_node(struct lyd_node *node)
 #ifdef LY_ENABLED_CACHE
         /* it should be empty because all the children are freed already (only if in debug mode) */
         lyht_free(node->ht);
+        lyv_uniq_idx_free(node->uniq);
 #endif
         break;
     case LYS_ANYDATA:
@@ -6496,6 +7227,10 @@ lyd_find_instance(const struct lyd_node *data, const struct lys_node *schema)
             goto error;
         }
         for (j = 0; j < ret->number; j++) {
+            if (ret->set.d[j]->virt && lyd_wd_virtual_create(ret->set.d[j])) {
+                ly_set_free(ret_aux);
+                goto error;
+            }
             LY_TREE_FOR(ret->set.d[j]->child, iter) {
                 if (iter->schema == spath->set.s[i - 1]) {
                     ly_set_add(ret_aux, iter, LY_SET_OPT_USEASLIST);
@@ -6535,6 +7270,104 @@ lyd_first_sibling(struct lyd_node *node)
     return start;
 }
 
+#ifdef LY_ENABLED_CACHE
+
+static int
+ly_set_hash_equal_cb(void *val1_p, void *val2_p, int mod, void *UNUSED(cb_data))
+{
+    struct ly_set_hash_item *val1, *val2;
+
+    val1 = (struct ly_set_hash_item *)val1_p;
+    val2 = (struct ly_set_hash_item *)val2_p;
+
+    if (val1->item != val2->item) {
+        return 0;
+    }
+
+    /* the same item can be stored several times (LY_SET_OPT_USEASLIST), when modifying, match the exact record */
+    if (mod && (val1->idx != val2->idx)) {
+        return 0;
+    }
+
+    return 1;
+}
+
+static uint32_t
+ly_set_hash_item(void *item)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&item, sizeof item);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+/**
+ * @brief Add a set item into the set hash table, create the hash table if the set is large enough.
+ *
+ * @param[in] set Set with the item already added into its array.
+ * @param[in] idx Index of the new item.
+ * @return EXIT_SUCCESS or EXIT_FAILURE.
+ */
+static int
+ly_set_insert_hash(struct ly_set *set, unsigned int idx)
+{
+    struct ly_set_hash_item hitem;
+    unsigned int i;
+    int r;
+
+    if (!set->ht) {
+        if (set->number < LY_CACHE_SET_HT_MIN_ITEMS) {
+            /* not worth it */
+            return EXIT_SUCCESS;
+        }
+
+        /* create hash table and add all the items */
+        set->ht = lyht_new(1, sizeof hitem, ly_set_hash_equal_cb, NULL, 1);
+        LY_CHECK_ERR_RETURN(!set->ht, LOGMEM(NULL), EXIT_FAILURE);
+        for (i = 0; i < set->number; ++i) {
+            hitem.item = set->set.g[i];
+            hitem.idx = i;
+
+            r = lyht_insert(set->ht, &hitem, ly_set_hash_item(hitem.item), NULL);
+            assert(!r);
+            (void)r;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    hitem.item = set->set.g[idx];
+    hitem.idx = idx;
+    if (lyht_insert(set->ht, &hitem, ly_set_hash_item(hitem.item), NULL) == -1) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Remove a set item from the set hash table, if any.
+ *
+ * @param[in] set Set with the item still in its array.
+ * @param[in] idx Index of the removed item.
+ */
+static void
+ly_set_remove_hash(struct ly_set *set, unsigned int idx)
+{
+    struct ly_set_hash_item hitem;
+    int r;
+
+    if (!set->ht) {
+        return;
+    }
+
+    hitem.item = set->set.g[idx];
+    hitem.idx = idx;
+    r = lyht_remove(set->ht, &hitem, ly_set_hash_item(hitem.item));
+    assert(!r);
+    (void)r;
+}
+
+#endif
+
 API struct ly_set *
 ly_set_new(void)
 {
@@ -6552,6 +7385,9 @@ ly_set_free(struct ly_set *set)
         return;
     }
 
+#ifdef LY_ENABLED_CACHE
+    lyht_free(set->ht);
+#endif
     free(set->set.g);
     free(set);
 }
@@ -6560,11 +7396,37 @@ API int
 ly_set_contains(const struct ly_set *set, void *node)
 {
     unsigned int i;
+#ifdef LY_ENABLED_CACHE
+    struct ly_set_hash_item hitem, *match;
+    uint32_t hash;
+#endif
 
     if (!set) {
         return -1;
     }
 
+#ifdef LY_ENABLED_CACHE
+    if (set->ht) {
+        hitem.item = node;
+        hash = ly_set_hash_item(node);
+        if (!lyht_find(set->ht, &hitem, hash, (void **)&match)) {
+            /* object found, but it can be stored more times (LY_SET_OPT_USEASLIST), return its first index */
+            i = match->idx;
+            hitem = *match;
+            while (!lyht_find_next(set->ht, &hitem, hash, (void **)&match)) {
+                if ((match->item == node) && (match->idx < i)) {
+                    i = match->idx;
+                }
+                hitem = *match;
+            }
+            return i;
+        }
+
+        /* object not found */
+        return -1;
+    }
+#endif
+
     for (i = 0; i < set->number; i++) {
         if (set->set.g[i] == node) {
             /* object found */
@@ -6585,7 +7447,7 @@ ly_set_dup(const struct ly_set *set)
         return NULL;
     }
 
-    new = malloc(sizeof *new);
+    new = calloc(1, sizeof *new);
     LY_CHECK_ERR_RETURN(!new, LOGMEM(NULL), NULL);
     new->number = set->number;
     new->size = set->size;
@@ -6593,13 +7455,20 @@ ly_set_dup(const struct ly_set *set)
     LY_CHECK_ERR_RETURN(!new->set.g, LOGMEM(NULL); free(new), NULL);
     memcpy(new->set.g, set->set.g, new->size * sizeof *(new->set.g));
 
+#ifdef LY_ENABLED_CACHE
+    if (set->ht && ly_set_insert_hash(new, 0)) {
+        ly_set_free(new);
+        return NULL;
+    }
+#endif
+
     return new;
 }
 
 API int
 ly_set_add(struct ly_set *set, void *node, int options)
 {
-    unsigned int i;
+    int i;
     void **new;
 
     if (!set || !node) {
@@ -6609,11 +7478,10 @@ ly_set_add(struct ly_set *set, void *node, int options)
 
     if (!(options & LY_SET_OPT_USEASLIST)) {
         /* search for duplication */
-        for (i = 0; i < set->number; i++) {
-            if (set->set.g[i] == node) {
-                /* already in set */
-                return i;
-            }
+        i = ly_set_contains(set, node);
+        if (i > -1) {
+            /* already in set */
+            return i;
         }
     }
 
@@ -6626,6 +7494,13 @@ ly_set_add(struct ly_set *set, void *node, int options)
 
     set->set.g[set->number++] = node;
 
+#ifdef LY_ENABLED_CACHE
+    if (ly_set_insert_hash(set, set->number - 1)) {
+        set->set.g[--set->number] = NULL;
+        return -1;
+    }
+#endif
+
     return set->number - 1;
 }
 
@@ -6667,7 +7542,18 @@ ly_set_merge(struct ly_set *trg, struct ly_set *src, int options)
     /* copy contents from src into trg */
     memcpy(trg->set.g + trg->number, src->set.g, src->number * sizeof *(src->set.g));
     ret = src->number;
+#ifdef LY_ENABLED_CACHE
+    for (i = 0; i < ret; ++i) {
+        ++trg->number;
+        if (ly_set_insert_hash(trg, trg->number - 1)) {
+            --trg->number;
+            ly_set_free(src);
+            return -1;
+        }
+    }
+#else
     trg->number += ret;
+#endif
 
     /* cleanup */
     ly_set_free(src);
@@ -6677,18 +7563,37 @@ ly_set_merge(struct ly_set *trg, struct ly_set *src, int options)
 API int
 ly_set_rm_index(struct ly_set *set, unsigned int index)
 {
+#ifdef LY_ENABLED_CACHE
+    int r;
+#endif
+
     if (!set || (index + 1) > set->number) {
         LOGARG;
         return EXIT_FAILURE;
     }
 
+#ifdef LY_ENABLED_CACHE
+    ly_set_remove_hash(set, index);
+#endif
+
     if (index == set->number - 1) {
         /* removing last item in set */
         set->set.g[index] = NULL;
     } else {
+#ifdef LY_ENABLED_CACHE
+        /* the last item changes its index */
+        ly_set_remove_hash(set, set->number - 1);
+#endif
         /* removing item somewhere in a middle, so put there the last item */
         set->set.g[index] = set->set.g[set->number - 1];
         set->set.g[set->number - 1] = NULL;
+#ifdef LY_ENABLED_CACHE
+        if (set->ht) {
+            r = ly_set_insert_hash(set, index);
+            assert(!r);
+            (void)r;
+        }
+#endif
     }
     set->number--;
 
@@ -6698,7 +7603,7 @@ ly_set_rm_index(struct ly_set *set, unsigned int index)
 API int
 ly_set_rm(struct ly_set *set, void *node)
 {
-    unsigned int i;
+    int i;
 
     if (!set || !node) {
         LOGARG;
@@ -6706,12 +7611,8 @@ ly_set_rm(struct ly_set *set, void *node)
     }
 
     /* get index */
-    for (i = 0; i < set->number; i++) {
-        if (set->set.g[i] == node) {
-            break;
-        }
-    }
-    if (i == set->number) {
+    i = ly_set_contains(set, node);
+    if (i == -1) {
         /* node is not in set */
         LOGARG;
         return EXIT_FAILURE;
@@ -6727,6 +7628,10 @@ ly_set_clean(struct ly_set *set)
         return EXIT_FAILURE;
     }
 
+#ifdef LY_ENABLED_CACHE
+    lyht_free(set->ht);
+    set->ht = NULL;
+#endif
     set->number = 0;
     return EXIT_SUCCESS;
 }
@@ -6909,135 +7814,823 @@ lyd_free_val_diff(struct lyd_difflist *diff)
     lyd_free_diff(diff);
 }
 
+/**
+ * @brief Default node template of a leaf or a leaf-list, its default values are already parsed
+ * so the default nodes can be created without parsing them again.
+ */
+struct lyd_wd_tpl {
+    const struct lys_node *schema;  /* leaf or leaf-list, the key of the template */
+    const char *dflt;               /* first default value the template was created from, only compared */
+    uint8_t dflt_size;              /* number of the default values */
+    uint8_t when_status;            /* when status of the created nodes */
+    uint16_t bits_count;            /* size of value.bit arrays of bits values */
+    uint8_t virt;                   /* whether the nodes do not have to be created (see #LYD_OPT_VIRTUAL_DFLT) */
+    struct lyd_wd_tpl_val {
+        const char *value_str;      /* canonical value (in the dictionary) */
+        lyd_val value;
+        LY_DATA_TYPE value_type;
+        uint8_t value_flags;
+    } *vals;                        /* parsed values, NULL if the nodes must be created the usual way */
+};
+
 static int
-lyd_wd_add_leaf(struct lyd_node **tree, struct lyd_node *last_parent, struct lys_node_leaf *leaf, struct unres_data *unres,
-                int check_when_must)
+lyd_wd_tpl_equal_cb(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
 {
-    struct lyd_node *dummy = NULL, *current;
-    struct lys_tpdf *tpdf;
-    const char *dflt = NULL;
-    int ret;
+    struct lyd_wd_tpl *tpl1, *tpl2;
 
-    /* get know if there is a default value */
-    if (leaf->dflt) {
-        /* leaf has a default value */
-        dflt = leaf->dflt;
-    } else if (!(leaf->flags & LYS_MAND_TRUE)) {
-        /* get the default value from the type */
-        for (tpdf = leaf->type.der; tpdf && !dflt; tpdf = tpdf->type.der) {
-            dflt = tpdf->dflt;
-        }
-    }
-    if (!dflt) {
-        /* no default value */
-        return EXIT_SUCCESS;
-    }
+    tpl1 = *(struct lyd_wd_tpl **)val1_p;
+    tpl2 = *(struct lyd_wd_tpl **)val2_p;
 
-    /* create the node */
-    if (!(dummy = lyd_new_dummy(*tree, last_parent, (struct lys_node*)leaf, dflt, 1))) {
-        goto error;
-    }
+    return (tpl1->schema == tpl2->schema);
+}
 
-    if (unres->store_diff) {
-        /* remember this subtree in the diff */
-        if (unres_data_diff_new(unres, dummy, NULL, 1)) {
-            goto error;
-        }
-    }
+static uint32_t
+lyd_wd_tpl_hash(const struct lys_node *schema)
+{
+    uint32_t hash;
 
-    if (!dummy->parent && (*tree)) {
-        /* connect dummy nodes into the data tree (at the end of top level nodes) */
-        if (lyd_insert_sibling(tree, dummy)) {
-            goto error;
-        }
-    }
-    for (current = dummy; ; current = current->child) {
-        /* remember the created data in unres */
-        if (check_when_must) {
-            if ((current->when_status & LYD_WHEN) && unres_data_add(unres, current, UNRES_WHEN) == -1) {
-                goto error;
-            }
-            if (check_when_must == 2) {
-                ret = resolve_applies_must(current);
-                if ((ret & 0x1) && (unres_data_add(unres, current, UNRES_MUST) == -1)) {
-                    goto error;
-                }
-                if ((ret & 0x2) && (unres_data_add(unres, current, UNRES_MUST_INOUT) == -1)) {
-                    goto error;
-                }
-            }
-        }
+    hash = dict_hash_multi(0, (const char *)&schema, sizeof schema);
+    return dict_hash_multi(hash, NULL, 0);
+}
 
-        /* clear dummy-node flag */
-        current->validity &= ~LYD_VAL_INUSE;
+/* the schema node of the template is not accessed, it may not exist anymore */
+static void
+lyd_wd_tpl_free(struct ly_ctx *ctx, struct lyd_wd_tpl *tpl)
+{
+    uint8_t i;
 
-        if (current->schema == (struct lys_node *)leaf) {
-            break;
+    if (tpl->vals) {
+        for (i = 0; i < tpl->dflt_size; ++i) {
+            lydict_remove(ctx, tpl->vals[i].value_str);
+            if (tpl->vals[i].value_type == LY_TYPE_BITS) {
+                free(tpl->vals[i].value.bit);
+            }
         }
+        free(tpl->vals);
     }
-    /* update parent's default flag if needed */
-    lyd_wd_update_parents(dummy);
+    free(tpl);
+}
 
-    /* if necessary, remember the created data value in unres */
-    if (((struct lyd_node_leaf_list *)current)->value_type == LY_TYPE_LEAFREF) {
-        if (unres_data_add(unres, current, UNRES_LEAFREF)) {
-            goto error;
-        }
-    } else if (((struct lyd_node_leaf_list *)current)->value_type == LY_TYPE_INST) {
-        if (unres_data_add(unres, current, UNRES_INSTID)) {
-            goto error;
-        }
+void
+lyd_wd_tpl_free_all(struct ly_ctx *ctx)
+{
+    void *val_p;
+    uint32_t i = 0;
+
+    if (!ctx->wd_tpls) {
+        return;
     }
 
-    if (!(*tree)) {
-        *tree = dummy;
+    while (lyht_iter_next(ctx->wd_tpls, &i, &val_p)) {
+        lyd_wd_tpl_free(ctx, *(struct lyd_wd_tpl **)val_p);
     }
-    return EXIT_SUCCESS;
+    lyht_free(ctx->wd_tpls);
+    ctx->wd_tpls = NULL;
+}
 
-error:
-    lyd_free(dummy);
-    return EXIT_FAILURE;
+/* get the schema node of the data parent of a node */
+static const struct lys_node *
+lyd_wd_data_parent(const struct lys_node *schema)
+{
+    for (schema = lys_parent(schema); schema && (schema->nodetype & (LYS_CHOICE | LYS_CASE | LYS_USES)); schema = lys_parent(schema));
+    return schema;
 }
 
+/* learn whether a missing default leaf(-list) or NP container can be created only once it is looked up,
+ * there is nothing to validate in it (see #LYD_OPT_VIRTUAL_DFLT) */
 static int
-lyd_wd_add_leaflist(struct lyd_node **tree, struct lyd_node *last_parent, struct lys_node_leaflist *llist,
-                    struct unres_data *unres, int check_when_must)
+lyd_wd_virt_schema(const struct lys_node *schema)
 {
-    struct lyd_node *dummy, *current, *first = NULL;
+    const struct lys_node *siter;
+    uint8_t must_size;
+
+    if (schema->flags & (LYS_CONFIG_R | LYS_UNIQUE | LYS_VALID_EXT)) {
+        /* state data default nodes are created only in some trees, the others are checked in the data */
+        return 0;
+    }
+    switch (schema->nodetype) {
+    case LYS_LEAF:
+        must_size = ((struct lys_node_leaf *)schema)->must_size;
+        break;
+    case LYS_LEAFLIST:
+        must_size = ((struct lys_node_leaflist *)schema)->must_size;
+        break;
+    case LYS_CONTAINER:
+        must_size = ((struct lys_node_container *)schema)->must_size;
+        break;
+    default:
+        return 0;
+    }
+    if (must_size) {
+        return 0;
+    }
+
+    siter = lyd_wd_data_parent(schema);
+    if (!siter || (siter->flags & LYS_VALID_EXT)) {
+        /* top-level nodes are always created, the parent may need to see all its children */
+        return 0;
+    }
+    for (; siter; siter = lys_parent(siter)) {
+        if (siter->nodetype & (LYS_RPC | LYS_ACTION | LYS_NOTIF)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static struct lyd_wd_tpl *
+lyd_wd_tpl_new(const struct lys_node *schema, const char **dflt, uint8_t dflt_size)
+{
+    struct ly_ctx *ctx = schema->module->ctx;
+    struct lys_type *type = &((struct lys_node_leaf *)schema)->type, *btype;
+    struct lyd_node_leaf_list node;
+    struct lyd_wd_tpl *tpl;
+    enum int_log_opts prev_ilo;
+    uint8_t i;
+
+    tpl = calloc(1, sizeof *tpl);
+    LY_CHECK_ERR_RETURN(!tpl, LOGMEM(ctx), NULL);
+    tpl->schema = schema;
+    tpl->dflt = dflt[0];
+    tpl->dflt_size = dflt_size;
+
+    if ((type->base == LY_TYPE_LEAFREF) || (type->base == LY_TYPE_INST) || lyp_is_rpc_action((struct lys_node *)schema)) {
+        /* the values are resolved in the data tree or the nodes are ordered, nothing to prepare */
+        return tpl;
+    }
+
+    tpl->vals = calloc(dflt_size, sizeof *tpl->vals);
+    LY_CHECK_ERR_RETURN(!tpl->vals, LOGMEM(ctx); free(tpl), NULL);
+    if (resolve_applies_when(schema, 0, NULL)) {
+        tpl->when_status = LYD_WHEN;
+    }
+    if (type->base == LY_TYPE_BITS) {
+        for (btype = type; !btype->info.bits.count; btype = &btype->der->type);
+        tpl->bits_count = btype->info.bits.count;
+    }
+
+    /* any errors are logged when the nodes are created the usual way */
+    ly_ilo_change(NULL, ILO_IGNORE, &prev_ilo, NULL);
+    for (i = 0; i < dflt_size; ++i) {
+        memset(&node, 0, sizeof node);
+        node.schema = (struct lys_node *)schema;
+        node.prev = (struct lyd_node *)&node;
+        node.value_type = type->base;
+        node.value_str = lydict_insert(ctx, dflt[i], 0);
+        node.dflt = 1;
+
+        if (!lyp_parse_value(type, &node.value_str, NULL, &node, NULL, NULL, 1, 1, 0)
+                || (node.value_flags & (LY_VALUE_USER | LY_VALUE_UNRES))
+                || ((node.value_type == LY_TYPE_BITS) && (type->base != LY_TYPE_BITS))
+                || (node.value_type == LY_TYPE_LEAFREF) || (node.value_type == LY_TYPE_INST)
+                || (node.value_type == LY_TYPE_UNION)) {
+            /* invalid value or a value that cannot be simply copied */
+            lyd_free_value(node.value, node.value_type, node.value_flags, type, node.value_str, NULL, NULL, NULL);
+            lydict_remove(ctx, node.value_str);
+            for (; i; --i) {
+                lydict_remove(ctx, tpl->vals[i - 1].value_str);
+                if (tpl->vals[i - 1].value_type == LY_TYPE_BITS) {
+                    free(tpl->vals[i - 1].value.bit);
+                }
+            }
+            free(tpl->vals);
+            tpl->vals = NULL;
+            break;
+        }
+
+        tpl->vals[i].value_str = node.value_str;
+        tpl->vals[i].value = node.value;
+        tpl->vals[i].value_type = node.value_type;
+        tpl->vals[i].value_flags = node.value_flags;
+    }
+    ly_ilo_restore(NULL, prev_ilo, NULL, 0);
+
+    if (tpl->vals && !tpl->when_status) {
+        tpl->virt = lyd_wd_virt_schema(schema);
+    }
+
+    return tpl;
+}
+
+/* get the template of a leaf(-list), create it if needed, ctx->wd_tpls_lock must be held */
+static struct lyd_wd_tpl *
+lyd_wd_tpl_get(const struct lys_node *schema, const char **dflt, uint8_t dflt_size)
+{
+    struct ly_ctx *ctx = schema->module->ctx;
+    struct lyd_wd_tpl tpl_rec, *tpl = &tpl_rec, **match;
+    uint32_t hash;
+
+    if (ctx->wd_tpls && (ctx->wd_tpls_epoch != ctx->feature_epoch)) {
+        /* the module set changed, the templates may belong to schema nodes that do not exist anymore */
+        lyd_wd_tpl_free_all(ctx);
+    }
+    if (!ctx->wd_tpls) {
+        ctx->wd_tpls = lyht_new(16, sizeof tpl, lyd_wd_tpl_equal_cb, NULL, 1);
+        LY_CHECK_ERR_RETURN(!ctx->wd_tpls, LOGMEM(ctx), NULL);
+        ctx->wd_tpls_epoch = ctx->feature_epoch;
+    }
+
+    tpl_rec.schema = schema;
+    hash = lyd_wd_tpl_hash(schema);
+    if (!lyht_find(ctx->wd_tpls, &tpl, hash, (void **)&match)) {
+        tpl = *match;
+        if ((tpl->dflt == dflt[0]) && (tpl->dflt_size == dflt_size)) {
+            return tpl;
+        }
+
+        /* the default values were changed (by a deviation), create the template again */
+        lyht_remove(ctx->wd_tpls, &tpl, hash);
+        lyd_wd_tpl_free(ctx, tpl);
+    }
+
+    tpl = lyd_wd_tpl_new(schema, dflt, dflt_size);
+    if (!tpl) {
+        return NULL;
+    }
+    if (lyht_insert(ctx->wd_tpls, &tpl, hash, NULL)) {
+        LOGINT(ctx);
+        lyd_wd_tpl_free(ctx, tpl);
+        return NULL;
+    }
+
+    return tpl;
+}
+
+/* create a single default node from a template, it is not connected anywhere */
+static struct lyd_node *
+lyd_wd_tpl_node(const struct lyd_wd_tpl *tpl, uint8_t idx)
+{
+    struct ly_ctx *ctx = tpl->schema->module->ctx;
+    struct lyd_node_leaf_list *leaf;
+
+    leaf = calloc(1, sizeof *leaf);
+    LY_CHECK_ERR_RETURN(!leaf, LOGMEM(ctx), NULL);
+
+    leaf->schema = (struct lys_node *)tpl->schema;
+    leaf->prev = (struct lyd_node *)leaf;
+    /* instance duplicity and mandatory children are not checked for implicit default nodes, the same as
+     * for lyd_new_dummy() ones, the rest must be */
+    leaf->validity = ly_new_node_validity(leaf->schema) & ~(LYD_VAL_DUP | LYD_VAL_MAND);
+    leaf->when_status = tpl->when_status;
+    leaf->dflt = 1;
+    leaf->value_str = lydict_insert(ctx, tpl->vals[idx].value_str, 0);
+    leaf->value_type = tpl->vals[idx].value_type;
+    leaf->value_flags = tpl->vals[idx].value_flags;
+    switch (leaf->value_type) {
+    case LY_TYPE_BINARY:
+    case LY_TYPE_STRING:
+        /* value_str pointer is shared in these cases */
+        leaf->value.string = leaf->value_str;
+        break;
+    case LY_TYPE_BITS:
+        leaf->value.bit = malloc(tpl->bits_count * sizeof *leaf->value.bit);
+        LY_CHECK_ERR_RETURN(!leaf->value.bit, LOGMEM(ctx); lydict_remove(ctx, leaf->value_str); free(leaf), NULL);
+        memcpy(leaf->value.bit, tpl->vals[idx].value.bit, tpl->bits_count * sizeof *leaf->value.bit);
+        break;
+    default:
+        leaf->value = tpl->vals[idx].value;
+        break;
+    }
+
+    return (struct lyd_node *)leaf;
+}
+
+/**
+ * @brief Create the default nodes of a leaf or a leaf-list from its template and append them
+ * all at once to the children of their parent.
+ *
+ * @param[in] parent Data parent of the created nodes.
+ * @param[in] schema Leaf or leaf-list schema node.
+ * @param[in] dflt Default values of \p schema.
+ * @param[in] dflt_size Number of the default values.
+ * @param[out] first First of the created nodes.
+ * @return 0 on success, 1 if the nodes cannot be created from a template, -1 on error.
+ */
+static int
+lyd_wd_tpl_stamp(struct lyd_node *parent, const struct lys_node *schema, const char **dflt, uint8_t dflt_size,
+                 struct lyd_node **first)
+{
+    struct ly_ctx *ctx = schema->module->ctx;
+    struct lyd_wd_tpl *tpl;
+    struct lyd_node *node;
+    uint8_t i;
+
+    *first = NULL;
+
+    /* the template nodes are created only directly in their parent */
+    if (lyd_wd_data_parent(schema) != parent->schema) {
+        return 1;
+    }
+
+    pthread_mutex_lock(&ctx->wd_tpls_lock);
+    tpl = lyd_wd_tpl_get(schema, dflt, dflt_size);
+    if (!tpl || !tpl->vals) {
+        pthread_mutex_unlock(&ctx->wd_tpls_lock);
+        return tpl ? 1 : -1;
+    }
+
+    for (i = 0; i < dflt_size; ++i) {
+        node = lyd_wd_tpl_node(tpl, i);
+        if (!node) {
+            goto error;
+        }
+
+        /* append it as the last child of the parent */
+        node->parent = parent;
+        if (parent->child) {
+            parent->child->prev->next = node;
+            node->prev = parent->child->prev;
+            parent->child->prev = node;
+        } else {
+            parent->child = node;
+            node->prev = node;
+        }
+#ifdef LY_ENABLED_CACHE
+        lyd_hash(node);
+        lyd_insert_hash(node);
+#endif
+        if (!*first) {
+            *first = node;
+        }
+    }
+    pthread_mutex_unlock(&ctx->wd_tpls_lock);
+
+    if (schema->child) {
+        /* the nodes are targets of some leafrefs */
+        LY_TREE_FOR(*first, node) {
+            check_leaf_list_backlinks(node, 0);
+        }
+    }
+
+    /* the same parent flags as lyd_insert() would set */
+    if (((schema->nodetype == LYS_LEAFLIST) && ((struct lys_node_leaflist *)schema)->max)
+            || (parent->schema->flags & LYS_VALID_EXT)) {
+        parent->validity |= LYD_VAL_MAND;
+    }
+    if ((schema->nodetype == LYS_LEAF) && (schema->flags & LYS_UNIQUE)) {
+        for (node = parent; node && (node->schema->nodetype != LYS_LIST); node = node->parent);
+        if (node) {
+            node->validity |= LYD_VAL_UNIQUE;
+        }
+    }
+
+    return 0;
+
+error:
+    pthread_mutex_unlock(&ctx->wd_tpls_lock);
+    while (*first) {
+        node = (*first)->next;
+        lyd_free(*first);
+        *first = node;
+    }
+    return -1;
+}
+
+/**
+ * @brief Get the default values of a leaf or a leaf-list that are used for its implicit default nodes.
+ *
+ * @param[in] schema Leaf or leaf-list schema node.
+ * @param[out] dflt Default values of \p schema.
+ * @return Number of the default values, 0 if there are none.
+ */
+static uint8_t
+lyd_wd_dflt(const struct lys_node *schema, const char ***dflt)
+{
+    struct lys_node_leaf *leaf;
+    struct lys_node_leaflist *llist;
     struct lys_tpdf *tpdf;
-    const char **dflt = NULL;
-    uint8_t dflt_size = 0;
-    int i, ret;
 
+    *dflt = NULL;
+    if (schema->nodetype == LYS_LEAF) {
+        leaf = (struct lys_node_leaf *)schema;
+        if (leaf->dflt) {
+            /* leaf has a default value */
+            *dflt = &leaf->dflt;
+        } else if (!(leaf->flags & LYS_MAND_TRUE)) {
+            /* get the default value from the type */
+            for (tpdf = leaf->type.der; tpdf && !tpdf->dflt; tpdf = tpdf->type.der);
+            if (tpdf) {
+                *dflt = &tpdf->dflt;
+            }
+        }
+        return *dflt ? 1 : 0;
+    }
+
+    llist = (struct lys_node_leaflist *)schema;
     if (llist->module->version < LYS_VERSION_1_1) {
         /* default values on leaf-lists are allowed from YANG 1.1 */
-        return EXIT_SUCCESS;
+        return 0;
     }
-
-    /* get know if there is a default value */
     if (llist->dflt_size) {
         /* there are default values */
-        dflt_size = llist->dflt_size;
-        dflt = llist->dflt;
+        *dflt = llist->dflt;
+        return llist->dflt_size;
     } else if (!llist->min) {
         /* get the default value from the type */
-        for (tpdf = llist->type.der; tpdf && !dflt; tpdf = tpdf->type.der) {
-            if (tpdf->dflt) {
-                dflt = &tpdf->dflt;
-                dflt_size = 1;
+        for (tpdf = llist->type.der; tpdf && !tpdf->dflt; tpdf = tpdf->type.der);
+        if (tpdf) {
+            *dflt = &tpdf->dflt;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* learn whether the default nodes of a leaf(-list) are only virtual in the parent (see #LYD_OPT_VIRTUAL_DFLT) */
+static int
+lyd_wd_tpl_virtual(const struct lyd_node *parent, const struct lys_node *schema, const char **dflt, uint8_t dflt_size)
+{
+    struct ly_ctx *ctx = schema->module->ctx;
+    struct lyd_wd_tpl *tpl;
+    int virt;
+
+    if (lyd_wd_data_parent(schema) != parent->schema) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&ctx->wd_tpls_lock);
+    tpl = lyd_wd_tpl_get(schema, dflt, dflt_size);
+    virt = tpl ? tpl->virt : 0;
+    pthread_mutex_unlock(&ctx->wd_tpls_lock);
+
+    return virt;
+}
+
+/* get the case of a choice that has some instance among the children, NULL if there is none */
+static const struct lys_node *
+lyd_wd_choice_case(const struct lyd_node *parent, const struct lys_node *choice)
+{
+    const struct lyd_node *iter;
+    const struct lys_node *siter, *siter_prev;
+
+    LY_TREE_FOR(parent ? parent->child : NULL, iter) {
+        for (siter = lys_parent(iter->schema), siter_prev = iter->schema;
+                siter && (siter->nodetype & (LYS_CASE | LYS_USES | LYS_CHOICE));
+                siter_prev = siter, siter = lys_parent(siter)) {
+            if (siter == choice) {
+                return siter_prev;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/* learn whether there is an instance of a schema node among the children */
+static int
+lyd_wd_has_instance(const struct lyd_node *parent, const struct lys_node *schema)
+{
+    const struct lyd_node *iter;
+
+    LY_TREE_FOR(parent ? parent->child : NULL, iter) {
+        if (iter->schema == schema) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* append a virtual default node to the others, it only refers to the parent, the parent does not know about it */
+static void
+lyd_wd_virtual_append(const struct lyd_node *parent, struct lyd_node **first, struct lyd_node *node)
+{
+    node->parent = (struct lyd_node *)parent;
+    if (*first) {
+        (*first)->prev->next = node;
+        node->prev = (*first)->prev;
+        (*first)->prev = node;
+    } else {
+        *first = node;
+    }
+}
+
+static int lyd_wd_virtual_children_r(const struct lyd_node *parent, const struct lys_node *sparent,
+                                     struct lyd_node **first);
+
+/* create (or only find out about) the virtual default nodes of a leaf(-list), returns 1 if there are some */
+static int
+lyd_wd_virtual_leaf(const struct lyd_node *parent, const struct lys_node *schema, struct lyd_node **first)
+{
+    struct ly_ctx *ctx = schema->module->ctx;
+    struct lyd_wd_tpl *tpl;
+    struct lyd_node *node;
+    const char **dflt;
+    uint8_t dflt_size, i;
+
+    dflt_size = lyd_wd_dflt(schema, &dflt);
+    if (!dflt_size || lys_is_disabled(schema, 2) || lyd_wd_has_instance(parent, schema)) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&ctx->wd_tpls_lock);
+    tpl = lyd_wd_tpl_get(schema, dflt, dflt_size);
+    if (!tpl || !tpl->virt || !first) {
+        pthread_mutex_unlock(&ctx->wd_tpls_lock);
+        return tpl ? tpl->virt : -1;
+    }
+    for (i = 0; i < dflt_size; ++i) {
+        node = lyd_wd_tpl_node(tpl, i);
+        if (!node) {
+            pthread_mutex_unlock(&ctx->wd_tpls_lock);
+            return -1;
+        }
+        lyd_wd_virtual_append(parent, first, node);
+    }
+    pthread_mutex_unlock(&ctx->wd_tpls_lock);
+
+    return 1;
+}
+
+/* create (or only find out about) a virtual NP container, its children are virtual as well,
+ * when only finding out, returns 1 if there are some virtual default leaves (leaf-lists) in it */
+static int
+lyd_wd_virtual_cont(const struct lyd_node *parent, const struct lys_node *schema, struct lyd_node **first)
+{
+    struct lyd_node *node;
+
+    if (((struct lys_node_container *)schema)->presence || lys_is_disabled(schema, 2) || !lyd_wd_virt_schema(schema)
+            || resolve_applies_when(schema, 0, NULL) || lyd_wd_has_instance(parent, schema)) {
+        return 0;
+    }
+
+    if (!first) {
+        /* an empty container does not matter */
+        return lyd_wd_virtual_children_r(NULL, schema, NULL);
+    }
+
+    node = _lyd_new(NULL, schema, 1);
+    if (!node) {
+        return -1;
+    }
+    /* there is nothing to validate in it */
+    node->validity = LYD_VAL_OK;
+    node->virt = 1;
+    lyd_wd_virtual_append(parent, first, node);
+
+    return 1;
+}
+
+/**
+ * @brief Create (or only find out about) the virtual default nodes in some schema children of a data node.
+ *
+ * @param[in] parent Data node with the virtual default children, NULL for a virtual container.
+ * @param[in] sparent Schema node with the schema children to go through.
+ * @param[in,out] first Created nodes are appended here, NULL if the nodes are only to be found.
+ * @return 0 if there are no virtual nodes, 1 if there are some, -1 on error.
+ */
+static int
+lyd_wd_virtual_children_r(const struct lyd_node *parent, const struct lys_node *sparent, struct lyd_node **first)
+{
+    const struct lys_node *siter, *scase;
+    int ret = 0, r;
+
+    LY_TREE_FOR(sparent->child, siter) {
+        switch (siter->nodetype) {
+        case LYS_USES:
+            r = lyd_wd_virtual_children_r(parent, siter, first);
+            break;
+        case LYS_CHOICE:
+            /* only the instantiated case or the default one */
+            scase = lyd_wd_choice_case(parent, siter);
+            if (!scase) {
+                scase = ((struct lys_node_choice *)siter)->dflt;
+            }
+            if (!scase) {
+                r = 0;
+            } else if (scase->nodetype == LYS_CASE) {
+                r = lyd_wd_virtual_children_r(parent, scase, first);
+            } else if (scase->nodetype & (LYS_LEAF | LYS_LEAFLIST)) {
+                /* shorthand case */
+                r = lyd_wd_virtual_leaf(parent, scase, first);
+            } else if (scase->nodetype == LYS_CONTAINER) {
+                r = lyd_wd_virtual_cont(parent, scase, first);
+            } else {
+                r = 0;
+            }
+            break;
+        case LYS_LEAF:
+        case LYS_LEAFLIST:
+            r = lyd_wd_virtual_leaf(parent, siter, first);
+            break;
+        case LYS_CONTAINER:
+            r = lyd_wd_virtual_cont(parent, siter, first);
+            break;
+        default:
+            /* other nodes do not have default values */
+            r = 0;
+            break;
+        }
+
+        if (r == -1) {
+            return -1;
+        } else if (r) {
+            ret = 1;
+            if (!first) {
+                /* we are only looking for any */
                 break;
             }
         }
     }
 
+    return ret;
+}
+
+int
+lyd_wd_virtual_children(const struct lyd_node *parent, struct lyd_node **first)
+{
+    int ret;
+
+    if (first) {
+        *first = NULL;
+    }
+    if (!parent->virt || !(parent->schema->nodetype & (LYS_CONTAINER | LYS_LIST))) {
+        return 0;
+    }
+
+    ret = lyd_wd_virtual_children_r(parent, parent->schema, first);
+    if ((ret == -1) && first) {
+        lyd_wd_virtual_free(*first);
+        *first = NULL;
+    }
+    return ret;
+}
+
+void
+lyd_wd_virtual_free(struct lyd_node *first)
+{
+    struct lyd_node *iter;
+
+    /* disconnect them from the parent so that it is not modified */
+    LY_TREE_FOR(first, iter) {
+        iter->parent = NULL;
+    }
+    lyd_free_withsiblings(first);
+}
+
+int
+lyd_wd_virtual_create(struct lyd_node *parent)
+{
+    struct lyd_node *first, *node;
+
+    if (lyd_wd_virtual_children(parent, &first) == -1) {
+        return EXIT_FAILURE;
+    }
+    parent->virt = 0;
+
+    /* connect them one by one as the last children of the parent, they were already validated as a part of it */
+    while (first) {
+        node = first;
+        first = node->next;
+        if (first) {
+            first->prev = node->prev;
+        }
+        node->next = NULL;
+        node->validity = LYD_VAL_OK;
+
+        if (parent->child) {
+            parent->child->prev->next = node;
+            node->prev = parent->child->prev;
+            parent->child->prev = node;
+        } else {
+            parent->child = node;
+            node->prev = node;
+        }
+#ifdef LY_ENABLED_CACHE
+        if (!node->hash) {
+            lyd_hash(node);
+        }
+        lyd_insert_hash(node);
+#endif
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int
+lyd_wd_add_leaf(struct lyd_node **tree, struct lyd_node *last_parent, struct lys_node_leaf *leaf, struct unres_data *unres,
+                int check_when_must, int virt)
+{
+    struct lyd_node *dummy = NULL, *current;
+    const char **dflt;
+    int ret;
+
+    /* get know if there is a default value */
+    if (!lyd_wd_dflt((struct lys_node *)leaf, &dflt)) {
+        /* no default value */
+        return EXIT_SUCCESS;
+    }
+
+    if (virt && last_parent && lyd_wd_tpl_virtual(last_parent, (struct lys_node *)leaf, dflt, 1)) {
+        /* the node is only virtual */
+        last_parent->virt = 1;
+        return EXIT_SUCCESS;
+    }
+
+    /* create the node, from the template if possible */
+    ret = last_parent ? lyd_wd_tpl_stamp(last_parent, (struct lys_node *)leaf, dflt, 1, &dummy) : 1;
+    if (ret == -1) {
+        return EXIT_FAILURE;
+    } else if ((ret == 1) && !(dummy = lyd_new_dummy(*tree, last_parent, (struct lys_node*)leaf, dflt[0], 1))) {
+        goto error;
+    }
+
+    if (unres->store_diff) {
+        /* remember this subtree in the diff */
+        if (unres_data_diff_new(unres, dummy, NULL, 1)) {
+            goto error;
+        }
+    }
+
+    if (!dummy->parent && (*tree)) {
+        /* connect dummy nodes into the data tree (at the end of top level nodes) */
+        if (lyd_insert_sibling(tree, dummy)) {
+            goto error;
+        }
+    }
+    for (current = dummy; ; current = current->child) {
+        /* remember the created data in unres */
+        if (check_when_must) {
+            if ((current->when_status & LYD_WHEN) && unres_data_add(unres, current, UNRES_WHEN) == -1) {
+                goto error;
+            }
+            if (check_when_must == 2) {
+                ret = resolve_applies_must(current);
+                if ((ret & 0x1) && (unres_data_add(unres, current, UNRES_MUST) == -1)) {
+                    goto error;
+                }
+                if ((ret & 0x2) && (unres_data_add(unres, current, UNRES_MUST_INOUT) == -1)) {
+                    goto error;
+                }
+            }
+        }
+
+        /* clear dummy-node flag */
+        current->validity &= ~LYD_VAL_INUSE;
+
+        if (current->schema == (struct lys_node *)leaf) {
+            break;
+        }
+    }
+    /* update parent's default flag if needed */
+    lyd_wd_update_parents(dummy);
+
+    /* if necessary, remember the created data value in unres */
+    if (((struct lyd_node_leaf_list *)current)->value_type == LY_TYPE_LEAFREF) {
+        if (unres_data_add(unres, current, UNRES_LEAFREF)) {
+            goto error;
+        }
+    } else if (((struct lyd_node_leaf_list *)current)->value_type == LY_TYPE_INST) {
+        if (unres_data_add(unres, current, UNRES_INSTID)) {
+            goto error;
+        }
+    }
+
+    if (!(*tree)) {
+        *tree = dummy;
+    }
+    return EXIT_SUCCESS;
+
+error:
+    lyd_free(dummy);
+    return EXIT_FAILURE;
+}
+
+static int
+lyd_wd_add_leaflist(struct lyd_node **tree, struct lyd_node *last_parent, struct lys_node_leaflist *llist,
+                    struct unres_data *unres, int check_when_must, int virt)
+{
+    struct lyd_node *dummy, *current, *first = NULL;
+    const char **dflt;
+    uint8_t dflt_size;
+    int i, ret, stamped;
+
+    /* get know if there is a default value */
+    dflt_size = lyd_wd_dflt((struct lys_node *)llist, &dflt);
     if (!dflt_size) {
         /* no default values to use */
         return EXIT_SUCCESS;
     }
 
+    if (virt && last_parent && lyd_wd_tpl_virtual(last_parent, (struct lys_node *)llist, dflt, dflt_size)) {
+        /* the nodes are only virtual */
+        last_parent->virt = 1;
+        return EXIT_SUCCESS;
+    }
+
+    /* create all the nodes at once from the template if possible */
+    stamped = last_parent ? lyd_wd_tpl_stamp(last_parent, (struct lys_node *)llist, dflt, dflt_size, &dummy) : 1;
+    if (stamped == -1) {
+        return EXIT_FAILURE;
+    }
+
     for (i = 0; i < dflt_size; i++) {
         /* create the node */
-        if (!(dummy = lyd_new_dummy(*tree, last_parent, (struct lys_node*)llist, dflt[i], 1))) {
+        if (!stamped) {
+            dummy = i ? dummy->next : dummy;
+        } else if (!(dummy = lyd_new_dummy(*tree, last_parent, (struct lys_node*)llist, dflt[i], 1))) {
             goto error;
         }
 
@@ -7166,8 +8759,8 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
 {
     struct ly_set *present = NULL;
     struct lys_node *siter, *siter_prev;
-    struct lyd_node *iter;
-    int i, check_when_must, storing_diff = 0;
+    struct lyd_node *iter, *virt_cont = NULL;
+    int i, check_when_must, virt, storing_diff = 0;
 
     assert(root);
 
@@ -7183,6 +8776,8 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
     } else {
         check_when_must = 2; /* check both when and must */
     }
+    /* the virtual default nodes only in complete datastores */
+    virt = (options & LYD_OPT_VIRTUAL_DFLT) && !(options & LYD_OPT_TYPEMASK & ~LYD_OPT_CONFIG);
 
     if (toplevel && (schema->nodetype & (LYS_LEAF | LYS_LIST | LYS_LEAFLIST | LYS_CONTAINER))) {
         /* search for the schema node instance */
@@ -7259,6 +8854,12 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
             /* useless to set mand flag */
             subroot->validity &= ~LYD_VAL_MAND;
 
+            if (virt && last_parent && !unres->store_diff && !(subroot->when_status & LYD_WHEN)
+                    && lyd_wd_virt_schema(schema)) {
+                /* it can be virtual if all its children are */
+                virt_cont = subroot;
+            }
+
             if (unres->store_diff) {
                 /* remember this container in the diff */
                 if (unres_data_diff_new(unres, subroot, NULL, 1)) {
@@ -7298,6 +8899,13 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
             /* fix default flag on existing containers - set it on all non-presence containers and in case we will
              * have in recursion function some non-default node, it will unset it */
             subroot->dflt = 1;
+#ifdef LY_ENABLED_CACHE
+            lyd_digest_invalidate(subroot);
+#endif
+        }
+        if (!virt) {
+            /* all the default nodes are created */
+            subroot->virt = 0;
         }
         /* falls through */
     case LYS_CASE:
@@ -7343,6 +8951,9 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
                                 for (iter = subroot; iter && iter->dflt; iter = iter->parent) {
                                     iter->dflt = 0;
                                 }
+#ifdef LY_ENABLED_CACHE
+                                lyd_digest_invalidate(subroot);
+#endif
                                 break;
                             }
                         }
@@ -7361,6 +8972,11 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
             /* continue generating the diff in functions above this one */
             unres->store_diff = 1;
         }
+        if (virt_cont && !virt_cont->child) {
+            /* there is nothing in the created container, it is only virtual */
+            virt_cont->parent->virt = 1;
+            lyd_free(virt_cont);
+        }
         break;
     case LYS_LEAF:
     case LYS_LEAFLIST:
@@ -7377,11 +8993,12 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
             }
         }
         if (schema->nodetype == LYS_LEAF) {
-            if (lyd_wd_add_leaf(root, last_parent, (struct lys_node_leaf*)schema, unres, check_when_must)) {
+            if (lyd_wd_add_leaf(root, last_parent, (struct lys_node_leaf*)schema, unres, check_when_must, virt)) {
                 return EXIT_FAILURE;
             }
         } else { /* LYS_LEAFLIST */
-            if (lyd_wd_add_leaflist(root, last_parent, (struct lys_node_leaflist*)schema, unres, check_when_must)) {
+            if (lyd_wd_add_leaflist(root, last_parent, (struct lys_node_leaflist*)schema, unres, check_when_must,
+                                    virt)) {
                 goto error;
             }
         }
@@ -181,6 +181,8 @@ struct lyd_node {
     uint8_t dflt:1;                  /**< flag for implicit default node */
     uint8_t when_status:3;           /**< bit for checking if the when-stmt condition is resolved - internal use only,
                                           do not use this value! */
+    uint8_t virt:1;                  /**< flag for virtual implicit default children (see #LYD_OPT_VIRTUAL_DFLT) -
+                                          internal use only, do not use this value! */
 
     struct lyd_attr *attr;           /**< pointer to the list of attributes of this node */
     struct lyd_node *next;           /**< pointer to the next sibling node (NULL if there is no one) */
@@ -204,6 +206,14 @@ struct lyd_node {
                                           is replaced in those structures. Therefore, be careful with accessing
                                           this member without having information about the node type from the schema's
                                           ::lys_node#nodetype member. */
+
+#ifdef LY_ENABLED_CACHE
+    struct lyd_uniq_idx *uniq;       /**< indexes of the unique statement values of the list instances in the tree,
+                                          set only in its root - internal use only, do not use this value! */
+    uint64_t digest;                 /**< stored digest of the whole subtree, 0 if not computed - internal use only,
+                                          do not use this value, use lyd_digest()! It is the last member and it is not
+                                          present in the end nodes structures */
+#endif
 };
 
 /**
@@ -437,6 +447,24 @@ struct lyd_difflist *lyd_diff(struct lyd_node *first, struct lyd_node *second, i
                                              explicit default nodes. */
 /**@} diffoptions */
 
+/**
+ * @brief Get the digest of a data subtree content.
+ *
+ * The digest covers the schema nodes, values and default flags of the whole subtree and the order of the user-ordered
+ * (leaf-)list instances, the attributes are not covered. Two subtrees with a different content have a different
+ * digest (except for the negligible probability of a 64b collision), so it can be used to check whether two data
+ * trees (in possibly different contexts) are the same by comparing their digests. Anydata and anyxml nodes with
+ * other than string values are covered by their identity, so the subtrees including them are never the same.
+ *
+ * With the cache enabled (ENABLE_CACHE build option), digests of the inner nodes are stored in the data tree and
+ * only the ones on the path to a modified node are computed again. lyd_diff() and lyd_merge() use them to skip
+ * identical subtrees. Otherwise, the digest is always computed from the whole subtree.
+ *
+ * @param[in] node Root of the subtree.
+ * @return Digest of the subtree, 0 on error.
+ */
+uint64_t lyd_digest(struct lyd_node *node);
+
 /**
  * @brief Build data path (usable as path, see @ref howtoxpath) of the data node.
  * @param[in] node Data node to be processed. Note that the node should be from a complete data tree, having a subtree
@@ -534,6 +562,15 @@ char *lyd_path(const struct lyd_node *node);
                                               preserved and option is ignored. */
 #define LYD_OPT_VAL_DIFF 0x40000 /**< Flag only for validation, store all the data node changes performed by the validation
                                       in a diff structure. */
+#define LYD_OPT_VIRTUAL_DFLT 0x80000 /**< Do not create the implicit default leaves, leaf-lists and non-presence
+                                          containers without when and must conditions (and not part of a unique
+                                          statement) in the data tree, they are only virtual. They are created once
+                                          they are looked up by XPath (also when evaluating when and must
+                                          conditions), lyd_find_path() or lyd_find_instance(), so these functions
+                                          then modify the data tree. The printers print them in the #LYP_WD_ALL,
+                                          #LYP_WD_ALL_TAG and #LYP_WD_IMPL_TAG modes (and always in LYB) without
+                                          creating them. Applicable only in combination with #LYD_OPT_DATA and
+                                          #LYD_OPT_CONFIG flags. */
 #define LYD_OPT_DATA_TEMPLATE 0x1000000 /**< Data represents YANG data template. */
 
 /**@} parseroptions */
@@ -955,6 +992,19 @@ struct lyd_node *lyd_dup_withsiblings(const struct lyd_node *node, int options);
  */
 struct lyd_node *lyd_dup_to_ctx(const struct lyd_node *node, int options, struct ly_ctx *ctx);
 
+struct ly_ctx_schema_map;
+
+/**
+ * @brief Same as lyd_dup_to_ctx(), but the schema nodes are translated using a schema map, which is faster
+ * when data are repeatedly moved between the same contexts.
+ *
+ * @param[in] node Data tree node to be duplicated.
+ * @param[in] options Bitmask of options flags, see @ref dupoptions.
+ * @param[in] map Schema map created by ly_ctx_schema_map_new(), its target context is the context of the copy.
+ * @return Created copy of the provided data \p node.
+ */
+struct lyd_node *lyd_dup_to_ctx_map(const struct lyd_node *node, int options, struct ly_ctx_schema_map *map);
+
 /**
  * @brief Merge a (sub)tree into a data tree.
  *
@@ -973,7 +1023,8 @@ struct lyd_node *lyd_dup_to_ctx(const struct lyd_node *node, int options, struct
  * @param[in] target Top-level (or an RPC output child) data tree to merge to. Must be valid.
  * @param[in] source Data tree to merge \p target with. Must be valid (at least as a subtree).
  * @param[in] options Bitmask of the following option flags:
- * - #LYD_OPT_DESTRUCT - spend \p source in the function, otherwise \p source is left untouched,
+ * - #LYD_OPT_DESTRUCT - spend \p source in the function, otherwise \p source is left untouched, the \p source
+ * subtrees missing in \p target are then moved into it instead of being duplicated,
  * - #LYD_OPT_NOSIBLINGS - merge only the \p source subtree (ignore siblings), otherwise merge
  * \p source and all its succeeding siblings (preceeding ones are still ignored!),
  * - #LYD_OPT_EXPLICIT - when merging an explicitly set node and a default node, always put
@@ -1004,6 +1055,20 @@ int lyd_merge(struct lyd_node *target, const struct lyd_node *source, int option
  */
 int lyd_merge_to_ctx(struct lyd_node **trg, const struct lyd_node *src, int options, struct ly_ctx *ctx);
 
+/**
+ * @brief Same as lyd_merge_to_ctx(), but the schema nodes are translated using a schema map, which is faster
+ * when data are repeatedly moved between the same contexts.
+ *
+ * __PARTIAL CHANGE__ - validate after the final change on the data tree (see @ref howtodatamanipulators).
+ *
+ * @param[in] trg Top-level (or an RPC output child) data tree to merge to, see lyd_merge_to_ctx().
+ * @param[in] src Data tree to merge \p target with. Must be valid (at least as a subtree).
+ * @param[in] options Bitmask of the option flags, see lyd_merge_to_ctx().
+ * @param[in] map Schema map created by ly_ctx_schema_map_new(), its target context is the context of the result.
+ * @return 0 on success, nonzero in case of an error.
+ */
+int lyd_merge_to_ctx_map(struct lyd_node **trg, const struct lyd_node *src, int options, struct ly_ctx_schema_map *map);
+
 #define LYD_OPT_EXPLICIT 0x0100
 
 /**
@@ -1144,6 +1209,73 @@ struct ly_set *lyd_find_path(const struct lyd_node *ctx_node, const char *path);
  */
 struct ly_set *lyd_find_instance(const struct lyd_node *data, const struct lys_node *schema);
 
+/**
+ * @brief Set of XPath filters compiled for repeated matching of data trees and their changes,
+ * for example subscription filters evaluated on every notification or datastore change.
+ *
+ * The filters are indexed by the schema nodes they can select so that matching a data tree is a single pass
+ * through it, no matter the number of filters. Filters that are plain location paths are decided by the presence
+ * of their nodes only, filters with predicates are evaluated only if their nodes are present, and any other
+ * expressions are always evaluated.
+ */
+struct lyd_xpath_filters;
+
+/**
+ * @brief Create a new empty set of XPath filters.
+ *
+ * @param[in] ctx Context of all the matched data.
+ * @return Created filter set, NULL on error.
+ */
+struct lyd_xpath_filters *lyd_xpath_filters_new(struct ly_ctx *ctx);
+
+/**
+ * @brief Add an XPath filter into a filter set.
+ *
+ * @param[in] filters Filter set to add to.
+ * @param[in] xpath Absolute XPath expression in the format of lyd_find_path(), the first node must be prefixed.
+ * @param[in] priv User pointer identifying the filter (subscription) returned on a match. Several filters
+ * can share the same pointer and match as their union.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+int lyd_xpath_filters_add(struct lyd_xpath_filters *filters, const char *xpath, void *priv);
+
+/**
+ * @brief Remove all the XPath filters with a user pointer from a filter set.
+ *
+ * @param[in] filters Filter set to remove from.
+ * @param[in] priv User pointer of the filters to remove.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if no such filter was found.
+ */
+int lyd_xpath_filters_remove(struct lyd_xpath_filters *filters, void *priv);
+
+/**
+ * @brief Free a filter set.
+ *
+ * @param[in] filters Filter set to free.
+ */
+void lyd_xpath_filters_free(struct lyd_xpath_filters *filters);
+
+/**
+ * @brief Find all the filters matching a data tree (such as a notification). A filter matches if it selects
+ * a node or if its result cast to boolean is true.
+ *
+ * @param[in] filters Filter set.
+ * @param[in] data Any node of the data tree, all the top-level siblings are always matched.
+ * @return Set of the user pointers of the matching filters, NULL on error.
+ */
+struct ly_set *lyd_xpath_filters_match(struct lyd_xpath_filters *filters, const struct lyd_node *data);
+
+/**
+ * @brief Find all the filters matching changes between two data trees. A filter matches a change if
+ * it selects the changed node, any of its ancestors or descendants, or if it is not a node-set
+ * and its result cast to boolean is true on the tree of the change.
+ *
+ * @param[in] filters Filter set.
+ * @param[in] diff Changes as returned by lyd_diff(), both the trees must still exist.
+ * @return Set of the user pointers of the matching filters, NULL on error.
+ */
+struct ly_set *lyd_xpath_filters_match_diff(struct lyd_xpath_filters *filters, const struct lyd_difflist *diff);
+
 /**
  * @brief Get the first sibling of the given node.
  *
@@ -1333,6 +1465,16 @@ struct lys_module *lyd_node_module(const struct lyd_node *node);
  */
 const struct lys_type *lyd_leaf_type(const struct lyd_node_leaf_list *leaf);
 
+/**
+ * @brief Set the number of threads used for printing data with #LYP_PARALLEL.
+ *
+ * The setting is global for all the contexts. Like the flag itself, it is experimental.
+ *
+ * @param[in] threads Number of the printing threads, 0 (default) for a thread per online CPU.
+ * @return Previous number of the printing threads.
+ */
+uint16_t lyd_print_threads(uint16_t threads);
+
 /**
 * @brief Print data tree in the specified format.
 *
@@ -1340,7 +1482,7 @@ const struct lys_type *lyd_leaf_type(const struct lyd_node_leaf_list *leaf);
 * @param[in] root Root node of the data tree to print. It can be actually any (not only real root)
 * node of the data tree to print the specific subtree.
 * @param[in] format Data output format.
-* @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS option.
+* @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS and LYP_LYB_* options.
 * @return 0 on success, 1 on failure (#ly_errno is set).
 */
 int lyd_print_mem(char **strp, const struct lyd_node *root, LYD_FORMAT format, int options);
@@ -1352,7 +1494,7 @@ int lyd_print_mem(char **strp, const struct lyd_node *root, LYD_FORMAT format, i
  * @param[in] root Root node of the data tree to print. It can be actually any (not only real root)
  * node of the data tree to print the specific subtree.
  * @param[in] format Data output format.
- * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS option.
+ * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS and LYP_LYB_* options.
  * @return 0 on success, 1 on failure (#ly_errno is set).
  */
 int lyd_print_fd(int fd, const struct lyd_node *root, LYD_FORMAT format, int options);
@@ -1364,7 +1506,7 @@ int lyd_print_fd(int fd, const struct lyd_node *root, LYD_FORMAT format, int opt
  * @param[in] root Root node of the data tree to print. It can be actually any (not only real root)
  * node of the data tree to print the specific subtree.
  * @param[in] format Data output format.
- * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS option.
+ * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS and LYP_LYB_* options.
  * @return 0 on success, 1 on failure (#ly_errno is set).
  */
 int lyd_print_file(FILE *f, const struct lyd_node *root, LYD_FORMAT format, int options);
@@ -1376,7 +1518,7 @@ int lyd_print_file(FILE *f, const struct lyd_node *root, LYD_FORMAT format, int
  * @param[in] root Root node of the data tree to print. It can be actually any (not only real root)
  * node of the data tree to print the specific subtree.
  * @param[in] format Data output format.
- * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS option.
+ * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS and LYP_LYB_* options.
  * @return 0 on success, 1 on failure (#ly_errno is set).
  */
 int lyd_print_path(const char *path, const struct lyd_node *root, LYD_FORMAT format, int options);
@@ -1389,7 +1531,7 @@ int lyd_print_path(const char *path, const struct lyd_node *root, LYD_FORMAT for
  * node of the data tree to print the specific subtree.
  * @param[in] arg Optional caller-specific argument to be passed to the \p writeclb callback.
  * @param[in] format Data output format.
- * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS option.
+ * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS and LYP_LYB_* options.
  * @return 0 on success, 1 on failure (#ly_errno is set).
  */
 int lyd_print_clb(ssize_t (*writeclb)(void *arg, const void *buf, size_t count), void *arg,
@@ -77,17 +77,88 @@ struct lyb_state {
     int mod_count;
     struct ly_ctx *ctx;
 
+    /* streamed variant of the format, only the innermost written counter is used */
+    int stream;
+
+    /* string table used, strings in the data can be references into it, the parser stores the table strings
+     * and the printer all the strings in the order of their first occurrence */
+    int str_table;
+    const char **strs;
+    uint32_t str_count;
+
+    /* payload compressed in blocks */
+    int compress;
+
+    /* LYB parser only */
+    uint8_t version;
+
     /* LYB printer only */
     struct {
         struct lys_node *first_sibling;
         struct hash_table *ht;
     } *sib_ht;
     int sib_ht_count;
+
+    /* LYB streamed printer only, output buffer and the position of the open data chunk header in it */
+    uint8_t *buf;
+    size_t buf_len;
+    size_t buf_size;
+    size_t chunk_pos;
+    int chunk_open;
+
+    /* LYB printer only, string occurrence counts and table indices */
+    struct hash_table *str_ht;
+
+    /* LYB printer only, buffer for a compressed block */
+    uint8_t *zbuf;
 };
 
 /* struct lyb_state allocation step */
 #define LYB_STATE_STEP 4
 
+/* LYB format version written in the header, version 0 used a different schema node hash function */
+#define LYB_VERSION_NUM 0x01
+
+/* Header bits with the LYB format version */
+#define LYB_VERSION_MASK 0x0f
+
+/* Header flag of the streamed variant of the format, subtrees are not prefixed by their size but data are split into
+ * chunks each with a header byte, which is either the size of the chunk or one of the following tags */
+#define LYB_HEADER_STREAM 0x10
+
+/* Streamed variant, end of the current subtree */
+#define LYB_STREAM_END 0x00
+
+/* Streamed variant, start of a nested subtree (or a top-level subtree, attribute) */
+#define LYB_STREAM_SUBTREE 0xFF
+
+/* Streamed variant, maximum size of a single data chunk */
+#define LYB_STREAM_CHUNK_MAX 0xFE
+
+/* Streamed variant, size of the printer output buffer */
+#define LYB_STREAM_BUF_SIZE 4096
+
+/* Header flag of a string table following the models, the strings in the data are prefixed with a reference into it
+ * (the string index + 1) or 0 if the string itself follows */
+#define LYB_HEADER_STRINGS 0x20
+
+/* Header flag of compressed payload, everything following the header is split into blocks each with the raw and
+ * compressed size (2B each, the same sizes mean the block is not compressed) and ends with zero raw size */
+#define LYB_HEADER_COMPRESS 0x40
+
+/* Maximum raw size of a compressed block */
+#define LYB_BLOCK_SIZE 0x8000
+
+/* Size of a compressed block header */
+#define LYB_BLOCK_HEADER_BYTES 4
+
+/* Block compression is LZ4-like, matches are at least 4 bytes long */
+#define LYB_LZ_MIN_MATCH 4
+
+/* Block compression, the last literals of a block and the minimal distance of the last match from the block end */
+#define LYB_LZ_LAST_LITERALS 5
+#define LYB_LZ_MF_LIMIT 12
+
 /**
  * LYB schema hash constants
  *
@@ -131,6 +202,9 @@ struct lyb_state {
 
 LYB_HASH lyb_hash(struct lys_node *sibling, uint8_t collision_id);
 
+/* Schema node hash as used in LYB version 0 data, they were computed with a different function */
+LYB_HASH lyb_hash_v0(struct lys_node *sibling, uint8_t collision_id);
+
 int lyb_has_schema_model(struct lys_node *sibling, const struct lys_module **models, int mod_count);
 
 /**
@@ -153,6 +227,24 @@ int lyb_has_schema_model(struct lys_node *sibling, const struct lys_module **mod
  */
 #define LY_VALUE_UNRESGRP 0x80
 
+/**
+ * @brief Type flag for a type instantiated from a grouping sharing its restrictions, enums, or bits
+ * with the grouping type, which owns them.
+ */
+#define LY_VALUE_SHARED 0x40
+
+/**
+ * @brief Type flag for a union member type whose patterns never match a value with a colon,
+ * such values are not even tried to be parsed as this type.
+ */
+#define LY_VALUE_NOCOLON 0x20
+
+/**
+ * @brief Internal validity flag for a node matched in lyd_diff() whose subtree is the same in both trees,
+ * always set together with #LYD_VAL_INUSE.
+ */
+#define LYD_VAL_INUSE_SAME 0x40
+
 #ifdef LY_ENABLED_CACHE
 
 /**
@@ -160,11 +252,26 @@ int lyb_has_schema_model(struct lys_node *sibling, const struct lys_module **mod
  */
 #   define LY_CACHE_HT_MIN_CHILDREN 4
 
+/**
+ * @brief Minimum number of items in a ::ly_set for it to create a hash table of its items.
+ */
+#   define LY_CACHE_SET_HT_MIN_ITEMS 16
+
+/**
+ * @brief Item stored in a ::ly_set hash table.
+ */
+struct ly_set_hash_item {
+    void *item;                      /**< pointer stored in the set */
+    unsigned int idx;                /**< index of the item in the set array */
+};
+
     int lyd_hash(struct lyd_node *node);
 
     void lyd_insert_hash(struct lyd_node *node);
 
     void lyd_unlink_hash(struct lyd_node *node, struct lyd_node *orig_parent);
+
+    void lyd_digest_invalidate(struct lyd_node *node);
 #endif
 
 /**
@@ -222,6 +329,29 @@ void lys_submodule_free(struct lys_submodule *submodule, void (*private_destruct
  */
 int lys_node_addchild(struct lys_node *parent, struct lys_module *module, struct lys_node *child, int options);
 
+#ifdef LY_ENABLED_CACHE
+
+/**
+ * @brief Get the hash of the module and name of a schema node, the common prefix of the hashes of all its data instances.
+ *
+ * @param[in] node Schema node that can be instantiated in data.
+ * @return Data hash of the node.
+ */
+uint32_t lys_data_hash(const struct lys_node *node);
+
+#endif
+
+/**
+ * @brief Invalidate the if-feature state cached in all the schema nodes of a context
+ * and its cached ietf-yang-library data.
+ *
+ * Must be called whenever a feature is enabled or disabled or the module set of the context
+ * (including the conformance of a module) changes.
+ *
+ * @param[in] ctx Context with the schema nodes.
+ */
+void lys_iffeature_cache_invalidate(struct ly_ctx *ctx);
+
 /**
  * @brief Find a valid grouping definition relative to a node.
  *
@@ -323,6 +453,50 @@ void lys_extension_instances_free(struct ly_ctx *ctx, struct lys_ext_instance **
  */
 int lys_leaf_add_leafref_target(struct lys_node_leaf *leafref_target, struct lys_node *leafref);
 
+struct lyxp_set;
+
+/**
+ * @brief Reverse XPath dependency record of a schema node, stored in the context.
+ */
+struct lys_xpath_dep {
+    const struct lys_node *node;    /**< schema node the record belongs to */
+    struct ly_set *dependents;      /**< nodes with must/when expressions reading the node */
+    struct ly_set *targets;         /**< nodes read by the must/when expressions of the node */
+};
+
+/**
+ * @brief Store the schema nodes read by the must/when expressions of \p node into the context
+ * dependency graph, replacing any previously stored ones.
+ *
+ * @param[in] node Node with the expressions.
+ * @param[in] set Atomized expressions of \p node as returned by lyxp_node_atomize().
+ * @return 0 on success, -1 on error.
+ */
+int lys_xpath_dep_store(const struct lys_node *node, const struct lyxp_set *set);
+
+/**
+ * @brief Get the nodes with must/when expressions reading \p node.
+ *
+ * @param[in] node Schema node to examine.
+ * @return Internal set of the dependent nodes (do not modify), NULL if there are none.
+ */
+struct ly_set *lys_xpath_dep_get(const struct lys_node *node);
+
+/**
+ * @brief Remove a schema node being freed from the context dependency graph.
+ *
+ * @param[in] ctx Context of the node.
+ * @param[in] node Node to remove.
+ */
+void lys_xpath_dep_remove(struct ly_ctx *ctx, const struct lys_node *node);
+
+/**
+ * @brief Free the whole context dependency graph.
+ *
+ * @param[in] ctx Context to use.
+ */
+void lys_xpath_dep_free_all(struct ly_ctx *ctx);
+
 /**
  * @brief Free a schema when condition
  *
@@ -421,6 +595,41 @@ struct lyd_node *_lyd_new(struct lyd_node *parent, const struct lys_node *schema
 struct lyd_node *lyd_new_dummy(struct lyd_node *data, struct lyd_node *parent, const struct lys_node *schema,
                                const char *value, int dflt);
 
+/**
+ * @brief Free all the default node templates of a context. Does not access any schema nodes
+ * so it can be called even after the modules were freed.
+ *
+ * @param[in] ctx Context with the templates.
+ */
+void lyd_wd_tpl_free_all(struct ly_ctx *ctx);
+
+/**
+ * @brief Create the virtual default children of a data node (see #LYD_OPT_VIRTUAL_DFLT). The created nodes
+ * refer to \p parent, but they are not its children, free them with lyd_wd_virtual_free(). The created
+ * containers have virtual children of their own.
+ *
+ * @param[in] parent Container or list data node.
+ * @param[out] first First of the created nodes, NULL if there are none. If not set, the nodes are not
+ * created, only the existence of some default leaves or leaf-lists (even in virtual containers) is learned.
+ * @return 1 if there are some virtual default children, 0 if there are none, -1 on error.
+ */
+int lyd_wd_virtual_children(const struct lyd_node *parent, struct lyd_node **first);
+
+/**
+ * @brief Free the virtual default nodes created by lyd_wd_virtual_children() without modifying their parent.
+ *
+ * @param[in] first First of the virtual default nodes.
+ */
+void lyd_wd_virtual_free(struct lyd_node *first);
+
+/**
+ * @brief Create the virtual default children of a data node in the data tree, once they are looked up.
+ *
+ * @param[in] parent Data node with the ::lyd_node#virt flag.
+ * @return EXIT_SUCCESS or EXIT_FAILURE.
+ */
+int lyd_wd_virtual_create(struct lyd_node *parent);
+
 /**
  * @brief Find the parent node of an attribute.
  *
@@ -493,6 +702,15 @@ int lys_get_sibling(const struct lys_node *siblings, const char *mod_name, int m
 int lys_getnext_data(const struct lys_module *mod, const struct lys_node *parent, const char *name, int nam_len,
                      LYS_NODE type, int getnext_opts, const struct lys_node **ret);
 
+/**
+ * @brief Find the schema node corresponding to \p schema in another context. Does not log.
+ *
+ * @param[in] schema Schema node to find.
+ * @param[in] ctx Context to search in, NULL for the context of \p schema.
+ * @return Found schema node, NULL if there is none.
+ */
+struct lys_node *lys_get_schema_inctx(struct lys_node *schema, struct ly_ctx *ctx);
+
 int lyd_get_unique_default(const char* unique_expr, struct lyd_node *list, const char **dflt);
 
 int lyd_build_relative_data_path(const struct lys_module *module, const struct lyd_node *node, const char *schema_id,
@@ -42,7 +42,7 @@
 #include "parser_yang.h"
 
 static int lys_type_dup(struct lys_module *mod, struct lys_node *parent, struct lys_type *new, struct lys_type *old,
-                        int in_grp, int shallow, struct unres_schema *unres);
+                        int in_grp, int shallow, int share, struct unres_schema *unres);
 
 API const struct lys_node_list *
 lys_is_key(const struct lys_node_leaf *node, uint8_t *index)
@@ -75,6 +75,90 @@ lys_is_key(const struct lys_node_leaf *node, uint8_t *index)
     return NULL;
 }
 
+void
+lys_iffeature_cache_invalidate(struct ly_ctx *ctx)
+{
+    /* the epoch is stored shifted in the nodes, 0 is the epoch of new nodes and is never valid */
+    ctx->feature_epoch = (ctx->feature_epoch + 1) & (UINT32_MAX >> 1);
+    if (!ctx->feature_epoch) {
+        ctx->feature_epoch = 1;
+    }
+}
+
+/* the if-feature cache is the last member of the structures of the nodes that can have if-features */
+static uint32_t *
+lys_node_iffeat_cache_p(struct lys_node *node)
+{
+    switch (node->nodetype) {
+    case LYS_CONTAINER:
+        return &((struct lys_node_container *)node)->iffeat_cache;
+    case LYS_CHOICE:
+        return &((struct lys_node_choice *)node)->iffeat_cache;
+    case LYS_LEAF:
+        return &((struct lys_node_leaf *)node)->iffeat_cache;
+    case LYS_LEAFLIST:
+        return &((struct lys_node_leaflist *)node)->iffeat_cache;
+    case LYS_LIST:
+        return &((struct lys_node_list *)node)->iffeat_cache;
+    case LYS_ANYXML:
+    case LYS_ANYDATA:
+        return &((struct lys_node_anydata *)node)->iffeat_cache;
+    case LYS_USES:
+        return &((struct lys_node_uses *)node)->iffeat_cache;
+    case LYS_CASE:
+        return &((struct lys_node_case *)node)->iffeat_cache;
+    case LYS_NOTIF:
+        return &((struct lys_node_notif *)node)->iffeat_cache;
+    case LYS_RPC:
+    case LYS_ACTION:
+        return &((struct lys_node_rpc_action *)node)->iffeat_cache;
+    case LYS_AUGMENT:
+        return &((struct lys_node_augment *)node)->iffeat_cache;
+    default:
+        return NULL;
+    }
+}
+
+/* evaluate the if-features of a node, the result is cached in the node until the feature epoch changes,
+ * the cache is accessed atomically because the nodes are read concurrently */
+static int
+lys_iffeature_disabled(struct lys_node *node)
+{
+    struct ly_ctx *ctx = node->module->ctx;
+    uint32_t *cache_p, cache = 0;
+    int i, disabled = 0;
+
+    cache_p = lys_node_iffeat_cache_p(node);
+    if (cache_p) {
+#ifdef __GNUC__
+        cache = __atomic_load_n(cache_p, __ATOMIC_RELAXED);
+#else
+        cache = *cache_p;
+#endif
+        if ((cache >> 1) == ctx->feature_epoch) {
+            return cache & 1;
+        }
+    }
+
+    for (i = 0; i < node->iffeature_size; i++) {
+        if (!resolve_iffeature(&node->iffeature[i])) {
+            disabled = 1;
+            break;
+        }
+    }
+
+    if (cache_p && !ctx->models.parsing_sub_modules_count) {
+        /* if-features (refines, deviations) of the modules being parsed may still change */
+        cache = (ctx->feature_epoch << 1) | disabled;
+#ifdef __GNUC__
+        __atomic_store_n(cache_p, cache, __ATOMIC_RELAXED);
+#else
+        *cache_p = cache;
+#endif
+    }
+    return disabled;
+}
+
 API const struct lys_node *
 lys_is_disabled(const struct lys_node *node, int recursive)
 {
@@ -85,15 +169,20 @@ lys_is_disabled(const struct lys_node *node, int recursive)
     }
 
 check:
-    if (node->nodetype != LYS_INPUT && node->nodetype != LYS_OUTPUT) {
-        /* input/output does not have if-feature, so skip them */
-
-        /* check local if-features */
+    if (node->nodetype == LYS_EXT) {
+        /* extension instances do not cache the state */
         for (i = 0; i < node->iffeature_size; i++) {
             if (!resolve_iffeature(&node->iffeature[i])) {
                 return node;
             }
         }
+    } else if ((node->nodetype != LYS_INPUT) && (node->nodetype != LYS_OUTPUT)) {
+        /* input/output does not have if-feature, so skip them */
+
+        /* check local if-features */
+        if (node->iffeature_size && lys_iffeature_disabled((struct lys_node *)node)) {
+            return node;
+        }
     }
 
     if (!recursive) {
@@ -750,6 +839,63 @@ lys_check_id(struct lys_node *node, struct lys_node *parent, struct lys_module *
     return EXIT_SUCCESS;
 }
 
+#ifdef LY_ENABLED_CACHE
+
+/* the data hash is the last member of the structures of the nodes that can be instantiated in data */
+static uint32_t *
+lys_node_data_hash_p(const struct lys_node *node)
+{
+    switch (node->nodetype) {
+    case LYS_CONTAINER:
+        return &((struct lys_node_container *)node)->data_hash;
+    case LYS_LEAF:
+        return &((struct lys_node_leaf *)node)->data_hash;
+    case LYS_LEAFLIST:
+        return &((struct lys_node_leaflist *)node)->data_hash;
+    case LYS_LIST:
+        return &((struct lys_node_list *)node)->data_hash;
+    case LYS_ANYXML:
+    case LYS_ANYDATA:
+        return &((struct lys_node_anydata *)node)->data_hash;
+    case LYS_NOTIF:
+        return &((struct lys_node_notif *)node)->data_hash;
+    case LYS_RPC:
+    case LYS_ACTION:
+        return &((struct lys_node_rpc_action *)node)->data_hash;
+    default:
+        return NULL;
+    }
+}
+
+/* hash the module and name of a node that can be instantiated in data, it is the same for all its instances */
+static void
+lys_node_data_hash(struct lys_node *node)
+{
+    struct lys_module *mod;
+    uint32_t hash, *hash_p;
+
+    hash_p = lys_node_data_hash_p(node);
+    if (!hash_p) {
+        return;
+    }
+
+    mod = lys_node_module(node);
+    hash = dict_hash_multi(0, mod->name, strlen(mod->name));
+    *hash_p = dict_hash_multi(hash, node->name, strlen(node->name));
+}
+
+uint32_t
+lys_data_hash(const struct lys_node *node)
+{
+    uint32_t *hash_p;
+
+    hash_p = lys_node_data_hash_p(node);
+    assert(hash_p);
+    return *hash_p;
+}
+
+#endif
+
 /* logs directly */
 int
 lys_node_addchild(struct lys_node *parent, struct lys_module *module, struct lys_node *child, int options)
@@ -881,6 +1027,10 @@ lys_node_addchild(struct lys_node *parent, struct lys_module *module, struct lys
         lys_node_unlink(child);
     }
 
+#ifdef LY_ENABLED_CACHE
+    lys_node_data_hash(child);
+#endif
+
     if ((child->nodetype & (LYS_INPUT | LYS_OUTPUT)) && parent->nodetype != LYS_EXT) {
         /* find the implicit input/output node */
         LY_TREE_FOR(parent->child, iter) {
@@ -1341,9 +1491,8 @@ lys_search_localfile(const char * const *searchpaths, int cwd, const char *name,
         free(wd);
         free(wn); wn = NULL;
 
-        dirs->number--;
-        wd = (char *)dirs->set.g[dirs->number];
-        dirs->set.g[dirs->number] = NULL;
+        wd = (char *)dirs->set.g[dirs->number - 1];
+        ly_set_rm_index(dirs, dirs->number - 1);
         LOGVRB("Searching for \"%s\" in %s.", name, wd);
 
         if (dir) {
@@ -1646,13 +1795,125 @@ lys_iffeature_free(struct ly_ctx *ctx, struct lys_iffeature *iffeature, uint8_t
     free(iffeature);
 }
 
+#ifdef LY_ENABLED_CACHE
+
+static int
+type_precompile_patterns(struct ly_ctx *ctx, struct lys_type *type)
+{
+    unsigned int u;
+
+    type->info.str.patterns_pcre = malloc(type->info.str.pat_count * 2 * sizeof *type->info.str.patterns_pcre);
+    LY_CHECK_ERR_RETURN(!type->info.str.patterns_pcre, LOGMEM(ctx), -1);
+    for (u = 0; u < type->info.str.pat_count; u++) {
+        if (lyp_precompile_pattern(ctx, &type->info.str.patterns[u].expr[1],
+                                   (pcre**)&type->info.str.patterns_pcre[2 * u],
+                                   (pcre_extra**)&type->info.str.patterns_pcre[2 * u + 1])) {
+            free(type->info.str.patterns_pcre);
+            type->info.str.patterns_pcre = NULL;
+            return -1;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+#endif
+
+static int
+restr_shareable(struct lys_restr *restr, unsigned int size)
+{
+    unsigned int u;
+
+    for (u = 0; u < size; u++) {
+        if (restr[u].ext_size) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Only the restrictions, enums and bits are shared and only if there are no extension instances
+ * or if-features in them, these are bound to their parent and are not duplicated the same way.
+ */
+static int
+type_info_shareable(struct lys_type *type, LY_DATA_TYPE base, int in_grp)
+{
+    unsigned int u;
+
+    switch (base) {
+    case LY_TYPE_BINARY:
+        return !type->info.binary.length || restr_shareable(type->info.binary.length, 1);
+    case LY_TYPE_BITS:
+        for (u = 0; u < type->info.bits.count; u++) {
+            if (type->info.bits.bit[u].ext_size || type->info.bits.bit[u].iffeature_size) {
+                return 0;
+            }
+        }
+        return 1;
+    case LY_TYPE_DEC64:
+        return !type->info.dec64.range || restr_shareable(type->info.dec64.range, 1);
+    case LY_TYPE_ENUM:
+        for (u = 0; u < type->info.enums.count; u++) {
+            if (type->info.enums.enm[u].ext_size || type->info.enums.enm[u].iffeature_size) {
+                return 0;
+            }
+        }
+        return 1;
+    case LY_TYPE_INT8:
+    case LY_TYPE_INT16:
+    case LY_TYPE_INT32:
+    case LY_TYPE_INT64:
+    case LY_TYPE_UINT8:
+    case LY_TYPE_UINT16:
+    case LY_TYPE_UINT32:
+    case LY_TYPE_UINT64:
+        return !type->info.num.range || restr_shareable(type->info.num.range, 1);
+    case LY_TYPE_STRING:
+        if (type->info.str.length && !restr_shareable(type->info.str.length, 1)) {
+            return 0;
+        }
+#ifdef LY_ENABLED_CACHE
+        if (!in_grp && type->info.str.pat_count && !type->info.str.patterns_pcre
+                && (type->value_flags & LY_VALUE_SHARED)) {
+            /* the patterns would have to be compiled for this instance anyway */
+            return 0;
+        }
+#else
+        (void)in_grp;
+#endif
+        return restr_shareable(type->info.str.patterns, type->info.str.pat_count);
+    default:
+        /* leafrefs are resolved for every instance, unions hold types with a parent */
+        return 0;
+    }
+}
+
+/*
+ * share - old is a type from a grouping (or already shares its information with one), if possible,
+ * new will reference its information instead of duplicating it
+ */
 static int
 type_dup(struct lys_module *mod, struct lys_node *parent, struct lys_type *new, struct lys_type *old,
-         LY_DATA_TYPE base, int in_grp, int shallow, struct unres_schema *unres)
+         LY_DATA_TYPE base, int in_grp, int shallow, int share, struct unres_schema *unres)
 {
     int i;
     unsigned int u;
 
+    if ((share || (old->value_flags & LY_VALUE_SHARED)) && type_info_shareable(old, base, in_grp)) {
+#ifdef LY_ENABLED_CACHE
+        if ((base == LY_TYPE_STRING) && !in_grp && old->info.str.pat_count && !old->info.str.patterns_pcre
+                && type_precompile_patterns(mod->ctx, old)) {
+            /* the grouping type itself, compile its patterns once for all the instances */
+            return -1;
+        }
+#endif
+        memcpy(&new->info, &old->info, sizeof new->info);
+        new->value_flags |= LY_VALUE_SHARED;
+        return EXIT_SUCCESS;
+    }
+
     switch (base) {
     case LY_TYPE_BINARY:
         if (old->info.binary.length) {
@@ -1768,18 +2029,8 @@ type_dup(struct lys_module *mod, struct lys_node *parent, struct lys_type *new,
             new->info.str.patterns = lys_restr_dup(mod, old->info.str.patterns, old->info.str.pat_count, shallow, unres);
             new->info.str.pat_count = old->info.str.pat_count;
 #ifdef LY_ENABLED_CACHE
-            if (!in_grp) {
-                new->info.str.patterns_pcre = malloc(new->info.str.pat_count * 2 * sizeof *new->info.str.patterns_pcre);
-                LY_CHECK_ERR_RETURN(!new->info.str.patterns_pcre, LOGMEM(mod->ctx), -1);
-                for (u = 0; u < new->info.str.pat_count; u++) {
-                    if (lyp_precompile_pattern(mod->ctx, &new->info.str.patterns[u].expr[1],
-                                              (pcre**)&new->info.str.patterns_pcre[2 * u],
-                                              (pcre_extra**)&new->info.str.patterns_pcre[2 * u + 1])) {
-                        free(new->info.str.patterns_pcre);
-                        new->info.str.patterns_pcre = NULL;
-                        return -1;
-                    }
-                }
+            if (!in_grp && type_precompile_patterns(mod->ctx, new)) {
+                return -1;
             }
 #endif
         }
@@ -1794,7 +2045,7 @@ type_dup(struct lys_module *mod, struct lys_node *parent, struct lys_type *new,
 
             for (u = 0; u < new->info.uni.count; u++) {
                 if (lys_type_dup(mod, parent, &(new->info.uni.types[u]), &(old->info.uni.types[u]), in_grp,
-                        shallow, unres)) {
+                        shallow, share, unres)) {
                     return -1;
                 }
             }
@@ -1825,7 +2076,7 @@ lys_yang_type_dup(struct lys_module *module, struct lys_node *parent, struct yan
         LOGMEM(module->ctx);
         goto error;
     }
-    if (type_dup(module, parent, type, old->type, new->base, in_grp, shallow, unres)) {
+    if (type_dup(module, parent, type, old->type, new->base, in_grp, shallow, 0, unres)) {
         new->type->base = new->base;
         lys_type_free(module->ctx, new->type, NULL);
         memset(&new->type->info, 0, sizeof new->type->info);
@@ -1908,7 +2159,7 @@ lys_copy_union_leafrefs(struct lys_module *mod, struct lys_node *parent, struct
             prev_new->der = type->der;
             break;
         default:
-            if (lys_type_dup(mod, parent, prev_new, type, 0, 0, unres)) {
+            if (lys_type_dup(mod, parent, prev_new, type, 0, 0, 0, unres)) {
                 return -1;
             }
             break;
@@ -2208,13 +2459,14 @@ lys_ext_instance_substmt(const struct lys_ext_instance *ext)
 
 static int
 lys_type_dup(struct lys_module *mod, struct lys_node *parent, struct lys_type *new, struct lys_type *old,
-            int in_grp, int shallow, struct unres_schema *unres)
+            int in_grp, int shallow, int share, struct unres_schema *unres)
 {
     int i;
 
     new->base = old->base;
     new->der = old->der;
     new->parent = (struct lys_tpdf *)parent;
+    new->value_flags |= old->value_flags & LY_VALUE_NOCOLON;
     new->ext_size = old->ext_size;
     if (lys_ext_dup(mod->ctx, mod, old->ext, old->ext_size, new, LYEXT_PAR_TYPE, &new->ext, shallow, unres)) {
         return -1;
@@ -2237,7 +2489,7 @@ lys_type_dup(struct lys_module *mod, struct lys_node *parent, struct lys_type *n
         return EXIT_SUCCESS;
     }
 
-    return type_dup(mod, parent, new, old, new->base, in_grp, shallow, unres);
+    return type_dup(mod, parent, new, old, new->base, in_grp, shallow, share, unres);
 }
 
 void
@@ -2253,6 +2505,11 @@ lys_type_free(struct ly_ctx *ctx, struct lys_type *type,
 
     lys_extension_instances_free(ctx, type->ext, type->ext_size, private_destructor);
 
+    if (type->value_flags & LY_VALUE_SHARED) {
+        /* the information is owned by the type in the grouping */
+        return;
+    }
+
     switch (type->base) {
     case LY_TYPE_BINARY:
         lys_restr_free(ctx, type->info.binary.length, private_destructor);
@@ -2403,6 +2660,8 @@ lys_augment_free(struct ly_ctx *ctx, struct lys_node_augment *aug,
 {
     struct lys_node *next, *sub;
 
+    lys_xpath_dep_remove(ctx, (struct lys_node *)aug);
+
     /* children from a resolved augment are freed under the target node */
     if (!aug->target || (aug->flags & LYS_NOTAPPLIED)) {
         LY_TREE_FOR_SAFE(aug->child, next, sub) {
@@ -2757,6 +3016,9 @@ lys_node_free(struct lys_node *node, void (*private_destructor)(const struct lys
 
     ctx = node->module->ctx;
 
+    /* the node cannot be referenced by any expression anymore */
+    lys_xpath_dep_remove(ctx, node);
+
     /* remove private object */
     if (node->priv && private_destructor) {
         private_destructor(node, node->priv);
@@ -3282,7 +3544,8 @@ lys_node_dup_recursion(struct lys_module *module, struct lys_node *parent, const
         break;
 
     case LYS_LEAF:
-        if (lys_type_dup(module, retval, &(leaf->type), &(leaf_orig->type), lys_ingrouping(retval), shallow, unres)) {
+        if (lys_type_dup(module, retval, &(leaf->type), &(leaf_orig->type), lys_ingrouping(retval), shallow,
+                         lys_ingrouping(node), unres)) {
             goto error;
         }
         leaf->units = lydict_insert(module->ctx, leaf_orig->units, 0);
@@ -3304,7 +3567,8 @@ lys_node_dup_recursion(struct lys_module *module, struct lys_node *parent, const
         break;
 
     case LYS_LEAFLIST:
-        if (lys_type_dup(module, retval, &(llist->type), &(llist_orig->type), lys_ingrouping(retval), shallow, unres)) {
+        if (lys_type_dup(module, retval, &(llist->type), &(llist_orig->type), lys_ingrouping(retval), shallow,
+                         lys_ingrouping(node), unres)) {
             goto error;
         }
         llist->units = lydict_insert(module->ctx, llist_orig->units, 0);
@@ -3591,8 +3855,19 @@ lys_node_dup(struct lys_module *module, struct lys_node *parent, const struct ly
 static void
 lys_node_switch(struct lys_node *node1, struct lys_node *node2)
 {
-    const size_t mem_size = 104;
-    uint8_t mem[mem_size];
+    /* large enough for any node type */
+    union {
+        struct lys_node_container cont;
+        struct lys_node_choice choice;
+        struct lys_node_leaf leaf;
+        struct lys_node_leaflist llist;
+        struct lys_node_list list;
+        struct lys_node_anydata any;
+        struct lys_node_case cs;
+        struct lys_node_inout inout;
+        struct lys_node_notif notif;
+        struct lys_node_rpc_action rpc;
+    } mem;
     size_t offset, size;
 
     assert((node1->module == node2->module) && ly_strequal(node1->name, node2->name, 1) && (node1->nodetype == node2->nodetype));
@@ -3654,9 +3929,9 @@ lys_node_switch(struct lys_node *node1, struct lys_node *node2)
     /* switch common node part */
     offset = 3 * sizeof(char *);
     size = sizeof(uint16_t) + 6 * sizeof(uint8_t) + sizeof(struct lys_ext_instance **) + sizeof(struct lys_iffeature *);
-    memcpy(mem, ((uint8_t *)node1) + offset, size);
+    memcpy(&mem, ((uint8_t *)node1) + offset, size);
     memcpy(((uint8_t *)node1) + offset, ((uint8_t *)node2) + offset, size);
-    memcpy(((uint8_t *)node2) + offset, mem, size);
+    memcpy(((uint8_t *)node2) + offset, &mem, size);
 
     /* switch node-specific data */
     offset = sizeof(struct lys_node);
@@ -3699,10 +3974,10 @@ lys_node_switch(struct lys_node *node1, struct lys_node *node2)
         LOGINT(node1->module->ctx);
         return;
     }
-    assert(size <= mem_size);
-    memcpy(mem, ((uint8_t *)node1) + offset, size);
+    assert(size <= sizeof mem);
+    memcpy(&mem, ((uint8_t *)node1) + offset, size);
     memcpy(((uint8_t *)node1) + offset, ((uint8_t *)node2) + offset, size);
-    memcpy(((uint8_t *)node2) + offset, mem, size);
+    memcpy(((uint8_t *)node2) + offset, &mem, size);
 
     /* typedefs were not copied to the backup node, so always reuse them,
      * in leaves/leaf-lists we must correct the type parent pointer */
@@ -3838,6 +4113,9 @@ lys_features_change(const struct lys_module *module, const char *name, int op)
         all = 1;
     }
 
+    /* the state of any node depending on the features may change */
+    lys_iffeature_cache_invalidate(module->ctx);
+
     progress = failk = 1;
     while (progress && failk) {
         for (i = -1, failk = progress = 0; i < module->inc_size; i++) {
@@ -4325,6 +4603,265 @@ next_iter:
     return ret_set;
 }
 
+static int
+lys_xpath_dep_equal_cb(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lys_xpath_dep *dep1, *dep2;
+
+    dep1 = *(struct lys_xpath_dep **)val1_p;
+    dep2 = *(struct lys_xpath_dep **)val2_p;
+
+    return (dep1->node == dep2->node);
+}
+
+static uint32_t
+lys_xpath_dep_hash(const struct lys_node *node)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&node, sizeof node);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+/**
+ * @brief Find the dependency record of a schema node.
+ *
+ * @param[in] ctx Context with the dependencies.
+ * @param[in] node Schema node to look for.
+ * @param[in] create Whether to create the record if it does not exist.
+ * @return Found (created) record, NULL if not found or on error.
+ */
+static struct lys_xpath_dep *
+lys_xpath_dep_find(struct ly_ctx *ctx, const struct lys_node *node, int create)
+{
+    struct lys_xpath_dep dep_rec, *dep = &dep_rec, **match;
+    uint32_t hash;
+
+    if (!ctx->xpath_deps) {
+        if (!create) {
+            return NULL;
+        }
+        ctx->xpath_deps = lyht_new(8, sizeof dep, lys_xpath_dep_equal_cb, NULL, 1);
+        LY_CHECK_ERR_RETURN(!ctx->xpath_deps, LOGMEM(ctx), NULL);
+    }
+
+    dep_rec.node = node;
+    hash = lys_xpath_dep_hash(node);
+    if (!lyht_find(ctx->xpath_deps, &dep, hash, (void **)&match)) {
+        return *match;
+    } else if (!create) {
+        return NULL;
+    }
+
+    dep = calloc(1, sizeof *dep);
+    LY_CHECK_ERR_RETURN(!dep, LOGMEM(ctx), NULL);
+    dep->node = node;
+    if (lyht_insert(ctx->xpath_deps, &dep, hash, NULL)) {
+        LOGINT(ctx);
+        free(dep);
+        return NULL;
+    }
+
+    return dep;
+}
+
+static void
+lys_xpath_dep_drop(struct ly_ctx *ctx, struct lys_xpath_dep *dep)
+{
+    if ((dep->dependents && dep->dependents->number) || (dep->targets && dep->targets->number)) {
+        /* still used */
+        return;
+    }
+
+    lyht_remove(ctx->xpath_deps, &dep, lys_xpath_dep_hash(dep->node));
+    ly_set_free(dep->dependents);
+    ly_set_free(dep->targets);
+    free(dep);
+}
+
+static void
+lys_xpath_dep_set_rm(struct ly_set *set, const struct lys_node *node)
+{
+    int i;
+
+    if (set && ((i = ly_set_contains(set, (void *)node)) > -1)) {
+        ly_set_rm_index(set, i);
+    }
+}
+
+/* unlinks node from the targets of its expressions */
+static void
+lys_xpath_dep_unlink_targets(struct ly_ctx *ctx, struct lys_xpath_dep *dep)
+{
+    struct lys_xpath_dep *trg;
+    unsigned int i;
+
+    for (i = 0; dep->targets && (i < dep->targets->number); ++i) {
+        if (dep->targets->set.s[i] == dep->node) {
+            /* dependency on itself */
+            lys_xpath_dep_set_rm(dep->dependents, dep->node);
+            continue;
+        }
+
+        trg = lys_xpath_dep_find(ctx, dep->targets->set.s[i], 0);
+        if (trg) {
+            lys_xpath_dep_set_rm(trg->dependents, dep->node);
+            lys_xpath_dep_drop(ctx, trg);
+        }
+    }
+    ly_set_clean(dep->targets);
+}
+
+int
+lys_xpath_dep_store(const struct lys_node *node, const struct lyxp_set *set)
+{
+    struct ly_ctx *ctx = node->module->ctx;
+    struct lys_xpath_dep *dep, *trg;
+    uint32_t i;
+
+    dep = lys_xpath_dep_find(ctx, node, 1);
+    if (!dep) {
+        return -1;
+    }
+
+    /* the expressions could have changed (deviation), forget the previous targets */
+    lys_xpath_dep_unlink_targets(ctx, dep);
+
+    for (i = 0; i < set->used; ++i) {
+        if (set->val.snodes[i].type != LYXP_NODE_ELEM) {
+            /* skip roots */
+            continue;
+        }
+
+        trg = lys_xpath_dep_find(ctx, set->val.snodes[i].snode, 1);
+        if (!trg) {
+            return -1;
+        }
+        if (!dep->targets && !(dep->targets = ly_set_new())) {
+            LOGMEM(ctx);
+            return -1;
+        }
+        if (!trg->dependents && !(trg->dependents = ly_set_new())) {
+            LOGMEM(ctx);
+            return -1;
+        }
+        if ((ly_set_add(dep->targets, (void *)trg->node, 0) == -1) || (ly_set_add(trg->dependents, (void *)node, 0) == -1)) {
+            return -1;
+        }
+    }
+
+    lys_xpath_dep_drop(ctx, dep);
+    return 0;
+}
+
+struct ly_set *
+lys_xpath_dep_get(const struct lys_node *node)
+{
+    struct lys_xpath_dep *dep;
+
+    dep = lys_xpath_dep_find(node->module->ctx, node, 0);
+    if (!dep || !dep->dependents || !dep->dependents->number) {
+        return NULL;
+    }
+
+    return dep->dependents;
+}
+
+void
+lys_xpath_dep_remove(struct ly_ctx *ctx, const struct lys_node *node)
+{
+    struct lys_xpath_dep *dep, *src;
+    unsigned int i;
+
+    dep = lys_xpath_dep_find(ctx, node, 0);
+    if (!dep) {
+        return;
+    }
+
+    lys_xpath_dep_unlink_targets(ctx, dep);
+
+    /* the expressions reading the node cannot reference it anymore */
+    for (i = 0; dep->dependents && (i < dep->dependents->number); ++i) {
+        src = lys_xpath_dep_find(ctx, dep->dependents->set.s[i], 0);
+        if (src) {
+            lys_xpath_dep_set_rm(src->targets, node);
+            lys_xpath_dep_drop(ctx, src);
+        }
+    }
+    ly_set_clean(dep->dependents);
+
+    lys_xpath_dep_drop(ctx, dep);
+}
+
+void
+lys_xpath_dep_free_all(struct ly_ctx *ctx)
+{
+    struct lys_xpath_dep *dep;
+    void *val_p;
+    uint32_t i = 0;
+
+    if (!ctx->xpath_deps) {
+        return;
+    }
+
+    while (lyht_iter_next(ctx->xpath_deps, &i, &val_p)) {
+        dep = *(struct lys_xpath_dep **)val_p;
+        ly_set_free(dep->dependents);
+        ly_set_free(dep->targets);
+        free(dep);
+    }
+    lyht_free(ctx->xpath_deps);
+    ctx->xpath_deps = NULL;
+}
+
+API struct ly_set *
+lys_xpath_dependents(const struct lys_node *node)
+{
+    struct ly_set *ret_set, *deps, *backlinks = NULL;
+    struct lys_node *dep;
+    unsigned int i;
+
+    if (!node) {
+        LOGARG;
+        return NULL;
+    }
+    if (node->module->ctx->xpath_deps_partial) {
+        LOGERR(node->module->ctx, LY_EINVAL, "XPath dependencies of the schemas parsed in a trusted context are not known.");
+        return NULL;
+    }
+
+    ret_set = ly_set_new();
+    LY_CHECK_ERR_RETURN(!ret_set, LOGMEM(node->module->ctx), NULL);
+
+    /* must and when expressions */
+    deps = lys_xpath_dep_get(node);
+    for (i = 0; deps && (i < deps->number); ++i) {
+        dep = deps->set.s[i];
+        if (lys_node_module(dep)->disabled) {
+            continue;
+        }
+        if (ly_set_add(ret_set, dep, 0) == -1) {
+            ly_set_free(ret_set);
+            return NULL;
+        }
+    }
+
+    /* leafref paths */
+    if (node->nodetype == LYS_LEAF) {
+        backlinks = ((struct lys_node_leaf *)node)->backlinks;
+    } else if (node->nodetype == LYS_LEAFLIST) {
+        backlinks = ((struct lys_node_leaflist *)node)->backlinks;
+    }
+    for (i = 0; backlinks && (i < backlinks->number); ++i) {
+        if (ly_set_add(ret_set, backlinks->set.s[i], 0) == -1) {
+            ly_set_free(ret_set);
+            return NULL;
+        }
+    }
+
+    return ret_set;
+}
+
 /* logs */
 int
 apply_aug(struct lys_node_augment *augment, struct unres_schema *unres)
@@ -4960,6 +5497,9 @@ lys_set_implemented(const struct lys_module *module)
     }
     unres_schema_free(NULL, &unres, 0);
 
+    /* the conformance of the module changed */
+    lys_iffeature_cache_invalidate(module->ctx);
+
     LOGVRB("Module \"%s%s%s\" now implemented.", module->name, (module->rev_size ? "@" : ""),
            (module->rev_size ? module->rev[0].date : ""));
     return EXIT_SUCCESS;
@@ -1291,6 +1291,13 @@ struct lys_node_container {
     struct lys_restr *must;          /**< array of must constraints */
     struct lys_tpdf *tpdf;           /**< array of typedefs */
     const char *presence;            /**< presence description, used also as a presence flag (optional) */
+
+#ifdef LY_ENABLED_CACHE
+    uint32_t data_hash;              /**< partial hash of the module and node name, the common prefix of
+                                          the hashes of all the data instances of the node, internal only */
+#endif
+    uint32_t iffeat_cache;           /**< if-feature state of the node cached for the current feature epoch of
+                                          the context, internal only */
 };
 
 /**
@@ -1331,6 +1338,8 @@ struct lys_node_choice {
     /* specific choice's data */
     struct lys_when *when;           /**< when statement (optional) */
     struct lys_node *dflt;           /**< default case of the choice (optional) */
+    uint32_t iffeat_cache;           /**< if-feature state of the node cached for the current feature epoch of
+                                          the context, internal only */
 };
 
 /**
@@ -1385,6 +1394,13 @@ struct lys_node_leaf {
 
     /* to this point, struct lys_node_leaf is compatible with struct lys_node_leaflist */
     const char *dflt;                /**< default value of the leaf */
+
+#ifdef LY_ENABLED_CACHE
+    uint32_t data_hash;              /**< partial hash of the module and node name, the common prefix of
+                                          the hashes of all the data instances of the node, internal only */
+#endif
+    uint32_t iffeat_cache;           /**< if-feature state of the node cached for the current feature epoch of
+                                          the context, internal only */
 };
 
 /**
@@ -1442,6 +1458,13 @@ struct lys_node_leaflist {
     const char **dflt;               /**< array of default value(s) of the leaflist */
     uint32_t min;                    /**< min-elements constraint (optional) */
     uint32_t max;                    /**< max-elements constraint, 0 means unbounded (optional) */
+
+#ifdef LY_ENABLED_CACHE
+    uint32_t data_hash;              /**< partial hash of the module and node name, the common prefix of
+                                          the hashes of all the data instances of the node, internal only */
+#endif
+    uint32_t iffeat_cache;           /**< if-feature state of the node cached for the current feature epoch of
+                                          the context, internal only */
 };
 
 /**
@@ -1499,6 +1522,12 @@ struct lys_node_list {
     const char *keys_str;            /**< string defining the keys, must be stored besides the keys array since the
                                           keys may not be present in case the list is inside grouping */
 
+#ifdef LY_ENABLED_CACHE
+    uint32_t data_hash;              /**< partial hash of the module and node name, the common prefix of
+                                          the hashes of all the data instances of the node, internal only */
+#endif
+    uint32_t iffeat_cache;           /**< if-feature state of the node cached for the current feature epoch of
+                                          the context, internal only */
 };
 
 /**
@@ -1546,6 +1575,13 @@ struct lys_node_anydata {
     /* specific anyxml's data */
     struct lys_when *when;           /**< when statement (optional) */
     struct lys_restr *must;          /**< array of must constraints */
+
+#ifdef LY_ENABLED_CACHE
+    uint32_t data_hash;              /**< partial hash of the module and node name, the common prefix of
+                                          the hashes of all the data instances of the node, internal only */
+#endif
+    uint32_t iffeat_cache;           /**< if-feature state of the node cached for the current feature epoch of
+                                          the context, internal only */
 };
 
 /**
@@ -1594,6 +1630,8 @@ struct lys_node_uses {
     struct lys_refine *refine;       /**< array of refine changes to the referred grouping */
     struct lys_node_augment *augment;/**< array of local augments to the referred grouping */
     struct lys_node_grp *grp;        /**< referred grouping definition (mandatory) */
+    uint32_t iffeat_cache;           /**< if-feature state of the node cached for the current feature epoch of
+                                          the context, internal only */
 };
 
 /**
@@ -1674,6 +1712,8 @@ struct lys_node_case {
 
     /* specific case's data */
     struct lys_when *when;           /**< when statement (optional) */
+    uint32_t iffeat_cache;           /**< if-feature state of the node cached for the current feature epoch of
+                                          the context, internal only */
 };
 
 /**
@@ -1764,6 +1804,13 @@ struct lys_node_notif {
     /* specific rpc's data */
     struct lys_tpdf *tpdf;           /**< array of typedefs */
     struct lys_restr *must;          /**< array of must constraints */
+
+#ifdef LY_ENABLED_CACHE
+    uint32_t data_hash;              /**< partial hash of the module and node name, the common prefix of
+                                          the hashes of all the data instances of the node, internal only */
+#endif
+    uint32_t iffeat_cache;           /**< if-feature state of the node cached for the current feature epoch of
+                                          the context, internal only */
 };
 
 /**
@@ -1809,6 +1856,13 @@ struct lys_node_rpc_action {
 
     /* specific rpc's data */
     struct lys_tpdf *tpdf;           /**< array of typedefs */
+
+#ifdef LY_ENABLED_CACHE
+    uint32_t data_hash;              /**< partial hash of the module and node name, the common prefix of
+                                          the hashes of all the data instances of the node, internal only */
+#endif
+    uint32_t iffeat_cache;           /**< if-feature state of the node cached for the current feature epoch of
+                                          the context, internal only */
 };
 
 /**
@@ -1854,6 +1908,8 @@ struct lys_node_augment {
 
     /* again compatible members with ::lys_node */
     void *priv;                      /**< private caller's data, not used by libyang */
+    uint32_t iffeat_cache;           /**< if-feature state of the node cached for the current feature epoch of
+                                          the context, internal only */
 };
 
 /**
@@ -2328,6 +2384,19 @@ struct ly_set *lys_node_xpath_atomize(const struct lys_node *node, int options);
 #define LYXP_RECURSIVE 0x01 /**< lys_node_xpath_atomize() option to return schema node dependencies of all the expressions in the subtree */
 #define LYXP_NO_LOCAL 0x02  /**< lys_node_xpath_atomize() option to discard schema node dependencies from the local subtree */
 
+/**
+ * @brief Get all the schema nodes whose must or when expressions or leafref paths read \p node.
+ *
+ * The reverse dependencies are collected when the modules are compiled, so this function does not
+ * evaluate any expressions. Nodes of disabled modules are not returned. The expressions of the modules
+ * parsed with #LY_CTX_TRUSTED are not checked, so once any module was parsed in a trusted context,
+ * the dependencies are not known and the function fails.
+ *
+ * @param[in] node Schema node to examine.
+ * @return Set of the dependent schema nodes (possibly empty), NULL on error.
+ */
+struct ly_set *lys_xpath_dependents(const struct lys_node *node);
+
 /**
  * @brief Build schema path (usable as path, see @ref howtoxpath) of the schema node.
  *
@@ -234,137 +234,386 @@ unique_errmsg_cleanup:
     return 0;
 }
 
-int
-lyv_data_unique(struct lyd_node *list)
+/* find the instance of a unique (descendant) schema node in a list instance */
+static struct lyd_node *
+lyv_uniq_data(struct lyd_node *list, const struct lys_node *snode)
 {
-    struct lyd_node *diter;
-    struct ly_set *set;
-    uint32_t i, j, n = 0;
-    int ret = 0;
-    uint32_t hash, u, usize = 0;
-    struct hash_table **uniqtables = NULL;
-    const char *id;
-    char *path;
-    struct lys_node_list *slist;
-    struct ly_ctx *ctx = list->schema->module->ctx;
+    const struct lys_node *sparent;
+    struct lyd_node *start = list, *iter;
+
+    /* get the data parent first, the unique leaves can be only in containers */
+    for (sparent = lys_parent(snode); sparent->nodetype & (LYS_CHOICE | LYS_CASE | LYS_USES); sparent = lys_parent(sparent));
+    if (sparent != list->schema) {
+        start = lyv_uniq_data(list, sparent);
+        if (!start) {
+            return NULL;
+        }
+    }
 
-    if (!(list->validity & LYD_VAL_UNIQUE)) {
-        /* validated sa part of another instance validation */
+    LY_TREE_FOR(start->child, iter) {
+        if (iter->schema == snode) {
+            return iter;
+        }
+    }
+    return NULL;
+}
+
+/* records of lyd_uniq_idx#tables are compared by value except when inserting or removing a particular instance */
+static int
+lyv_uniq_idx_equal(void *val1_p, void *val2_p, int mod, void *cb_data)
+{
+    if (mod) {
+        return *(struct lyd_node **)val1_p == *(struct lyd_node **)val2_p;
+    }
+    if ((*(struct lyd_node **)val2_p)->validity & LYD_VAL_UNIQUE) {
+        /* the stored values may be stale, the instance is compared again once validated itself */
         return 0;
     }
 
-    slist = (struct lys_node_list *)list->schema;
+    return lyv_list_uniq_equal(val1_p, val2_p, 0, cb_data);
+}
 
-    /* get all list instances */
-    if (ly_vlog_build_path(LY_VLOG_LYD, list, &path, 0, 1)) {
-        return -1;
+static int
+lyv_uniq_inst_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    return ((struct lyd_uniq_inst *)val1_p)->node == ((struct lyd_uniq_inst *)val2_p)->node;
+}
+
+static uint32_t
+lyv_uniq_inst_hash(const struct lyd_node *node)
+{
+    return dict_hash_multi(dict_hash_multi(0, (const char *)&node, sizeof node), NULL, 0);
+}
+
+void
+lyv_uniq_idx_free(struct lyd_uniq_idx *idx)
+{
+    struct lyd_uniq_idx *next;
+    uint8_t j;
+
+    for (; idx; idx = next) {
+        next = idx->next;
+        for (j = 0; j < idx->slist->unique_size; ++j) {
+            lyht_free(idx->tables[j]);
+        }
+        free(idx->tables);
+        lyht_free(idx->inst);
+        free(idx->tmp);
+        free(idx->leaves);
+        free(idx);
     }
-    set = lyd_find_path(list, path);
-    free(path);
-    if (!set) {
-        return -1;
+}
+
+static struct lyd_uniq_idx *
+lyv_uniq_idx_new(const struct lys_node_list *slist, uint32_t count)
+{
+    struct ly_ctx *ctx = slist->module->ctx;
+    struct lyd_uniq_idx *idx;
+    const struct lys_node *sleaf;
+    uint32_t i, k, size;
+    uint8_t j;
+
+    /* large enough not to be enlarged while the instances are added */
+    for (size = LYHT_MIN_SIZE; (count * 100) / size >= LYHT_ENLARGE_PERCENTAGE; size <<= 1);
+
+    idx = calloc(1, sizeof *idx);
+    LY_CHECK_ERR_RETURN(!idx, LOGMEM(ctx), NULL);
+    idx->slist = slist;
+
+    /* resolve the unique expressions only once for all the instances */
+    for (j = k = 0; j < slist->unique_size; j++) {
+        k += slist->unique[j].expr_size;
     }
+    idx->leaves = malloc(k * sizeof *idx->leaves);
+    idx->tables = calloc(slist->unique_size, sizeof *idx->tables);
+    idx->inst = lyht_new(size, sizeof(struct lyd_uniq_inst) + slist->unique_size * sizeof(uint32_t),
+                         lyv_uniq_inst_equal, NULL, 1);
+    idx->tmp = malloc(sizeof(struct lyd_uniq_inst) + slist->unique_size * sizeof(uint32_t));
+    LY_CHECK_ERR_GOTO(!idx->leaves || !idx->tables || !idx->inst || !idx->tmp, LOGMEM(ctx), error);
+    for (j = k = 0; j < slist->unique_size; j++) {
+        for (i = 0; i < slist->unique[j].expr_size; i++, k++) {
+            if (resolve_descendant_schema_nodeid(slist->unique[j].expr[i], slist->child, LYS_LEAF, 1, &sleaf)
+                    || !sleaf) {
+                /* unique expression was checked when the schema was parsed so this should not happen */
+                LOGINT(ctx);
+                goto error;
+            }
+            idx->leaves[k] = sleaf;
+        }
 
-    for (i = 0; i < set->number; ++i) {
-        /* remove the flag */
-        set->set.d[i]->validity &= ~LYD_VAL_UNIQUE;
+        idx->tables[j] = lyht_new(size, sizeof(struct lyd_node *), lyv_uniq_idx_equal, (void *)(j + 1L), 1);
+        LY_CHECK_ERR_GOTO(!idx->tables[j], LOGMEM(ctx), error);
     }
 
-    if (set->number == 2) {
-        /* simple comparison */
-        if (lyv_list_uniq_equal(&set->set.d[0], &set->set.d[1], 0, (void *)0)) {
-            /* instance duplication */
-            ly_set_free(set);
-            return 1;
+    return idx;
+
+error:
+    if (idx->tables) {
+        for (j = 0; (j < slist->unique_size) && idx->tables[j]; ++j) {
+            lyht_free(idx->tables[j]);
         }
-    } else if (set->number > 2) {
-        /* use hashes for comparison */
-        /* first, allocate the table, the size depends on number of items in the set */
-        for (u = 31; u > 0; u--) {
-            usize = set->number << u;
-            usize = usize >> u;
-            if (usize == set->number) {
+    }
+    free(idx->tables);
+    lyht_free(idx->inst);
+    free(idx->tmp);
+    free(idx->leaves);
+    free(idx);
+    return NULL;
+}
+
+void
+lyv_uniq_idx_remove(struct lyd_uniq_idx *idx, struct lyd_node *list)
+{
+    struct lyd_uniq_inst *inst;
+    uint32_t hash;
+    uint8_t j;
+
+    inst = idx->tmp;
+    inst->node = list;
+    hash = lyv_uniq_inst_hash(list);
+    if (lyht_find(idx->inst, inst, hash, (void **)&inst)) {
+        /* not indexed */
+        return;
+    }
+
+    /* the values may have changed since, use the stored hashes */
+    for (j = 0; j < idx->slist->unique_size; ++j) {
+        if (inst->hash[j] && lyht_remove(idx->tables[j], &list, inst->hash[j])) {
+            assert(0);
+        }
+    }
+    if (lyht_remove(idx->inst, inst, hash)) {
+        assert(0);
+    }
+}
+
+/* add a list instance into the index, 1 if it duplicates another one */
+static int
+lyv_uniq_idx_add(struct lyd_uniq_idx *idx, struct lyd_node *list)
+{
+    struct lyd_node *diter;
+    struct lyd_uniq_inst *inst;
+    const struct lys_node_list *slist = idx->slist;
+    const char *id;
+    uint32_t i, k, hash;
+    uint8_t j;
+
+    inst = idx->tmp;
+    inst->node = list;
+
+    for (j = k = 0; j < slist->unique_size; k += slist->unique[j].expr_size, j++) {
+        /* get the hash of the values of the instance */
+        id = NULL;
+        for (i = hash = 0; i < slist->unique[j].expr_size; i++) {
+            diter = lyv_uniq_data(list, idx->leaves[k + i]);
+            if (diter) {
+                id = ((struct lyd_node_leaf_list *)diter)->value_str;
+            } else {
+                /* use default value */
+                if (lyd_get_unique_default(slist->unique[j].expr[i], list, &id)) {
+                    return -1;
+                }
+            }
+            if (!id) {
+                /* unique item not present nor has default value */
                 break;
             }
+            hash = dict_hash_multi(hash, id, strlen(id));
         }
-        if (u == 0) {
-            LOGINT(ctx);
-            ret = -1;
-            goto cleanup;
-        } else {
-            u = 32 - u;
-            usize = 1 << u;
+        if (!id) {
+            /* skip this list instance since its unique set is incomplete */
+            inst->hash[j] = 0;
+            continue;
         }
 
-        n = slist->unique_size;
-        uniqtables = malloc(n * sizeof *uniqtables);
-        if (!uniqtables) {
-            LOGMEM(ctx);
-            ret = -1;
-            n = 0;
-            goto cleanup;
+        /* finish the hash value, 0 marks the instance not being in the table */
+        hash = dict_hash_multi(hash, NULL, 0);
+        inst->hash[j] = hash ? hash : 1;
+    }
+
+    /* compare the values with the instances with the same hashes */
+    for (j = 0; j < slist->unique_size; ++j) {
+        if (inst->hash[j] && !lyht_find(idx->tables[j], &list, inst->hash[j], NULL)) {
+            return 1;
         }
-        for (j = 0; j < n; j++) {
-            uniqtables[j] = lyht_new(usize, sizeof(struct lyd_node *), lyv_list_uniq_equal, (void *)(j + 1L), 0);
-            if (!uniqtables[j]) {
-                LOGMEM(ctx);
-                ret = -1;
-                goto cleanup;
-            }
+    }
+
+    /* no duplicates, store the instance */
+    for (j = 0; j < slist->unique_size; ++j) {
+        if (inst->hash[j] && (lyht_insert(idx->tables[j], &list, inst->hash[j], NULL) == -1)) {
+            LOGMEM(slist->module->ctx);
+            return -1;
         }
+    }
+    if (lyht_insert(idx->inst, inst, lyv_uniq_inst_hash(list), NULL) == -1) {
+        LOGMEM(slist->module->ctx);
+        return -1;
+    }
 
-        for (u = 0; u < set->number; u++) {
-            /* loop for unique - get the hash for the instances */
-            for (j = 0; j < n; j++) {
-                id = NULL;
-                for (i = hash = 0; i < slist->unique[j].expr_size; i++) {
-                    diter = resolve_data_descendant_schema_nodeid(slist->unique[j].expr[i], set->set.d[u]->child);
-                    if (diter) {
-                        id = ((struct lyd_node_leaf_list *)diter)->value_str;
-                    } else {
-                        /* use default value */
-                        if (lyd_get_unique_default(slist->unique[j].expr[i], set->set.d[u], &id)) {
-                            ret = -1;
-                            goto cleanup;
-                        }
-                    }
-                    if (!id) {
-                        /* unique item not present nor has default value */
-                        break;
-                    }
-                    hash = dict_hash_multi(hash, id, strlen(id));
-                }
-                if (!id) {
-                    /* skip this list instance since its unique set is incomplete */
-                    continue;
-                }
+    return 0;
+}
 
-                /* finish the hash value */
-                hash = dict_hash_multi(hash, NULL, 0);
+/* create the index of all the instances of a list, clears their flags */
+static int
+lyv_uniq_idx_build(struct ly_set *set, const struct lys_node_list *slist, struct lyd_uniq_idx **idx_p)
+{
+    uint32_t i;
+    int ret;
 
-                /* insert into the hashtable */
-                if (lyht_insert(uniqtables[j], &set->set.d[u], hash, NULL)) {
-                    ret = 1;
-                    goto cleanup;
-                }
+    *idx_p = lyv_uniq_idx_new(slist, set->number);
+    if (!*idx_p) {
+        return -1;
+    }
+
+    for (i = 0; i < set->number; ++i) {
+        /* the stored instances must be compared with the next ones */
+        set->set.d[i]->validity &= ~LYD_VAL_UNIQUE;
+        if ((ret = lyv_uniq_idx_add(*idx_p, set->set.d[i]))) {
+            set->set.d[i]->validity |= LYD_VAL_UNIQUE;
+
+            /* the index would not be complete */
+            lyv_uniq_idx_free(*idx_p);
+            *idx_p = NULL;
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+/* collect the instances of the last schema node in the path from the siblings, in the document order */
+static int
+lyv_uniq_instances(struct lyd_node *siblings, const struct lys_node **spath, int depth, struct ly_set *set)
+{
+    struct lyd_node *iter;
+
+    LY_TREE_FOR(siblings, iter) {
+        if (iter->schema != spath[depth]) {
+            continue;
+        }
+
+        if (!depth) {
+            if (ly_set_add(set, iter, LY_SET_OPT_USEASLIST) == -1) {
+                return -1;
             }
+        } else if (lyv_uniq_instances(iter->child, spath, depth - 1, set)) {
+            return -1;
         }
     }
 
-cleanup:
-    ly_set_free(set);
-    for (j = 0; j < n; j++) {
-        if (!uniqtables[j]) {
-            /* failed when allocating uniquetables[j], following j are not allocated */
-            break;
+    return 0;
+}
+
+int
+lyv_data_unique(struct lyd_node *list)
+{
+    struct lyd_node *diter, *root = NULL;
+    struct ly_set *set;
+    struct lyd_uniq_idx *idx = NULL;
+    const struct lys_node **spath;
+    struct lys_node_list *slist;
+    struct ly_ctx *ctx = list->schema->module->ctx;
+    uint32_t i;
+    int ret;
+
+    if (!(list->validity & LYD_VAL_UNIQUE)) {
+        /* validated as part of another instance validation */
+        return 0;
+    }
+
+    slist = (struct lys_node_list *)list->schema;
+
+#ifdef LY_ENABLED_CACHE
+    root = lyv_uniq_root(list);
+    idx = root ? lyv_uniq_idx_find(root, list->schema) : NULL;
+    if (idx) {
+        /* the index is kept up to date, only this instance has to be checked again */
+        lyv_uniq_idx_remove(idx, list);
+        ret = lyv_uniq_idx_add(idx, list);
+        if (!ret) {
+            list->validity &= ~LYD_VAL_UNIQUE;
+        } else if (ret == -1) {
+            /* the instance may be in some of the tables, start again next time */
+            lyv_uniq_idx_unlink(root, idx);
         }
-        lyht_free(uniqtables[j]);
+        return ret;
+    }
+#endif
+
+    /* get all list instances in the data tree (as its data path without predicates would), from the top-level
+     * siblings (or the root storing the index) following the schema nodes of the list data parents */
+    for (i = 0, diter = list; diter->parent; ++i, diter = diter->parent);
+    spath = malloc((i + 1) * sizeof *spath);
+    LY_CHECK_ERR_RETURN(!spath, LOGMEM(ctx), -1);
+    for (i = 0, diter = list; diter->parent; ++i, diter = diter->parent) {
+        spath[i] = diter->schema;
+    }
+    spath[i] = diter->schema;
+    for (; diter->prev->next; diter = diter->prev);
+
+    set = ly_set_new();
+    if (!set || (root ? lyv_uniq_instances(root->child, spath, i - 1, set) : lyv_uniq_instances(diter, spath, i, set))) {
+        free(spath);
+        ly_set_free(set);
+        return -1;
     }
-    free(uniqtables);
+    free(spath);
+
+    if ((set->number == 2) && lyv_list_uniq_equal(&set->set.d[0], &set->set.d[1], 0, (void *)0)) {
+        /* simple comparison, instance duplication */
+        ly_set_free(set);
+        return 1;
+    }
+
+    ret = lyv_uniq_idx_build(set, slist, &idx);
+    ly_set_free(set);
+#ifdef LY_ENABLED_CACHE
+    if (idx && root) {
+        /* keep it */
+        idx->next = root->uniq;
+        root->uniq = idx;
+        idx = NULL;
+    }
+#endif
+    lyv_uniq_idx_free(idx);
 
     return ret;
 }
 
+#ifdef LY_ENABLED_CACHE
+
+struct lyd_node *
+lyv_uniq_root(struct lyd_node *node)
+{
+    for (; node->parent; node = node->parent);
+
+    /* there can be more instances of a top-level list, so the indexes of the lists in one of them
+     * would not include all the instances */
+    return (node->schema->nodetype & (LYS_CONTAINER | LYS_RPC | LYS_NOTIF)) ? node : NULL;
+}
+
+struct lyd_uniq_idx *
+lyv_uniq_idx_find(struct lyd_node *root, const struct lys_node *schema)
+{
+    struct lyd_uniq_idx *idx;
+
+    for (idx = root->uniq; idx && ((struct lys_node *)idx->slist != schema); idx = idx->next);
+    return idx;
+}
+
+void
+lyv_uniq_idx_unlink(struct lyd_node *root, struct lyd_uniq_idx *idx)
+{
+    struct lyd_uniq_idx **prev_p;
+
+    for (prev_p = &root->uniq; *prev_p != idx; prev_p = &(*prev_p)->next);
+    *prev_p = idx->next;
+    idx->next = NULL;
+    lyv_uniq_idx_free(idx);
+}
+
+#endif
+
 static int
 lyv_list_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
 {
@@ -681,6 +930,9 @@ lyv_data_content(struct lyd_node *node, int options, struct unres_data *unres)
     struct lys_iffeature *iff;
     const char *id, *idname;
     struct ly_ctx *ctx;
+#ifdef LY_ENABLED_CACHE
+    struct lyd_uniq_idx *uniq_idx;
+#endif
 
     assert(node);
     assert(node->schema);
@@ -797,6 +1049,12 @@ lyv_data_content(struct lyd_node *node, int options, struct unres_data *unres)
         if (options & LYD_OPT_TRUSTED) {
             /* just remove flag */
             node->validity &= ~LYD_VAL_UNIQUE;
+#ifdef LY_ENABLED_CACHE
+            /* the instance would stay in the index with its previous values, build it again */
+            if ((diter = lyv_uniq_root(node)) && (uniq_idx = lyv_uniq_idx_find(diter, schema))) {
+                lyv_uniq_idx_unlink(diter, uniq_idx);
+            }
+#endif
         } else {
             /* check the unique constraint at the end (once the parsing is done) */
             if (unres_data_add(unres, node, UNRES_UNIQ_LEAVES)) {
@@ -49,14 +49,88 @@ int lyv_data_context(const struct lyd_node *node, int options, struct unres_data
  */
 int lyv_data_content(struct lyd_node *node, int options, struct unres_data *unres);
 
+/**
+ * @brief Indexed list instance, the value of lyd_uniq_idx#inst records.
+ */
+struct lyd_uniq_inst {
+    struct lyd_node *node;          /**< list instance */
+    uint32_t hash[];                /**< hash of the values of every unique statement, 0 if the values are not complete
+                                         and the instance is not in the table */
+};
+
+/**
+ * @brief Index of the unique statement values of all the instances of a list in a data tree, stored in the
+ * root of the tree (::lyd_node#uniq) if it is a container (or an RPC/notification).
+ *
+ * Instances are indexed when their unique statements are validated. Instances leaving the tree are removed
+ * from the index and the ones entering it are flagged with #LYD_VAL_UNIQUE. So is every instance whose values
+ * may change, its records are not compared with (the values may be stale) and the next validation replaces them
+ * using the stored hashes.
+ */
+struct lyd_uniq_idx {
+    const struct lys_node_list *slist; /**< list schema node */
+    const struct lys_node **leaves;    /**< leaves of all the unique statements, in order */
+    struct hash_table *inst;           /**< all the indexed instances (struct lyd_uniq_inst) */
+    struct hash_table **tables;        /**< instances with complete values (struct lyd_node *) for every unique
+                                            statement, hashed by the values */
+    struct lyd_uniq_inst *tmp;         /**< record buffer */
+    struct lyd_uniq_idx *next;         /**< index of another list in the same tree */
+};
+
 /**
  * @brief Check list unique leaves.
  *
+ * All the instances in the data tree are checked, using (and creating) the unique index of the tree, if it can have one.
+ *
  * @param[in] list List node to be checked.
  * @return 0 on success, non-zero on error.
  */
 int lyv_data_unique(struct lyd_node *list);
 
+/**
+ * @brief Free unique indexes.
+ *
+ * @param[in] idx First index to free, all the following are freed as well.
+ */
+void lyv_uniq_idx_free(struct lyd_uniq_idx *idx);
+
+/**
+ * @brief Remove a list instance from a unique index, if there.
+ *
+ * @param[in] idx Unique index.
+ * @param[in] list List instance.
+ */
+void lyv_uniq_idx_remove(struct lyd_uniq_idx *idx, struct lyd_node *list);
+
+#ifdef LY_ENABLED_CACHE
+
+/**
+ * @brief Get the root of a data tree storing the unique indexes of its lists.
+ *
+ * @param[in] node Any node in the tree.
+ * @return Root node, NULL if the tree cannot store the indexes.
+ */
+struct lyd_node *lyv_uniq_root(struct lyd_node *node);
+
+/**
+ * @brief Find the unique index of a list.
+ *
+ * @param[in] root Root of the data tree.
+ * @param[in] schema List schema node.
+ * @return Index, NULL if the list is not indexed.
+ */
+struct lyd_uniq_idx *lyv_uniq_idx_find(struct lyd_node *root, const struct lys_node *schema);
+
+/**
+ * @brief Remove and free a unique index of a data tree.
+ *
+ * @param[in] root Root of the data tree.
+ * @param[in] idx Index to free.
+ */
+void lyv_uniq_idx_unlink(struct lyd_node *root, struct lyd_uniq_idx *idx);
+
+#endif
+
 /**
  * @brief Check for list/leaflist instance duplications.
  *
@@ -480,6 +480,13 @@ lyxml_getutf8(struct ly_ctx *ctx, const char *buf, unsigned int *read)
     int i;
 
     c = buf[0];
+
+    /* the most common case first, printable ASCII character */
+    if ((c >= 0x20) && (c < 0x7f)) {
+        *read = 1;
+        return c;
+    }
+
     *read = 0;
 
     /* buf is NULL terminated string, so 0 means EOF */
@@ -618,6 +625,14 @@ loop:
             o = 0;
         }
 
+        if (!cdsect && (r = ly_char_run(&data[*len], LY_CHAR_CTRL | LY_CHAR_UTF8 | LY_CHAR_XML, BUFSIZE - o))) {
+            /* copy plain and valid UTF-8 characters at once, the run cannot include the delimiter */
+            memcpy(&buf[o], &data[*len], r);
+            o += r - 1;     /* o is ++ in for loop */
+            (*len) += r;
+            continue;
+        }
+
         if (cdsect || !strncmp(&data[*len], "<![CDATA[", 9)) {
             /* CDSect */
             if (!cdsect) {
@@ -1266,12 +1281,24 @@ int
 lyxml_dump_text(struct lyout *out, const char *text, LYXML_DATA_TYPE type)
 {
     unsigned int i, n;
+    size_t len;
 
     if (!text) {
         return 0;
     }
 
     for (i = n = 0; text[i]; i++) {
+        /* write all the characters not needing escaping at once */
+        len = ly_char_run(&text[i], LY_CHAR_CTRL | LY_CHAR_XML, SIZE_MAX);
+        if (len) {
+            ly_write(out, &text[i], len);
+            n += len;
+            i += len;
+            if (!text[i]) {
+                break;
+            }
+        }
+
         switch (text[i]) {
         case '&':
             n += ly_print(out, "&amp;");
@@ -382,6 +382,9 @@ cast_string_recursive(struct lyd_node *node, struct lys_module *local_mod, int f
         strcpy(*str + (*used - 1), "\n");
         ++(*used);
 
+        if (node->virt && lyd_wd_virtual_create(node)) {
+            return -1;
+        }
         LY_TREE_FOR(node->child, child) {
             if (cast_string_recursive(child, local_mod, 0, root_type, indent + 1, str, used, size)) {
                 return -1;
@@ -5461,6 +5464,10 @@ moveto_node(struct lyxp_set *set, struct lyd_node *cur_node, const char *qname,
         } else if (!(set->val.nodes[i].node->validity & LYD_VAL_INUSE)
                 && !(set->val.nodes[i].node->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA))) {
 
+            if (set->val.nodes[i].node->virt && lyd_wd_virtual_create(set->val.nodes[i].node)) {
+                lydict_remove(ctx, name_dict);
+                return -1;
+            }
             LY_TREE_FOR(set->val.nodes[i].node->child, sub) {
                 ret = moveto_node_check(sub, root_type, name_dict, moveto_mod, options);
                 if (!ret) {
@@ -5723,6 +5730,10 @@ moveto_node_alldesc(struct lyxp_set *set, struct lyd_node *cur_node, const char
             if (elem->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) {
                 next = NULL;
             } else {
+                if (elem->virt && lyd_wd_virtual_create(elem)) {
+                    set_free_content(&ret_set);
+                    return -1;
+                }
                 next = elem->child;
             }
             if (!next) {
@@ -6170,6 +6181,9 @@ moveto_self_add_children_r(const struct lyd_node *parent, uint32_t parent_pos, e
     case LYXP_NODE_ELEM:
         /* add all the children ... */
         if (!(parent->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST))) {
+            if (parent->virt && lyd_wd_virtual_create((struct lyd_node *)parent)) {
+                return -1;
+            }
             LY_TREE_FOR(parent->child, sub) {
                 /* context check */
                 if ((root_type == LYXP_NODE_ROOT_CONFIG) && (sub->schema->flags & LYS_CONFIG_R)) {
@@ -8434,42 +8448,45 @@ eval_expr_select(struct lyxp_expr *exp, uint16_t *exp_idx, enum lyxp_expr_type e
     return ret;
 }
 
-int
-lyxp_eval(const char *expr, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
-          const struct lys_module *local_mod, struct lyxp_set *set, int options)
+struct lyxp_expr *
+lyxp_compile_expr(struct ly_ctx *ctx, const char *expr)
 {
-    struct ly_ctx *ctx;
     struct lyxp_expr *exp;
     uint16_t exp_idx = 0;
-    int rc = -1;
-
-    if (!expr || !local_mod || !set) {
-        LOGARG;
-        return EXIT_FAILURE;
-    }
-
-    ctx = local_mod->ctx;
 
     exp = lyxp_parse_expr(ctx, expr);
     if (!exp) {
-        rc = -1;
-        goto finish;
+        return NULL;
     }
 
-    rc = reparse_or_expr(ctx, exp, &exp_idx);
-    if (rc) {
-        goto finish;
+    if (reparse_or_expr(ctx, exp, &exp_idx)) {
+        lyxp_expr_free(exp);
+        return NULL;
     } else if (exp->used > exp_idx) {
         LOGVAL(ctx, LYE_XPATH_INTOK, LY_VLOG_NONE, NULL, "Unknown", &exp->expr[exp->expr_pos[exp_idx]]);
         LOGVAL(ctx, LYE_SPEC, LY_VLOG_NONE, NULL, "Unparsed characters \"%s\" left at the end of an XPath expression.",
                &exp->expr[exp->expr_pos[exp_idx]]);
-        rc = -1;
-        goto finish;
+        lyxp_expr_free(exp);
+        return NULL;
     }
 
     print_expr_struct_debug(exp);
 
-    exp_idx = 0;
+    return exp;
+}
+
+int
+lyxp_eval_expr(struct lyxp_expr *exp, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
+               const struct lys_module *local_mod, struct lyxp_set *set, int options)
+{
+    uint16_t exp_idx = 0;
+    int rc;
+
+    if (!exp || !local_mod || !set) {
+        LOGARG;
+        return EXIT_FAILURE;
+    }
+
     memset(set, 0, sizeof *set);
     set->type = LYXP_SET_EMPTY;
     if (cur_node) {
@@ -8481,11 +8498,32 @@ lyxp_eval(const char *expr, const struct lyd_node *cur_node, enum lyxp_node_type
         rc = EXIT_SUCCESS;
     }
     if ((rc == -1) && cur_node) {
-        LOGPATH(ctx, LY_VLOG_LYD, cur_node);
+        LOGPATH(local_mod->ctx, LY_VLOG_LYD, cur_node);
         lyxp_set_cast(set, LYXP_SET_EMPTY, cur_node, local_mod, options);
     }
 
-finish:
+    return rc;
+}
+
+int
+lyxp_eval(const char *expr, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
+          const struct lys_module *local_mod, struct lyxp_set *set, int options)
+{
+    struct lyxp_expr *exp;
+    int rc;
+
+    if (!expr || !local_mod || !set) {
+        LOGARG;
+        return EXIT_FAILURE;
+    }
+
+    exp = lyxp_compile_expr(local_mod->ctx, expr);
+    if (!exp) {
+        return -1;
+    }
+
+    rc = lyxp_eval_expr(exp, cur_node, cur_node_type, local_mod, set, options);
+
     lyxp_expr_free(exp);
     return rc;
 }
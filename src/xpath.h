@@ -256,6 +256,30 @@ struct lyxp_set {
 int lyxp_eval(const char *expr, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
               const struct lys_module *local_mod, struct lyxp_set *set, int options);
 
+/**
+ * @brief Parse an XPath expression and check its grammar so that it can be evaluated repeatedly
+ * with lyxp_eval_expr() without parsing it again. Logs directly.
+ *
+ * @param[in] ctx Context for errors.
+ * @param[in] expr XPath expression to compile. Must be in JSON format (prefixes are model names). It is duplicated.
+ * @return Compiled expression or NULL on error.
+ */
+struct lyxp_expr *lyxp_compile_expr(struct ly_ctx *ctx, const char *expr);
+
+/**
+ * @brief Evaluate an XPath expression compiled by lyxp_compile_expr() on data. Works exactly like lyxp_eval().
+ *
+ * @param[in] exp Compiled expression to evaluate.
+ * @param[in] cur_node Current (context) data node, see lyxp_eval().
+ * @param[in] cur_node_type Current (context) data node type, see lyxp_eval().
+ * @param[in] local_mod Local module relative to the \p exp.
+ * @param[out] set Result set, see lyxp_eval().
+ * @param[in] options Whether to apply some evaluation restrictions, see lyxp_eval().
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on unresolved when dependency, -1 on error.
+ */
+int lyxp_eval_expr(struct lyxp_expr *exp, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
+                   const struct lys_module *local_mod, struct lyxp_set *set, int options);
+
 /**
  * @brief Get all the partial XPath nodes (atoms) that are required for \p expr to be evaluated.
  *
@@ -0,0 +1,802 @@
+/**
+ * @file xpath_filter.c
+ * @brief Matching data trees and their changes against a set of XPath filters
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libyang.h"
+#include "common.h"
+#include "context.h"
+#include "tree_data.h"
+#include "tree_internal.h"
+#include "hash_table.h"
+#include "xpath.h"
+
+/*
+ * Every filter is compiled once and classified by its tokens:
+ *
+ * - LYXF_SIMPLE - a location path without predicates (possibly a union of them), any instance of any
+ *                 of its target schema nodes means it selects something, it is never evaluated,
+ * - LYXF_PATH - a location path with predicates, it can only select instances of its target schema nodes
+ *               so it is evaluated only when there are some,
+ * - LYXF_GENERIC - any other expression (functions, comparisons, ...), it is always evaluated.
+ *
+ * The target schema nodes of SIMPLE and PATH filters are learned by atomizing the filter and all the
+ * filters are indexed by them in a single hash table. Matching a data tree is then one DFS pass with
+ * a single hash table lookup per data node and evaluation only of the filters whose targets were met.
+ */
+#define LYXF_SIMPLE 1
+#define LYXF_PATH 2
+#define LYXF_GENERIC 3
+
+/**
+ * @brief Cached filter evaluation result on one data tree.
+ */
+struct lyxf_eval {
+    const struct lyd_node *root;     /**< first top-level sibling of the evaluated data tree */
+    struct ly_set *nodes;            /**< selected nodes, NULL if the result was not a node-set */
+    int result;                      /**< result cast to boolean */
+};
+
+/**
+ * @brief Compiled filter.
+ */
+struct lyxf_filter {
+    void *priv;                      /**< user pointer identifying the filter, NULL for a free slot */
+    const char *expr;                /**< filter expression with all the prefixes, in the dictionary */
+    struct lyxp_expr *exp;           /**< compiled expression */
+    const struct lys_module *mod;    /**< module of the first step, used as the local module */
+    uint32_t visit;                  /**< last stamp this filter was collected in */
+    uint32_t match;                  /**< last pass this filter matched in */
+    uint8_t kind;                    /**< LYXF_SIMPLE, LYXF_PATH, or LYXF_GENERIC */
+    struct lyxf_eval eval[2];        /**< evaluation results in the current pass (diff refers to 2 trees) */
+};
+
+/**
+ * @brief Record of the schema node index.
+ */
+struct lyxf_index_rec {
+    const struct lys_node *snode;    /**< target schema node, must be first (compared by the hash table) */
+    uint32_t count;                  /**< number of filters */
+    uint32_t *filters;               /**< indexes of the filters targeting the schema node */
+};
+
+struct lyd_xpath_filters {
+    struct ly_ctx *ctx;
+    struct lyxf_filter *filters;     /**< filters, can include free slots */
+    uint32_t count;                  /**< number of filter slots */
+    struct hash_table *index;        /**< schema node index (struct lyxf_index_rec) */
+    uint32_t *generic;               /**< indexes of LYXF_GENERIC filters */
+    uint32_t generic_count;
+    uint32_t stamp;                  /**< last used stamp */
+};
+
+static uint32_t
+lyxf_index_hash(const struct lys_node *snode)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&snode, sizeof snode);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+static struct lyxf_index_rec *
+lyxf_index_find(struct lyd_xpath_filters *filters, const struct lys_node *snode)
+{
+    struct lyxf_index_rec rec, *match;
+
+    rec.snode = snode;
+    if (lyht_find(filters->index, &rec, lyxf_index_hash(snode), (void **)&match)) {
+        return NULL;
+    }
+    return match;
+}
+
+static int
+lyxf_index_add(struct lyd_xpath_filters *filters, const struct lys_node *snode, uint32_t idx)
+{
+    struct lyxf_index_rec rec, *match;
+    uint32_t *new;
+
+    rec.snode = snode;
+    rec.count = 0;
+    rec.filters = NULL;
+    if (lyht_insert(filters->index, &rec, lyxf_index_hash(snode), (void **)&match) == -1) {
+        return -1;
+    }
+
+    if (match->count && (match->filters[match->count - 1] == idx)) {
+        /* already added */
+        return 0;
+    }
+
+    new = realloc(match->filters, (match->count + 1) * sizeof *match->filters);
+    LY_CHECK_ERR_RETURN(!new, LOGMEM(filters->ctx), -1);
+    match->filters = new;
+    match->filters[match->count++] = idx;
+    return 0;
+}
+
+static void
+lyxf_index_del(struct lyd_xpath_filters *filters, uint32_t idx)
+{
+    struct lyxf_index_rec *rec;
+    void *val_p;
+    uint32_t i = 0, j;
+
+    while (lyht_iter_next(filters->index, &i, &val_p)) {
+        rec = (struct lyxf_index_rec *)val_p;
+        for (j = 0; j < rec->count; ++j) {
+            if (rec->filters[j] == idx) {
+                rec->filters[j] = rec->filters[--rec->count];
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Classify a filter expression by its tokens.
+ *
+ * @param[in] exp Compiled expression.
+ * @return LYXF_SIMPLE, LYXF_PATH, or LYXF_GENERIC.
+ */
+static uint8_t
+lyxf_classify(const struct lyxp_expr *exp)
+{
+    uint16_t i;
+    uint32_t depth = 0;
+    uint8_t kind = LYXF_SIMPLE;
+
+    if (!exp->used || (exp->tokens[0] != LYXP_TOKEN_OPERATOR_PATH)) {
+        /* not an absolute location path */
+        return LYXF_GENERIC;
+    }
+
+    for (i = 0; i < exp->used; ++i) {
+        switch (exp->tokens[i]) {
+        case LYXP_TOKEN_BRACK1:
+            ++depth;
+            kind = LYXF_PATH;
+            break;
+        case LYXP_TOKEN_BRACK2:
+            --depth;
+            break;
+        case LYXP_TOKEN_NAMETEST:
+        case LYXP_TOKEN_OPERATOR_PATH:
+            break;
+        case LYXP_TOKEN_OPERATOR_UNI:
+            if (!depth && (i + 1 < exp->used) && (exp->tokens[i + 1] != LYXP_TOKEN_OPERATOR_PATH)) {
+                /* union with a relative or non-path expression */
+                return LYXF_GENERIC;
+            }
+            break;
+        default:
+            if (!depth) {
+                /* anything else outside predicates changes the meaning of the result */
+                return LYXF_GENERIC;
+            }
+            break;
+        }
+    }
+
+    return kind;
+}
+
+/**
+ * @brief Learn the module of the first step of a filter expression.
+ */
+static const struct lys_module *
+lyxf_first_module(struct ly_ctx *ctx, const struct lyxp_expr *exp)
+{
+    const struct lys_module *mod;
+    const char *name, *colon;
+    uint16_t i;
+
+    for (i = 0; (i < exp->used) && (exp->tokens[i] != LYXP_TOKEN_NAMETEST); ++i);
+    if (i == exp->used) {
+        LOGVAL(ctx, LYE_SPEC, LY_VLOG_NONE, NULL, "XPath filter \"%s\" does not reference any node.", exp->expr);
+        return NULL;
+    }
+
+    name = &exp->expr[exp->expr_pos[i]];
+    colon = memchr(name, ':', exp->tok_len[i]);
+    if (!colon) {
+        LOGVAL(ctx, LYE_SPEC, LY_VLOG_NONE, NULL, "XPath filter \"%s\" must start with a prefixed node.", exp->expr);
+        return NULL;
+    }
+
+    mod = ly_ctx_nget_module(ctx, name, colon - name, NULL, 1);
+    if (!mod) {
+        LOGVAL(ctx, LYE_XPATH_INMOD, LY_VLOG_NONE, NULL, (int)(colon - name), name);
+        return NULL;
+    }
+
+    return mod;
+}
+
+/**
+ * @brief Add the target schema nodes of a filter into the index.
+ *
+ * @return 0 on success, 1 if the targets could not be learned, -1 on error.
+ */
+static int
+lyxf_index_targets(struct lyd_xpath_filters *filters, uint32_t idx)
+{
+    struct lyxf_filter *filter = &filters->filters[idx];
+    const struct lys_node *snode;
+    struct lyxp_set set;
+    uint32_t i, targets = 0;
+    int rc = 0;
+
+    snode = lys_getnext(NULL, NULL, filter->mod, LYS_GETNEXT_NOSTATECHECK);
+    if (!snode) {
+        return 1;
+    }
+
+    memset(&set, 0, sizeof set);
+    if (lyxp_atomize(filter->expr, snode, LYXP_NODE_ROOT, &set, LYXP_SNODE, NULL)) {
+        free(set.val.snodes);
+        return 1;
+    }
+
+    for (i = 0; i < set.used; ++i) {
+        /* the nodes left in the context are the nodes that can be selected */
+        if ((set.val.snodes[i].type != LYXP_NODE_ELEM) || (set.val.snodes[i].in_ctx != 1)) {
+            continue;
+        }
+        if (lyxf_index_add(filters, set.val.snodes[i].snode, idx)) {
+            rc = -1;
+            break;
+        }
+        ++targets;
+    }
+    free(set.val.snodes);
+
+    if (!rc && !targets) {
+        /* it cannot select anything that we know of */
+        rc = 1;
+    }
+    return rc;
+}
+
+static void
+lyxf_eval_clear(struct lyxf_filter *filter)
+{
+    int i;
+
+    for (i = 0; i < 2; ++i) {
+        ly_set_free(filter->eval[i].nodes);
+        memset(&filter->eval[i], 0, sizeof filter->eval[i]);
+    }
+}
+
+/**
+ * @brief Get a new stamp for a matching pass or for collecting filters.
+ */
+static uint32_t
+lyxf_stamp_next(struct lyd_xpath_filters *filters)
+{
+    uint32_t i;
+
+    if (!++filters->stamp) {
+        /* overflow, start again */
+        for (i = 0; i < filters->count; ++i) {
+            filters->filters[i].visit = 0;
+            filters->filters[i].match = 0;
+        }
+        filters->stamp = 1;
+    }
+
+    return filters->stamp;
+}
+
+/**
+ * @brief Evaluate a filter on a data tree, results are cached for the current pass.
+ *
+ * @param[in] filter Filter to evaluate.
+ * @param[in] node Any node of the data tree.
+ * @return Evaluation result, NULL on error.
+ */
+static struct lyxf_eval *
+lyxf_evaluate(struct lyxf_filter *filter, const struct lyd_node *node)
+{
+    const struct lyd_node *root;
+    struct lyxf_eval *eval;
+    struct lyxp_set xp_set;
+    uint32_t i;
+
+    for (root = node; root->parent; root = root->parent);
+    for (; root->prev->next; root = root->prev);
+
+    for (i = 0; i < 2; ++i) {
+        if (filter->eval[i].root == root) {
+            return &filter->eval[i];
+        }
+    }
+    for (i = 0; (i < 2) && filter->eval[i].root; ++i);
+    if (i == 2) {
+        /* a third tree, should not happen with a diff */
+        ly_set_free(filter->eval[1].nodes);
+        i = 1;
+    }
+    eval = &filter->eval[i];
+    memset(eval, 0, sizeof *eval);
+
+    memset(&xp_set, 0, sizeof xp_set);
+    if (lyxp_eval_expr(filter->exp, root, LYXP_NODE_ELEM, filter->mod, &xp_set, 0) != EXIT_SUCCESS) {
+        lyxp_set_cast(&xp_set, LYXP_SET_EMPTY, root, filter->mod, 0);
+        return NULL;
+    }
+
+    if (xp_set.type == LYXP_SET_NODE_SET) {
+        eval->nodes = ly_set_new();
+        LY_CHECK_ERR_RETURN(!eval->nodes, LOGMEM(filter->mod->ctx); lyxp_set_cast(&xp_set, LYXP_SET_EMPTY, root, filter->mod, 0), NULL);
+        for (i = 0; i < xp_set.used; ++i) {
+            if ((xp_set.val.nodes[i].type == LYXP_NODE_ELEM) && (ly_set_add(eval->nodes, xp_set.val.nodes[i].node, 0) == -1)) {
+                lyxp_set_cast(&xp_set, LYXP_SET_EMPTY, root, filter->mod, 0);
+                return NULL;
+            }
+        }
+        eval->result = eval->nodes->number ? 1 : 0;
+    } else {
+        lyxp_set_cast(&xp_set, LYXP_SET_BOOLEAN, root, filter->mod, 0);
+        eval->result = xp_set.val.bool;
+    }
+    lyxp_set_cast(&xp_set, LYXP_SET_EMPTY, root, filter->mod, 0);
+
+    eval->root = root;
+    return eval;
+}
+
+/**
+ * @brief Learn whether an evaluated filter selected the changed node, its ancestor or its descendant.
+ */
+static int
+lyxf_eval_overlaps(struct lyxf_eval *eval, const struct lyd_node *node)
+{
+    const struct lyd_node *iter;
+    uint32_t i;
+
+    if (!eval->nodes) {
+        /* not a node-set, just the result */
+        return eval->result;
+    }
+
+    for (iter = node; iter; iter = iter->parent) {
+        if (ly_set_contains(eval->nodes, (void *)iter) > -1) {
+            return 1;
+        }
+    }
+
+    for (i = 0; i < eval->nodes->number; ++i) {
+        for (iter = eval->nodes->set.d[i]->parent; iter; iter = iter->parent) {
+            if (iter == node) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+API struct lyd_xpath_filters *
+lyd_xpath_filters_new(struct ly_ctx *ctx)
+{
+    struct lyd_xpath_filters *filters;
+
+    if (!ctx) {
+        LOGARG;
+        return NULL;
+    }
+
+    filters = calloc(1, sizeof *filters);
+    LY_CHECK_ERR_RETURN(!filters, LOGMEM(ctx), NULL);
+
+    filters->ctx = ctx;
+    /* records are identified by the schema node pointer they start with */
+    filters->index = lyht_new(8, sizeof(struct lyxf_index_rec), NULL, NULL, 1);
+    LY_CHECK_ERR_RETURN(!filters->index, LOGMEM(ctx); free(filters), NULL);
+
+    return filters;
+}
+
+API int
+lyd_xpath_filters_add(struct lyd_xpath_filters *filters, const char *xpath, void *priv)
+{
+    struct lyxf_filter *filter, *new;
+    struct lyxp_expr *exp;
+    const struct lys_module *mod;
+    char *expr;
+    uint32_t idx, *new_generic;
+    int r;
+
+    if (!filters || !xpath || !priv) {
+        LOGARG;
+        return EXIT_FAILURE;
+    }
+
+    /* learn the module of the first node and add all the implicit prefixes */
+    exp = lyxp_parse_expr(filters->ctx, xpath);
+    if (!exp) {
+        return EXIT_FAILURE;
+    }
+    mod = lyxf_first_module(filters->ctx, exp);
+    lyxp_expr_free(exp);
+    if (!mod) {
+        return EXIT_FAILURE;
+    }
+    expr = transform_json2xpath(mod, xpath);
+    if (!expr) {
+        return EXIT_FAILURE;
+    }
+
+    exp = lyxp_compile_expr(filters->ctx, expr);
+    if (!exp) {
+        free(expr);
+        return EXIT_FAILURE;
+    }
+
+    /* find a free slot */
+    for (idx = 0; (idx < filters->count) && filters->filters[idx].priv; ++idx);
+    if (idx == filters->count) {
+        new = realloc(filters->filters, (filters->count + 1) * sizeof *filters->filters);
+        LY_CHECK_ERR_RETURN(!new, LOGMEM(filters->ctx); free(expr); lyxp_expr_free(exp), EXIT_FAILURE);
+        filters->filters = new;
+        ++filters->count;
+    }
+    filter = &filters->filters[idx];
+    memset(filter, 0, sizeof *filter);
+    filter->priv = priv;
+    filter->expr = lydict_insert_zc(filters->ctx, expr);
+    filter->exp = exp;
+    filter->mod = mod;
+    filter->kind = lyxf_classify(exp);
+
+    if (filter->kind != LYXF_GENERIC) {
+        r = lyxf_index_targets(filters, idx);
+        if (r == -1) {
+            goto error;
+        } else if (r) {
+            /* we do not know what it can select, so always evaluate it */
+            lyxf_index_del(filters, idx);
+            filter->kind = LYXF_GENERIC;
+        }
+    }
+
+    if (filter->kind == LYXF_GENERIC) {
+        new_generic = realloc(filters->generic, (filters->generic_count + 1) * sizeof *filters->generic);
+        LY_CHECK_ERR_GOTO(!new_generic, LOGMEM(filters->ctx), error);
+        filters->generic = new_generic;
+        filters->generic[filters->generic_count++] = idx;
+    }
+
+    return EXIT_SUCCESS;
+
+error:
+    lyxf_index_del(filters, idx);
+    lydict_remove(filters->ctx, filter->expr);
+    lyxp_expr_free(filter->exp);
+    memset(filter, 0, sizeof *filter);
+    return EXIT_FAILURE;
+}
+
+API int
+lyd_xpath_filters_remove(struct lyd_xpath_filters *filters, void *priv)
+{
+    struct lyxf_filter *filter;
+    uint32_t idx, i;
+    int found = 0;
+
+    if (!filters || !priv) {
+        LOGARG;
+        return EXIT_FAILURE;
+    }
+
+    for (idx = 0; idx < filters->count; ++idx) {
+        filter = &filters->filters[idx];
+        if (filter->priv != priv) {
+            continue;
+        }
+
+        if (filter->kind == LYXF_GENERIC) {
+            for (i = 0; filters->generic[i] != idx; ++i);
+            filters->generic[i] = filters->generic[--filters->generic_count];
+        } else {
+            lyxf_index_del(filters, idx);
+        }
+
+        lydict_remove(filters->ctx, filter->expr);
+        lyxp_expr_free(filter->exp);
+        lyxf_eval_clear(filter);
+        memset(filter, 0, sizeof *filter);
+        found = 1;
+    }
+
+    if (!found) {
+        LOGERR(filters->ctx, LY_EINVAL, "XPath filter to remove not found.");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+API void
+lyd_xpath_filters_free(struct lyd_xpath_filters *filters)
+{
+    struct lyxf_index_rec *rec;
+    void *val_p;
+    uint32_t i = 0;
+
+    if (!filters) {
+        return;
+    }
+
+    while (lyht_iter_next(filters->index, &i, &val_p)) {
+        rec = (struct lyxf_index_rec *)val_p;
+        free(rec->filters);
+    }
+    lyht_free(filters->index);
+
+    for (i = 0; i < filters->count; ++i) {
+        if (filters->filters[i].priv) {
+            lydict_remove(filters->ctx, filters->filters[i].expr);
+            lyxp_expr_free(filters->filters[i].exp);
+            lyxf_eval_clear(&filters->filters[i]);
+        }
+    }
+    free(filters->filters);
+    free(filters->generic);
+    free(filters);
+}
+
+/**
+ * @brief Collect the filters that can select a node. Simple filters are matched directly, others are added
+ * into the candidates to evaluate.
+ *
+ * @param[in] filters Filters.
+ * @param[in] node Data node.
+ * @param[in] pass Current matching pass.
+ * @param[in] visit Stamp of the current collection, every filter is collected only once.
+ * @param[in,out] matches Set of user pointers of the matched filters.
+ * @param[in,out] candidates Set of the filters to evaluate.
+ * @return 0 on success, -1 on error.
+ */
+static int
+lyxf_collect_filters(struct lyd_xpath_filters *filters, const struct lyd_node *node, uint32_t pass, uint32_t visit,
+                     struct ly_set *matches, struct ly_set *candidates)
+{
+    struct lyxf_index_rec *rec;
+    struct lyxf_filter *filter;
+    uint32_t i;
+
+    rec = lyxf_index_find(filters, node->schema);
+    if (!rec) {
+        return 0;
+    }
+
+    for (i = 0; i < rec->count; ++i) {
+        filter = &filters->filters[rec->filters[i]];
+        if ((filter->visit == visit) || (filter->match == pass)) {
+            /* already collected or even matched */
+            continue;
+        }
+        filter->visit = visit;
+
+        if (filter->kind == LYXF_SIMPLE) {
+            /* an instance of the target is enough */
+            filter->match = pass;
+            if (ly_set_add(matches, filter->priv, 0) == -1) {
+                return -1;
+            }
+        } else if (ly_set_add(candidates, filter, LY_SET_OPT_USEASLIST) == -1) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+API struct ly_set *
+lyd_xpath_filters_match(struct lyd_xpath_filters *filters, const struct lyd_node *data)
+{
+    const struct lyd_node *root, *sibling, *next, *elem;
+    struct lyxf_filter *filter;
+    struct lyxf_eval *eval;
+    struct ly_set *matches, *candidates = NULL;
+    uint32_t i, pass;
+
+    if (!filters) {
+        LOGARG;
+        return NULL;
+    }
+
+    matches = ly_set_new();
+    LY_CHECK_ERR_RETURN(!matches, LOGMEM(filters->ctx), NULL);
+    if (!data) {
+        return matches;
+    }
+    candidates = ly_set_new();
+    LY_CHECK_ERR_GOTO(!candidates, LOGMEM(filters->ctx), error);
+
+    for (root = data; root->parent; root = root->parent);
+    for (; root->prev->next; root = root->prev);
+
+    pass = lyxf_stamp_next(filters);
+
+    /* single pass through the data, collect filters that can select something */
+    LY_TREE_FOR(root, sibling) {
+        LY_TREE_DFS_BEGIN(sibling, next, elem) {
+            if (lyxf_collect_filters(filters, elem, pass, pass, matches, candidates)) {
+                goto error;
+            }
+            LY_TREE_DFS_END(sibling, next, elem);
+        }
+    }
+
+    for (i = 0; i < filters->generic_count; ++i) {
+        if (ly_set_add(candidates, &filters->filters[filters->generic[i]], LY_SET_OPT_USEASLIST) == -1) {
+            goto error;
+        }
+    }
+
+    /* evaluate the rest */
+    for (i = 0; i < candidates->number; ++i) {
+        filter = (struct lyxf_filter *)candidates->set.g[i];
+        eval = lyxf_evaluate(filter, root);
+        if (eval && eval->result) {
+            filter->match = pass;
+            if (ly_set_add(matches, filter->priv, 0) == -1) {
+                eval = NULL;
+            }
+        }
+        lyxf_eval_clear(filter);
+        if (!eval) {
+            goto error;
+        }
+    }
+
+    ly_set_free(candidates);
+    return matches;
+
+error:
+    ly_set_free(candidates);
+    ly_set_free(matches);
+    return NULL;
+}
+
+/**
+ * @brief Match filters against a single change.
+ *
+ * @param[in] filters Filters.
+ * @param[in] node Changed (created, deleted, moved) data node.
+ * @param[in] pass Current matching pass.
+ * @param[in,out] matches Set of user pointers of the matched filters.
+ * @param[in] candidates Auxiliary set.
+ * @return 0 on success, -1 on error.
+ */
+static int
+lyxf_match_change(struct lyd_xpath_filters *filters, const struct lyd_node *node, uint32_t pass, struct ly_set *matches,
+                  struct ly_set *candidates)
+{
+    const struct lyd_node *iter, *next, *elem;
+    struct lyxf_filter *filter;
+    struct lyxf_eval *eval;
+    uint32_t i, visit;
+
+    ly_set_clean(candidates);
+    visit = lyxf_stamp_next(filters);
+
+    /* the change is in the subtree of a selected node */
+    for (iter = node; iter; iter = iter->parent) {
+        if (lyxf_collect_filters(filters, iter, pass, visit, matches, candidates)) {
+            return -1;
+        }
+    }
+
+    /* a selected node was changed with the subtree */
+    if (!(node->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA))) {
+        LY_TREE_FOR(node->child, iter) {
+            LY_TREE_DFS_BEGIN(iter, next, elem) {
+                if (lyxf_collect_filters(filters, elem, pass, visit, matches, candidates)) {
+                    return -1;
+                }
+                LY_TREE_DFS_END(iter, next, elem);
+            }
+        }
+    }
+
+    for (i = 0; i < filters->generic_count; ++i) {
+        filter = &filters->filters[filters->generic[i]];
+        if ((filter->match != pass) && (ly_set_add(candidates, filter, LY_SET_OPT_USEASLIST) == -1)) {
+            return -1;
+        }
+    }
+
+    /* evaluate the candidates on the tree of the change, the results are cached for the whole diff */
+    for (i = 0; i < candidates->number; ++i) {
+        filter = (struct lyxf_filter *)candidates->set.g[i];
+        eval = lyxf_evaluate(filter, node);
+        if (!eval) {
+            return -1;
+        }
+        if (lyxf_eval_overlaps(eval, node)) {
+            filter->match = pass;
+            if (ly_set_add(matches, filter->priv, 0) == -1) {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+API struct ly_set *
+lyd_xpath_filters_match_diff(struct lyd_xpath_filters *filters, const struct lyd_difflist *diff)
+{
+    const struct lyd_node *node;
+    struct ly_set *matches, *candidates = NULL;
+    uint32_t i, pass;
+    int rc = 0;
+
+    if (!filters || !diff) {
+        LOGARG;
+        return NULL;
+    }
+
+    matches = ly_set_new();
+    LY_CHECK_ERR_RETURN(!matches, LOGMEM(filters->ctx), NULL);
+    candidates = ly_set_new();
+    LY_CHECK_ERR_GOTO(!candidates, LOGMEM(filters->ctx); rc = -1, cleanup);
+
+    pass = lyxf_stamp_next(filters);
+
+    for (i = 0; diff->type[i] != LYD_DIFF_END; ++i) {
+        switch (diff->type[i]) {
+        case LYD_DIFF_DELETED:
+        case LYD_DIFF_MOVEDAFTER1:
+            node = diff->first[i];
+            break;
+        case LYD_DIFF_CHANGED:
+        case LYD_DIFF_CREATED:
+        case LYD_DIFF_MOVEDAFTER2:
+            node = diff->second[i];
+            break;
+        default:
+            node = NULL;
+            break;
+        }
+        if (!node) {
+            continue;
+        }
+
+        rc = lyxf_match_change(filters, node, pass, matches, candidates);
+        if (rc) {
+            break;
+        }
+    }
+
+cleanup:
+    /* throw away the cached evaluations */
+    for (i = 0; i < filters->count; ++i) {
+        if (filters->filters[i].priv) {
+            lyxf_eval_clear(&filters->filters[i]);
+        }
+    }
+    ly_set_free(candidates);
+    if (rc) {
+        ly_set_free(matches);
+        return NULL;
+    }
+    return matches;
+}
@@ -405,6 +405,141 @@ test_move3(void **state)
     lyd_free_diff(diff);
 }
 
+static void
+test_toplevel(void **state)
+{
+    struct state *st = (*state);
+    const char *yang = "module top {namespace urn:libyang:tests:top; prefix t;"
+                       "list item {key name; leaf name {type string;} leaf value {type uint8;}}"
+                       "leaf-list order {ordered-by user; type uint8;}}";
+    const char *xml1 = "<item xmlns=\"urn:libyang:tests:top\"><name>a</name><value>1</value></item>"
+                       "<item xmlns=\"urn:libyang:tests:top\"><name>b</name><value>1</value></item>"
+                       "<item xmlns=\"urn:libyang:tests:top\"><name>c</name><value>1</value></item>"
+                       "<item xmlns=\"urn:libyang:tests:top\"><name>d</name><value>1</value></item>"
+                       "<item xmlns=\"urn:libyang:tests:top\"><name>e</name><value>1</value></item>"
+                       "<item xmlns=\"urn:libyang:tests:top\"><name>f</name><value>1</value></item>"
+                       "<order xmlns=\"urn:libyang:tests:top\">1</order>"
+                       "<order xmlns=\"urn:libyang:tests:top\">2</order>"
+                       "<order xmlns=\"urn:libyang:tests:top\">3</order>"
+                       "<order xmlns=\"urn:libyang:tests:top\">4</order>"
+                       "<order xmlns=\"urn:libyang:tests:top\">5</order>";
+    const char *xml2 = "<item xmlns=\"urn:libyang:tests:top\"><name>a</name><value>1</value></item>"
+                       "<item xmlns=\"urn:libyang:tests:top\"><name>b</name><value>1</value></item>"
+                       "<item xmlns=\"urn:libyang:tests:top\"><name>d</name><value>1</value></item>"
+                       "<item xmlns=\"urn:libyang:tests:top\"><name>e</name><value>2</value></item>"
+                       "<item xmlns=\"urn:libyang:tests:top\"><name>f</name><value>1</value></item>"
+                       "<item xmlns=\"urn:libyang:tests:top\"><name>g</name><value>1</value></item>"
+                       "<order xmlns=\"urn:libyang:tests:top\">1</order>"
+                       "<order xmlns=\"urn:libyang:tests:top\">3</order>"
+                       "<order xmlns=\"urn:libyang:tests:top\">4</order>"
+                       "<order xmlns=\"urn:libyang:tests:top\">2</order>"
+                       "<order xmlns=\"urn:libyang:tests:top\">5</order>";
+    char *str;
+    struct lyd_difflist *diff;
+
+    /* enough top-level siblings to be searched in a temporary hash table */
+    assert_ptr_not_equal(lys_parse_mem(st->ctx, yang, LYS_IN_YANG), NULL);
+    assert_ptr_not_equal((st->first = lyd_parse_mem(st->ctx, xml1, LYD_XML, LYD_OPT_CONFIG)), NULL);
+    assert_ptr_not_equal((st->second = lyd_parse_mem(st->ctx, xml2, LYD_XML, LYD_OPT_CONFIG)), NULL);
+
+    assert_ptr_not_equal((diff = lyd_diff(st->first, st->second, 0)), NULL);
+    assert_ptr_not_equal(diff->type, NULL);
+
+    assert_int_equal(diff->type[0], LYD_DIFF_CHANGED);
+    assert_string_equal((str = lyd_path(diff->first[0])), "/top:item[name='e']/value");
+    free(str);
+    assert_string_equal((str = lyd_path(diff->second[0])), "/top:item[name='e']/value");
+    free(str);
+
+    assert_int_equal(diff->type[1], LYD_DIFF_DELETED);
+    assert_string_equal((str = lyd_path(diff->first[1])), "/top:item[name='c']");
+    free(str);
+    assert_ptr_equal(diff->second[1], NULL);
+
+    assert_int_equal(diff->type[2], LYD_DIFF_MOVEDAFTER1);
+    assert_string_equal((str = lyd_path(diff->first[2])), "/top:order[.='2']");
+    free(str);
+    assert_string_equal((str = lyd_path(diff->second[2])), "/top:order[.='4']");
+    free(str);
+
+    assert_int_equal(diff->type[3], LYD_DIFF_CREATED);
+    assert_ptr_equal(diff->first[3], NULL);
+    assert_string_equal((str = lyd_path(diff->second[3])), "/top:item[name='g']");
+    free(str);
+
+    assert_int_equal(diff->type[4], LYD_DIFF_END);
+
+    lyd_free_diff(diff);
+}
+
+static void
+test_digest(void **state)
+{
+    struct state *st = (*state);
+    const char *xml = "<df xmlns=\"urn:libyang:tests:defaults\">"
+                        "<llist>1</llist>"
+                        "<llist>2</llist>"
+                        "<list><name>a</name><value>1</value></list>"
+                        "<list><name>b</name><value>2</value></list>"
+                      "</df>";
+    char *str;
+    struct ly_set *set;
+    struct lyd_node *leaf, *llist1, *llist2;
+    struct lyd_difflist *diff;
+
+    assert_ptr_not_equal((st->first = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG)), NULL);
+    assert_ptr_not_equal((st->second = lyd_dup_withsiblings(st->first, LYD_DUP_OPT_RECURSIVE)), NULL);
+    assert_true(lyd_digest(st->first) == lyd_digest(st->second));
+    assert_true(lyd_digest(st->first->child) != lyd_digest(st->second));
+
+    /* change a nested leaf after the digests were computed */
+    assert_ptr_not_equal((set = lyd_find_path(st->second, "/defaults:df/list[name='a']/value")), NULL);
+    assert_int_equal(set->number, 1);
+    leaf = set->set.d[0];
+    ly_set_free(set);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)leaf, "3"), 0);
+    assert_true(lyd_digest(st->first) != lyd_digest(st->second));
+
+    assert_ptr_not_equal((diff = lyd_diff(st->first, st->second, 0)), NULL);
+    assert_int_equal(diff->type[0], LYD_DIFF_CHANGED);
+    assert_string_equal((str = lyd_path(diff->second[0])), "/defaults:df/list[name='a']/value");
+    free(str);
+    assert_int_equal(diff->type[1], LYD_DIFF_END);
+    lyd_free_diff(diff);
+
+    /* the same content again */
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)leaf, "1"), 0);
+    assert_true(lyd_digest(st->first) == lyd_digest(st->second));
+
+    /* removed subtree */
+    assert_ptr_not_equal((set = lyd_find_path(st->second, "/defaults:df/list[name='b']")), NULL);
+    assert_int_equal(set->number, 1);
+    lyd_free(set->set.d[0]);
+    ly_set_free(set);
+    assert_true(lyd_digest(st->first) != lyd_digest(st->second));
+
+    assert_ptr_not_equal((diff = lyd_diff(st->first, st->second, 0)), NULL);
+    assert_int_equal(diff->type[0], LYD_DIFF_DELETED);
+    assert_string_equal((str = lyd_path(diff->first[0])), "/defaults:df/list[name='b']");
+    free(str);
+    assert_int_equal(diff->type[1], LYD_DIFF_END);
+    lyd_free_diff(diff);
+
+    /* user-ordered instances in a different order */
+    assert_ptr_not_equal((set = lyd_find_path(st->second, "/defaults:df/llist")), NULL);
+    assert_int_equal(set->number, 2);
+    llist1 = set->set.d[0];
+    llist2 = set->set.d[1];
+    ly_set_free(set);
+    assert_int_equal(lyd_insert_before(llist1, llist2), 0);
+
+    assert_ptr_not_equal((diff = lyd_diff(st->first, st->second, 0)), NULL);
+    assert_int_equal(diff->type[0], LYD_DIFF_DELETED);
+    assert_int_equal(diff->type[1], LYD_DIFF_MOVEDAFTER1);
+    assert_int_equal(diff->type[2], LYD_DIFF_END);
+    lyd_free_diff(diff);
+}
+
 static void
 test_mix1(void **state)
 {
@@ -573,6 +708,8 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_move1, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_move2, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_move3, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_toplevel, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_digest, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_mix1, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_mix2, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_wd1, setup_f, teardown_f), };
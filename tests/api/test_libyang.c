@@ -248,6 +248,54 @@ test_ly_ctx_info(void **state)
     lyd_free_withsiblings(node);
 }
 
+static void
+test_ly_ctx_info_cached(void **state)
+{
+    const struct lyd_node *cached;
+    struct lyd_node *node, *data;
+    struct ly_set *set;
+    (void) state; /* unused */
+
+    cached = ly_ctx_info_cached(NULL);
+    assert_ptr_equal(cached, NULL);
+
+    cached = ly_ctx_info_cached(ctx);
+    assert_ptr_not_equal(cached, NULL);
+    assert_int_equal(LYD_VAL_OK, cached->validity);
+
+    /* the data are created only once */
+    node = ly_ctx_info(ctx);
+    assert_ptr_not_equal(node, NULL);
+    assert_ptr_not_equal(node, cached);
+    assert_ptr_equal(ly_ctx_info_cached(ctx), cached);
+    lyd_free_withsiblings(node);
+
+    /* but they change with the features */
+    set = lyd_find_path(cached, "/ietf-yang-library:modules-state/module[name='b']/feature");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 0);
+    ly_set_free(set);
+
+    assert_int_equal(lys_features_enable(module, "foo"), 0);
+    cached = ly_ctx_info_cached(ctx);
+    assert_ptr_not_equal(cached, NULL);
+    set = lyd_find_path(cached, "/ietf-yang-library:modules-state/module[name='b']/feature");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    ly_set_free(set);
+
+    /* the data are added only once */
+    data = lyd_dup_withsiblings(root, LYD_DUP_OPT_RECURSIVE);
+    assert_ptr_not_equal(data, NULL);
+    assert_int_equal(lyd_validate(&data, LYD_OPT_DATA | LYD_OPT_DATA_ADD_YANGLIB, ctx), 0);
+    assert_int_equal(lyd_validate(&data, LYD_OPT_DATA | LYD_OPT_DATA_ADD_YANGLIB, ctx), 0);
+    set = lyd_find_path(data, "/ietf-yang-library:modules-state");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    ly_set_free(set);
+    lyd_free_withsiblings(data);
+}
+
 static void
 test_ly_ctx_new_ylmem(void **state)
 {
@@ -1035,6 +1083,75 @@ test_ly_set_rm_index(void **state)
     ly_set_free(set);
 }
 
+static void
+test_ly_set_large(void **state)
+{
+    (void) state; /* unused */
+    struct ly_set *set, *dup, *src;
+    int items[100];
+    int i, rc;
+
+    set = ly_set_new();
+    assert_ptr_not_equal(set, NULL);
+
+    for (i = 0; i < 100; ++i) {
+        rc = ly_set_add(set, &items[i], 0);
+        assert_int_equal(rc, i);
+    }
+    /* duplicates are detected */
+    for (i = 0; i < 100; ++i) {
+        rc = ly_set_add(set, &items[i], 0);
+        assert_int_equal(rc, i);
+    }
+    assert_int_equal(set->number, 100);
+
+    /* removing moves the last item */
+    rc = ly_set_rm(set, &items[10]);
+    assert_int_equal(rc, 0);
+    assert_int_equal(set->number, 99);
+    assert_int_equal(ly_set_contains(set, &items[10]), -1);
+    assert_int_equal(ly_set_contains(set, &items[99]), 10);
+    rc = ly_set_rm_index(set, 98);
+    assert_int_equal(rc, 0);
+    assert_int_equal(ly_set_contains(set, &items[98]), -1);
+    for (i = 0; i < (signed)set->number; ++i) {
+        assert_int_equal(ly_set_contains(set, set->set.g[i]), i);
+    }
+
+    /* duplicated items when used as a list */
+    rc = ly_set_add(set, &items[0], LY_SET_OPT_USEASLIST);
+    assert_int_equal(rc, 98);
+    assert_int_equal(ly_set_contains(set, &items[0]), 0);
+    rc = ly_set_rm_index(set, 0);
+    assert_int_equal(rc, 0);
+    assert_int_equal(ly_set_contains(set, &items[0]), 0);
+    rc = ly_set_rm(set, &items[0]);
+    assert_int_equal(rc, 0);
+    assert_int_equal(ly_set_contains(set, &items[0]), -1);
+
+    dup = ly_set_dup(set);
+    assert_ptr_not_equal(dup, NULL);
+    for (i = 0; i < (signed)dup->number; ++i) {
+        assert_int_equal(ly_set_contains(dup, dup->set.g[i]), i);
+    }
+
+    src = ly_set_new();
+    assert_ptr_not_equal(src, NULL);
+    ly_set_add(src, &items[0], 0);
+    ly_set_add(src, &items[1], 0);
+    rc = ly_set_merge(dup, src, 0);
+    assert_int_equal(rc, 1);
+    assert_int_equal(ly_set_contains(dup, &items[0]), dup->number - 1);
+
+    ly_set_clean(dup);
+    assert_int_equal(ly_set_contains(dup, &items[1]), -1);
+    rc = ly_set_add(dup, &items[1], 0);
+    assert_int_equal(rc, 0);
+
+    ly_set_free(dup);
+    ly_set_free(set);
+}
+
 static void
 test_ly_set_free(void **state)
 {
@@ -1658,6 +1775,7 @@ int main(void)
         cmocka_unit_test(test_ly_ctx_set_searchdir),
         cmocka_unit_test(test_ly_ctx_set_searchdir_invalid),
         cmocka_unit_test_setup_teardown(test_ly_ctx_info, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_ly_ctx_info_cached, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_ctx_new_ylmem, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_ctx_module_clb, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_ctx_get_module, setup_f, teardown_f),
@@ -1677,6 +1795,7 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_ly_set_add, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_set_rm, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_set_rm_index, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_ly_set_large, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_set_free, setup_f, teardown_f),
         cmocka_unit_test(test_ly_verb),
         cmocka_unit_test(test_ly_get_log_clb),
@@ -1602,6 +1602,50 @@ test_lyd_leaf_type(void **state)
     lyd_free_withsiblings(data);
 }
 
+static void
+test_lyd_path_long(void **state)
+{
+    struct ly_ctx *ctx = (struct ly_ctx *)*state;
+    const char *yang = "module y {"
+"  namespace urn:y;"
+"  prefix y;"
+"  list l {"
+"    key k;"
+"    leaf k { type string; }"
+"    list m {"
+"      key k;"
+"      leaf k { type string; }"
+"      leaf v { type union { type uint8; type int8 { range \"-10..-1\"; } } }"
+"    }"
+"  }"
+"}";
+    char key[301], xml[1024], expected[1024], *str;
+    struct lyd_node *data;
+
+    assert_ptr_not_equal(lys_parse_mem(ctx, yang, LYS_IN_YANG), 0);
+
+    /* longer than any internal path buffer */
+    memset(key, 'k', 300);
+    key[300] = '\0';
+    sprintf(xml, "<l xmlns=\"urn:y\"><k>%s</k><m><k>it's</k><v>7</v></m></l>", key);
+    data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(data, NULL);
+
+    str = lyd_path(data->child->next->child->next);
+    assert_ptr_not_equal(str, NULL);
+    sprintf(expected, "/y:l[k='%s']/m[k=\"it's\"]/v", key);
+    assert_string_equal(str, expected);
+    free(str);
+    lyd_free_withsiblings(data);
+
+    /* all the union members fail, only the final error is reported with its path */
+    sprintf(xml, "<l xmlns=\"urn:y\"><k>%s</k><m><k>it's</k><v>300</v></m></l>", key);
+    data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_equal(data, NULL);
+    assert_int_equal(ly_vecode(ctx), LYVE_INVAL);
+    assert_string_equal(ly_errpath(ctx), expected);
+}
+
 static void
 test_lyd_validation_dflt_empty_containers(void **state)
 {
@@ -1803,6 +1847,7 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_lyd_print_clb_json, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_path, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_leaf_type, setup_f2, teardown_f2),
+        cmocka_unit_test_setup_teardown(test_lyd_path_long, setup_f2, teardown_f2),
         cmocka_unit_test_setup_teardown(test_lyd_validation_dflt_empty_containers, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_diff, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_free_diff, setup_f, teardown_f),
@@ -616,6 +616,95 @@ test_merge_to_ctx_with_missing_schema(void **state)
     free(printed);
 }
 
+static void
+test_merge_to_ctx_map(void **state)
+{
+    struct state *st = (*state);
+    const char *sch_x = "module x {"
+                        "  namespace urn:x;"
+                        "  prefix x;"
+                        "  container c {"
+                        "    list l {"
+                        "      key n;"
+                        "      leaf n { type string; }"
+                        "      leaf v { type string; }}}}";
+    const char *sch_y = "module y {"
+                        "  namespace urn:y;"
+                        "  prefix y;"
+                        "  import x { prefix x; }"
+                        "  augment /x:c/x:l { leaf a { type string; } }}";
+    const char *sch_z = "module z {"
+                        "  namespace urn:z;"
+                        "  prefix z;"
+                        "  leaf z { type string; }}";
+    const char *trg = "<c xmlns=\"urn:x\"><l><n>a</n><v>1</v></l></c>";
+    const char *src1 = "<c xmlns=\"urn:x\"><l><n>a</n><v>2</v><a xmlns=\"urn:y\">x</a></l></c>";
+    const char *src2 = "<c xmlns=\"urn:x\"><l><n>b</n><v>3</v><a xmlns=\"urn:y\">y</a></l></c>";
+    const char *result = "<c xmlns=\"urn:x\"><l><n>a</n><v>2</v><a xmlns=\"urn:y\">x</a></l>"
+                         "<l><n>b</n><v>3</v><a xmlns=\"urn:y\">y</a></l></c>";
+    struct ly_ctx_schema_map *map;
+    struct lyd_node *source, *node;
+    char *printed = NULL;
+
+    assert_ptr_not_equal(lys_parse_mem(st->ctx1, sch_x, LYS_IN_YANG), NULL);
+    assert_ptr_not_equal(lys_parse_mem(st->ctx1, sch_y, LYS_IN_YANG), NULL);
+    assert_ptr_not_equal(lys_parse_mem(st->ctx1, sch_z, LYS_IN_YANG), NULL);
+    assert_ptr_not_equal(lys_parse_mem(st->ctx2, sch_x, LYS_IN_YANG), NULL);
+    assert_ptr_not_equal(lys_parse_mem(st->ctx2, sch_y, LYS_IN_YANG), NULL);
+
+    map = ly_ctx_schema_map_new(st->ctx1, st->ctx2);
+    assert_ptr_not_equal(map, NULL);
+
+    /* the augment node is found in the target context */
+    node = lyd_new_path(NULL, st->ctx1, "/x:c/l[n='a']/y:a", "x", 0, 0);
+    assert_ptr_not_equal(node, NULL);
+    source = node->child->child->prev;
+    assert_string_equal(source->schema->name, "a");
+    assert_ptr_equal(ly_ctx_schema_map_get(map, source->schema), ly_ctx_get_node(st->ctx2, NULL, "/x:c/l/y:a", 0));
+    assert_ptr_equal(ly_ctx_schema_map_get(map, source->schema), ly_ctx_get_node(st->ctx2, NULL, "/x:c/l/y:a", 0));
+    lyd_free(node);
+
+    /* a module missing in the target context */
+    node = lyd_new_path(NULL, st->ctx1, "/z:z", "z", 0, 0);
+    assert_ptr_not_equal(node, NULL);
+    assert_ptr_equal(lyd_dup_to_ctx_map(node, LYD_DUP_OPT_RECURSIVE, map), NULL);
+    assert_ptr_equal(ly_ctx_schema_map_get(map, node->schema), NULL);
+    lyd_free(node);
+
+    st->target = lyd_parse_mem(st->ctx2, trg, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->target, NULL);
+
+    /* merge twice with the same map, the source is copied */
+    st->source = lyd_parse_mem(st->ctx1, src1, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->source, NULL);
+    assert_int_equal(lyd_merge_to_ctx_map(&st->target, st->source, 0, map), 0);
+    lyd_free_withsiblings(st->source);
+
+    /* the module set of the target context changes */
+    assert_ptr_not_equal(lys_parse_mem(st->ctx2, sch_z, LYS_IN_YANG), NULL);
+
+    st->source = lyd_parse_mem(st->ctx1, src2, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->source, NULL);
+    node = lyd_dup_to_ctx_map(st->source, LYD_DUP_OPT_RECURSIVE, map);
+    assert_ptr_not_equal(node, NULL);
+    assert_ptr_equal(node->child->child->prev->schema, ly_ctx_get_node(st->ctx2, NULL, "/x:c/l/y:a", 0));
+    assert_int_equal(lyd_validate(&node, LYD_OPT_CONFIG, NULL), 0);
+    lyd_free_withsiblings(node);
+    assert_int_equal(lyd_merge_to_ctx_map(&st->target, st->source, LYD_OPT_DESTRUCT, map), 0);
+    st->source = NULL;
+
+    /* the source context and the map are not needed anymore */
+    ly_ctx_schema_map_free(map);
+    ly_ctx_destroy(st->ctx1, NULL);
+    st->ctx1 = NULL;
+
+    assert_ptr_equal(st->target->schema->module->ctx, st->ctx2);
+    assert_int_equal(lyd_validate(&st->target, LYD_OPT_CONFIG, NULL), 0);
+    lyd_print_mem(&printed, st->target, LYD_XML, LYP_WITHSIBLINGS);
+    assert_string_equal(printed, result);
+    free(printed);
+}
+
 static void
 test_merge_leafrefs(void **state)
 {
@@ -653,6 +742,113 @@ test_merge_leafrefs(void **state)
     free(prt);
 }
 
+static void
+test_merge_toplevel_siblings(void **state)
+{
+    struct state *st = (*state);
+    const char *sch = "module x {"
+                      "  namespace urn:x;"
+                      "  prefix x;"
+                      "  list l {"
+                      "    key n;"
+                      "    leaf n { type uint8; }"
+                      "    leaf v { type string; }}"
+                      "  leaf-list ll { type string; }}";
+    const char *src = "<l xmlns=\"urn:x\"><n>3</n><v>c</v></l>"
+                      "<l xmlns=\"urn:x\"><n>10</n><v>j</v></l>"
+                      "<ll xmlns=\"urn:x\">b</ll>"
+                      "<l xmlns=\"urn:x\"><n>7</n></l>";
+    const char *res = "<l xmlns=\"urn:x\"><n>0</n></l>"
+                      "<l xmlns=\"urn:x\"><n>1</n></l>"
+                      "<l xmlns=\"urn:x\"><n>2</n></l>"
+                      "<l xmlns=\"urn:x\"><n>3</n><v>c</v></l>"
+                      "<l xmlns=\"urn:x\"><n>4</n></l>"
+                      "<l xmlns=\"urn:x\"><n>5</n></l>"
+                      "<l xmlns=\"urn:x\"><n>6</n></l>"
+                      "<l xmlns=\"urn:x\"><n>7</n><v>x</v></l>"
+                      "<l xmlns=\"urn:x\"><n>8</n></l>"
+                      "<l xmlns=\"urn:x\"><n>9</n></l>"
+                      "<ll xmlns=\"urn:x\">a</ll>"
+                      "<l xmlns=\"urn:x\"><n>10</n><v>j</v></l>"
+                      "<ll xmlns=\"urn:x\">b</ll>";
+    char *trg, *prt = NULL;
+    int i, len;
+
+    assert_ptr_not_equal(lys_parse_mem(st->ctx1, sch, LYS_IN_YANG), NULL);
+
+    /* enough siblings to be found by their hash */
+    trg = malloc(1024);
+    assert_ptr_not_equal(trg, NULL);
+    for (i = 0, len = 0; i < 10; i++) {
+        len += sprintf(trg + len, "<l xmlns=\"urn:x\"><n>%d</n>%s</l>", i, (i == 7) ? "<v>x</v>" : "");
+    }
+    sprintf(trg + len, "<ll xmlns=\"urn:x\">a</ll>");
+    st->target = lyd_parse_mem(st->ctx1, trg, LYD_XML, LYD_OPT_CONFIG);
+    free(trg);
+    assert_ptr_not_equal(st->target, NULL);
+
+    st->source = lyd_parse_mem(st->ctx1, src, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->source, NULL);
+
+    /* only the first source sibling */
+    assert_int_equal(lyd_merge(st->target, st->source, LYD_OPT_NOSIBLINGS), 0);
+    assert_string_equal(((struct lyd_node_leaf_list *)st->target->prev)->value_str, "a");
+    assert_string_equal(((struct lyd_node_leaf_list *)st->target->next->next->next->child->next)->value_str, "c");
+
+    /* the source is not changed */
+    assert_int_equal(lyd_merge(st->target, st->source, 0), 0);
+    lyd_print_mem(&prt, st->source, LYD_XML, LYP_WITHSIBLINGS);
+    assert_string_equal(prt, src);
+    free(prt);
+
+    assert_int_equal(lyd_validate(&st->target, LYD_OPT_CONFIG, NULL), 0);
+    lyd_print_mem(&prt, st->target, LYD_XML, LYP_WITHSIBLINGS);
+    assert_string_equal(prt, res);
+    free(prt);
+
+    /* merging it again changes nothing */
+    assert_int_equal(lyd_merge(st->target, st->source, LYD_OPT_DESTRUCT), 0);
+    st->source = NULL;
+    lyd_print_mem(&prt, st->target, LYD_XML, LYP_WITHSIBLINGS);
+    assert_string_equal(prt, res);
+    free(prt);
+}
+
+static void
+test_merge_nested_unique(void **state)
+{
+    struct state *st = (*state);
+    const char *sch = "module x {"
+                      "  namespace urn:x;"
+                      "  prefix x;"
+                      "  container c {"
+                      "    list l {"
+                      "      key n;"
+                      "      leaf n { type uint8; }"
+                      "      list u {"
+                      "        key k;"
+                      "        unique v;"
+                      "        leaf k { type uint8; }"
+                      "        leaf v { type string; }}}}}";
+    const char *trg = "<c xmlns=\"urn:x\"><l><n>1</n></l></c>";
+    const char *src = "<c xmlns=\"urn:x\"><l><n>2</n>"
+                      "<u><k>1</k><v>a</v></u><u><k>2</k><v>a</v></u></l></c>";
+
+    assert_ptr_not_equal(lys_parse_mem(st->ctx1, sch, LYS_IN_YANG), NULL);
+
+    st->target = lyd_parse_mem(st->ctx1, trg, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->target, NULL);
+
+    /* the unique statement is not checked in the source */
+    st->source = lyd_parse_mem(st->ctx1, src, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_TRUSTED);
+    assert_ptr_not_equal(st->source, NULL);
+
+    /* the new list instance is linked as a whole, but its nested list must be checked */
+    assert_int_equal(lyd_merge(st->target, st->source, LYD_OPT_DESTRUCT), 0);
+    st->source = NULL;
+    assert_int_not_equal(lyd_validate(&st->target, LYD_OPT_CONFIG, NULL), 0);
+    assert_int_equal(ly_vecode(st->ctx1), LYVE_NOUNIQ);
+}
 
 int
 main(void)
@@ -669,7 +865,10 @@ main(void)
                     cmocka_unit_test_setup_teardown(test_merge_to_trgctx2, setup_mctx, teardown_mctx),
                     cmocka_unit_test_setup_teardown(test_merge_to_ctx, setup_mctx, teardown_mctx),
                     cmocka_unit_test_setup_teardown(test_merge_to_ctx_with_missing_schema, setup_mctx, teardown_mctx),
+                    cmocka_unit_test_setup_teardown(test_merge_to_ctx_map, setup_mctx, teardown_mctx),
                     cmocka_unit_test_setup_teardown(test_merge_leafrefs, setup_dflt, teardown_dflt),
+                    cmocka_unit_test_setup_teardown(test_merge_toplevel_siblings, setup_dflt, teardown_dflt),
+                    cmocka_unit_test_setup_teardown(test_merge_nested_unique, setup_dflt, teardown_dflt),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
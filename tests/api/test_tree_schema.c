@@ -1538,6 +1538,117 @@ test_lys_xpath_atomize(void **state)
     ly_set_free(set);
 }
 
+static void
+test_lys_xpath_dependents(void **state)
+{
+    (void) state; /* unused */
+    const struct lys_module *module;
+    const struct lys_node *cont, *x, *flag, *ref, *other;
+    struct ly_set *set;
+    const char *schema =
+    "module dep {"
+        "namespace \"urn:dep\";"
+        "prefix \"d\";"
+        "container cont {"
+            "must \"../flag\";"
+            "leaf x {"
+                "when \"../../flag = 'on'\";"
+                "type string;"
+            "}"
+        "}"
+        "leaf flag {"
+            "type string;"
+        "}"
+        "leaf ref {"
+            "type leafref {"
+                "path \"/d:flag\";"
+            "}"
+        "}"
+        "leaf other {"
+            "type string;"
+        "}"
+    "}";
+
+    module = lys_parse_mem(ctx, schema, LYS_IN_YANG);
+    assert_non_null(module);
+    cont = module->data;
+    x = cont->child;
+    flag = cont->next;
+    ref = flag->next;
+    other = ref->next;
+
+    set = lys_xpath_dependents(flag);
+    assert_non_null(set);
+    assert_int_equal(set->number, 3);
+    assert_int_not_equal(ly_set_contains(set, (void *)cont), -1);
+    assert_int_not_equal(ly_set_contains(set, (void *)x), -1);
+    assert_int_not_equal(ly_set_contains(set, (void *)ref), -1);
+    ly_set_free(set);
+
+    set = lys_xpath_dependents(other);
+    assert_non_null(set);
+    assert_int_equal(set->number, 0);
+    ly_set_free(set);
+
+    /* nodes of disabled modules are skipped */
+    assert_int_equal(lys_set_disabled(module), 0);
+    set = lys_xpath_dependents(flag);
+    assert_non_null(set);
+    assert_int_equal(set->number, 0);
+    ly_set_free(set);
+    assert_int_equal(lys_set_enabled(module), 0);
+
+    set = lys_xpath_dependents(flag);
+    assert_non_null(set);
+    assert_int_equal(set->number, 3);
+    ly_set_free(set);
+
+    /* the expressions of trusted modules are not checked, the dependencies are incomplete */
+    ly_ctx_set_trusted(ctx);
+    assert_non_null(lys_parse_mem(ctx, "module dep2 {namespace urn:dep2; prefix d2; import dep {prefix d;}"
+                                  "leaf y {type string; must \"/d:flag\";}}", LYS_IN_YANG));
+    ly_ctx_unset_trusted(ctx);
+    assert_null(lys_xpath_dependents(flag));
+}
+
+static void
+test_lys_set_enabled_backlinks(void **state)
+{
+    (void) state; /* unused */
+    const struct lys_module *module;
+    struct lys_node_leaf *target;
+    const struct lys_node *ref;
+    const char *schema =
+    "module backlinks {"
+        "namespace \"urn:backlinks\";"
+        "prefix \"b\";"
+        "leaf first {"
+            "type string;"
+        "}"
+        "leaf target {"
+            "type string;"
+        "}"
+        "leaf ref {"
+            "type leafref {"
+                "path \"/b:target\";"
+            "}"
+        "}"
+    "}";
+
+    module = lys_parse_mem(ctx, schema, LYS_IN_YANG);
+    assert_non_null(module);
+    target = (struct lys_node_leaf *)module->data->next;
+    ref = target->next;
+    assert_non_null(target->backlinks);
+    assert_int_not_equal(ly_set_contains(target->backlinks, (void *)ref), -1);
+
+    /* the leafrefs in all the top-level nodes, not only the first one, are linked again */
+    assert_int_equal(lys_set_disabled(module), 0);
+    assert_int_equal(lys_set_enabled(module), 0);
+    assert_non_null(target->backlinks);
+    assert_int_not_equal(ly_set_contains(target->backlinks, (void *)ref), -1);
+}
+
 static void
 test_lys_path(void **state)
 {
@@ -1571,6 +1682,56 @@ test_lys_path(void **state)
     free(path);
 }
 
+#ifdef LY_ENABLED_CACHE
+
+static void
+test_lys_data_hash(void **state)
+{
+    (void) state; /* unused */
+    const struct lys_module *mod1, *mod2;
+    const struct lys_node *l, *c1_l, *c2_l, *m, *c1_m;
+    struct ly_set *set;
+
+    mod1 = lys_parse_mem(ctx, "module h1 {namespace urn:h1; prefix h1;"
+                              "grouping g {leaf l {type string;}}"
+                              "container c1 {uses g;} container c2 {uses g;} leaf l {type string;}}", LYS_IN_YANG);
+    assert_ptr_not_equal(mod1, NULL);
+    mod2 = lys_parse_mem(ctx, "module h2 {namespace urn:h2; prefix h2; import h1 {prefix h1;}"
+                              "augment /h1:c1 {leaf m {type string;}} leaf m {type string;}}", LYS_IN_YANG);
+    assert_ptr_not_equal(mod2, NULL);
+
+    set = lys_find_path(mod1, NULL, "/h1:l");
+    assert_ptr_not_equal(set, NULL);
+    l = set->set.s[0];
+    ly_set_free(set);
+    set = lys_find_path(mod1, NULL, "/h1:c1/l");
+    assert_ptr_not_equal(set, NULL);
+    c1_l = set->set.s[0];
+    ly_set_free(set);
+    set = lys_find_path(mod1, NULL, "/h1:c2/l");
+    assert_ptr_not_equal(set, NULL);
+    c2_l = set->set.s[0];
+    ly_set_free(set);
+    set = lys_find_path(mod2, NULL, "/h2:m");
+    assert_ptr_not_equal(set, NULL);
+    m = set->set.s[0];
+    ly_set_free(set);
+    set = lys_find_path(mod1, NULL, "/h1:c1/h2:m");
+    assert_ptr_not_equal(set, NULL);
+    c1_m = set->set.s[0];
+    ly_set_free(set);
+
+    /* the hash depends only on the module and name of the node, not on its location */
+#define LEAF_HASH(node) ((const struct lys_node_leaf *)(node))->data_hash
+    assert_int_equal(LEAF_HASH(l), LEAF_HASH(c1_l));
+    assert_int_equal(LEAF_HASH(l), LEAF_HASH(c2_l));
+    assert_int_equal(LEAF_HASH(m), LEAF_HASH(c1_m));
+    assert_int_not_equal(LEAF_HASH(l), LEAF_HASH(m));
+#undef LEAF_HASH
+}
+
+#endif
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -1602,7 +1763,12 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_lys_print_file_jsons, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lys_find_path, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lys_xpath_atomize, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lys_xpath_dependents, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lys_set_enabled_backlinks, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lys_path, setup_f, teardown_f),
+#ifdef LY_ENABLED_CACHE
+        cmocka_unit_test_setup_teardown(test_lys_data_hash, setup_f, teardown_f),
+#endif
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
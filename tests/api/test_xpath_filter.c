@@ -0,0 +1,264 @@
+/**
+ * @file test_xpath_filter.c
+ * @brief Cmocka tests for XPath filter sets.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "tests/config.h"
+#include "libyang.h"
+
+struct state {
+    struct ly_ctx *ctx;
+    struct lyd_xpath_filters *filters;
+    struct lyd_node *first;
+    struct lyd_node *second;
+};
+
+static const char *schema =
+"module filt {"
+"  namespace urn:filt;"
+"  prefix f;"
+"  container ifs {"
+"    list if {"
+"      key name;"
+"      leaf name { type string; }"
+"      leaf mtu { type uint16; }"
+"      leaf enabled { type boolean; }"
+"    }"
+"  }"
+"  container sys {"
+"    leaf hostname { type string; }"
+"  }"
+"  notification alarm {"
+"    leaf severity { type string; }"
+"    leaf resource { type string; }"
+"  }"
+"}";
+
+static const char *data1 =
+"<ifs xmlns=\"urn:filt\">"
+  "<if><name>eth0</name><mtu>1500</mtu></if>"
+  "<if><name>eth1</name><mtu>1500</mtu></if>"
+"</ifs>"
+"<sys xmlns=\"urn:filt\"><hostname>router</hostname></sys>";
+
+static const char *data2 =
+"<ifs xmlns=\"urn:filt\">"
+  "<if><name>eth0</name><mtu>1500</mtu></if>"
+  "<if><name>eth1</name><mtu>9000</mtu></if>"
+"</ifs>"
+"<sys xmlns=\"urn:filt\"><hostname>router</hostname></sys>";
+
+/* filter identifiers */
+static int sub_sys, sub_eth0_mtu, sub_count, sub_enabled, sub_eth1, sub_alarm, sub_mtu;
+
+static int
+setup_f(void **state)
+{
+    struct state *st;
+
+    (*state) = st = calloc(1, sizeof *st);
+    if (!st) {
+        fprintf(stderr, "Memory allocation error.\n");
+        return -1;
+    }
+
+    st->ctx = ly_ctx_new(NULL, 0);
+    if (!st->ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        goto error;
+    }
+
+    if (!lys_parse_mem(st->ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto error;
+    }
+
+    st->filters = lyd_xpath_filters_new(st->ctx);
+    if (!st->filters) {
+        fprintf(stderr, "Failed to create filters.\n");
+        goto error;
+    }
+
+    if (lyd_xpath_filters_add(st->filters, "/filt:sys", &sub_sys)
+            || lyd_xpath_filters_add(st->filters, "/filt:ifs/if[name='eth0']/mtu", &sub_eth0_mtu)
+            || lyd_xpath_filters_add(st->filters, "count(/filt:ifs/if) > 1", &sub_count)
+            || lyd_xpath_filters_add(st->filters, "/filt:ifs/if/enabled", &sub_enabled)
+            || lyd_xpath_filters_add(st->filters, "/filt:ifs/if[name='eth1']", &sub_eth1)
+            || lyd_xpath_filters_add(st->filters, "/filt:alarm[severity='critical']", &sub_alarm)
+            || lyd_xpath_filters_add(st->filters, "/filt:ifs/if/mtu[. > 2000]", &sub_mtu)) {
+        fprintf(stderr, "Failed to add filters.\n");
+        goto error;
+    }
+
+    return 0;
+
+error:
+    lyd_xpath_filters_free(st->filters);
+    ly_ctx_destroy(st->ctx, NULL);
+    free(st);
+    (*state) = NULL;
+
+    return -1;
+}
+
+static int
+teardown_f(void **state)
+{
+    struct state *st = (*state);
+
+    lyd_free_withsiblings(st->first);
+    lyd_free_withsiblings(st->second);
+    lyd_xpath_filters_free(st->filters);
+    ly_ctx_destroy(st->ctx, NULL);
+    free(st);
+    (*state) = NULL;
+
+    return 0;
+}
+
+static void
+test_invalid(void **state)
+{
+    struct state *st = (*state);
+
+    assert_int_not_equal(lyd_xpath_filters_add(st->filters, "/sys", &sub_sys), 0);
+    assert_int_not_equal(lyd_xpath_filters_add(st->filters, "/unknown:sys", &sub_sys), 0);
+    assert_int_not_equal(lyd_xpath_filters_add(st->filters, "/filt:ifs/if[", &sub_sys), 0);
+    assert_int_not_equal(lyd_xpath_filters_add(st->filters, "/filt:sys", NULL), 0);
+    assert_int_not_equal(lyd_xpath_filters_remove(st->filters, st), 0);
+}
+
+static void
+test_match_data(void **state)
+{
+    struct state *st = (*state);
+    struct ly_set *set;
+
+    st->first = lyd_parse_mem(st->ctx, data1, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->first, NULL);
+
+    set = lyd_xpath_filters_match(st->filters, st->first);
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 4);
+    assert_int_not_equal(ly_set_contains(set, &sub_sys), -1);
+    assert_int_not_equal(ly_set_contains(set, &sub_eth0_mtu), -1);
+    assert_int_not_equal(ly_set_contains(set, &sub_count), -1);
+    assert_int_not_equal(ly_set_contains(set, &sub_eth1), -1);
+    ly_set_free(set);
+
+    /* no data */
+    set = lyd_xpath_filters_match(st->filters, NULL);
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 0);
+    ly_set_free(set);
+
+    /* removed filters do not match anymore */
+    assert_int_equal(lyd_xpath_filters_remove(st->filters, &sub_sys), 0);
+    assert_int_equal(lyd_xpath_filters_remove(st->filters, &sub_count), 0);
+    set = lyd_xpath_filters_match(st->filters, st->first->next);
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 2);
+    assert_int_equal(ly_set_contains(set, &sub_sys), -1);
+    assert_int_equal(ly_set_contains(set, &sub_count), -1);
+    ly_set_free(set);
+
+    /* free slot is reused */
+    assert_int_equal(lyd_xpath_filters_add(st->filters, "/filt:sys/hostname", &sub_sys), 0);
+    set = lyd_xpath_filters_match(st->filters, st->first);
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 3);
+    assert_int_not_equal(ly_set_contains(set, &sub_sys), -1);
+    ly_set_free(set);
+}
+
+static void
+test_match_notif(void **state)
+{
+    struct state *st = (*state);
+    struct ly_set *set;
+
+    st->first = lyd_parse_mem(st->ctx, "<alarm xmlns=\"urn:filt\"><severity>minor</severity></alarm>", LYD_XML,
+                              LYD_OPT_NOTIF, NULL);
+    assert_ptr_not_equal(st->first, NULL);
+    st->second = lyd_parse_mem(st->ctx, "<alarm xmlns=\"urn:filt\"><severity>critical</severity></alarm>", LYD_XML,
+                               LYD_OPT_NOTIF, NULL);
+    assert_ptr_not_equal(st->second, NULL);
+
+    set = lyd_xpath_filters_match(st->filters, st->first);
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 0);
+    ly_set_free(set);
+
+    set = lyd_xpath_filters_match(st->filters, st->second);
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    assert_ptr_equal(set->set.g[0], &sub_alarm);
+    ly_set_free(set);
+}
+
+static void
+test_match_diff(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_difflist *diff;
+    struct ly_set *set;
+
+    st->first = lyd_parse_mem(st->ctx, data1, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->first, NULL);
+    st->second = lyd_parse_mem(st->ctx, data2, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->second, NULL);
+
+    diff = lyd_diff(st->first, st->second, 0);
+    assert_ptr_not_equal(diff, NULL);
+
+    set = lyd_xpath_filters_match_diff(st->filters, diff);
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 3);
+    assert_int_not_equal(ly_set_contains(set, &sub_eth1), -1);
+    assert_int_not_equal(ly_set_contains(set, &sub_count), -1);
+    assert_int_not_equal(ly_set_contains(set, &sub_mtu), -1);
+    ly_set_free(set);
+    lyd_free_diff(diff);
+
+    /* delete the whole interface list */
+    lyd_free(st->second->child);
+    lyd_free(st->second->child);
+    diff = lyd_diff(st->first, st->second, 0);
+    assert_ptr_not_equal(diff, NULL);
+
+    set = lyd_xpath_filters_match_diff(st->filters, diff);
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 3);
+    assert_int_not_equal(ly_set_contains(set, &sub_eth0_mtu), -1);
+    assert_int_not_equal(ly_set_contains(set, &sub_eth1), -1);
+    assert_int_not_equal(ly_set_contains(set, &sub_count), -1);
+    ly_set_free(set);
+    lyd_free_diff(diff);
+}
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_invalid, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_match_data, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_match_notif, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_match_diff, setup_f, teardown_f),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
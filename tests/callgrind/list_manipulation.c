@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <valgrind/callgrind.h>
 
@@ -8,6 +9,41 @@
 #define DATA1 TESTS_DIR "/callgrind/files/lists.xml"
 #define DATA2 TESTS_DIR "/callgrind/files/lists2.xml"
 
+#define TOP_COUNT 5000
+
+/* many top-level list instances and user-ordered leaf-list items, every 100th instance is changed */
+static struct lyd_node *
+parse_top_lists(struct ly_ctx *ctx, int modified)
+{
+    struct lyd_node *data;
+    char *xml, *ptr;
+    int i;
+
+    xml = malloc(TOP_COUNT * 160 + 1);
+    if (!xml) {
+        return NULL;
+    }
+
+    ptr = xml;
+    for (i = 0; i < TOP_COUNT; ++i) {
+        if (modified && (i % 100 == 1)) {
+            /* deleted */
+            continue;
+        }
+        ptr += sprintf(ptr, "<list2 xmlns=\"urn:libyang:test:lists\"><key2>%d</key2><leaf2>%s</leaf2></list2>",
+                       modified && (i % 100 == 2) ? i + TOP_COUNT : i, modified && (i % 100 == 3) ? "new" : "old");
+    }
+    for (i = 0; i < TOP_COUNT; ++i) {
+        /* moved */
+        ptr += sprintf(ptr, "<llist2 xmlns=\"urn:libyang:test:lists\">%d</llist2>",
+                       modified && (i % 100 == 4) ? i + 1 : (modified && (i % 100 == 5) ? i - 1 : i));
+    }
+
+    data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    free(xml);
+    return data;
+}
+
 int
 main(void)
 {
@@ -66,6 +102,25 @@ main(void)
     }
     CALLGRIND_STOP_INSTRUMENTATION;
 
+    /* diff of many top-level siblings */
+    lyd_free_diff(diff);
+    diff = NULL;
+    lyd_free_withsiblings(data1);
+    data1 = parse_top_lists(ctx, 0);
+    data2 = parse_top_lists(ctx, 1);
+    if (!data1 || !data2) {
+        ret = 1;
+        goto finish;
+    }
+
+    CALLGRIND_START_INSTRUMENTATION;
+    diff = lyd_diff(data1, data2, 0);
+    CALLGRIND_STOP_INSTRUMENTATION;
+    if (!diff) {
+        ret = 1;
+        goto finish;
+    }
+
 finish:
     lyd_free_diff(diff);
     lyd_free_withsiblings(data1);
@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <valgrind/callgrind.h>
+
+#include "tests/config.h"
+#include "libyang.h"
+
+#define SCHEMA TESTS_DIR "/callgrind/files/statelists.yang"
+
+#define ENTRY_COUNT 50
+#define SAMPLE_COUNT 100
+
+int
+main(void)
+{
+    int ret = 0, i, j;
+    char buf[32];
+    struct ly_ctx *ctx = NULL;
+    const struct lys_module *mod;
+    struct lyd_node *data = NULL, *entry, *detail, *sample;
+
+    ctx = ly_ctx_new(NULL, 0);
+    if (!ctx) {
+        ret = 1;
+        goto finish;
+    }
+
+    mod = lys_parse_path(ctx, SCHEMA, LYS_YANG);
+    if (!mod) {
+        ret = 1;
+        goto finish;
+    }
+
+    CALLGRIND_START_INSTRUMENTATION;
+    /* every new node is inserted into a subtree of nested lists without keys */
+    data = lyd_new(NULL, mod, "stats");
+    if (!data) {
+        ret = 1;
+        goto finish;
+    }
+    for (i = 0; i < ENTRY_COUNT; ++i) {
+        entry = lyd_new(data, mod, "entry");
+        sprintf(buf, "entry%d", i);
+        if (!entry || !lyd_new_leaf(entry, mod, "name", buf)) {
+            ret = 1;
+            goto finish;
+        }
+        detail = lyd_new(entry, mod, "detail");
+        if (!detail) {
+            ret = 1;
+            goto finish;
+        }
+        for (j = 0; j < SAMPLE_COUNT; ++j) {
+            sample = lyd_new(detail, mod, "sample");
+            sprintf(buf, "%d", j);
+            if (!sample || !lyd_new_leaf(sample, mod, "value", buf) || !lyd_new_leaf(sample, mod, "tag", buf)) {
+                ret = 1;
+                goto finish;
+            }
+        }
+        sprintf(buf, "%d", SAMPLE_COUNT);
+        if (!lyd_new_leaf(entry, mod, "count", buf)) {
+            ret = 1;
+            goto finish;
+        }
+    }
+    CALLGRIND_STOP_INSTRUMENTATION;
+
+finish:
+    lyd_free_withsiblings(data);
+    ly_ctx_destroy(ctx, NULL);
+    return ret;
+}
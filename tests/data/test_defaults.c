@@ -661,6 +661,213 @@ test_leaflist_yang(void **state)
     assert_string_equal(st->xml, xml_three);
 }
 
+static void
+test_list_entries(void **state)
+{
+    struct state *st = (*state);
+    const struct lys_module *mod;
+    struct lyd_node_leaf_list *bits1, *bits2;
+    struct ly_set *set;
+    const char *yang = "module x {"
+"  yang-version 1.1;"
+"  namespace \"urn:x\";"
+"  prefix x;"
+"  feature f;"
+"  container top {"
+"    list entry {"
+"      key name;"
+"      leaf name { type string; }"
+"      leaf b { type bits { bit a; bit b; bit c; } default \"c a\"; }"
+"      leaf e { type enumeration { enum one; enum two; } default two; }"
+"      leaf-list ll { type string; default x; default y; }"
+"      leaf w { when \"../name = 'e1'\"; type uint8; default 7; }"
+"      leaf r { type leafref { path \"../e\"; } default two; }"
+"      leaf f { if-feature f; type int8; default -5; }"
+"    }"
+"  }}";
+    const char *dev = "module x-dev {"
+"  namespace \"urn:x-dev\";"
+"  prefix xd;"
+"  import x { prefix x; }"
+"  deviation /x:top/x:entry/x:e { deviate replace { default one; } }"
+"}";
+    const char *xml = "<top xmlns=\"urn:x\"><entry><name>e0</name></entry><entry><name>e1</name></entry></top>";
+    const char *xml_e1 = "<entry xmlns=\"urn:x\"><name>e1</name><b>a c</b><e>two</e><ll>x</ll><ll>y</ll>"
+                         "<w>7</w><r>two</r></entry>";
+
+    mod = lys_parse_mem(st->ctx, yang, LYS_IN_YANG);
+    assert_ptr_not_equal(mod, NULL);
+
+    /* the same defaults are created in every entry, when is evaluated separately */
+    st->dt = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    set = lyd_find_path(st->dt, "/x:top/entry[name='e1']");
+    assert_int_equal(set->number, 1);
+    assert_int_equal(lyd_print_mem(&(st->xml), set->set.d[0], LYD_XML, LYP_WD_ALL), 0);
+    assert_string_equal(st->xml, xml_e1);
+    ly_set_free(set);
+    set = lyd_find_path(st->dt, "/x:top/entry/w");
+    assert_int_equal(set->number, 1);
+    ly_set_free(set);
+    set = lyd_find_path(st->dt, "/x:top/entry/ll");
+    assert_int_equal(set->number, 4);
+    assert_int_equal(set->set.d[0]->dflt, 1);
+    ly_set_free(set);
+
+    /* the values are not shared between the entries */
+    set = lyd_find_path(st->dt, "/x:top/entry/b");
+    assert_int_equal(set->number, 2);
+    bits1 = (struct lyd_node_leaf_list *)set->set.d[0];
+    bits2 = (struct lyd_node_leaf_list *)set->set.d[1];
+    ly_set_free(set);
+    assert_ptr_not_equal(bits1->value.bit, bits2->value.bit);
+    assert_ptr_not_equal(bits1->value.bit[0], NULL);
+    assert_ptr_equal(bits1->value.bit[1], NULL);
+    assert_ptr_not_equal(bits1->value.bit[2], NULL);
+    assert_ptr_equal(bits1->value.bit[0], bits2->value.bit[0]);
+
+    /* leafref defaults are created the usual way */
+    set = lyd_find_path(st->dt, "/x:top/entry[name='e0']/r");
+    assert_int_equal(set->number, 1);
+    assert_int_equal(set->set.d[0]->dflt, 1);
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[0])->value_str, "two");
+    ly_set_free(set);
+    lyd_free_withsiblings(st->dt);
+
+    /* enabled feature */
+    assert_int_equal(lys_features_enable(mod, "f"), 0);
+    st->dt = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    set = lyd_find_path(st->dt, "/x:top/entry/f");
+    assert_int_equal(set->number, 2);
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[1])->value_str, "-5");
+    ly_set_free(set);
+    lyd_free_withsiblings(st->dt);
+
+    /* changed default value */
+    assert_ptr_not_equal(lys_parse_mem(st->ctx, dev, LYS_IN_YANG), NULL);
+    st->dt = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    set = lyd_find_path(st->dt, "/x:top/entry/e");
+    assert_int_equal(set->number, 2);
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[0])->value_str, "one");
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[1])->value_str, "one");
+    ly_set_free(set);
+}
+
+static void
+test_virtual(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *e0, *e1, *iter, *lyb_dt;
+    struct ly_set *set;
+    char *lyb;
+    int count;
+    const char *yang = "module v {"
+"  yang-version 1.1;"
+"  namespace \"urn:v\";"
+"  prefix v;"
+"  container top {"
+"    list entry {"
+"      key name;"
+"      leaf name { type string; }"
+"      leaf a { type uint8; default 1; }"
+"      leaf m { type uint8; default 2; must \". < 10\"; }"
+"      leaf t { type uint8; default 3; }"
+"      leaf chk { type uint8; must \"../t = current()\"; }"
+"      leaf-list ll { type string; default x; default y; }"
+"      container c { leaf d { type string; default dd; } }"
+"      choice ch {"
+"        default one;"
+"        case one { leaf o { type int8; default -1; } }"
+"        case two { leaf tw { type int8; default 2; } leaf tw2 { type int8; default 4; } }"
+"      }"
+"      leaf w { type string; when \"../c/d = 'dd'\"; }"
+"    }"
+"  }}";
+    const char *xml = "<top xmlns=\"urn:v\"><entry><name>e0</name></entry>"
+                      "<entry><name>e1</name><tw>5</tw><chk>3</chk><w>x</w></entry></top>";
+    const char *xml_e0 = "<entry xmlns=\"urn:v\"><name>e0</name><m>2</m><a>1</a><t>3</t><ll>x</ll><ll>y</ll>"
+                         "<c><d>dd</d></c><o>-1</o></entry>";
+    const char *json_e0 = "{\"v:entry\":[{\"name\":\"e0\",\"m\":2,\"a\":1,\"t\":3,\"ll\":[\"x\",\"y\"],"
+                          "\"c\":{\"d\":\"dd\"},\"o\":-1}]}";
+
+    assert_ptr_not_equal(lys_parse_mem(st->ctx, yang, LYS_IN_YANG), NULL);
+
+    /* must and when of e1 see the virtual default nodes */
+    st->dt = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_VIRTUAL_DFLT);
+    assert_ptr_not_equal(st->dt, NULL);
+    e0 = st->dt->child;
+    e1 = e0->next;
+
+    /* only the default nodes with a must are created in e0 */
+    count = 0;
+    LY_TREE_FOR(e0->child, iter) {
+        ++count;
+    }
+    assert_int_equal(count, 2);
+    assert_string_equal(e0->child->prev->schema->name, "m");
+
+    /* the virtual nodes are printed in the usual with-defaults modes */
+    assert_int_equal(lyd_print_mem(&(st->xml), e0, LYD_XML, LYP_WD_ALL), 0);
+    assert_string_equal(st->xml, xml_e0);
+    free(st->xml);
+    assert_int_equal(lyd_print_mem(&(st->xml), e0, LYD_JSON, LYP_WD_ALL), 0);
+    assert_string_equal(st->xml, json_e0);
+    free(st->xml);
+    assert_int_equal(lyd_print_mem(&(st->xml), e0, LYD_XML, LYP_WD_IMPL_TAG), 0);
+    assert_string_equal(st->xml, "<entry xmlns=\"urn:v\" xmlns:ncwd=\"urn:ietf:params:xml:ns:yang:ietf-netconf-with-defaults\">"
+                        "<name>e0</name><m ncwd:default=\"true\">2</m><a ncwd:default=\"true\">1</a>"
+                        "<t ncwd:default=\"true\">3</t><ll ncwd:default=\"true\">x</ll><ll ncwd:default=\"true\">y</ll>"
+                        "<c><d ncwd:default=\"true\">dd</d></c><o ncwd:default=\"true\">-1</o></entry>");
+    free(st->xml);
+    assert_int_equal(lyd_print_mem(&(st->xml), e0, LYD_XML, LYP_WD_TRIM), 0);
+    assert_string_equal(st->xml, "<entry xmlns=\"urn:v\"><name>e0</name></entry>");
+    free(st->xml);
+    assert_string_equal(e0->child->prev->schema->name, "m");
+
+    /* they are sent in LYB */
+    assert_int_equal(lyd_print_mem(&lyb, st->dt, LYD_LYB, LYP_WITHSIBLINGS), 0);
+    lyb_dt = lyd_parse_mem(st->ctx, lyb, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_TRUSTED);
+    free(lyb);
+    assert_ptr_not_equal(lyb_dt, NULL);
+    set = lyd_find_path(lyb_dt, "/v:top/entry[name='e0']/c/d");
+    assert_int_equal(set->number, 1);
+    assert_int_equal(set->set.d[0]->dflt, 1);
+    ly_set_free(set);
+    lyd_free_withsiblings(lyb_dt);
+
+    /* the evaluation in e1 created its default nodes, even in the container */
+    set = lyd_find_instance(e1, e1->schema->child->next->next->next);
+    assert_int_equal(set->number, 2);
+    ly_set_free(set);
+    assert_string_equal(e1->child->prev->schema->name, "tw2");
+    set = lyd_find_path(e1, "c/d");
+    assert_int_equal(set->number, 1);
+    assert_int_equal(set->set.d[0]->dflt, 1);
+    ly_set_free(set);
+
+    /* lyd_find_path() finds them and creates them */
+    set = lyd_find_path(st->dt, "/v:top/entry/c/d");
+    assert_int_equal(set->number, 2);
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[0])->value_str, "dd");
+    assert_ptr_equal(set->set.d[0]->parent->parent, e0);
+    ly_set_free(set);
+    set = lyd_find_path(st->dt, "/v:top/entry/ll");
+    assert_int_equal(set->number, 4);
+    ly_set_free(set);
+    assert_string_equal(e0->child->prev->schema->name, "o");
+    assert_int_equal(lyd_print_mem(&(st->xml), e0, LYD_XML, LYP_WD_ALL), 0);
+    assert_string_equal(st->xml, xml_e0);
+
+    lyd_free_withsiblings(st->dt);
+
+    /* a must that is false with the virtual default node */
+    st->dt = lyd_parse_mem(st->ctx, "<top xmlns=\"urn:v\"><entry><name>e0</name><chk>4</chk></entry></top>", LYD_XML,
+                           LYD_OPT_CONFIG | LYD_OPT_VIRTUAL_DFLT);
+    assert_ptr_equal(st->dt, NULL);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -680,7 +887,9 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_feature, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_leaflist_in10, setup_clean_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_leaflist_yang, setup_clean_f, teardown_f),
-                    cmocka_unit_test_setup_teardown(test_leaflist_yin, setup_clean_f, teardown_f), };
+                    cmocka_unit_test_setup_teardown(test_leaflist_yin, setup_clean_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_list_entries, setup_clean_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_virtual, setup_clean_f, teardown_f), };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -294,12 +294,169 @@ test_parse_numbers(void **state)
 
 }
 
+static void
+test_long_strings(void **state)
+{
+    struct state *st;
+    struct lyd_node *dt;
+    LYD_FORMAT formats[] = {LYD_JSON, LYD_XML};
+    const char *schema = "module str {namespace urn:str; prefix s; leaf text {type string;}}";
+    char *value, *printed;
+    int i;
+
+    (*state) = st = calloc(1, sizeof *st);
+    assert_non_null(st);
+    st->ctx = ly_ctx_new(NULL, 0);
+    assert_non_null(st->ctx);
+    assert_non_null(lys_parse_mem(st->ctx, schema, LYS_IN_YANG));
+
+    /* long value with characters to escape spread over the internal buffer boundaries */
+    value = malloc(5001);
+    assert_non_null(value);
+    for (i = 0; i < 5000; ++i) {
+        switch (i % 333) {
+        case 0:
+            value[i] = '"';
+            break;
+        case 1:
+            value[i] = '\\';
+            break;
+        case 2:
+            value[i] = '&';
+            break;
+        case 3:
+            value[i] = '<';
+            break;
+        case 4:
+            value[i] = '\n';
+            break;
+        default:
+            value[i] = 'a' + (i % 26);
+            break;
+        }
+    }
+    value[5000] = '\0';
+
+    st->dt = lyd_new_leaf(NULL, ly_ctx_get_module(st->ctx, "str", NULL, 1), "text", value);
+    assert_non_null(st->dt);
+
+    for (i = 0; i < 2; ++i) {
+        assert_int_equal(lyd_print_mem(&printed, st->dt, formats[i], 0), 0);
+        dt = lyd_parse_mem(st->ctx, printed, formats[i], LYD_OPT_CONFIG);
+        free(printed);
+        assert_non_null(dt);
+        assert_string_equal(((struct lyd_node_leaf_list *)dt)->value_str, value);
+        lyd_free_withsiblings(dt);
+    }
+
+    free(value);
+}
+
+static void
+test_utf8_strings(void **state)
+{
+    struct state *st;
+    struct lyd_node *dt;
+    LYD_FORMAT formats[] = {LYD_JSON, LYD_XML};
+    const char *schema = "module str {namespace urn:str; prefix s; leaf text {type string;}}";
+    const char *chars[] = {"\xc3\xa4", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "&", "\"", "x"};
+    const char *invalid[] = {"\xed\xa0\x80", "\xef\xbf\xbe", "\xf4\x8f\xbf\xbf", "\x01"};
+    char *value, *printed, *data;
+    int i, j, len;
+
+    (*state) = st = calloc(1, sizeof *st);
+    assert_non_null(st);
+    st->ctx = ly_ctx_new(NULL, 0);
+    assert_non_null(st->ctx);
+    assert_non_null(lys_parse_mem(st->ctx, schema, LYS_IN_YANG));
+
+    /* long value with multi-byte characters spread over the internal buffer boundaries */
+    value = malloc(4 * 3000 + 1);
+    assert_non_null(value);
+    for (i = len = 0; i < 3000; ++i) {
+        j = (i % 97 == 96) ? (3 + i % 2) : ((i % 7 == 6) ? 5 : (i / 7) % 3);
+        strcpy(&value[len], chars[j]);
+        len += strlen(chars[j]);
+    }
+
+    st->dt = lyd_new_leaf(NULL, ly_ctx_get_module(st->ctx, "str", NULL, 1), "text", value);
+    assert_non_null(st->dt);
+
+    for (i = 0; i < 2; ++i) {
+        assert_int_equal(lyd_print_mem(&printed, st->dt, formats[i], 0), 0);
+        dt = lyd_parse_mem(st->ctx, printed, formats[i], LYD_OPT_CONFIG);
+        free(printed);
+        assert_non_null(dt);
+        assert_string_equal(((struct lyd_node_leaf_list *)dt)->value_str, value);
+        lyd_free_withsiblings(dt);
+    }
+
+    /* a forbidden character after a long run of valid ones */
+    data = malloc(len + 64);
+    assert_non_null(data);
+    value[1000] = '\0';
+    for (j = 0; j < 4; ++j) {
+        sprintf(data, "{\"str:text\":\"%s%s\"}", value, invalid[j]);
+        assert_null(lyd_parse_mem(st->ctx, data, LYD_JSON, LYD_OPT_CONFIG));
+        sprintf(data, "<text xmlns=\"urn:str\">%s%s</text>", value, invalid[j]);
+        assert_null(lyd_parse_mem(st->ctx, data, LYD_XML, LYD_OPT_CONFIG));
+    }
+
+    /* truncated character hiding the closing quote */
+    sprintf(data, "{\"str:text\":\"%s\xf0\x9f\"}", value);
+    assert_null(lyd_parse_mem(st->ctx, data, LYD_JSON, LYD_OPT_CONFIG));
+
+    free(data);
+    free(value);
+}
+
+static void
+test_escaped_names(void **state)
+{
+    struct state *st;
+    const char *schema = "module str {namespace urn:str; prefix s; leaf text {type string;} leaf textual {type string;}}";
+
+    (*state) = st = calloc(1, sizeof *st);
+    assert_non_null(st);
+    st->ctx = ly_ctx_new(NULL, 0);
+    assert_non_null(st->ctx);
+    assert_non_null(lys_parse_mem(st->ctx, schema, LYS_IN_YANG));
+
+    /* plain strings are used directly from the input */
+    st->dt = lyd_parse_mem(st->ctx, "{\"str:text\":\"v\xc3\xa4lue\",\"str:textual\":\"\xc3\xa4\"}", LYD_JSON,
+                           LYD_OPT_CONFIG);
+    assert_non_null(st->dt);
+    assert_string_equal(((struct lyd_node_leaf_list *)st->dt)->value_str, "v\xc3\xa4lue");
+    assert_string_equal(((struct lyd_node_leaf_list *)st->dt->next)->value_str, "\xc3\xa4");
+    lyd_free_withsiblings(st->dt);
+
+    /* escaped member name */
+    st->dt = lyd_parse_mem(st->ctx, "{\"str:t\\u0065xt\":\"a\\\"b\"}", LYD_JSON, LYD_OPT_CONFIG);
+    assert_non_null(st->dt);
+    assert_string_equal(st->dt->schema->name, "text");
+    assert_string_equal(((struct lyd_node_leaf_list *)st->dt)->value_str, "a\"b");
+    lyd_free_withsiblings(st->dt);
+
+    /* name prefixes must match exactly */
+    st->dt = lyd_parse_mem(st->ctx, "{\"st:text\":\"a\"}", LYD_JSON, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_null(st->dt);
+    st->dt = lyd_parse_mem(st->ctx, "{\"str:tex\":\"a\"}", LYD_JSON, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_null(st->dt);
+
+    /* invalid UTF-8 */
+    st->dt = lyd_parse_mem(st->ctx, "{\"str:text\":\"\xc3\"}", LYD_JSON, LYD_OPT_CONFIG);
+    assert_null(st->dt);
+}
+
 int
 main(void)
 {
     const struct CMUnitTest tests[] = {
                     cmocka_unit_test_teardown(test_parse_if, teardown_f),
                     cmocka_unit_test_teardown(test_parse_numbers, teardown_f),
+                    cmocka_unit_test_teardown(test_long_strings, teardown_f),
+                    cmocka_unit_test_teardown(test_utf8_strings, teardown_f),
+                    cmocka_unit_test_teardown(test_escaped_names, teardown_f),
                     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -975,6 +975,124 @@ test_parse_noncharacters_xml(void **state)
 
 }
 
+static ssize_t
+print_clb(void *arg, const void *buf, size_t count)
+{
+    char **str = arg;
+    size_t len = *str ? strlen(*str) : 0;
+
+    *str = realloc(*str, len + count + 1);
+    memcpy(*str + len, buf, count);
+    (*str)[len + count] = '\0';
+    return count;
+}
+
+static void
+test_parse_print_parallel(void **state)
+{
+    struct state *st = (*state);
+    const char *schema = "module par {namespace urn:par; prefix p;"
+                           "container top {list entry {key id; leaf id {type uint32;} leaf name {type string;}"
+                             "container stats {leaf in {type uint64;}} leaf-list tag {type string;}}}"
+                           "list item {key id; leaf id {type uint32;} leaf value {type string;}}"
+                           "container more {list rec {key id; leaf id {type uint32;}}}}";
+    const char *schema_aug = "module par-aug {namespace urn:par-aug; prefix a; import par {prefix p;}"
+                               "augment /p:top/p:entry {leaf note {type string;}}}";
+    const int formats[] = {LYD_XML, LYD_JSON};
+    const int options[] = {LYP_WITHSIBLINGS, LYP_WITHSIBLINGS | LYP_FORMAT, LYP_FORMAT};
+    char *xml, *ptr;
+    int i, j;
+    uint16_t prev_threads;
+
+    *state = st = calloc(1, sizeof *st);
+    assert_ptr_not_equal(st, NULL);
+
+    /* use several threads even on a single CPU */
+    prev_threads = lyd_print_threads(4);
+
+    st->ctx = ly_ctx_new(TESTS_DIR"/data/files", 0);
+    assert_ptr_not_equal(st->ctx, NULL);
+    assert_ptr_not_equal(ly_ctx_load_module(st->ctx, "annotations", NULL), NULL);
+    assert_ptr_not_equal(lys_parse_mem(st->ctx, schema, LYS_IN_YANG), NULL);
+    assert_ptr_not_equal(lys_parse_mem(st->ctx, schema_aug, LYS_IN_YANG), NULL);
+
+    /* many annotated leaf-list instances in a container */
+    st->dt = lyd_parse_path(st->ctx, TESTS_DIR"/data/files/many-childs-annot.xml", LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    for (i = 0; i < 2; i++) {
+        for (j = 0; j < 3; j++) {
+            assert_int_equal(lyd_print_mem(&st->str1, st->dt, formats[i], options[j]), 0);
+            assert_int_equal(lyd_print_mem(&st->str2, st->dt, formats[i], options[j] | LYP_PARALLEL), 0);
+            assert_string_equal(st->str1, st->str2);
+            free(st->str1);
+            st->str1 = NULL;
+            free(st->str2);
+            st->str2 = NULL;
+        }
+    }
+    lyd_free_withsiblings(st->dt);
+
+    /* list instances with foreign namespaces and annotations inside a container and on the top-level */
+    xml = malloc(1000 * 250 + 600 * 80 + 64);
+    assert_ptr_not_equal(xml, NULL);
+    ptr = xml + sprintf(xml, "<top xmlns=\"urn:par\">");
+    for (i = 0; i < 1000; i++) {
+        ptr += sprintf(ptr, "<entry%s><id>%d</id><name>entry&lt;%d&gt;</name><stats><in>%d</in></stats><tag>a</tag>"
+                       "<tag>b%d</tag><note xmlns=\"urn:par-aug\">note%d</note></entry>",
+                       (i % 7) ? "" : " xmlns:an=\"urn:annot\" an:id=\"x\"", i, i, i * 3, i, i);
+    }
+    ptr += sprintf(ptr, "</top>");
+    for (i = 0; i < 600; i++) {
+        ptr += sprintf(ptr, "<item xmlns=\"urn:par\"><id>%d</id><value>item%d</value></item>", i, i);
+    }
+    st->dt = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    free(xml);
+    assert_ptr_not_equal(st->dt, NULL);
+
+    for (i = 0; i < 2; i++) {
+        for (j = 0; j < 3; j++) {
+            assert_int_equal(lyd_print_mem(&st->str1, st->dt, formats[i], options[j]), 0);
+            assert_int_equal(lyd_print_clb(print_clb, &st->str2, st->dt, formats[i], options[j] | LYP_PARALLEL), 0);
+            assert_string_equal(st->str1, st->str2);
+            free(st->str1);
+            st->str1 = NULL;
+            free(st->str2);
+            st->str2 = NULL;
+        }
+    }
+    lyd_free_withsiblings(st->dt);
+
+    /* few top-level siblings, several nested sibling sets printed by the same threads */
+    xml = malloc(300 * 60 + 300 * 20 + 128);
+    assert_ptr_not_equal(xml, NULL);
+    ptr = xml + sprintf(xml, "<top xmlns=\"urn:par\">");
+    for (i = 0; i < 300; i++) {
+        ptr += sprintf(ptr, "<entry><id>%d</id><name>entry%d</name></entry>", i, i);
+    }
+    ptr += sprintf(ptr, "</top><more xmlns=\"urn:par\">");
+    for (i = 0; i < 300; i++) {
+        ptr += sprintf(ptr, "<rec><id>%d</id></rec>", i);
+    }
+    ptr += sprintf(ptr, "</more>");
+    st->dt = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    free(xml);
+    assert_ptr_not_equal(st->dt, NULL);
+
+    for (i = 0; i < 2; i++) {
+        for (j = 0; j < 3; j++) {
+            assert_int_equal(lyd_print_mem(&st->str1, st->dt, formats[i], options[j]), 0);
+            assert_int_equal(lyd_print_mem(&st->str2, st->dt, formats[i], options[j] | LYP_PARALLEL), 0);
+            assert_string_equal(st->str1, st->str2);
+            free(st->str1);
+            st->str1 = NULL;
+            free(st->str2);
+            st->str2 = NULL;
+        }
+    }
+
+    lyd_print_threads(prev_threads);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -986,6 +1104,7 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_parse_print_oookeys_xml, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_parse_print_oookeys_json, setup_f, teardown_f),
                     cmocka_unit_test_teardown(test_parse_noncharacters_xml, teardown_f),
+                    cmocka_unit_test_teardown(test_parse_print_parallel, teardown_f),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -198,6 +198,82 @@ test_un_nested(void **state)
     assert_string_equal(ly_errmsg(st->ctx), "Unique data leaf(s) \"cont/a cont/b\" not satisfied in \"/unique:un/list[name='namc']/list2[name='a']\" and \"/unique:un/list[name='nam']/list2[name='x']\".");
 }
 
+static struct lyd_node *
+get_node(struct lyd_node *root, const char *path)
+{
+    struct ly_set *set;
+    struct lyd_node *node;
+
+    set = lyd_find_path(root, path);
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    node = set->set.d[0];
+    ly_set_free(set);
+
+    return node;
+}
+
+static void
+test_un_edit(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *node, *dt2;
+    const char *xml1 = "<un xmlns=\"urn:libyang:tests:unique\">"
+                        "<list><name>x</name><value>1</value><a>1</a></list>"
+                        "<list><name>y</name><value>2</value><a>2</a></list>"
+                        "<list><name>z</name><a>3</a></list>"
+                        "<list><name>q</name><value>7</value><a>3</a></list>"
+                       "</un>";
+    const char *xml2 = "<un xmlns=\"urn:libyang:tests:unique\">"
+                        "<list><name>m</name><value>1</value><a>1</a></list>"
+                       "</un>";
+
+    st->dt = lyd_parse_mem(st->ctx, xml1, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+
+    /* changed values */
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)get_node(st->dt, "/unique:un/list[name='y']/value"), "1"), 0);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)get_node(st->dt, "/unique:un/list[name='y']/a"), "1"), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 1);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_NOUNIQ);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)get_node(st->dt, "/unique:un/list[name='x']/a"), "2"), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+
+    /* swapped values */
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)get_node(st->dt, "/unique:un/list[name='x']/a"), "1"), 0);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)get_node(st->dt, "/unique:un/list[name='y']/a"), "2"), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+
+    /* inserted instance */
+    node = lyd_new_path(st->dt, NULL, "/unique:un/list[name='w']/value", "1", 0, 0);
+    assert_ptr_not_equal(node, NULL);
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/unique:un/list[name='w']/a", "2", 0, 0), NULL);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 1);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_NOUNIQ);
+    lyd_free(node);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+
+    /* removed value, the default one collides */
+    lyd_free(get_node(st->dt, "/unique:un/list[name='q']/value"));
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 1);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_NOUNIQ);
+    lyd_free(get_node(st->dt, "/unique:un/list[name='z']"));
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+
+    /* instance moved into another tree */
+    dt2 = lyd_parse_mem(st->ctx, xml2, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(dt2, NULL);
+    node = get_node(st->dt, "/unique:un/list[name='x']");
+    assert_int_equal(lyd_insert(dt2, node), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    assert_int_equal(lyd_validate(&dt2, LYD_OPT_CONFIG, NULL), 1);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_NOUNIQ);
+    assert_int_equal(lyd_insert(st->dt, node), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    assert_int_equal(lyd_validate(&dt2, LYD_OPT_CONFIG, NULL), 0);
+    lyd_free(dt2);
+}
+
 static void
 test_schema_inpath(void **state)
 {
@@ -225,6 +301,7 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_un_defaults, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_un_empty, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_un_nested, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_un_edit, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_schema_inpath, setup_f, teardown_f),
     };
 
@@ -215,11 +215,40 @@ test_inet_types(void **state)
     assert_string_equal(((struct lyd_node_leaf_list *)st->dt)->value_str, "ffff:ffff:ffff:7f::/55");
 }
 
+static void
+test_dup(void **state)
+{
+    struct state *st = (struct state *)*state;
+    struct lyd_node *dup;
+
+    /* ipv4-address member of ip-address union is not stored by a plugin */
+    st->dt = lyd_new_leaf(NULL, st->mod, "inet1", "192.168.0.1");
+    assert_non_null(st->dt);
+    assert_false(((struct lyd_node_leaf_list *)st->dt)->value_flags & LY_VALUE_USER);
+    dup = lyd_dup(st->dt, 0);
+    assert_non_null(dup);
+    assert_string_equal(((struct lyd_node_leaf_list *)dup)->value_str, "192.168.0.1");
+    assert_false(((struct lyd_node_leaf_list *)dup)->value_flags & LY_VALUE_USER);
+    lyd_free(dup);
+    lyd_free_withsiblings(st->dt);
+
+    /* ipv6-address member is */
+    st->dt = lyd_new_leaf(NULL, st->mod, "inet1", "2008:15:0:0:0:0:feAC:1");
+    assert_non_null(st->dt);
+    assert_true(((struct lyd_node_leaf_list *)st->dt)->value_flags & LY_VALUE_USER);
+    dup = lyd_dup(st->dt, 0);
+    assert_non_null(dup);
+    assert_string_equal(((struct lyd_node_leaf_list *)dup)->value_str, "2008:15::feac:1");
+    assert_true(((struct lyd_node_leaf_list *)dup)->value_flags & LY_VALUE_USER);
+    lyd_free(dup);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(test_yang_types, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_inet_types, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_dup, setup_f, teardown_f),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
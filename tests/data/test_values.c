@@ -14,6 +14,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <setjmp.h>
 #include <stdarg.h>
 #include <cmocka.h>
@@ -422,6 +423,85 @@ test_validate_value(void **state)
     assert_int_equal(lyd_validate_value(node, "9.223372036854775807"), EXIT_SUCCESS); /* ok */
 }
 
+/*
+ * union values are resolved as the first member type in order they are valid for, even if the value is not even
+ * tried to be parsed as some of the member types
+ */
+static void
+test_union(void **state)
+{
+    struct state *st = (*state);
+    const char *yang = "module x {"
+                    "  yang-version 1.1;"
+                    "  namespace urn:x;"
+                    "  prefix x;"
+                    "  typedef word { type string { pattern '[a-z\\-]+'; } }"
+                    "  leaf n { type union { type int8; type decimal64 { fraction-digits 2; } type boolean; type empty;"
+                    "    type enumeration { enum one; } type string; } }"
+                    "  leaf d { type union { type int8; type string; } default 0x10; }"
+                    "  leaf c1 { type union { type word { length 1..10; } type string { pattern 'a.b'; } } }"
+                    "  leaf c2 { type union { type string { pattern '[0-9]+'; } type string { pattern '[!-~]+'; } } }"
+                    "  leaf c3 { type union { type string { pattern '[\\p{L}]+'; } type string { pattern '\\S+'; } } }"
+                    "  leaf c4 { type union { type string { pattern '[a-z]+'; } type string { pattern '[^ ]+'; } } }"
+                    "  leaf c5 { type union { type word; type string { pattern '[a-z]+' { modifier invert-match; } } } }"
+                    "}";
+    const char *xml = "<n xmlns=\"urn:x\">%s</n>";
+    const char *values[] = {"+5", "300", "-1.5", "true", "", "one", "1e5", "five", "1:2"};
+    LY_DATA_TYPE bases[] = {LY_TYPE_INT8, LY_TYPE_DEC64, LY_TYPE_DEC64, LY_TYPE_BOOL, LY_TYPE_EMPTY, LY_TYPE_ENUM,
+                            LY_TYPE_STRING, LY_TYPE_STRING, LY_TYPE_STRING};
+    const char *leaves[] = {"c1", "c2", "c3", "c4", "c5"};
+    const char *colon_values[] = {"a:b", "1:2", "a:b", "a:b", "a:b"};
+    const char *no_colon_values[] = {"ab", "12", "ab", "ab", "a-b"};
+    const struct lys_module *mod;
+    const struct lys_node_leaf *sleaf;
+    struct lyd_node_leaf_list *leaf;
+    char buf[128];
+    unsigned int i;
+
+    mod = lys_parse_mem(st->ctx, yang, LYS_IN_YANG);
+    assert_ptr_not_equal(mod, NULL);
+
+    /* lexical classes of the values */
+    for (i = 0; i < sizeof values / sizeof *values; ++i) {
+        sprintf(buf, xml, values[i]);
+        st->dt = lyd_parse_mem(st->ctx, buf, LYD_XML, LYD_OPT_CONFIG);
+        assert_ptr_not_equal(st->dt, NULL);
+        leaf = (struct lyd_node_leaf_list *)st->dt;
+        assert_int_equal(leaf->value_type, bases[i]);
+        assert_int_equal(lyd_leaf_type(leaf)->base, bases[i]);
+        lyd_free_withsiblings(st->dt);
+    }
+    st->dt = NULL;
+
+    /* integers in default values can be hexadecimal */
+    sleaf = (const struct lys_node_leaf *)mod->data->next;
+    assert_string_equal(sleaf->dflt, "16");
+
+    /* the colon is excluded only by patterns that can never match it */
+    for (i = 0; i < sizeof leaves / sizeof *leaves; ++i) {
+        sleaf = (const struct lys_node_leaf *)mod->data->next->next;
+        for (; strcmp(sleaf->name, leaves[i]); sleaf = (const struct lys_node_leaf *)sleaf->next);
+
+        sprintf(buf, "<%s xmlns=\"urn:x\">%s</%s>", leaves[i], colon_values[i], leaves[i]);
+        st->dt = lyd_parse_mem(st->ctx, buf, LYD_XML, LYD_OPT_CONFIG);
+        assert_ptr_not_equal(st->dt, NULL);
+        assert_ptr_equal(lyd_leaf_type((struct lyd_node_leaf_list *)st->dt), &sleaf->type.info.uni.types[1]);
+        lyd_free_withsiblings(st->dt);
+
+        sprintf(buf, "<%s xmlns=\"urn:x\">%s</%s>", leaves[i], no_colon_values[i], leaves[i]);
+        st->dt = lyd_parse_mem(st->ctx, buf, LYD_XML, LYD_OPT_CONFIG);
+        assert_ptr_not_equal(st->dt, NULL);
+        assert_ptr_equal(lyd_leaf_type((struct lyd_node_leaf_list *)st->dt), &sleaf->type.info.uni.types[0]);
+        lyd_free_withsiblings(st->dt);
+    }
+    st->dt = NULL;
+
+    /* no member type accepts the value */
+    st->dt = lyd_parse_mem(st->ctx, "<c1 xmlns=\"urn:x\">a:bc</c1>", LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_equal(st->dt, NULL);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_INVAL);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -431,7 +511,8 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_xmltojson_identityref2, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_xmltojson_instanceid, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_canonical, setup_f, teardown_f),
-                    cmocka_unit_test_setup_teardown(test_validate_value, setup_f, teardown_f),};
+                    cmocka_unit_test_setup_teardown(test_validate_value, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_union, setup_f, teardown_f),};
 
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -271,6 +271,54 @@ test_augment_choice(void **state)
     assert_non_null(st->dt);
 }
 
+static void
+test_autodel_dependency(void **state)
+{
+    struct state *st = (*state);
+    const char *schema =
+    "module when-dep {"
+        "namespace urn:when-dep;"
+        "prefix wd;"
+        "leaf z {"
+            "when \"/wd:cont\";"
+            "type string;"
+        "}"
+        "container cont {"
+            "leaf x {"
+                "when \"/wd:flag = 'on'\";"
+                "type string;"
+            "}"
+        "}"
+        "leaf flag {"
+            "type string;"
+        "}"
+    "}";
+    const struct lys_module *mod;
+    struct lyd_node *node;
+    int ret;
+
+    mod = lys_parse_mem(st->ctx, schema, LYS_IN_YANG);
+    assert_non_null(mod);
+
+    st->dt = lyd_new_path(NULL, st->ctx, "/when-dep:z", "z", 0, 0);
+    assert_non_null(st->dt);
+    assert_non_null(lyd_new_path(st->dt, NULL, "/when-dep:cont/x", "x", 0, 0));
+    node = lyd_new_path(st->dt, NULL, "/when-dep:flag", "on", 0, 0);
+    assert_non_null(node);
+    ret = lyd_validate(&st->dt, LYD_OPT_CONFIG | LYD_OPT_WHENAUTODEL, NULL);
+    assert_int_equal(ret, 0);
+
+    /* x gets auto-deleted together with cont, z is evaluated before that and needs to be evaluated again */
+    ret = lyd_change_leaf((struct lyd_node_leaf_list *)node, "off");
+    assert_int_equal(ret, 0);
+    ret = lyd_validate(&st->dt, LYD_OPT_CONFIG | LYD_OPT_WHENAUTODEL, NULL);
+    assert_int_equal(ret, 0);
+
+    assert_non_null(st->dt);
+    assert_string_equal(st->dt->schema->name, "flag");
+    assert_ptr_equal(st->dt->next, NULL);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -281,6 +329,7 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_insert_noautodel, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_value_prefix, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_augment_choice, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_autodel_dependency, setup_f, teardown_f),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
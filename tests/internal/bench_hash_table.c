@@ -0,0 +1,239 @@
+/**
+ * @file bench_hash_table.c
+ * @brief Hash table benchmark, measures the string hash throughput and the typical workloads
+ * of the tables used in libyang.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libyang.h"
+#include "hash_table.h"
+
+#define BENCH_ROUNDS 5
+
+struct bench_str {
+    char *value;
+    size_t len;
+};
+
+static int
+ptr_equal_cb(void *val1_p, void *val2_p, int mod, void *cb_data)
+{
+    (void)mod;
+    (void)cb_data;
+
+    return *(void **)val1_p == *(void **)val2_p;
+}
+
+static int
+str_equal_cb(void *val1_p, void *val2_p, int mod, void *cb_data)
+{
+    struct bench_str *str1 = val1_p, *str2 = val2_p;
+    (void)mod;
+    (void)cb_data;
+
+    return (str1->len == str2->len) && !strncmp(str1->value, str2->value, str1->len);
+}
+
+static uint32_t
+ptr_hash(void *ptr)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&ptr, sizeof ptr);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+static uint32_t
+str_hash(struct bench_str *str)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, str->value, str->len);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+static double
+elapsed_ns(struct timespec *start)
+{
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1e9 + (end.tv_nsec - start->tv_nsec);
+}
+
+/* Bob Jenkin's one-at-a-time hash, previously used by the dictionary, for comparison */
+static uint32_t
+oaat_hash_multi(uint32_t hash, const char *key_part, size_t len)
+{
+    size_t i;
+
+    if (key_part) {
+        for (i = 0; i < len; ++i) {
+            hash += key_part[i];
+            hash += (hash << 10);
+            hash ^= (hash >> 6);
+        }
+    } else {
+        hash += (hash << 3);
+        hash ^= (hash >> 11);
+        hash += (hash << 15);
+    }
+
+    return hash;
+}
+
+/* hash the same key repeatedly, print the time of one hash and the throughput */
+static void
+bench_hash(const char *name, uint32_t (*hash_multi)(uint32_t, const char *, size_t), size_t len)
+{
+    struct timespec start;
+    char *key;
+    uint32_t i, count, hash = 0;
+    double ns;
+
+    key = malloc(len);
+    for (i = 0; i < len; ++i) {
+        key[i] = 'a' + (i % 26);
+    }
+    count = (64 * 1024 * 1024) / len;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < count; ++i) {
+        /* depend on the previous hash so that the calls cannot be merged */
+        key[0] = hash;
+        hash = hash_multi(hash_multi(0, key, len), NULL, 0);
+    }
+    ns = elapsed_ns(&start);
+
+    printf("%-14s %8zu %10.1f %10.1f\n", name, len, ns / count, (len * count) / (ns / 1e9) / (1024 * 1024));
+    free(key);
+}
+
+/* insert all the values, find them, look for missing ones and remove them all again */
+static void
+bench(const char *name, values_equal_cb val_equal, void *vals, uint16_t val_size, uint32_t *hashes, uint32_t count)
+{
+    struct hash_table *ht;
+    struct timespec start;
+    double ins = 0, hit = 0, miss = 0, rem = 0;
+    uint32_t i, r, miss_hash;
+
+    for (r = 0; r < BENCH_ROUNDS; ++r) {
+        ht = lyht_new(1, val_size, val_equal, NULL, 1);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (i = 0; i < count; ++i) {
+            lyht_insert(ht, (char *)vals + i * val_size, hashes[i], NULL);
+        }
+        ins += elapsed_ns(&start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (i = 0; i < count; ++i) {
+            if (lyht_find(ht, (char *)vals + i * val_size, hashes[i], NULL)) {
+                fprintf(stderr, "%s: value %u not found.\n", name, i);
+                exit(1);
+            }
+        }
+        hit += elapsed_ns(&start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (i = 0; i < count; ++i) {
+            /* a different hash, the value is never found */
+            miss_hash = hashes[i] ^ 0x5bd1e995;
+            lyht_find(ht, (char *)vals + i * val_size, miss_hash, NULL);
+        }
+        miss += elapsed_ns(&start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (i = 0; i < count; ++i) {
+            lyht_remove(ht, (char *)vals + i * val_size, hashes[i]);
+        }
+        rem += elapsed_ns(&start);
+
+        lyht_free(ht);
+    }
+
+    count *= BENCH_ROUNDS;
+    printf("%-14s %8u %10.1f %10.1f %10.1f %10.1f\n", name, count / BENCH_ROUNDS, ins / count, hit / count,
+           miss / count, rem / count);
+}
+
+int
+main(int argc, char **argv)
+{
+    uint32_t count, i, *hashes;
+    void **ptrs;
+    struct bench_str *strs;
+    char buf[32];
+
+    count = (argc > 1) ? (uint32_t)atoi(argv[1]) : 100000;
+    if (!count) {
+        fprintf(stderr, "Usage: %s [value-count]\n", argv[0]);
+        return 1;
+    }
+
+    ptrs = malloc(count * sizeof *ptrs);
+    strs = malloc(count * sizeof *strs);
+    hashes = malloc(count * sizeof *hashes);
+    if (!ptrs || !strs || !hashes) {
+        fprintf(stderr, "Memory allocation error.\n");
+        return 1;
+    }
+
+    printf("%-14s %8s %10s %10s\n", "hash", "length", "hash", "throughput");
+    printf("%-14s %8s %10s %10s\n", "", "", "[ns]", "[MB/s]");
+    for (i = 8; i <= 4096; i *= 4) {
+        bench_hash("dict_hash", dict_hash_multi, i);
+        bench_hash("one-at-a-time", oaat_hash_multi, i);
+    }
+    printf("\n");
+
+    printf("%-14s %8s %10s %10s %10s %10s\n", "table", "values", "insert", "find", "find-miss", "remove");
+    printf("%-14s %8s %10s %10s %10s %10s\n", "", "", "[ns/op]", "[ns/op]", "[ns/op]", "[ns/op]");
+
+    /* node pointers, such as child and set indexes */
+    for (i = 0; i < count; ++i) {
+        ptrs[i] = malloc(16);
+        hashes[i] = ptr_hash(ptrs[i]);
+    }
+    bench("ptr-callback", ptr_equal_cb, ptrs, sizeof *ptrs, hashes, count);
+    bench("ptr-inline", NULL, ptrs, sizeof *ptrs, hashes, count);
+
+    /* strings, such as the dictionary */
+    for (i = 0; i < count; ++i) {
+        sprintf(buf, "node-name-%u", i);
+        strs[i].value = strdup(buf);
+        strs[i].len = strlen(buf);
+        hashes[i] = str_hash(&strs[i]);
+    }
+    bench("string", str_equal_cb, strs, sizeof *strs, hashes, count);
+
+    /* poorly distributed hashes, such as the short LYB schema hashes */
+    for (i = 0; i < count; ++i) {
+        hashes[i] = i & 0xff;
+    }
+    bench("short-hash", ptr_equal_cb, ptrs, sizeof *ptrs, hashes, count > 4096 ? 4096 : count);
+
+    for (i = 0; i < count; ++i) {
+        free(ptrs[i]);
+        free(strs[i].value);
+    }
+    free(ptrs);
+    free(strs);
+    free(hashes);
+    return 0;
+}
@@ -191,13 +191,10 @@ test_collisions(void **state)
         rec = lyht_get_rec(ht->recs, ht->rec_size, i);
         assert_int_equal(rec->hits, 0);
     }
-    rec = lyht_get_rec(ht->recs, ht->rec_size, i);
-    assert_int_equal(rec->hits, 4);
-    assert_int_equal(GET_REC_VAL(rec), i);
-    ++i;
     for (; i < 6; ++i) {
         rec = lyht_get_rec(ht->recs, ht->rec_size, i);
         assert_int_equal(rec->hits, 1);
+        assert_int_equal(rec->hash, 2);
         assert_int_equal(GET_REC_VAL(rec), i);
     }
     for (; i < 8; ++i) {
@@ -205,32 +202,32 @@ test_collisions(void **state)
         assert_int_equal(rec->hits, 0);
     }
 
+    /* searches never continue past the only group of a small table, the records are fully emptied */
     i = 4;
     assert_int_equal(lyht_remove(ht, &i, 2), 0);
 
     rec = lyht_get_rec(ht->recs, ht->rec_size, i);
-    assert_int_equal(rec->hits, -1);
+    assert_int_equal(rec->hits, 0);
 
     i = 2;
     assert_int_equal(lyht_remove(ht, &i, 2), 0);
 
     /* check all records */
-    for (i = 0; i < 2; ++i) {
+    for (i = 0; i < 3; ++i) {
         rec = lyht_get_rec(ht->recs, ht->rec_size, i);
         assert_int_equal(rec->hits, 0);
     }
     rec = lyht_get_rec(ht->recs, ht->rec_size, i);
-    assert_int_equal(rec->hits, 2);
-    assert_int_equal(GET_REC_VAL(rec), 5);
+    assert_int_equal(rec->hits, 1);
+    assert_int_equal(GET_REC_VAL(rec), 3);
+    ++i;
+    rec = lyht_get_rec(ht->recs, ht->rec_size, i);
+    assert_int_equal(rec->hits, 0);
     ++i;
     rec = lyht_get_rec(ht->recs, ht->rec_size, i);
     assert_int_equal(rec->hits, 1);
-    assert_int_equal(GET_REC_VAL(rec), 3);
+    assert_int_equal(GET_REC_VAL(rec), 5);
     ++i;
-    for (; i < 6; ++i) {
-        rec = lyht_get_rec(ht->recs, ht->rec_size, i);
-        assert_int_equal(rec->hits, -1);
-    }
     for (; i < 8; ++i) {
         rec = lyht_get_rec(ht->recs, ht->rec_size, i);
         assert_int_equal(rec->hits, 0);
@@ -255,18 +252,169 @@ test_collisions(void **state)
     assert_int_equal(lyht_remove(ht, &i, 2), 0);
 
     /* check all records */
-    for (i = 0; i < 2; ++i) {
+    for (i = 0; i < 8; ++i) {
         rec = lyht_get_rec(ht->recs, ht->rec_size, i);
         assert_int_equal(rec->hits, 0);
     }
-    for (; i < 6; ++i) {
-        rec = lyht_get_rec(ht->recs, ht->rec_size, i);
-        assert_int_equal(rec->hits, -1);
+}
+
+static void
+test_deleted(void **state)
+{
+    int i, *match;
+    struct ht_rec *rec;
+    (void)state;
+
+    lyht_free(ht);
+    ht = lyht_new(64, sizeof(int), val_equal, NULL, 0);
+    assert_non_null(ht);
+
+    /* more colliding values than fit into a group */
+    for (i = 0; i < 20; ++i) {
+        assert_int_equal(lyht_insert(ht, &i, 0, NULL), 0);
     }
-    for (; i < 8; ++i) {
+    for (i = 0; i < LYHT_GROUP_SIZE; ++i) {
         rec = lyht_get_rec(ht->recs, ht->rec_size, i);
-        assert_int_equal(rec->hits, 0);
+        assert_int_equal(rec->hits, 1);
+        assert_int_equal(GET_REC_VAL(rec), i);
     }
+
+    /* searches may have continued past the record, it must only be marked */
+    i = 5;
+    assert_int_equal(lyht_remove(ht, &i, 0), 0);
+    rec = lyht_get_rec(ht->recs, ht->rec_size, i);
+    assert_int_equal(rec->hits, -1);
+    assert_int_equal(ht->deleted, 1);
+    assert_int_equal(lyht_find(ht, &i, 0, NULL), 1);
+    i = 19;
+    assert_int_equal(lyht_find(ht, &i, 0, (void **)&match), 0);
+    assert_int_equal(*match, 19);
+
+    /* the deleted record is reused */
+    i = 5;
+    assert_int_equal(lyht_insert(ht, &i, 0, NULL), 0);
+    rec = lyht_get_rec(ht->recs, ht->rec_size, i);
+    assert_int_equal(rec->hits, 1);
+    assert_int_equal(ht->deleted, 0);
+    assert_int_equal(lyht_insert(ht, &i, 0, NULL), 1);
+
+    /* a value not colliding with the others is fully emptied */
+    i = 40;
+    assert_int_equal(lyht_insert(ht, &i, 40, NULL), 0);
+    assert_int_equal(lyht_remove(ht, &i, 40), 0);
+    rec = lyht_get_rec(ht->recs, ht->rec_size, i);
+    assert_int_equal(rec->hits, 0);
+    assert_int_equal(ht->used, 20);
+}
+
+static int
+val_equal_tens(void *val1, void *val2, int mod, void *cb_data)
+{
+    int *v1, *v2;
+    (void)cb_data;
+
+    v1 = (int *)val1;
+    v2 = (int *)val2;
+
+    if (mod) {
+        return *v1 == *v2;
+    }
+    return *v1 / 10 == *v2 / 10;
+}
+
+static void
+test_find_next(void **state)
+{
+    int i, *match;
+    (void)state;
+
+    lyht_free(ht);
+    ht = lyht_new(8, sizeof(int), val_equal_tens, NULL, 1);
+    assert_non_null(ht);
+
+    for (i = 11; i < 14; ++i) {
+        assert_int_equal(lyht_insert(ht, &i, 1, NULL), 0);
+    }
+    i = 21;
+    assert_int_equal(lyht_insert(ht, &i, 1, NULL), 0);
+    i = 15;
+    assert_int_equal(lyht_insert(ht, &i, 9, NULL), 0);
+
+    i = 10;
+    assert_int_equal(lyht_find(ht, &i, 1, (void **)&match), 0);
+    assert_int_equal(*match, 11);
+    assert_int_equal(lyht_find_next(ht, match, 1, (void **)&match), 0);
+    assert_int_equal(*match, 12);
+    assert_int_equal(lyht_find_next(ht, match, 1, (void **)&match), 0);
+    assert_int_equal(*match, 13);
+    assert_int_equal(lyht_find_next(ht, match, 1, (void **)&match), 0);
+    assert_int_equal(*match, 21);
+    assert_int_equal(lyht_find_next(ht, match, 1, (void **)&match), 1);
+}
+
+static void
+test_dup(void **state)
+{
+    struct hash_table *dup;
+    int i;
+    (void)state;
+
+    for (i = 1; i < 8; i += 2) {
+        assert_int_equal(lyht_insert(ht, &i, i, NULL), 0);
+    }
+    i = 4;
+    assert_int_equal(lyht_insert(ht, &i, 4, NULL), 0);
+    assert_int_equal(lyht_remove(ht, &i, 4), 0);
+
+    dup = lyht_dup(ht);
+    assert_non_null(dup);
+    assert_int_equal(dup->used, 4);
+
+    /* all the values are copied, not only the ones in the first used records */
+    for (i = 1; i < 8; i += 2) {
+        assert_int_equal(lyht_find(dup, &i, i, NULL), 0);
+    }
+    i = 4;
+    assert_int_equal(lyht_find(dup, &i, 4, NULL), 1);
+
+    /* the tables are independent */
+    i = 7;
+    assert_int_equal(lyht_remove(dup, &i, 7), 0);
+    assert_int_equal(lyht_find(dup, &i, 7, NULL), 1);
+    assert_int_equal(lyht_find(ht, &i, 7, NULL), 0);
+
+    lyht_free(dup);
+}
+
+static void
+test_ptr_keys(void **state)
+{
+    struct hash_table *pht;
+    void *ptrs[100], **match;
+    int i;
+    (void)state;
+
+    pht = lyht_new(1, sizeof(void *), NULL, NULL, 1);
+    assert_non_null(pht);
+
+    for (i = 0; i < 100; ++i) {
+        ptrs[i] = &ptrs[i];
+        assert_int_equal(lyht_insert(pht, &ptrs[i], i / 4, NULL), 0);
+    }
+    assert_int_equal(pht->used, 100);
+    for (i = 0; i < 100; ++i) {
+        assert_int_equal(lyht_find(pht, &ptrs[i], i / 4, (void **)&match), 0);
+        assert_ptr_equal(*match, ptrs[i]);
+        assert_int_equal(lyht_insert(pht, &ptrs[i], i / 4, NULL), 1);
+    }
+    for (i = 0; i < 100; i += 2) {
+        assert_int_equal(lyht_remove(pht, &ptrs[i], i / 4), 0);
+    }
+    for (i = 0; i < 100; ++i) {
+        assert_int_equal(lyht_find(pht, &ptrs[i], i / 4, NULL), i % 2 ? 0 : 1);
+    }
+
+    lyht_free(pht);
 }
 
 int main(void)
@@ -276,6 +424,10 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_half_full, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_resize, setup_f_resize, teardown_f),
         cmocka_unit_test_setup_teardown(test_collisions, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_deleted, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_find_next, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_dup, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_ptr_keys, setup_f, teardown_f),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
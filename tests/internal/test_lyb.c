@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <setjmp.h>
 #include <stdarg.h>
 #include <cmocka.h>
@@ -657,6 +658,285 @@ test_leafrefs(void **state)
     check_data_tree(st->dt1, st->dt2);
 }
 
+static void
+test_version0(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *iter;
+    struct ly_set *set;
+    /* ietf-interfaces data printed by LYB version 0 */
+    unsigned char data[] = {
+    0x6c, 0x79, 0x62, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x69, 0x65, 0x74, 0x66,
+    0x2d, 0x69, 0x6e, 0x74, 0x65, 0x72, 0x66, 0x61, 0x63, 0x65, 0x73, 0xa8,
+    0x1c, 0x07, 0x00, 0x69, 0x65, 0x74, 0x66, 0x2d, 0x69, 0x70, 0xd0, 0x1c,
+    0x4f, 0x08, 0x0f, 0x00, 0x69, 0x65, 0x74, 0x66, 0x2d, 0x69, 0x6e, 0x74,
+    0x65, 0x72, 0x66, 0x61, 0x63, 0x65, 0x73, 0xa8, 0x1c, 0x80, 0x00, 0x3a,
+    0x07, 0xe4, 0x00, 0x07, 0x00, 0xbe, 0x00, 0x0a, 0x65, 0x74, 0x68, 0x30,
+    0x1e, 0x00, 0xa9, 0x00, 0x07, 0x69, 0x61, 0x6e, 0x61, 0x2d, 0x69, 0x66,
+    0x2d, 0x74, 0x79, 0x70, 0x65, 0x3a, 0x65, 0x74, 0x68, 0x65, 0x72, 0x6e,
+    0x65, 0x74, 0x43, 0x73, 0x6d, 0x61, 0x63, 0x64, 0x04, 0x00, 0xc2, 0x00,
+    0x03, 0x01, 0x0f, 0x03, 0xd6, 0x00, 0x05, 0x00, 0xe9, 0x00, 0x0f, 0xdc,
+    0x05, 0x04, 0x00, 0xd7, 0x00, 0x83, 0x01, 0x04, 0x00, 0xf8, 0x00, 0x83,
+    0x00, 0x00
+    };
+
+    assert_non_null(ly_ctx_load_module(st->ctx, "ietf-ip", NULL));
+    assert_non_null(ly_ctx_load_module(st->ctx, "iana-if-type", NULL));
+
+    /* the schema node hashes are computed differently */
+    st->dt1 = lyd_parse_mem(st->ctx, (char *)data, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt1, NULL);
+
+    set = lyd_find_path(st->dt1, "/ietf-interfaces:interfaces/interface[name='eth0']/ietf-ip:ipv4/mtu");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[0])->value_str, "1500");
+    ly_set_free(set);
+
+    /* the same data printed again are the current version */
+    assert_int_equal(lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS), 0);
+    assert_int_equal(st->mem[3], LYB_VERSION_NUM);
+    st->dt2 = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt2, NULL);
+    check_data_tree(st->dt1, st->dt2);
+
+    /* unknown newer version */
+    data[3] = LYB_VERSION_NUM + 1;
+    iter = lyd_parse_mem(st->ctx, (char *)data, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_equal(iter, NULL);
+}
+
+struct stream_out {
+    char *buf;
+    size_t len;
+    size_t max_write;
+};
+
+static ssize_t
+stream_clb(void *arg, const void *buf, size_t count)
+{
+    struct stream_out *out = arg;
+
+    out->buf = realloc(out->buf, out->len + count);
+    memcpy(out->buf + out->len, buf, count);
+    out->len += count;
+    if (count > out->max_write) {
+        out->max_write = count;
+    }
+
+    return count;
+}
+
+static void
+test_stream(void **state)
+{
+    struct state *st = (*state);
+    struct stream_out out = {NULL, 0, 0};
+    struct lyd_node *iter;
+    int ret;
+
+    ly_ctx_set_searchdir(st->ctx, TESTS_DIR"/data/files");
+    assert_non_null(ly_ctx_load_module(st->ctx, "annotations", NULL));
+
+    st->dt1 = lyd_parse_path(st->ctx, TESTS_DIR"/data/files/many-childs-annot.xml", LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt1, NULL);
+
+    /* the output is written gradually, never more than the internal buffer at once */
+    ret = lyd_print_clb(stream_clb, &out, st->dt1, LYD_LYB, LYP_WITHSIBLINGS | LYP_LYB_STREAM);
+    assert_int_equal(ret, 0);
+    assert_true(out.len > LYB_STREAM_BUF_SIZE);
+    assert_true(out.max_write <= LYB_STREAM_BUF_SIZE);
+    assert_int_equal(out.buf[3], LYB_VERSION_NUM | LYB_HEADER_STREAM);
+    assert_int_equal(lyd_lyb_data_length(out.buf), out.len);
+    st->mem = out.buf;
+
+    st->dt2 = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt2, NULL);
+    check_data_tree(st->dt1, st->dt2);
+
+    /* unknown header flag */
+    st->mem[3] |= 0x80;
+    iter = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_equal(iter, NULL);
+}
+
+static void
+test_stream_anydata(void **state)
+{
+    struct state *st = (*state);
+    const struct lys_module *mod;
+    struct lyd_node *tree;
+    struct lyd_node_anydata *any;
+    char *str;
+    int ret;
+    const char *test_anydata =
+    "module test-anydata {"
+    "   namespace \"urn:test-anydata\";"
+    "   prefix ya;"
+    ""
+    "   container cont {"
+    "       anydata any;"
+    "       leaf str { type string; }"
+    "   }"
+    "}";
+
+    mod = lys_parse_mem(st->ctx, test_anydata, LYS_YANG);
+    assert_non_null(mod);
+
+    /* string value split into several data chunks */
+    str = malloc(1000);
+    memset(str, 'a', 999);
+    str[999] = '\0';
+
+    tree = lyd_new(NULL, mod, "cont");
+    assert_non_null(tree);
+    assert_non_null(lyd_new_leaf(tree, NULL, "str", str));
+
+    /* nested data tree printed into memory first */
+    st->dt1 = lyd_new(NULL, mod, "cont");
+    assert_non_null(st->dt1);
+    assert_non_null(lyd_new_anydata(st->dt1, NULL, "any", tree, LYD_ANYDATA_DATATREE));
+    assert_non_null(lyd_new_leaf(st->dt1, NULL, "str", str));
+    free(str);
+
+    ret = lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS | LYP_LYB_STREAM);
+    assert_int_equal(ret, 0);
+
+    st->dt2 = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt2, NULL);
+    assert_string_equal(((struct lyd_node_leaf_list *)st->dt2->child->next)->value_str,
+                        ((struct lyd_node_leaf_list *)st->dt1->child->next)->value_str);
+
+    /* the nested data */
+    any = (struct lyd_node_anydata *)st->dt2->child;
+    assert_int_equal(any->value_type, LYD_ANYDATA_LYB);
+    tree = lyd_parse_mem(st->ctx, any->value.mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_non_null(tree);
+    assert_int_equal(strlen(((struct lyd_node_leaf_list *)tree->child)->value_str), 999);
+    lyd_free_withsiblings(tree);
+}
+
+static void
+test_strings(void **state)
+{
+    struct state *st = (*state);
+    struct stream_out out = {NULL, 0, 0};
+    size_t len;
+    int ret;
+
+    ly_ctx_set_searchdir(st->ctx, TESTS_DIR"/data/files");
+    assert_non_null(ly_ctx_load_module(st->ctx, "annotations", NULL));
+
+    st->dt1 = lyd_parse_path(st->ctx, TESTS_DIR"/data/files/many-childs-annot.xml", LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt1, NULL);
+
+    ret = lyd_print_clb(stream_clb, &out, st->dt1, LYD_LYB, LYP_WITHSIBLINGS);
+    assert_int_equal(ret, 0);
+    len = out.len;
+    free(out.buf);
+    memset(&out, 0, sizeof out);
+
+    /* repeated annotation names and values are written only once */
+    ret = lyd_print_clb(stream_clb, &out, st->dt1, LYD_LYB, LYP_WITHSIBLINGS | LYP_LYB_STRINGS);
+    assert_int_equal(ret, 0);
+    assert_int_equal(out.buf[3], LYB_VERSION_NUM | LYB_HEADER_STRINGS);
+    assert_true(out.len < len);
+    st->mem = out.buf;
+
+    st->dt2 = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt2, NULL);
+    check_data_tree(st->dt1, st->dt2);
+}
+
+static void
+test_compress(void **state)
+{
+    struct state *st = (*state);
+    struct stream_out out = {NULL, 0, 0};
+    struct lyd_node *iter;
+    size_t len;
+    int ret;
+
+    ly_ctx_set_searchdir(st->ctx, TESTS_DIR"/data/files");
+    assert_non_null(ly_ctx_load_module(st->ctx, "annotations", NULL));
+
+    st->dt1 = lyd_parse_path(st->ctx, TESTS_DIR"/data/files/many-childs-annot.xml", LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt1, NULL);
+
+    ret = lyd_print_clb(stream_clb, &out, st->dt1, LYD_LYB, LYP_WITHSIBLINGS);
+    assert_int_equal(ret, 0);
+    len = out.len;
+    free(out.buf);
+    memset(&out, 0, sizeof out);
+
+    /* compressed payload */
+    ret = lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS | LYP_LYB_COMPRESS);
+    assert_int_equal(ret, 0);
+    assert_int_equal(st->mem[3], LYB_VERSION_NUM | LYB_HEADER_COMPRESS);
+    assert_true((size_t)lyd_lyb_data_length(st->mem) < len);
+
+    st->dt2 = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt2, NULL);
+    check_data_tree(st->dt1, st->dt2);
+
+    /* wrong raw size of the first block */
+    ++st->mem[4];
+    iter = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_equal(iter, NULL);
+
+    /* streamed variant with all the options */
+    ret = lyd_print_clb(stream_clb, &out, st->dt1, LYD_LYB,
+                        LYP_WITHSIBLINGS | LYP_LYB_STREAM | LYP_LYB_STRINGS | LYP_LYB_COMPRESS);
+    assert_int_equal(ret, 0);
+    assert_int_equal(out.buf[3], LYB_VERSION_NUM | LYB_HEADER_STREAM | LYB_HEADER_STRINGS | LYB_HEADER_COMPRESS);
+    assert_int_equal(lyd_lyb_data_length(out.buf), out.len);
+    assert_true(out.len < len);
+
+    lyd_free_withsiblings(st->dt2);
+    st->dt2 = lyd_parse_mem(st->ctx, out.buf, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    free(out.buf);
+    assert_ptr_not_equal(st->dt2, NULL);
+    check_data_tree(st->dt1, st->dt2);
+}
+
+static void
+test_compress_truncated(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *iter;
+    FILE *f;
+    int ret, len;
+
+    ly_ctx_set_searchdir(st->ctx, TESTS_DIR"/data/files");
+    assert_non_null(ly_ctx_load_module(st->ctx, "annotations", NULL));
+
+    st->dt1 = lyd_parse_path(st->ctx, TESTS_DIR"/data/files/many-childs-annot.xml", LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt1, NULL);
+
+    ret = lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS | LYP_LYB_COMPRESS);
+    assert_int_equal(ret, 0);
+    len = lyd_lyb_data_length(st->mem);
+    assert_true(len > 8);
+
+    /* the stream ends in the middle of the first block */
+    f = tmpfile();
+    assert_non_null(f);
+    assert_int_equal(fwrite(st->mem, 1, len / 2, f), len / 2);
+    fflush(f);
+
+    iter = lyd_parse_fd(st->ctx, fileno(f), LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_equal(iter, NULL);
+    assert_int_equal(ly_errno, LY_EINVAL);
+
+    /* the stream ends in the middle of the block header */
+    assert_int_equal(ftruncate(fileno(f), 7), 0);
+    iter = lyd_parse_fd(st->ctx, fileno(f), LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_equal(iter, NULL);
+    assert_int_equal(ly_errno, LY_EINVAL);
+
+    fclose(f);
+}
+
 int
 main(void)
 {
@@ -675,6 +955,12 @@ main(void)
         cmocka_unit_test_setup_teardown(test_submodule_feature, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_coliding_augments, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_leafrefs, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_version0, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_stream, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_stream_anydata, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_strings, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_compress, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_compress_truncated, setup_f, teardown_f),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
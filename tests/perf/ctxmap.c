@@ -0,0 +1,146 @@
+/**
+ * @file ctxmap.c
+ * @brief performance test - moving data from a session context into a master context with and without a schema map.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "perf_common.h"
+
+#define ROUNDS 20
+
+static const char *schema =
+"module ctxmap {"
+"  namespace urn:ctxmap;"
+"  prefix c;"
+"  container top {"
+"    list entry {"
+"      key id;"
+"      leaf id { type uint32; }"
+"      leaf name { type string; }"
+"      leaf enabled { type boolean; }"
+"      container stats {"
+"        leaf in { type uint64; }"
+"        leaf out { type uint64; }"
+"      }"
+"    }"
+"  }"
+"}";
+
+static const char *schema_aug =
+"module ctxmap-aug {"
+"  namespace urn:ctxmap-aug;"
+"  prefix a;"
+"  import ctxmap { prefix c; }"
+"  augment /c:top/c:entry {"
+"    leaf note { type string; }"
+"  }"
+"}";
+
+/* time of duplicating the session data into the master context and of merging them into the master data */
+static int
+transplant(struct ly_ctx *master_ctx, struct lyd_node **master, struct lyd_node *session, struct ly_ctx_schema_map *map,
+           double *dup_ms, double *merge_ms)
+{
+	struct timespec start;
+	struct lyd_node *copy;
+	int i;
+
+	*dup_ms = 0;
+	*merge_ms = 0;
+	for (i = 0; i < ROUNDS; i++) {
+		PERF_START(&start);
+		copy = map ? lyd_dup_to_ctx_map(session, LYD_DUP_OPT_RECURSIVE, map)
+		           : lyd_dup_to_ctx(session, LYD_DUP_OPT_RECURSIVE, master_ctx);
+		*dup_ms += perf_elapsed(&start);
+		if (!copy) {
+			return -1;
+		}
+		lyd_free(copy);
+
+		PERF_START(&start);
+		if (map ? lyd_merge_to_ctx_map(master, session, 0, map) : lyd_merge_to_ctx(master, session, 0, master_ctx)) {
+			return -1;
+		}
+		*merge_ms += perf_elapsed(&start);
+	}
+	*dup_ms /= ROUNDS;
+	*merge_ms /= ROUNDS;
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *session_ctx = NULL, *master_ctx = NULL;
+	struct ly_ctx_schema_map *map = NULL;
+	struct lyd_node *session = NULL, *master = NULL;
+	char *xml, *ptr;
+	double dup_ms, merge_ms, map_dup_ms, map_merge_ms;
+	int i, count = 20000, ret = 1;
+
+	count = perf_arg(argc, argv, 1, count);
+	if (count < 1) {
+		fprintf(stderr, "Usage: %s [entry-count]\n", argv[0]);
+		return 1;
+	}
+
+	session_ctx = perf_ctx_new(schema, schema_aug, NULL);
+	master_ctx = perf_ctx_new(schema, schema_aug, NULL);
+	if (!session_ctx || !master_ctx) {
+		goto cleanup;
+	}
+
+	xml = perf_buf_new(count * 200 + 64);
+	if (!xml) {
+		goto cleanup;
+	}
+	ptr = xml + sprintf(xml, "<top xmlns=\"urn:ctxmap\">");
+	for (i = 0; i < count; i++) {
+		ptr += sprintf(ptr, "<entry><id>%d</id><name>entry%d</name><enabled>%s</enabled><stats><in>%d</in><out>%d</out>"
+		               "</stats><note xmlns=\"urn:ctxmap-aug\">note%d</note></entry>", i, i, (i % 2) ? "true" : "false",
+		               i * 3, i * 7, i);
+	}
+	sprintf(ptr, "</top>");
+
+	session = lyd_parse_mem(session_ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+	master = lyd_parse_mem(master_ctx, "<top xmlns=\"urn:ctxmap\"/>", LYD_XML, LYD_OPT_CONFIG);
+	free(xml);
+	if (!session || !master) {
+		fprintf(stderr, "Failed to parse data.\n");
+		goto cleanup;
+	}
+
+	map = ly_ctx_schema_map_new(session_ctx, master_ctx);
+	if (!map) {
+		fprintf(stderr, "Failed to create schema map.\n");
+		goto cleanup;
+	}
+
+	if (transplant(master_ctx, &master, session, NULL, &dup_ms, &merge_ms)
+	        || transplant(master_ctx, &master, session, map, &map_dup_ms, &map_merge_ms)) {
+		fprintf(stderr, "Failed to move data.\n");
+		goto cleanup;
+	}
+
+	printf("%d entries into another context: dup %8.3f ms  merge %8.3f ms  with schema map: dup %8.3f ms  merge %8.3f ms\n",
+	       count, dup_ms, merge_ms, map_dup_ms, map_merge_ms);
+	ret = 0;
+
+cleanup:
+	ly_ctx_schema_map_free(map);
+	lyd_free_withsiblings(session);
+	lyd_free_withsiblings(master);
+	ly_ctx_destroy(session_ctx, NULL);
+	ly_ctx_destroy(master_ctx, NULL);
+	return ret;
+}
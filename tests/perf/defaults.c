@@ -0,0 +1,134 @@
+/**
+ * @file defaults.c
+ * @brief performance test - adding implicit default nodes into list entries during validation,
+ * with and without the virtual default nodes.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "perf_common.h"
+
+static const char *schema =
+"module defaults {"
+"  yang-version 1.1;"
+"  namespace urn:defaults;"
+"  prefix d;"
+"  import ietf-inet-types { prefix inet; }"
+"  typedef percent { type uint8 { range 0..100; } default 50; }"
+"  container top {"
+"    list entry {"
+"      key name;"
+"      leaf name { type string; }"
+"      leaf enabled { type boolean; default true; }"
+"      leaf mtu { type uint16 { range 68..9000; } default 1500; }"
+"      leaf weight { type percent; }"
+"      leaf ratio { type decimal64 { fraction-digits 2; } default 0.75; }"
+"      leaf mode { type enumeration { enum fast; enum slow; enum auto; } default auto; }"
+"      leaf flags { type bits { bit a; bit b; bit c; } default \"a c\"; }"
+"      leaf descr { type string { length 0..64; } default \"not set\"; }"
+"      leaf address { type inet:ip-address; default 0.0.0.0; }"
+"      leaf port { type inet:port-number; default 830; }"
+"      leaf-list tag { type string; default x; default y; }"
+"      container timers {"
+"        leaf hello { type uint32; default 10; }"
+"        leaf dead { type uint32; default 40; }"
+"        leaf retransmit { type uint32; default 5; }"
+"      }"
+"      choice transport {"
+"        default tcp;"
+"        case tcp { leaf tcp-port { type inet:port-number; default 22; } }"
+"        case udp { leaf udp-port { type inet:port-number; default 53; } }"
+"      }"
+"    }"
+"  }"
+"}";
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct timespec start;
+	struct lyd_node *data = NULL;
+	char *xml, *ptr;
+	double parse_ms, validate_ms, virtual_ms;
+	int i, count = 5000, rounds = 5, ret = 1;
+
+	count = perf_arg(argc, argv, 1, count);
+	if (count < 1) {
+		fprintf(stderr, "Usage: %s [entry-count]\n", argv[0]);
+		return 1;
+	}
+
+	ctx = perf_ctx_new(schema, NULL);
+	if (!ctx) {
+		return 1;
+	}
+
+	/* only the keys are present, everything else is a default node */
+	xml = perf_buf_new(count * 64 + 64);
+	if (!xml) {
+		ly_ctx_destroy(ctx, NULL);
+		return 1;
+	}
+	ptr = xml + sprintf(xml, "<top xmlns=\"urn:defaults\">");
+	for (i = 0; i < count; i++) {
+		ptr += sprintf(ptr, "<entry><name>entry%d</name></entry>", i);
+	}
+	sprintf(ptr, "</top>");
+
+	parse_ms = validate_ms = virtual_ms = 0;
+	for (i = 0; i < rounds; i++) {
+		/* the defaults are added by the parser */
+		PERF_START(&start);
+		data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+		parse_ms += perf_elapsed(&start);
+		if (!data) {
+			fprintf(stderr, "Failed to parse data.\n");
+			goto cleanup;
+		}
+		lyd_free_withsiblings(data);
+
+		/* the defaults are added by the validation */
+		data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_EDIT);
+		if (!data) {
+			fprintf(stderr, "Failed to parse data.\n");
+			goto cleanup;
+		}
+		PERF_START(&start);
+		if (lyd_validate(&data, LYD_OPT_CONFIG, NULL)) {
+			fprintf(stderr, "Failed to validate data.\n");
+			lyd_free_withsiblings(data);
+			goto cleanup;
+		}
+		validate_ms += perf_elapsed(&start);
+		lyd_free_withsiblings(data);
+
+		/* the defaults are only virtual */
+		PERF_START(&start);
+		data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_VIRTUAL_DFLT);
+		virtual_ms += perf_elapsed(&start);
+		if (!data) {
+			fprintf(stderr, "Failed to parse data.\n");
+			goto cleanup;
+		}
+		lyd_free_withsiblings(data);
+	}
+
+	printf("%d entries with 18 default nodes each: parse %8.3f ms  validate %8.3f ms  parse virtual %8.3f ms\n", count,
+	       parse_ms / rounds, validate_ms / rounds, virtual_ms / rounds);
+	ret = 0;
+
+cleanup:
+	free(xml);
+	ly_ctx_destroy(ctx, NULL);
+	return ret;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file diff.c
+ * @brief performance test - repeatedly comparing a large data tree with its slightly modified copy.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "perf_common.h"
+
+#define CHANGES 10
+
+static const char *schema =
+"module diff {"
+"  namespace urn:diff;"
+"  prefix d;"
+"  container top {"
+"    list entry {"
+"      key id;"
+"      leaf id { type uint32; }"
+"      leaf name { type string; }"
+"      leaf enabled { type boolean; }"
+"      container stats {"
+"        leaf in { type uint64; }"
+"        leaf out { type uint64; }"
+"      }"
+"    }"
+"  }"
+"}";
+
+/* number of the differences, -1 on error */
+static int
+diff_count(struct lyd_node *first, struct lyd_node *second)
+{
+	struct lyd_difflist *diff;
+	int i;
+
+	diff = lyd_diff(first, second, 0);
+	if (!diff) {
+		return -1;
+	}
+	for (i = 0; diff->type[i] != LYD_DIFF_END; i++);
+	lyd_free_diff(diff);
+	return i;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct timespec start;
+	struct lyd_node *data = NULL, *copy = NULL, *entry, **leaves = NULL;
+	char *xml, *ptr, buf[32];
+	double first_ms, diff_ms = 0, same_ms;
+	int i, j, count = 100000, rounds = 10, same, ret = 1;
+
+	count = perf_arg(argc, argv, 1, count);
+	if (count < CHANGES) {
+		fprintf(stderr, "Usage: %s [entry-count]\n", argv[0]);
+		return 1;
+	}
+
+	ctx = perf_ctx_new(schema, NULL);
+	if (!ctx) {
+		return 1;
+	}
+
+	xml = perf_buf_new(count * 160 + 64);
+	if (!xml) {
+		ly_ctx_destroy(ctx, NULL);
+		return 1;
+	}
+	ptr = xml + sprintf(xml, "<top xmlns=\"urn:diff\">");
+	for (i = 0; i < count; i++) {
+		ptr += sprintf(ptr, "<entry><id>%d</id><name>entry%d</name><enabled>%s</enabled><stats><in>%d</in><out>%d</out>"
+		               "</stats></entry>", i, i, (i % 2) ? "true" : "false", i * 3, i * 7);
+	}
+	sprintf(ptr, "</top>");
+
+	data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+	free(xml);
+	if (!data) {
+		fprintf(stderr, "Failed to parse data.\n");
+		goto cleanup;
+	}
+	copy = lyd_dup_withsiblings(data, LYD_DUP_OPT_RECURSIVE);
+	leaves = malloc(count * sizeof *leaves);
+	if (!copy || !leaves) {
+		fprintf(stderr, "Failed to duplicate data.\n");
+		goto cleanup;
+	}
+
+	/* remember the stats/in leaves to modify */
+	i = 0;
+	LY_TREE_FOR(copy->child, entry) {
+		leaves[i++] = entry->child->prev->child;
+	}
+
+	/* the first comparison of the unmodified trees */
+	PERF_START(&start);
+	if (diff_count(data, copy)) {
+		fprintf(stderr, "Failed to compare data.\n");
+		goto cleanup;
+	}
+	first_ms = perf_elapsed(&start);
+
+	/* modify a few leaves before every comparison */
+	srand(1);
+	for (i = 0; i < rounds; i++) {
+		for (j = 0; j < CHANGES; j++) {
+			sprintf(buf, "%d", rand());
+			lyd_change_leaf((struct lyd_node_leaf_list *)leaves[rand() % count], buf);
+		}
+
+		PERF_START(&start);
+		if (diff_count(data, copy) < 1) {
+			fprintf(stderr, "Failed to compare data.\n");
+			goto cleanup;
+		}
+		diff_ms += perf_elapsed(&start);
+	}
+
+	/* just check whether the trees are the same */
+	PERF_START(&start);
+	same = (lyd_digest(data) == lyd_digest(copy));
+	same_ms = perf_elapsed(&start);
+
+	printf("%d entries, %d changes: first diff %8.3f ms  diff %8.3f ms  same check %8.3f ms (%s)\n", count, CHANGES,
+	       first_ms, diff_ms / rounds, same_ms, same ? "same" : "different");
+	ret = 0;
+
+cleanup:
+	free(leaves);
+	lyd_free_withsiblings(copy);
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+	return ret;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file dup.c
+ * @brief performance test - duplicating a large data tree, time and memory of the copies.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "perf_common.h"
+
+#define READERS 5
+
+static const char *schema =
+"module dup {"
+"  namespace urn:dup;"
+"  prefix d;"
+"  import ietf-inet-types { prefix inet; }"
+"  identity proto;"
+"  identity tcp { base proto; }"
+"  identity udp { base proto; }"
+"  container top {"
+"    list entry {"
+"      key id;"
+"      leaf id { type uint32; }"
+"      leaf name { type string; }"
+"      leaf address { type inet:ip-address; }"
+"      leaf port { type inet:port-number; }"
+"      leaf mode { type enumeration { enum fast; enum slow; } }"
+"      leaf proto { type identityref { base proto; } }"
+"      leaf flags { type bits { bit a; bit b; bit c; } }"
+"      container stats {"
+"        leaf in { type uint64; }"
+"        leaf out { type uint64; }"
+"      }"
+"    }"
+"  }"
+"}";
+
+/* resident memory of the process in kB, 0 if it cannot be learned */
+static long
+resident(void)
+{
+	FILE *f;
+	long size, pages = 0;
+
+	f = fopen("/proc/self/statm", "r");
+	if (!f) {
+		return 0;
+	}
+	if (fscanf(f, "%ld %ld", &size, &pages) != 2) {
+		pages = 0;
+	}
+	fclose(f);
+	return pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct timespec start;
+	struct lyd_node *data = NULL, *copies[READERS] = {NULL};
+	char *xml, *ptr;
+	double dup_ms, free_ms;
+	long mem;
+	int i, count = 100000, ret = 1;
+
+	count = perf_arg(argc, argv, 1, count);
+	if (count < 1) {
+		fprintf(stderr, "Usage: %s [entry-count]\n", argv[0]);
+		return 1;
+	}
+
+	ctx = perf_ctx_new(schema, NULL);
+	if (!ctx) {
+		return 1;
+	}
+
+	xml = perf_buf_new(count * 320 + 64);
+	if (!xml) {
+		ly_ctx_destroy(ctx, NULL);
+		return 1;
+	}
+	ptr = xml + sprintf(xml, "<top xmlns=\"urn:dup\" xmlns:d=\"urn:dup\">");
+	for (i = 0; i < count; i++) {
+		ptr += sprintf(ptr, "<entry><id>%d</id><name>entry%d</name><address>10.%d.%d.%d</address><port>%d</port>"
+		               "<mode>%s</mode><proto>d:%s</proto><flags>a%s</flags><stats><in>%d</in><out>%d</out></stats></entry>",
+		               i, i, (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff, i & 0xffff, (i % 2) ? "fast" : "slow",
+		               (i % 3) ? "tcp" : "udp", (i % 2) ? " c" : "", i * 3, i * 7);
+	}
+	sprintf(ptr, "</top>");
+
+	data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+	free(xml);
+	if (!data) {
+		fprintf(stderr, "Failed to parse data.\n");
+		goto cleanup;
+	}
+
+	/* keep all the copies at once, like a snapshot for every concurrent reader */
+	mem = resident();
+	PERF_START(&start);
+	for (i = 0; i < READERS; i++) {
+		copies[i] = lyd_dup_withsiblings(data, LYD_DUP_OPT_RECURSIVE);
+		if (!copies[i]) {
+			fprintf(stderr, "Failed to duplicate data.\n");
+			goto cleanup;
+		}
+	}
+	dup_ms = perf_elapsed(&start);
+	mem = resident() - mem;
+
+	PERF_START(&start);
+	for (i = 0; i < READERS; i++) {
+		lyd_free_withsiblings(copies[i]);
+		copies[i] = NULL;
+	}
+	free_ms = perf_elapsed(&start);
+
+	printf("%d entries with 11 nodes each: duplicate %8.3f ms  free %8.3f ms  memory %7ld kB per copy\n", count,
+	       dup_ms / READERS, free_ms / READERS, mem / READERS);
+	ret = 0;
+
+cleanup:
+	for (i = 0; i < READERS; i++) {
+		lyd_free_withsiblings(copies[i]);
+	}
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+	return ret;
+}
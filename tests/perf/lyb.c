@@ -0,0 +1,175 @@
+/**
+ * @file lyb.c
+ * @brief performance test - printing and parsing a large data tree in the LYB format variants and in XML.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "perf_common.h"
+
+#define ROUNDS 5
+
+static const char *schema =
+"module lyb {"
+"  namespace urn:lyb;"
+"  prefix l;"
+"  container top {"
+"    list entry {"
+"      key id;"
+"      leaf id { type uint32; }"
+"      leaf name { type string; }"
+"      leaf enabled { type boolean; }"
+"      leaf type { type string; }"
+"      container stats {"
+"        leaf in { type uint64; }"
+"        leaf out { type uint64; }"
+"      }"
+"    }"
+"  }"
+"}";
+
+static const struct {
+	const char *name;
+	int options;
+} variants[] = {
+	{"LYB", 0},
+	{"streamed LYB", LYP_LYB_STREAM},
+	{"LYB with strings", LYP_LYB_STRINGS},
+	{"compressed LYB", LYP_LYB_COMPRESS},
+	{"streamed LYB with all", LYP_LYB_STREAM | LYP_LYB_STRINGS | LYP_LYB_COMPRESS},
+};
+
+static const char *types[] = {"ethernetCsmacd", "softwareLoopback", "ieee8023adLag", "l2vlan"};
+
+struct output {
+	char *buf;
+	size_t len;
+	size_t max_write;
+};
+
+static ssize_t
+write_clb(void *arg, const void *buf, size_t count)
+{
+	struct output *out = arg;
+	char *ptr;
+
+	ptr = realloc(out->buf, out->len + count);
+	if (!ptr) {
+		return -1;
+	}
+	out->buf = ptr;
+	memcpy(out->buf + out->len, buf, count);
+	out->len += count;
+	if (count > out->max_write) {
+		out->max_write = count;
+	}
+	return count;
+}
+
+/* average time of printing and parsing the data, the largest single write into the output */
+static int
+measure(struct ly_ctx *ctx, struct lyd_node *data, LYD_FORMAT format, int options, double *print_ms, double *parse_ms,
+        struct output *out)
+{
+	struct timespec start;
+	struct lyd_node *parsed;
+	int i;
+
+	*print_ms = 0;
+	*parse_ms = 0;
+	for (i = 0; i < ROUNDS; i++) {
+		free(out->buf);
+		memset(out, 0, sizeof *out);
+
+		PERF_START(&start);
+		if (lyd_print_clb(write_clb, out, data, format, options) || !write_clb(out, "", 1)) {
+			return -1;
+		}
+		*print_ms += perf_elapsed(&start);
+
+		PERF_START(&start);
+		parsed = lyd_parse_mem(ctx, out->buf, format, LYD_OPT_CONFIG | LYD_OPT_TRUSTED);
+		*parse_ms += perf_elapsed(&start);
+		if (!parsed) {
+			return -1;
+		}
+		lyd_free_withsiblings(parsed);
+	}
+	*print_ms /= ROUNDS;
+	*parse_ms /= ROUNDS;
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx = NULL;
+	struct lyd_node *data = NULL;
+	struct output out = {NULL, 0, 0};
+	char *xml, *ptr;
+	double print_ms, parse_ms;
+	int i, count = 50000, ret = 1;
+	size_t v;
+
+	count = perf_arg(argc, argv, 1, count);
+	if (count < 1) {
+		fprintf(stderr, "Usage: %s [entry-count]\n", argv[0]);
+		return 1;
+	}
+
+	ctx = perf_ctx_new(schema, NULL);
+	if (!ctx) {
+		goto cleanup;
+	}
+
+	xml = perf_buf_new(count * 200 + 64);
+	if (!xml) {
+		goto cleanup;
+	}
+	ptr = xml + sprintf(xml, "<top xmlns=\"urn:lyb\">");
+	for (i = 0; i < count; i++) {
+		ptr += sprintf(ptr, "<entry><id>%d</id><name>entry%d</name><enabled>%s</enabled><type>%s</type><stats><in>%d</in>"
+		               "<out>%d</out></stats></entry>", i, i, (i % 2) ? "true" : "false", types[i % 4], i * 3, i * 7);
+	}
+	sprintf(ptr, "</top>");
+
+	data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+	free(xml);
+	if (!data) {
+		fprintf(stderr, "Failed to parse data.\n");
+		goto cleanup;
+	}
+
+	if (measure(ctx, data, LYD_XML, LYP_WITHSIBLINGS, &print_ms, &parse_ms, &out)) {
+		fprintf(stderr, "Failed to print or parse XML data.\n");
+		goto cleanup;
+	}
+	printf("%d entries %-21s: print %8.3f ms  parse %8.3f ms  size %8zu B  largest write %8zu B\n",
+	       count, "XML", print_ms, parse_ms, out.len, out.max_write);
+
+	for (v = 0; v < sizeof variants / sizeof *variants; v++) {
+		if (measure(ctx, data, LYD_LYB, LYP_WITHSIBLINGS | variants[v].options, &print_ms, &parse_ms, &out)) {
+			fprintf(stderr, "Failed to print or parse %s data.\n", variants[v].name);
+			goto cleanup;
+		}
+		printf("%d entries %-21s: print %8.3f ms  parse %8.3f ms  size %8zu B  largest write %8zu B\n",
+		       count, variants[v].name, print_ms, parse_ms, out.len, out.max_write);
+	}
+	ret = 0;
+
+cleanup:
+	free(out.buf);
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+	return ret;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file merge.c
+ * @brief performance test - merging a large candidate data tree into a large running data tree.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "perf_common.h"
+
+static const char *schema =
+"module merge {"
+"  namespace urn:merge;"
+"  prefix m;"
+"  container top {"
+"    list entry {"
+"      key id;"
+"      leaf id { type uint32; }"
+"      leaf name { type string; }"
+"      leaf enabled { type boolean; }"
+"      container stats {"
+"        leaf in { type uint64; }"
+"        leaf out { type uint64; }"
+"      }"
+"    }"
+"  }"
+"  list item {"
+"    key id;"
+"    leaf id { type uint32; }"
+"    leaf value { type string; }"
+"  }"
+"}";
+
+/* entries [first, first + count) and items [item_first, item_first + items), the changed ones have different names */
+static struct lyd_node *
+build(struct ly_ctx *ctx, int first, int count, int item_first, int items, int changed)
+{
+	struct lyd_node *data;
+	char *xml, *ptr;
+	int i;
+
+	xml = perf_buf_new((count + items) * 160 + 64);
+	if (!xml) {
+		return NULL;
+	}
+	ptr = xml + sprintf(xml, "<top xmlns=\"urn:merge\">");
+	for (i = first; i < first + count; i++) {
+		ptr += sprintf(ptr, "<entry><id>%d</id><name>%s%d</name><enabled>%s</enabled><stats><in>%d</in><out>%d</out>"
+		               "</stats></entry>", i, changed ? "changed" : "entry", i, (i % 2) ? "true" : "false", i * 3, i * 7);
+	}
+	ptr += sprintf(ptr, "</top>");
+	for (i = item_first; i < item_first + items; i++) {
+		ptr += sprintf(ptr, "<item xmlns=\"urn:merge\"><id>%d</id><value>%s%d</value></item>", i,
+		               changed ? "changed" : "item", i);
+	}
+
+	data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+	free(xml);
+	return data;
+}
+
+/* number of the top-level nodes and their children */
+static int
+count_nodes(struct lyd_node *data)
+{
+	struct lyd_node *iter, *child;
+	int count = 0;
+
+	LY_TREE_FOR(data, iter) {
+		count++;
+		LY_TREE_FOR(iter->child, child) {
+			count++;
+		}
+	}
+	return count;
+}
+
+/* time of merging half new and half existing entries and items into the running data, -1 on error */
+static double
+merge(struct ly_ctx *ctx, int count, int items, int options, int *result)
+{
+	struct timespec start;
+	struct lyd_node *running, *candidate;
+	double ms = -1;
+
+	running = build(ctx, 0, count, 0, items, 0);
+	candidate = build(ctx, count / 2, count, items / 2, items, 1);
+	if (!running || !candidate) {
+		goto cleanup;
+	}
+
+	PERF_START(&start);
+	if (lyd_merge(running, candidate, options)) {
+		goto cleanup;
+	}
+	ms = perf_elapsed(&start);
+	if (options & LYD_OPT_DESTRUCT) {
+		candidate = NULL;
+	}
+
+	if (lyd_validate(&running, LYD_OPT_CONFIG, NULL)) {
+		ms = -1;
+		goto cleanup;
+	}
+	*result = count_nodes(running);
+
+cleanup:
+	lyd_free_withsiblings(candidate);
+	lyd_free_withsiblings(running);
+	return ms;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	double destruct_ms, copy_ms;
+	int count = 100000, items, result1 = 0, result2 = 0;
+
+	count = perf_arg(argc, argv, 1, count);
+	items = count / 5;
+	if (count < 2) {
+		fprintf(stderr, "Usage: %s [entry-count]\n", argv[0]);
+		return 1;
+	}
+
+	ctx = perf_ctx_new(schema, NULL);
+	if (!ctx) {
+		return 1;
+	}
+
+	destruct_ms = merge(ctx, count, items, LYD_OPT_DESTRUCT, &result1);
+	copy_ms = merge(ctx, count, items, 0, &result2);
+	if ((destruct_ms < 0) || (copy_ms < 0) || (result1 != result2)) {
+		fprintf(stderr, "Failed to merge data.\n");
+		ly_ctx_destroy(ctx, NULL);
+		return 1;
+	}
+
+	printf("%d entries, %d items: merge (destruct) %9.3f ms  merge (copy) %9.3f ms  result %d nodes\n", count, items,
+	       destruct_ms, copy_ms, result1);
+
+	ly_ctx_destroy(ctx, NULL);
+	return 0;
+}
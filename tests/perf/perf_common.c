@@ -0,0 +1,74 @@
+/**
+ * @file perf_common.c
+ * @brief performance tests - common timing and fixture helpers.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "perf_common.h"
+
+double
+perf_elapsed(const struct timespec *start)
+{
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) * 1000.0 + (end.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+int
+perf_arg(int argc, char *argv[], int idx, int def)
+{
+	if (argc > idx) {
+		return atoi(argv[idx]);
+	}
+	return def;
+}
+
+struct ly_ctx *
+perf_ctx_new(const char *schema, ...)
+{
+	struct ly_ctx *ctx;
+	va_list ap;
+
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx) {
+		fprintf(stderr, "Failed to create context.\n");
+		return NULL;
+	}
+
+	va_start(ap, schema);
+	for (; schema; schema = va_arg(ap, const char *)) {
+		if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+			fprintf(stderr, "Failed to load data model.\n");
+			ly_ctx_destroy(ctx, NULL);
+			ctx = NULL;
+			break;
+		}
+	}
+	va_end(ap);
+
+	return ctx;
+}
+
+char *
+perf_buf_new(size_t size)
+{
+	char *buf;
+
+	buf = malloc(size);
+	if (!buf) {
+		fprintf(stderr, "Memory allocation error.\n");
+	}
+	return buf;
+}
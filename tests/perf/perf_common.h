@@ -0,0 +1,56 @@
+/**
+ * @file perf_common.h
+ * @brief performance tests - common timing and fixture helpers.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#ifndef PERF_COMMON_H_
+#define PERF_COMMON_H_
+
+#include <stddef.h>
+#include <time.h>
+
+#include "libyang.h"
+
+/**
+ * @brief Get the current time to measure from.
+ */
+#define PERF_START(start) clock_gettime(CLOCK_MONOTONIC, start)
+
+/**
+ * @brief Milliseconds elapsed since \p start.
+ */
+double perf_elapsed(const struct timespec *start);
+
+/**
+ * @brief Get an optional numeric command-line argument.
+ *
+ * @param[in] idx Index of the argument.
+ * @param[in] def Value used when the argument is not present.
+ * @return Argument value, \p def if not present.
+ */
+int perf_arg(int argc, char *argv[], int idx, int def);
+
+/**
+ * @brief Create a new context with YANG modules.
+ *
+ * @param[in] schema First YANG module, followed by any other modules and NULL.
+ * @return New context, NULL on error (printed).
+ */
+struct ly_ctx *perf_ctx_new(const char *schema, ...);
+
+/**
+ * @brief Allocate a buffer for generated data.
+ *
+ * @return Buffer of \p size bytes, NULL on error (printed).
+ */
+char *perf_buf_new(size_t size);
+
+#endif /* PERF_COMMON_H_ */
@@ -0,0 +1,121 @@
+/**
+ * @file print.c
+ * @brief performance test - printing a large data tree sequentially and in several threads.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "perf_common.h"
+
+#define ROUNDS 5
+
+static const char *schema =
+"module print {"
+"  namespace urn:print;"
+"  prefix p;"
+"  container top {"
+"    list entry {"
+"      key id;"
+"      leaf id { type uint32; }"
+"      leaf name { type string; }"
+"      leaf enabled { type boolean; }"
+"      container stats {"
+"        leaf in { type uint64; }"
+"        leaf out { type uint64; }"
+"      }"
+"      leaf-list tag { type string; }"
+"    }"
+"  }"
+"}";
+
+/* average time of printing the data, -1 on error */
+static double
+print(struct lyd_node *data, LYD_FORMAT format, int options, size_t *len)
+{
+	struct timespec start;
+	double ms = 0;
+	char *str;
+	int i;
+
+	for (i = 0; i < ROUNDS; i++) {
+		PERF_START(&start);
+		if (lyd_print_mem(&str, data, format, options)) {
+			return -1;
+		}
+		ms += perf_elapsed(&start);
+		*len = strlen(str);
+		free(str);
+	}
+	return ms / ROUNDS;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *data = NULL;
+	char *xml, *ptr;
+	const LYD_FORMAT formats[] = {LYD_XML, LYD_JSON};
+	double seq_ms, par_ms;
+	size_t seq_len, par_len;
+	int i, count = 200000, threads = 0, ret = 1;
+
+	count = perf_arg(argc, argv, 1, count);
+	threads = perf_arg(argc, argv, 2, threads);
+	if ((count < 1) || (threads < 0)) {
+		fprintf(stderr, "Usage: %s [entry-count [threads]]\n", argv[0]);
+		return 1;
+	}
+	lyd_print_threads(threads);
+
+	ctx = perf_ctx_new(schema, NULL);
+	if (!ctx) {
+		return 1;
+	}
+
+	xml = perf_buf_new(count * 200 + 64);
+	if (!xml) {
+		ly_ctx_destroy(ctx, NULL);
+		return 1;
+	}
+	ptr = xml + sprintf(xml, "<top xmlns=\"urn:print\">");
+	for (i = 0; i < count; i++) {
+		ptr += sprintf(ptr, "<entry><id>%d</id><name>entry %d</name><enabled>%s</enabled><stats><in>%d</in><out>%d</out>"
+		               "</stats><tag>a&amp;b</tag><tag>tag%d</tag></entry>", i, i, (i % 2) ? "true" : "false", i * 3,
+		               i * 7, i);
+	}
+	sprintf(ptr, "</top>");
+
+	data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+	free(xml);
+	if (!data) {
+		fprintf(stderr, "Failed to parse data.\n");
+		goto cleanup;
+	}
+
+	for (i = 0; i < 2; i++) {
+		seq_ms = print(data, formats[i], LYP_FORMAT | LYP_WITHSIBLINGS, &seq_len);
+		par_ms = print(data, formats[i], LYP_FORMAT | LYP_WITHSIBLINGS | LYP_PARALLEL, &par_len);
+		if ((seq_ms < 0) || (par_ms < 0) || (seq_len != par_len)) {
+			fprintf(stderr, "Failed to print data.\n");
+			goto cleanup;
+		}
+		printf("%d entries as %-4s (%6.1f MB): sequential %9.3f ms  parallel %9.3f ms\n", count,
+		       (formats[i] == LYD_XML) ? "XML" : "JSON", seq_len / 1048576.0, seq_ms, par_ms);
+	}
+	ret = 0;
+
+cleanup:
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+	return ret;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file statelists.c
+ * @brief performance test - building and parsing nested state lists without keys.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "perf_common.h"
+
+static const char *schema =
+"module statelists {"
+"  namespace urn:statelists;"
+"  prefix s;"
+"  container stats {"
+"    config false;"
+"    list entry {"
+"      leaf name { type string; }"
+"      leaf count { type uint32; }"
+"      container detail {"
+"        list sample {"
+"          leaf value { type uint32; }"
+"          leaf-list tag { type string; }"
+"        }"
+"      }"
+"    }"
+"  }"
+"}";
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	const struct lys_module *mod;
+	struct timespec start;
+	struct lyd_node *data = NULL, *parsed = NULL, *entry, *detail, *sample;
+	char buf[32], *str = NULL;
+	double build_ms, parse_ms;
+	int i, j, count = 200, samples = 100, ret = 1;
+
+	count = perf_arg(argc, argv, 1, count);
+	samples = perf_arg(argc, argv, 2, samples);
+	if ((count < 1) || (samples < 1)) {
+		fprintf(stderr, "Usage: %s [entry-count [sample-count]]\n", argv[0]);
+		return 1;
+	}
+
+	ctx = perf_ctx_new(schema, NULL);
+	if (!ctx) {
+		return 1;
+	}
+	mod = ly_ctx_get_module(ctx, "statelists", NULL, 0);
+
+	/* every new node is inserted into a subtree of (nested) lists without keys */
+	PERF_START(&start);
+	data = lyd_new(NULL, mod, "stats");
+	for (i = 0; i < count; i++) {
+		entry = lyd_new(data, mod, "entry");
+		sprintf(buf, "entry%d", i);
+		lyd_new_leaf(entry, mod, "name", buf);
+		detail = lyd_new(entry, mod, "detail");
+		for (j = 0; j < samples; j++) {
+			sample = lyd_new(detail, mod, "sample");
+			sprintf(buf, "%d", j);
+			lyd_new_leaf(sample, mod, "value", buf);
+			lyd_new_leaf(sample, mod, "tag", buf);
+		}
+		sprintf(buf, "%d", samples);
+		if (!lyd_new_leaf(entry, mod, "count", buf)) {
+			fprintf(stderr, "Failed to create data.\n");
+			goto cleanup;
+		}
+	}
+	build_ms = perf_elapsed(&start);
+
+	if (lyd_print_mem(&str, data, LYD_XML, LYP_WITHSIBLINGS)) {
+		fprintf(stderr, "Failed to print data.\n");
+		goto cleanup;
+	}
+
+	PERF_START(&start);
+	parsed = lyd_parse_mem(ctx, str, LYD_XML, LYD_OPT_GET | LYD_OPT_TRUSTED);
+	parse_ms = perf_elapsed(&start);
+	if (!parsed) {
+		fprintf(stderr, "Failed to parse data.\n");
+		goto cleanup;
+	}
+
+	printf("%d entries, %d samples each: build %8.3f ms  parse %8.3f ms\n", count, samples, build_ms, parse_ms);
+	ret = 0;
+
+cleanup:
+	free(str);
+	lyd_free_withsiblings(parsed);
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+	return ret;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file strings.c
+ * @brief performance test - printing and parsing long string values.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "perf_common.h"
+
+#define ROUNDS 20
+
+static const char *schema =
+"module strings {"
+"  namespace urn:strings;"
+"  prefix s;"
+"  list item {"
+"    key id;"
+"    leaf id { type uint32; }"
+"    leaf text { type string; }"
+"  }"
+"}";
+
+static int
+bench(struct ly_ctx *ctx, struct lyd_node *data, LYD_FORMAT format, const char *name)
+{
+	struct timespec start;
+	struct lyd_node *parsed;
+	char *str = NULL;
+	double print_ms = 0, parse_ms = 0;
+	int i;
+
+	for (i = 0; i < ROUNDS; i++) {
+		free(str);
+		PERF_START(&start);
+		if (lyd_print_mem(&str, data, format, LYP_WITHSIBLINGS)) {
+			fprintf(stderr, "Failed to print data.\n");
+			return 1;
+		}
+		print_ms += perf_elapsed(&start);
+
+		PERF_START(&start);
+		parsed = lyd_parse_mem(ctx, str, format, LYD_OPT_CONFIG | LYD_OPT_TRUSTED);
+		parse_ms += perf_elapsed(&start);
+		if (!parsed) {
+			fprintf(stderr, "Failed to parse data.\n");
+			free(str);
+			return 1;
+		}
+		lyd_free_withsiblings(parsed);
+	}
+
+	printf("%-6s %8zu bytes  print %8.3f ms  parse %8.3f ms\n", name, strlen(str), print_ms / ROUNDS, parse_ms / ROUNDS);
+	free(str);
+	return 0;
+}
+
+static struct lyd_node *
+create_data(struct ly_ctx *ctx, int count, const char *text)
+{
+	struct lyd_node *data = NULL, *node;
+	char path[64];
+	int i;
+
+	for (i = 0; i < count; i++) {
+		sprintf(path, "/strings:item[id='%d']/text", i);
+		node = lyd_new_path(data, ctx, path, (void *)text, 0, 0);
+		if (!node) {
+			fprintf(stderr, "Failed to create data.\n");
+			lyd_free_withsiblings(data);
+			return NULL;
+		}
+		if (!data) {
+			data = node;
+		}
+	}
+
+	return data;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *data = NULL;
+	/* 2-, 3- and 4-byte characters */
+	const char *utf8[] = {"\xc3\xa4", "\xe2\x82\xac", "\xf0\x9f\x98\x80"};
+	char *text = NULL;
+	int i, j, count = 1000, len = 2000, ret = 1;
+
+	count = perf_arg(argc, argv, 1, count);
+	len = perf_arg(argc, argv, 2, len);
+	if ((count < 1) || (len < 1)) {
+		fprintf(stderr, "Usage: %s [item-count [text-length]]\n", argv[0]);
+		return 1;
+	}
+
+	ctx = perf_ctx_new(schema, NULL);
+	if (!ctx) {
+		return 1;
+	}
+
+	/* long plain ASCII text with a character to escape once in a while */
+	text = perf_buf_new(len + 4);
+	if (!text) {
+		goto cleanup;
+	}
+	for (i = 0; i < len; i++) {
+		text[i] = (i % 500 == 499) ? '&' : 'a' + (i % 26);
+	}
+	text[len] = '\0';
+
+	data = create_data(ctx, count, text);
+	if (!data || bench(ctx, data, LYD_XML, "XML") || bench(ctx, data, LYD_JSON, "JSON")) {
+		goto cleanup;
+	}
+	lyd_free_withsiblings(data);
+
+	/* the same length of non-ASCII text, a space once in a while */
+	for (i = 0; i < len; ) {
+		if (i % 64 == 63) {
+			text[i++] = ' ';
+			continue;
+		}
+		j = i % 3;
+		strcpy(&text[i], utf8[j]);
+		i += strlen(utf8[j]);
+	}
+	text[i] = '\0';
+
+	data = create_data(ctx, count, text);
+	if (!data) {
+		goto cleanup;
+	}
+	ret = bench(ctx, data, LYD_XML, "XML-8") || bench(ctx, data, LYD_JSON, "JSON-8");
+
+cleanup:
+	free(text);
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+	return ret;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file unions.c
+ * @brief performance test - parsing values of union types, mostly from ietf-inet-types.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "perf_common.h"
+
+static const char *schema =
+"module unions {"
+"  namespace urn:unions;"
+"  prefix u;"
+"  import ietf-inet-types { prefix inet; }"
+"  container top {"
+"    list entry {"
+"      key id;"
+"      leaf id { type uint32; }"
+"      leaf address { type inet:ip-address; }"
+"      leaf host { type inet:host; }"
+"      leaf port { type union { type inet:port-number; type enumeration { enum any; } } }"
+"      leaf mixed { type union { type uint32; type enumeration { enum auto; enum none; } type string; } }"
+"    }"
+"  }"
+"}";
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct timespec start;
+	struct lyd_node *data = NULL;
+	char *xml, *ptr;
+	double parse_ms;
+	int i, count = 20000, rounds = 5, ret = 1;
+
+	count = perf_arg(argc, argv, 1, count);
+	if (count < 1) {
+		fprintf(stderr, "Usage: %s [entry-count]\n", argv[0]);
+		return 1;
+	}
+
+	ctx = perf_ctx_new(schema, NULL);
+	if (!ctx) {
+		return 1;
+	}
+
+	/* every union member is the first one to match for some of the values */
+	xml = perf_buf_new(count * 256 + 64);
+	if (!xml) {
+		ly_ctx_destroy(ctx, NULL);
+		return 1;
+	}
+	ptr = xml + sprintf(xml, "<top xmlns=\"urn:unions\">");
+	for (i = 0; i < count; i++) {
+		ptr += sprintf(ptr, "<entry><id>%d</id>", i);
+		if (i % 2) {
+			ptr += sprintf(ptr, "<address>10.%d.%d.1</address>", (i >> 8) & 0xff, i & 0xff);
+		} else {
+			ptr += sprintf(ptr, "<address>2001:db8::%x</address>", i & 0xffff);
+		}
+		if (i % 3) {
+			ptr += sprintf(ptr, "<host>host%d.example.com</host>", i);
+		} else {
+			ptr += sprintf(ptr, "<host>192.0.2.%d</host>", i & 0xff);
+		}
+		ptr += sprintf(ptr, (i % 4) ? "<port>%d</port>" : "<port>any</port>", i & 0xffff);
+		switch (i % 3) {
+		case 0:
+			ptr += sprintf(ptr, "<mixed>%d</mixed>", i);
+			break;
+		case 1:
+			ptr += sprintf(ptr, "<mixed>auto</mixed>");
+			break;
+		default:
+			ptr += sprintf(ptr, "<mixed>name%d</mixed>", i);
+			break;
+		}
+		ptr += sprintf(ptr, "</entry>");
+	}
+	sprintf(ptr, "</top>");
+
+	parse_ms = 0;
+	for (i = 0; i < rounds; i++) {
+		PERF_START(&start);
+		data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+		parse_ms += perf_elapsed(&start);
+		if (!data) {
+			fprintf(stderr, "Failed to parse data.\n");
+			goto cleanup;
+		}
+		lyd_free_withsiblings(data);
+	}
+
+	printf("%d entries with 4 union values each: parse %8.3f ms\n", count, parse_ms / rounds);
+	ret = 0;
+
+cleanup:
+	free(xml);
+	ly_ctx_destroy(ctx, NULL);
+	return ret;
+}
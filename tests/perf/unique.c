@@ -0,0 +1,117 @@
+/**
+ * @file unique.c
+ * @brief performance test - validating unique statements of long lists.
+ *
+ * Copyright (c) 2026 libyang contributors
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "perf_common.h"
+
+static const char *schema =
+"module unique {"
+"  namespace urn:unique;"
+"  prefix u;"
+"  container top {"
+"    list entry {"
+"      key id;"
+"      unique \"address port\";"
+"      unique \"info/name\";"
+"      leaf id { type uint32; }"
+"      leaf address { type string; }"
+"      leaf port { type uint16; default 830; }"
+"      container info {"
+"        leaf name { type string; }"
+"      }"
+"    }"
+"  }"
+"}";
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct timespec start;
+	struct lyd_node *data = NULL, *entry;
+	struct ly_set *set;
+	char *xml, *ptr;
+	double parse_ms, validate_ms;
+	int i, count = 100000, rounds = 5, ret = 1;
+
+	count = perf_arg(argc, argv, 1, count);
+	if (count < 1) {
+		fprintf(stderr, "Usage: %s [entry-count]\n", argv[0]);
+		return 1;
+	}
+
+	ctx = perf_ctx_new(schema, NULL);
+	if (!ctx) {
+		return 1;
+	}
+
+	/* every other entry uses the default port */
+	xml = perf_buf_new(count * 128 + 64);
+	if (!xml) {
+		ly_ctx_destroy(ctx, NULL);
+		return 1;
+	}
+	ptr = xml + sprintf(xml, "<top xmlns=\"urn:unique\">");
+	for (i = 0; i < count; i++) {
+		ptr += sprintf(ptr, "<entry><id>%d</id><address>10.%d.%d.%d</address>", i, (i >> 16) & 0xff, (i >> 8) & 0xff,
+		               i & 0xff);
+		if (i % 2) {
+			ptr += sprintf(ptr, "<port>%d</port>", 1024 + (i & 0xff));
+		}
+		ptr += sprintf(ptr, "<info><name>entry%d</name></info></entry>", i);
+	}
+	sprintf(ptr, "</top>");
+
+	parse_ms = validate_ms = 0;
+	for (i = 0; i < rounds; i++) {
+		PERF_START(&start);
+		data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+		parse_ms += perf_elapsed(&start);
+		if (!data) {
+			fprintf(stderr, "Failed to parse data.\n");
+			goto cleanup;
+		}
+
+		/* change a single entry, all the unique statements must be checked again */
+		set = lyd_find_path(data, "/unique:top/entry[id='0']/info/name");
+		if (!set || (set->number != 1)) {
+			fprintf(stderr, "Failed to find data.\n");
+			ly_set_free(set);
+			lyd_free_withsiblings(data);
+			goto cleanup;
+		}
+		entry = set->set.d[0];
+		ly_set_free(set);
+		lyd_change_leaf((struct lyd_node_leaf_list *)entry, "renamed");
+
+		PERF_START(&start);
+		if (lyd_validate(&data, LYD_OPT_CONFIG, NULL)) {
+			fprintf(stderr, "Failed to validate data.\n");
+			lyd_free_withsiblings(data);
+			goto cleanup;
+		}
+		validate_ms += perf_elapsed(&start);
+		lyd_free_withsiblings(data);
+	}
+
+	printf("%d entries with 2 unique statements: parse %8.3f ms  validate %8.3f ms\n", count, parse_ms / rounds,
+	       validate_ms / rounds);
+	ret = 0;
+
+cleanup:
+	free(xml);
+	ly_ctx_destroy(ctx, NULL);
+	return ret;
+}
@@ -257,6 +257,59 @@ test_inval_expr5(void **state)
     assert_int_equal(ly_vecode(ctx), LYVE_INARG);
 }
 
+static void
+test_toggle(void **state)
+{
+    struct ly_ctx *ctx = *state;
+    const struct lys_module *mod1, *mod2;
+    const struct lys_node *cont, *leaf, *other;
+    const char *yang1 = "module toggle1 {\n"
+"  namespace \"urn:toggle1\";\n"
+"  prefix t1;\n"
+"  feature a;\n"
+"  feature b { if-feature a; }\n"
+"  container c { if-feature a; leaf l { if-feature b; type string; } }}";
+    const char *yang2 = "module toggle2 {\n"
+"  namespace \"urn:toggle2\";\n"
+"  prefix t2;\n"
+"  import toggle1 { prefix t1; }\n"
+"  leaf m { if-feature t1:a; type string; }}";
+
+    mod1 = lys_parse_mem(ctx, yang1, LYS_IN_YANG);
+    assert_non_null(mod1);
+    mod2 = lys_parse_mem(ctx, yang2, LYS_IN_YANG);
+    assert_non_null(mod2);
+    cont = mod1->data;
+    leaf = cont->child;
+    other = mod2->data;
+
+    /* evaluate (and remember) the initial state */
+    assert_ptr_equal(lys_is_disabled(cont, 0), cont);
+    assert_ptr_equal(lys_is_disabled(leaf, 1), leaf);
+    assert_ptr_equal(lys_is_disabled(other, 0), other);
+    assert_null(lys_getnext(NULL, NULL, mod2, 0));
+
+    assert_int_equal(lys_features_enable(mod1, "a"), 0);
+    assert_null(lys_is_disabled(cont, 0));
+    assert_ptr_equal(lys_is_disabled(leaf, 1), leaf);
+    assert_null(lys_is_disabled(other, 0));
+    assert_ptr_equal(lys_getnext(NULL, NULL, mod2, 0), other);
+
+    assert_int_equal(lys_features_enable(mod1, "b"), 0);
+    assert_null(lys_is_disabled(leaf, 1));
+
+    /* disabling a also disables b */
+    assert_int_equal(lys_features_disable(mod1, "a"), 0);
+    assert_ptr_equal(lys_is_disabled(cont, 0), cont);
+    assert_ptr_equal(lys_is_disabled(leaf, 0), leaf);
+    assert_ptr_equal(lys_is_disabled(other, 0), other);
+    assert_null(lys_getnext(NULL, NULL, mod2, 0));
+
+    assert_int_equal(lys_features_enable(mod1, "*"), 0);
+    assert_null(lys_is_disabled(leaf, 1));
+    assert_null(lys_is_disabled(other, 1));
+}
+
 int
 main(void)
 {
@@ -269,7 +322,8 @@ main(void)
         cmocka_unit_test_setup_teardown(test_inval_expr2, setup_ctx_yang, teardown_ctx),
         cmocka_unit_test_setup_teardown(test_inval_expr3, setup_ctx_yang, teardown_ctx),
         cmocka_unit_test_setup_teardown(test_inval_expr4, setup_ctx_yang, teardown_ctx),
-        cmocka_unit_test_setup_teardown(test_inval_expr5, setup_ctx_yang, teardown_ctx)
+        cmocka_unit_test_setup_teardown(test_inval_expr5, setup_ctx_yang, teardown_ctx),
+        cmocka_unit_test_setup_teardown(test_toggle, setup_ctx_yang, teardown_ctx)
     };
 
     return cmocka_run_group_tests(cmut, NULL, NULL);
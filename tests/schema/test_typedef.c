@@ -1146,7 +1146,7 @@ test_typedef_patterns_optimizations_schema(struct state *st, const struct lys_mo
     const char *invalid2 = "<b xmlns=\"urn:libyang:tests:patterns\">b</b>";
     const char *invalid3 = "<c xmlns=\"urn:libyang:tests:patterns\">c</c>";
     struct lys_node_grp *grp = NULL;
-    struct lys_node_leaf *leaf = NULL;
+    struct lys_node_leaf *leaf = NULL, *grp_leaf = NULL;
     struct lys_node *iter;
     struct lyd_node *data;
 
@@ -1176,22 +1176,21 @@ test_typedef_patterns_optimizations_schema(struct state *st, const struct lys_mo
     assert_ptr_not_equal(grp->tpdf[0].type.info.str.patterns_pcre, NULL);
 #endif
 
-    /* 3. grouping's leaf does not have PCRE data */
+    /* 3. grouping's leaf has PCRE data compiled once it was instantiated */
     LY_TREE_FOR(mod->data, iter) {
         if (iter->nodetype == LYS_GROUPING && !strcmp(iter->name, "b")) {
-            leaf = (struct lys_node_leaf*)iter->child;
+            grp_leaf = (struct lys_node_leaf*)iter->child;
             break;
         }
     }
-    assert_ptr_not_equal(leaf, NULL);
-    assert_int_equal(leaf->type.base, LY_TYPE_STRING);
-    assert_int_equal(leaf->type.info.str.pat_count, 1);
+    assert_ptr_not_equal(grp_leaf, NULL);
+    assert_int_equal(grp_leaf->type.base, LY_TYPE_STRING);
+    assert_int_equal(grp_leaf->type.info.str.pat_count, 1);
 #ifdef LY_ENABLED_CACHE
-    assert_ptr_equal(leaf->type.info.str.patterns_pcre, NULL);
+    assert_ptr_not_equal(grp_leaf->type.info.str.patterns_pcre, NULL);
 #endif
-    leaf = NULL;
 
-    /* 4. but it's instantiated copy does have PCRE data */
+    /* 4. and it's instantiated copy shares the patterns with it */
     LY_TREE_FOR(mod->data, iter) {
         if (iter->nodetype == LYS_USES && !strcmp(iter->name, "b")) {
             leaf = (struct lys_node_leaf*)iter->child;
@@ -1201,8 +1200,9 @@ test_typedef_patterns_optimizations_schema(struct state *st, const struct lys_mo
     assert_ptr_not_equal(leaf, NULL);
     assert_int_equal(leaf->type.base, LY_TYPE_STRING);
     assert_int_equal(leaf->type.info.str.pat_count, 1);
+    assert_ptr_equal(leaf->type.info.str.patterns, grp_leaf->type.info.str.patterns);
 #ifdef LY_ENABLED_CACHE
-    assert_ptr_not_equal(leaf->type.info.str.patterns_pcre, NULL);
+    assert_ptr_equal(leaf->type.info.str.patterns_pcre, grp_leaf->type.info.str.patterns_pcre);
 #endif
 
     /* check data */
@@ -1239,6 +1239,89 @@ test_typedef_patterns_optimizations_yin(void **state)
     test_typedef_patterns_optimizations_schema(st, mod);
 }
 
+static void
+test_typedef_grouping_shared(void **state)
+{
+    struct state *st = (*state);
+    const struct lys_module *mod_a, *mod_b, *mod_d;
+    const struct lys_node_leaf *grp_e, *grp_n, *grp_u, *leaf;
+    struct lyd_node *data;
+    const char *yang_a = "module a {"
+                         "  namespace urn:a;"
+                         "  prefix a;"
+                         "  grouping g {"
+                         "    leaf e { type enumeration { enum one; enum two; } }"
+                         "    leaf n { type uint8 { range \"1..10\"; } }"
+                         "    leaf u { type union { type string { length 1..3; } type enumeration { enum x; } } }"
+                         "  }"
+                         "  container c { uses g; }"
+                         "}";
+    const char *yang_b = "module b {"
+                         "  namespace urn:b;"
+                         "  prefix b;"
+                         "  import a { prefix a; }"
+                         "  container c { uses a:g; }"
+                         "}";
+    const char *yang_d = "module d {"
+                         "  namespace urn:d;"
+                         "  prefix d;"
+                         "  import b { prefix b; }"
+                         "  deviation /b:c/b:e { deviate replace { type string; } }"
+                         "}";
+
+    mod_a = lys_parse_mem(st->ctx, yang_a, LYS_IN_YANG);
+    assert_ptr_not_equal(mod_a, NULL);
+    mod_b = lys_parse_mem(st->ctx, yang_b, LYS_IN_YANG);
+    assert_ptr_not_equal(mod_b, NULL);
+
+    grp_e = (const struct lys_node_leaf *)mod_a->data->child;
+    grp_n = (const struct lys_node_leaf *)grp_e->next;
+    grp_u = (const struct lys_node_leaf *)grp_n->next;
+
+    /* the instances reference the enums and restrictions of the grouping */
+    leaf = (const struct lys_node_leaf *)ly_ctx_get_node(st->ctx, NULL, "/a:c/e", 0);
+    assert_ptr_not_equal(leaf, NULL);
+    assert_ptr_equal(leaf->type.info.enums.enm, grp_e->type.info.enums.enm);
+    leaf = (const struct lys_node_leaf *)ly_ctx_get_node(st->ctx, NULL, "/b:c/e", 0);
+    assert_ptr_not_equal(leaf, NULL);
+    assert_ptr_equal(leaf->type.info.enums.enm, grp_e->type.info.enums.enm);
+    leaf = (const struct lys_node_leaf *)ly_ctx_get_node(st->ctx, NULL, "/b:c/n", 0);
+    assert_ptr_not_equal(leaf, NULL);
+    assert_ptr_equal(leaf->type.info.num.range, grp_n->type.info.num.range);
+
+    /* only the union members are shared, not the union itself */
+    leaf = (const struct lys_node_leaf *)ly_ctx_get_node(st->ctx, NULL, "/b:c/u", 0);
+    assert_ptr_not_equal(leaf, NULL);
+    assert_ptr_not_equal(leaf->type.info.uni.types, grp_u->type.info.uni.types);
+    assert_ptr_equal(leaf->type.info.uni.types[0].info.str.length, grp_u->type.info.uni.types[0].info.str.length);
+    assert_ptr_equal(leaf->type.info.uni.types[1].info.enums.enm, grp_u->type.info.uni.types[1].info.enums.enm);
+
+    data = lyd_parse_mem(st->ctx, "<c xmlns=\"urn:b\"><e>two</e><n>5</n><u>x</u></c>", LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(data, NULL);
+    lyd_free_withsiblings(data);
+    assert_ptr_equal(lyd_parse_mem(st->ctx, "<c xmlns=\"urn:b\"><n>11</n></c>", LYD_XML, LYD_OPT_CONFIG), NULL);
+    assert_ptr_equal(lyd_parse_mem(st->ctx, "<c xmlns=\"urn:b\"><u>abcd</u></c>", LYD_XML, LYD_OPT_CONFIG), NULL);
+
+    /* a deviated instance gets its own type */
+    mod_d = lys_parse_mem(st->ctx, yang_d, LYS_IN_YANG);
+    assert_ptr_not_equal(mod_d, NULL);
+    leaf = (const struct lys_node_leaf *)ly_ctx_get_node(st->ctx, NULL, "/b:c/e", 0);
+    assert_ptr_not_equal(leaf, NULL);
+    assert_int_equal(leaf->type.base, LY_TYPE_STRING);
+    assert_int_equal(grp_e->type.base, LY_TYPE_ENUM);
+    data = lyd_parse_mem(st->ctx, "<c xmlns=\"urn:b\"><e>three</e></c>", LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(data, NULL);
+    lyd_free_withsiblings(data);
+
+    /* removing the deviation restores the shared type, removing the grouping module removes its users as well */
+    assert_int_equal(ly_ctx_remove_module(mod_d, NULL), 0);
+    leaf = (const struct lys_node_leaf *)ly_ctx_get_node(st->ctx, NULL, "/b:c/e", 0);
+    assert_ptr_not_equal(leaf, NULL);
+    assert_ptr_equal(leaf->type.info.enums.enm, grp_e->type.info.enums.enm);
+    assert_int_equal(ly_ctx_remove_module(mod_a, NULL), 0);
+    assert_ptr_equal(ly_ctx_get_module(st->ctx, "b", NULL, 0), NULL);
+}
+
 int
 main(void)
 {
@@ -1266,6 +1349,7 @@ main(void)
         cmocka_unit_test_setup_teardown(test_typedef_11_union_empty_yang, setup_ctx, teardown_ctx),
         cmocka_unit_test_setup_teardown(test_typedef_patterns_optimizations_yin, setup_ctx, teardown_ctx),
         cmocka_unit_test_setup_teardown(test_typedef_patterns_optimizations_yang, setup_ctx, teardown_ctx),
+        cmocka_unit_test_setup_teardown(test_typedef_grouping_shared, setup_ctx, teardown_ctx),
     };
 
     return cmocka_run_group_tests(cmut, NULL, NULL);